@@ -18,7 +18,7 @@ fi
 
 echo ""
 echo "Installing dependencies via vcpkg (this may take 30-60 minutes on first run)..."
-"${VCPKG_ROOT}/vcpkg" install google-cloud-cpp[core,storage]:x64-linux gtest:x64-linux
+"${VCPKG_ROOT}/vcpkg" install google-cloud-cpp[core,storage]:x64-linux gtest:x64-linux benchmark:x64-linux
 
 echo ""
 echo "=== Setup complete! ==="
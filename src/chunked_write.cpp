@@ -0,0 +1,166 @@
+#include "chunked_write.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+namespace gcscfuse {
+
+ChunkedWrite::ChunkedWrite(size_t base_size, size_t chunk_size, std::int64_t base_generation)
+    : chunk_size_(std::max<size_t>(chunk_size, 1)),
+      base_size_(base_size),
+      base_generation_(base_generation),
+      base_valid_(base_size),
+      size_(base_size)
+{
+}
+
+size_t ChunkedWrite::growth(off_t offset, size_t size) const {
+    if (offset < 0 || size == 0) {
+        return 0;
+    }
+    const size_t first = static_cast<size_t>(offset) / chunk_size_;
+    const size_t last = (static_cast<size_t>(offset) + size - 1) / chunk_size_;
+    size_t missing = 0;
+    for (size_t index = first; index <= last; ++index) {
+        if (chunks_.find(index) == chunks_.end()) {
+            missing++;
+        }
+    }
+    return missing * chunk_size_;
+}
+
+ssize_t ChunkedWrite::write(const char* data, size_t size, off_t offset, const BaseReader& read_base) {
+    if (offset < 0) {
+        return -EINVAL;
+    }
+    const size_t start = static_cast<size_t>(offset);
+    const size_t end = start + size;
+
+    for (size_t pos = start; pos < end;) {
+        const size_t index = pos / chunk_size_;
+        const size_t chunk_start = index * chunk_size_;
+        const size_t chunk_end = chunk_start + chunk_size_;
+
+        auto it = chunks_.find(index);
+        if (it == chunks_.end()) {
+            // Bring in the chunk's base bytes, unless this write replaces all of them
+            std::string chunk(chunk_size_, '\0');
+            const size_t base_end = std::min(chunk_end, base_valid_);
+            const bool covered = start <= chunk_start && end >= base_end;
+            if (base_end > chunk_start && !covered &&
+                !readBase(&chunk[0], base_end - chunk_start, chunk_start, read_base)) {
+                return pos > start ? static_cast<ssize_t>(pos - start) : -EIO;
+            }
+            it = chunks_.emplace(index, std::move(chunk)).first;
+        }
+
+        const size_t piece = std::min(chunk_end, end) - pos;
+        std::memcpy(&it->second[pos - chunk_start], data + (pos - start), piece);
+        // A gap between the old end and pos now reads as zeros too
+        first_change_ = std::min(first_change_, std::min(pos, size_));
+        pos += piece;
+        size_ = std::max(size_, pos);
+    }
+    return static_cast<ssize_t>(size);
+}
+
+ssize_t ChunkedWrite::read(char* buf, size_t size, off_t offset, const BaseReader& read_base) const {
+    if (offset < 0) {
+        return -EINVAL;
+    }
+    const size_t start = static_cast<size_t>(offset);
+    if (start >= size_) {
+        return 0;
+    }
+    size = std::min(size, size_ - start);
+
+    for (size_t pos = start; pos < start + size;) {
+        const size_t index = pos / chunk_size_;
+        const size_t chunk_start = index * chunk_size_;
+        const size_t piece = std::min(chunk_start + chunk_size_, start + size) - pos;
+        char* out = buf + (pos - start);
+
+        auto it = chunks_.find(index);
+        if (it != chunks_.end()) {
+            std::memcpy(out, it->second.data() + (pos - chunk_start), piece);
+        } else {
+            const size_t base_part = pos < base_valid_ ? std::min(piece, base_valid_ - pos) : 0;
+            if (base_part > 0 && !readBase(out, base_part, pos, read_base)) {
+                return -EIO;
+            }
+            std::memset(out + base_part, 0, piece - base_part);
+        }
+        pos += piece;
+    }
+    return static_cast<ssize_t>(size);
+}
+
+void ChunkedWrite::truncate(size_t new_size) {
+    if (new_size == size_) {
+        return;
+    }
+    first_change_ = std::min(first_change_, std::min(new_size, size_));
+
+    if (new_size < size_) {
+        // Chunks past the end are dropped; the cut-off part of the last one
+        // is zeroed so it reads as zeros if the file grows again
+        chunks_.erase(chunks_.lower_bound((new_size + chunk_size_ - 1) / chunk_size_), chunks_.end());
+        auto it = chunks_.find(new_size / chunk_size_);
+        if (it != chunks_.end()) {
+            const size_t keep = new_size % chunk_size_;
+            std::memset(&it->second[keep], 0, chunk_size_ - keep);
+        }
+        base_valid_ = std::min(base_valid_, new_size);
+    }
+    size_ = new_size;
+}
+
+bool ChunkedWrite::copyTo(size_t offset, const Sink& sink, const BaseReader& read_base) const {
+    std::string scratch;
+    for (size_t pos = offset; pos < size_;) {
+        const size_t index = pos / chunk_size_;
+        const size_t chunk_start = index * chunk_size_;
+        const size_t piece = std::min(chunk_start + chunk_size_, size_) - pos;
+
+        auto it = chunks_.find(index);
+        if (it != chunks_.end()) {
+            if (!sink(it->second.data() + (pos - chunk_start), piece)) {
+                return false;
+            }
+        } else {
+            scratch.assign(piece, '\0');
+            const size_t base_part = pos < base_valid_ ? std::min(piece, base_valid_ - pos) : 0;
+            if (base_part > 0 && !readBase(&scratch[0], base_part, pos, read_base)) {
+                return false;
+            }
+            if (!sink(scratch.data(), piece)) {
+                return false;
+            }
+        }
+        pos += piece;
+    }
+    return true;
+}
+
+bool ChunkedWrite::appendOnly() const {
+    return changed() && base_valid_ == base_size_ && first_change_ >= base_size_ && size_ > base_size_;
+}
+
+bool ChunkedWrite::readBase(char* buf, size_t size, size_t offset, const BaseReader& read_base) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = read_base(buf + done, size - done, static_cast<off_t>(offset + done));
+        if (n < 0) {
+            return false;
+        }
+        if (n == 0) {
+            // The base ended early (changed underneath); the rest reads as zeros
+            std::memset(buf + done, 0, size - done);
+            break;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace gcscfuse
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <functional>
+#include <limits>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+
+namespace gcscfuse {
+
+/**
+ * ChunkedWrite - Pending edits of a large existing object, held per chunk
+ *
+ * The object's content is divided into fixed-size chunks. Only chunks that
+ * have been written are held in memory; every other byte is still read
+ * from the original (base) object, so an edit or an append costs a chunk
+ * of memory rather than the whole object. A chunk is read from the base
+ * when first written, unless the write covers all of its base bytes.
+ *
+ * Truncating keeps only a prefix of the base; bytes past the end of the
+ * base (or of a truncation) read as zeros, as in any sparse file.
+ *
+ * When every change lies at or after the end of the base, the new content
+ * is the base followed by a tail (appendOnly()), which GCS can join with
+ * compose instead of the whole object being uploaded again.
+ *
+ * The base is one GCS generation of the object: base reads are pinned to
+ * it, and the upload only succeeds while it is still the live version.
+ * A base of unknown generation (0) can only be rewritten unconditionally.
+ *
+ * Not thread-safe; callers serialize access per object.
+ */
+class ChunkedWrite {
+public:
+    // Read bytes of the base object; returns bytes read (0 at its end) or -errno
+    using BaseReader = std::function<ssize_t(char* buf, size_t size, off_t offset)>;
+
+    // Receives content in order; returns false to stop
+    using Sink = std::function<bool(const char* data, size_t size)>;
+
+    // base_generation 0 means the base's generation is unknown
+    ChunkedWrite(size_t base_size, size_t chunk_size, std::int64_t base_generation = 0);
+
+    ChunkedWrite(const ChunkedWrite&) = delete;
+    ChunkedWrite& operator=(const ChunkedWrite&) = delete;
+
+    // Bytes of memory a write of [offset, offset + size) would add
+    size_t growth(off_t offset, size_t size) const;
+
+    // Write at offset, extending the content. Returns bytes written or -errno.
+    ssize_t write(const char* data, size_t size, off_t offset, const BaseReader& read_base);
+
+    // Read at offset. Returns bytes read (0 at EOF) or -errno.
+    ssize_t read(char* buf, size_t size, off_t offset, const BaseReader& read_base) const;
+
+    // Resize to new_size
+    void truncate(size_t new_size);
+
+    // Hand the content from offset to the end to sink, in pieces of at
+    // most one chunk. False if the base could not be read or sink stopped.
+    bool copyTo(size_t offset, const Sink& sink, const BaseReader& read_base) const;
+
+    size_t size() const { return size_; }
+    size_t baseSize() const { return base_size_; }
+    std::int64_t baseGeneration() const { return base_generation_; }
+    size_t chunkSize() const { return chunk_size_; }
+
+    // Memory held by written chunks
+    size_t memoryBytes() const { return chunks_.size() * chunk_size_; }
+
+    // False until something is written or the size changes
+    bool changed() const { return first_change_ != kUnchanged; }
+
+    // True if the content is the whole base followed by new bytes
+    bool appendOnly() const;
+
+private:
+    static constexpr size_t kUnchanged = std::numeric_limits<size_t>::max();
+
+    size_t chunk_size_;
+    size_t base_size_;
+    std::int64_t base_generation_;
+    size_t base_valid_;   // prefix of the base still part of the content
+    size_t size_;
+    size_t first_change_ = kUnchanged;  // lowest offset whose content differs from the base
+
+    std::map<size_t, std::string> chunks_;  // chunk index -> chunk_size_ bytes
+
+    // Read [offset, offset + size) of the base into buf, zero-filling past its end
+    static bool readBase(char* buf, size_t size, size_t offset, const BaseReader& read_base);
+};
+
+} // namespace gcscfuse
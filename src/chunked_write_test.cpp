@@ -0,0 +1,193 @@
+#include <gtest/gtest.h>
+#include "chunked_write.hpp"
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace gcscfuse;
+
+// Base object content, recording the ranges read from it
+class FakeBase {
+public:
+    explicit FakeBase(std::string content) : content(std::move(content)) {}
+
+    ChunkedWrite::BaseReader reader() {
+        return [this](char* buf, size_t size, off_t offset) -> ssize_t {
+            if (fail) {
+                return -EIO;
+            }
+            reads.emplace_back(static_cast<size_t>(offset), size);
+            if (static_cast<size_t>(offset) >= content.size()) {
+                return 0;
+            }
+            size_t n = std::min(size, content.size() - static_cast<size_t>(offset));
+            std::memcpy(buf, content.data() + offset, n);
+            return static_cast<ssize_t>(n);
+        };
+    }
+
+    std::string content;
+    std::vector<std::pair<size_t, size_t>> reads;
+    bool fail = false;
+};
+
+std::string pattern(size_t size) {
+    std::string s(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+        s[i] = static_cast<char>('a' + i % 26);
+    }
+    return s;
+}
+
+std::string readAll(const ChunkedWrite& chunked, FakeBase& base) {
+    std::string out(chunked.size(), '\0');
+    EXPECT_EQ(chunked.read(&out[0], out.size(), 0, base.reader()), static_cast<ssize_t>(out.size()));
+    return out;
+}
+
+std::string copyAll(const ChunkedWrite& chunked, FakeBase& base, size_t offset = 0) {
+    std::string out;
+    EXPECT_TRUE(chunked.copyTo(offset, [&](const char* data, size_t size) {
+        EXPECT_LE(size, chunked.chunkSize());
+        out.append(data, size);
+        return true;
+    }, base.reader()));
+    return out;
+}
+
+TEST(ChunkedWriteTest, SmallOverwriteHoldsOneChunk) {
+    FakeBase base(pattern(10000));
+    ChunkedWrite chunked(10000, 1000);
+
+    EXPECT_EQ(chunked.growth(4500, 10), 1000u);
+    EXPECT_EQ(chunked.write("XXXXXXXXXX", 10, 4500, base.reader()), 10);
+    EXPECT_EQ(chunked.memoryBytes(), 1000u);
+    EXPECT_EQ(chunked.size(), 10000u);
+    ASSERT_EQ(base.reads.size(), 1u);
+    EXPECT_EQ(base.reads[0], std::make_pair(size_t{4000}, size_t{1000}));
+    EXPECT_EQ(chunked.growth(4600, 10), 0u);
+
+    std::string expected = base.content;
+    expected.replace(4500, 10, "XXXXXXXXXX");
+    EXPECT_EQ(readAll(chunked, base), expected);
+    EXPECT_EQ(copyAll(chunked, base), expected);
+    EXPECT_FALSE(chunked.appendOnly());
+}
+
+TEST(ChunkedWriteTest, WriteCoveringChunkSkipsBaseRead) {
+    FakeBase base(pattern(3000));
+    ChunkedWrite chunked(3000, 1000);
+
+    std::string data(1000, 'Z');
+    EXPECT_EQ(chunked.write(data.data(), data.size(), 1000, base.reader()), 1000);
+    EXPECT_TRUE(base.reads.empty());
+}
+
+TEST(ChunkedWriteTest, AppendIsAppendOnly) {
+    FakeBase base(pattern(2500));
+    ChunkedWrite chunked(2500, 1000);
+    EXPECT_FALSE(chunked.changed());
+
+    std::string tail(700, 'T');
+    EXPECT_EQ(chunked.write(tail.data(), tail.size(), 2500, base.reader()), 700);
+    EXPECT_EQ(chunked.size(), 3200u);
+    EXPECT_TRUE(chunked.changed());
+    EXPECT_TRUE(chunked.appendOnly());
+    // The chunk holding the old end was read for its base part
+    ASSERT_EQ(base.reads.size(), 1u);
+    EXPECT_EQ(base.reads[0], std::make_pair(size_t{2000}, size_t{500}));
+
+    EXPECT_EQ(copyAll(chunked, base, 2500), tail);
+    EXPECT_EQ(copyAll(chunked, base), base.content + tail);
+}
+
+TEST(ChunkedWriteTest, WriteAfterGapReadsZeros) {
+    FakeBase base(pattern(1500));
+    ChunkedWrite chunked(1500, 1000);
+
+    EXPECT_EQ(chunked.write("end", 3, 4000, base.reader()), 3);
+    EXPECT_EQ(chunked.size(), 4003u);
+    EXPECT_TRUE(chunked.appendOnly());
+    EXPECT_EQ(readAll(chunked, base), base.content + std::string(2500, '\0') + "end");
+}
+
+TEST(ChunkedWriteTest, ShrinkingEndsAppendOnly) {
+    FakeBase base(pattern(5000));
+    ChunkedWrite chunked(5000, 1000);
+
+    chunked.truncate(3500);
+    EXPECT_EQ(chunked.size(), 3500u);
+    EXPECT_FALSE(chunked.appendOnly());
+    EXPECT_EQ(readAll(chunked, base), base.content.substr(0, 3500));
+
+    // Bytes cut off stay zero when the file grows again
+    chunked.truncate(4200);
+    EXPECT_EQ(readAll(chunked, base), base.content.substr(0, 3500) + std::string(700, '\0'));
+}
+
+TEST(ChunkedWriteTest, ShrinkingZeroesCutOffPartOfWrittenChunk) {
+    FakeBase base(pattern(3000));
+    ChunkedWrite chunked(3000, 1000);
+
+    std::string data(600, 'W');
+    chunked.write(data.data(), data.size(), 1200, base.reader());
+    chunked.truncate(1500);
+    EXPECT_EQ(chunked.memoryBytes(), 1000u);
+    chunked.truncate(2100);
+
+    std::string expected = base.content.substr(0, 1200) + std::string(300, 'W') + std::string(600, '\0');
+    EXPECT_EQ(readAll(chunked, base), expected);
+    EXPECT_EQ(copyAll(chunked, base), expected);
+}
+
+TEST(ChunkedWriteTest, TruncateDropsChunksPastEnd) {
+    FakeBase base(pattern(4000));
+    ChunkedWrite chunked(4000, 1000);
+
+    chunked.write("a", 1, 500, base.reader());
+    chunked.write("b", 1, 3500, base.reader());
+    EXPECT_EQ(chunked.memoryBytes(), 2000u);
+    chunked.truncate(1000);
+    EXPECT_EQ(chunked.memoryBytes(), 1000u);
+}
+
+TEST(ChunkedWriteTest, GrowingIsAppendOnly) {
+    FakeBase base(pattern(1000));
+    ChunkedWrite chunked(1000, 400);
+
+    chunked.truncate(1600);
+    EXPECT_TRUE(chunked.appendOnly());
+    EXPECT_EQ(chunked.memoryBytes(), 0u);
+    EXPECT_EQ(copyAll(chunked, base, 1000), std::string(600, '\0'));
+}
+
+TEST(ChunkedWriteTest, BaseReadFailureFailsWrite) {
+    FakeBase base(pattern(3000));
+    base.fail = true;
+    ChunkedWrite chunked(3000, 1000);
+
+    EXPECT_EQ(chunked.write("x", 1, 10, base.reader()), -EIO);
+    EXPECT_EQ(chunked.memoryBytes(), 0u);
+    EXPECT_FALSE(chunked.changed());
+
+    char buf[10];
+    EXPECT_EQ(chunked.read(buf, sizeof(buf), 0, base.reader()), -EIO);
+    EXPECT_FALSE(chunked.copyTo(0, [](const char*, size_t) { return true; }, base.reader()));
+}
+
+TEST(ChunkedWriteTest, ReadPastEndReturnsZero) {
+    FakeBase base(pattern(100));
+    ChunkedWrite chunked(100, 64);
+
+    char buf[32];
+    EXPECT_EQ(chunked.read(buf, sizeof(buf), 100, base.reader()), 0);
+    EXPECT_EQ(chunked.read(buf, sizeof(buf), 90, base.reader()), 10);
+    EXPECT_EQ(std::string(buf, 10), base.content.substr(90));
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,5 +1,6 @@
 #include "config.hpp"
 #include <yaml-cpp/yaml.h>
+#include <algorithm>
 #include <getopt.h>
 #include <iostream>
 #include <fstream>
@@ -15,15 +16,63 @@ namespace {
         std::transform(v.begin(), v.end(), v.begin(), ::tolower);
         return v == "true" || v == "yes" || v == "1" || v == "on";
     }
+    
+    // Comma-separated names, skipping empty entries
+    std::vector<std::string> parseList(const std::string& value) {
+        std::vector<std::string> items;
+        std::stringstream stream(value);
+        std::string item;
+        while (std::getline(stream, item, ',')) {
+            const size_t start = item.find_first_not_of(" \t");
+            if (start != std::string::npos) {
+                items.push_back(item.substr(start, item.find_last_not_of(" \t") - start + 1));
+            }
+        }
+        return items;
+    }
 }
 
 void GCSFSConfig::loadDefaults() {
     enable_stat_cache = true;
     stat_cache_timeout = 60;
+    negative_stat_cache_timeout = 5;
+    stale_while_revalidate = 0;
+    max_stat_cache_entries = 1000000;
+    stat_cache_sweep_interval = 60;
+    metadata_snapshot_dir = "";
+    metadata_snapshot_interval = 300;
+    warm_tree_prefetch_dirs = 0;
+    warm_tree_concurrency = 4;
+    batch_metadata_lookups = true;
+    small_file_prefetch_kb = 0;
     enable_file_content_cache = true;
+    content_cache_block_size_mb = 1;
+    random_read_kb = 128;
+    small_object_prefetch_mb = 8;
+    max_content_cache_mb = 512;
+    cache_dir = "";
+    max_disk_cache_mb = 10240;
+    enable_read_ahead = true;
+    read_ahead_chunk_kb = 1024;
+    read_ahead_max_chunks = 8;
+    max_write_buffer_mb = 2048;
+    chunked_write_threshold_mb = 64;
+    parallel_upload_threshold_mb = 128;
+    parallel_upload_part_size_mb = 32;
+    parallel_upload_concurrency = 8;
+    enable_streaming_writes = true;
+    staging_dir = "";
+    enable_write_back = false;
+    write_back_dirty_mb = 512;
+    write_back_workers = 4;
+    gcs_connection_pool_size = 0;
+    gcs_max_concurrent_requests = 16;
+    gcs_max_bulk_requests = 8;
+    enable_metrics = true;
     debug_mode = false;
     verbose_logging = false;
     bucket_name = "";
+    buckets.clear();
     mount_point = "";
     fuse_args.clear();
 }
@@ -37,6 +86,12 @@ bool GCSFSConfig::loadFromYAML(const std::string& config_path) {
             bucket_name = config["bucket_name"].as<std::string>();
         }
         
+        if (config["buckets"]) {
+            const YAML::Node& node = config["buckets"];
+            buckets = node.IsSequence() ? node.as<std::vector<std::string>>()
+                                        : parseList(node.as<std::string>());
+        }
+        
         if (config["mount_point"]) {
             mount_point = config["mount_point"].as<std::string>();
         }
@@ -49,10 +104,142 @@ bool GCSFSConfig::loadFromYAML(const std::string& config_path) {
             stat_cache_timeout = config["stat_cache_timeout"].as<int>();
         }
         
+        if (config["negative_stat_cache_timeout"]) {
+            negative_stat_cache_timeout = config["negative_stat_cache_timeout"].as<int>();
+        }
+        
+        if (config["stale_while_revalidate"]) {
+            stale_while_revalidate = config["stale_while_revalidate"].as<int>();
+        }
+        
+        if (config["max_stat_cache_entries"]) {
+            max_stat_cache_entries = config["max_stat_cache_entries"].as<int>();
+        }
+        
+        if (config["stat_cache_sweep_interval"]) {
+            stat_cache_sweep_interval = config["stat_cache_sweep_interval"].as<int>();
+        }
+        
+        if (config["metadata_snapshot_dir"]) {
+            metadata_snapshot_dir = config["metadata_snapshot_dir"].as<std::string>();
+        }
+        
+        if (config["metadata_snapshot_interval"]) {
+            metadata_snapshot_interval = config["metadata_snapshot_interval"].as<int>();
+        }
+        
+        if (config["warm_tree_prefetch_dirs"]) {
+            warm_tree_prefetch_dirs = config["warm_tree_prefetch_dirs"].as<int>();
+        }
+        
+        if (config["warm_tree_concurrency"]) {
+            warm_tree_concurrency = config["warm_tree_concurrency"].as<int>();
+        }
+        
+        if (config["batch_metadata_lookups"]) {
+            batch_metadata_lookups = config["batch_metadata_lookups"].as<bool>();
+        }
+        
+        if (config["small_file_prefetch_kb"]) {
+            small_file_prefetch_kb = config["small_file_prefetch_kb"].as<int>();
+        }
+        
         if (config["enable_file_content_cache"]) {
             enable_file_content_cache = config["enable_file_content_cache"].as<bool>();
         }
         
+        if (config["content_cache_block_size_mb"]) {
+            content_cache_block_size_mb = config["content_cache_block_size_mb"].as<int>();
+        }
+        
+        if (config["max_content_cache_mb"]) {
+            max_content_cache_mb = config["max_content_cache_mb"].as<int>();
+        }
+        
+        if (config["random_read_kb"]) {
+            random_read_kb = config["random_read_kb"].as<int>();
+        }
+        
+        if (config["small_object_prefetch_mb"]) {
+            small_object_prefetch_mb = config["small_object_prefetch_mb"].as<int>();
+        }
+        
+        if (config["cache_dir"]) {
+            cache_dir = config["cache_dir"].as<std::string>();
+        }
+        
+        if (config["max_disk_cache_mb"]) {
+            max_disk_cache_mb = config["max_disk_cache_mb"].as<int>();
+        }
+        
+        if (config["enable_read_ahead"]) {
+            enable_read_ahead = config["enable_read_ahead"].as<bool>();
+        }
+        
+        if (config["read_ahead_chunk_kb"]) {
+            read_ahead_chunk_kb = config["read_ahead_chunk_kb"].as<int>();
+        }
+        
+        if (config["read_ahead_max_chunks"]) {
+            read_ahead_max_chunks = config["read_ahead_max_chunks"].as<int>();
+        }
+        
+        if (config["max_write_buffer_mb"]) {
+            max_write_buffer_mb = config["max_write_buffer_mb"].as<int>();
+        }
+        
+        if (config["chunked_write_threshold_mb"]) {
+            chunked_write_threshold_mb = config["chunked_write_threshold_mb"].as<int>();
+        }
+        
+        if (config["parallel_upload_threshold_mb"]) {
+            parallel_upload_threshold_mb = config["parallel_upload_threshold_mb"].as<int>();
+        }
+        
+        if (config["parallel_upload_part_size_mb"]) {
+            parallel_upload_part_size_mb = config["parallel_upload_part_size_mb"].as<int>();
+        }
+        
+        if (config["parallel_upload_concurrency"]) {
+            parallel_upload_concurrency = config["parallel_upload_concurrency"].as<int>();
+        }
+        
+        if (config["enable_streaming_writes"]) {
+            enable_streaming_writes = config["enable_streaming_writes"].as<bool>();
+        }
+        
+        if (config["staging_dir"]) {
+            staging_dir = config["staging_dir"].as<std::string>();
+        }
+        
+        if (config["enable_write_back"]) {
+            enable_write_back = config["enable_write_back"].as<bool>();
+        }
+        
+        if (config["write_back_dirty_mb"]) {
+            write_back_dirty_mb = config["write_back_dirty_mb"].as<int>();
+        }
+        
+        if (config["write_back_workers"]) {
+            write_back_workers = config["write_back_workers"].as<int>();
+        }
+        
+        if (config["gcs_connection_pool_size"]) {
+            gcs_connection_pool_size = config["gcs_connection_pool_size"].as<int>();
+        }
+        
+        if (config["gcs_max_concurrent_requests"]) {
+            gcs_max_concurrent_requests = config["gcs_max_concurrent_requests"].as<int>();
+        }
+        
+        if (config["gcs_max_bulk_requests"]) {
+            gcs_max_bulk_requests = config["gcs_max_bulk_requests"].as<int>();
+        }
+        
+        if (config["enable_metrics"]) {
+            enable_metrics = config["enable_metrics"].as<bool>();
+        }
+        
         if (config["debug"]) {
             debug_mode = config["debug"].as<bool>();
         }
@@ -75,6 +262,9 @@ void GCSFSConfig::loadFromEnv() {
     if (const char* bucket = std::getenv("GCSFUSE_BUCKET")) {
         bucket_name = bucket;
     }
+    if (const char* bucket_list = std::getenv("GCSFUSE_BUCKETS")) {
+        buckets = parseList(bucket_list);
+    }
     if (const char* mount = std::getenv("GCSFUSE_MOUNT_POINT")) {
         mount_point = mount;
     }
@@ -84,9 +274,108 @@ void GCSFSConfig::loadFromEnv() {
     if (const char* ttl = std::getenv("GCSFUSE_STAT_CACHE_TTL")) {
         stat_cache_timeout = std::atoi(ttl);
     }
+    if (const char* negative_ttl = std::getenv("GCSFUSE_NEGATIVE_STAT_CACHE_TTL")) {
+        negative_stat_cache_timeout = std::atoi(negative_ttl);
+    }
+    if (const char* swr = std::getenv("GCSFUSE_STALE_WHILE_REVALIDATE")) {
+        stale_while_revalidate = std::atoi(swr);
+    }
+    if (const char* max_entries = std::getenv("GCSFUSE_MAX_STAT_CACHE_ENTRIES")) {
+        max_stat_cache_entries = std::atoi(max_entries);
+    }
+    if (const char* sweep = std::getenv("GCSFUSE_STAT_CACHE_SWEEP_INTERVAL")) {
+        stat_cache_sweep_interval = std::atoi(sweep);
+    }
+    if (const char* snapshot_dir = std::getenv("GCSFUSE_METADATA_SNAPSHOT_DIR")) {
+        metadata_snapshot_dir = snapshot_dir;
+    }
+    if (const char* snapshot_interval = std::getenv("GCSFUSE_METADATA_SNAPSHOT_INTERVAL")) {
+        metadata_snapshot_interval = std::atoi(snapshot_interval);
+    }
+    if (const char* warm_dirs = std::getenv("GCSFUSE_WARM_TREE_PREFETCH_DIRS")) {
+        warm_tree_prefetch_dirs = std::atoi(warm_dirs);
+    }
+    if (const char* warm_concurrency = std::getenv("GCSFUSE_WARM_TREE_CONCURRENCY")) {
+        warm_tree_concurrency = std::atoi(warm_concurrency);
+    }
+    if (const char* batch_lookups = std::getenv("GCSFUSE_BATCH_METADATA_LOOKUPS")) {
+        batch_metadata_lookups = parseBool(batch_lookups);
+    }
+    if (const char* small_file_kb = std::getenv("GCSFUSE_SMALL_FILE_PREFETCH_KB")) {
+        small_file_prefetch_kb = std::atoi(small_file_kb);
+    }
     if (const char* file_cache = std::getenv("GCSFUSE_FILE_CACHE")) {
         enable_file_content_cache = parseBool(file_cache);
     }
+    if (const char* block_size = std::getenv("GCSFUSE_CONTENT_CACHE_BLOCK_SIZE_MB")) {
+        content_cache_block_size_mb = std::atoi(block_size);
+    }
+    if (const char* max_cache = std::getenv("GCSFUSE_MAX_CONTENT_CACHE_MB")) {
+        max_content_cache_mb = std::atoi(max_cache);
+    }
+    if (const char* random_read = std::getenv("GCSFUSE_RANDOM_READ_KB")) {
+        random_read_kb = std::atoi(random_read);
+    }
+    if (const char* prefetch = std::getenv("GCSFUSE_SMALL_OBJECT_PREFETCH_MB")) {
+        small_object_prefetch_mb = std::atoi(prefetch);
+    }
+    if (const char* dir = std::getenv("GCSFUSE_CACHE_DIR")) {
+        cache_dir = dir;
+    }
+    if (const char* max_disk = std::getenv("GCSFUSE_MAX_DISK_CACHE_MB")) {
+        max_disk_cache_mb = std::atoi(max_disk);
+    }
+    if (const char* read_ahead = std::getenv("GCSFUSE_READ_AHEAD")) {
+        enable_read_ahead = parseBool(read_ahead);
+    }
+    if (const char* chunk_kb = std::getenv("GCSFUSE_READ_AHEAD_CHUNK_KB")) {
+        read_ahead_chunk_kb = std::atoi(chunk_kb);
+    }
+    if (const char* max_chunks = std::getenv("GCSFUSE_READ_AHEAD_MAX_CHUNKS")) {
+        read_ahead_max_chunks = std::atoi(max_chunks);
+    }
+    if (const char* max_write = std::getenv("GCSFUSE_MAX_WRITE_BUFFER_MB")) {
+        max_write_buffer_mb = std::atoi(max_write);
+    }
+    if (const char* chunked = std::getenv("GCSFUSE_CHUNKED_WRITE_THRESHOLD_MB")) {
+        chunked_write_threshold_mb = std::atoi(chunked);
+    }
+    if (const char* threshold = std::getenv("GCSFUSE_PARALLEL_UPLOAD_THRESHOLD_MB")) {
+        parallel_upload_threshold_mb = std::atoi(threshold);
+    }
+    if (const char* part_size = std::getenv("GCSFUSE_PARALLEL_UPLOAD_PART_SIZE_MB")) {
+        parallel_upload_part_size_mb = std::atoi(part_size);
+    }
+    if (const char* concurrency = std::getenv("GCSFUSE_PARALLEL_UPLOAD_CONCURRENCY")) {
+        parallel_upload_concurrency = std::atoi(concurrency);
+    }
+    if (const char* streaming = std::getenv("GCSFUSE_STREAMING_WRITES")) {
+        enable_streaming_writes = parseBool(streaming);
+    }
+    if (const char* staging = std::getenv("GCSFUSE_STAGING_DIR")) {
+        staging_dir = staging;
+    }
+    if (const char* write_back = std::getenv("GCSFUSE_WRITE_BACK")) {
+        enable_write_back = parseBool(write_back);
+    }
+    if (const char* dirty_mb = std::getenv("GCSFUSE_WRITE_BACK_DIRTY_MB")) {
+        write_back_dirty_mb = std::atoi(dirty_mb);
+    }
+    if (const char* workers = std::getenv("GCSFUSE_WRITE_BACK_WORKERS")) {
+        write_back_workers = std::atoi(workers);
+    }
+    if (const char* pool = std::getenv("GCSFUSE_GCS_CONNECTION_POOL_SIZE")) {
+        gcs_connection_pool_size = std::atoi(pool);
+    }
+    if (const char* max_requests = std::getenv("GCSFUSE_GCS_MAX_CONCURRENT_REQUESTS")) {
+        gcs_max_concurrent_requests = std::atoi(max_requests);
+    }
+    if (const char* max_bulk = std::getenv("GCSFUSE_GCS_MAX_BULK_REQUESTS")) {
+        gcs_max_bulk_requests = std::atoi(max_bulk);
+    }
+    if (const char* metrics = std::getenv("GCSFUSE_METRICS")) {
+        enable_metrics = parseBool(metrics);
+    }
     if (const char* debug = std::getenv("GCSFUSE_DEBUG")) {
         debug_mode = parseBool(debug);
     }
@@ -138,15 +427,102 @@ GCSFSConfig GCSFSConfig::load(int argc, char* argv[]) {
 }
 
 void GCSFSConfig::validate() const {
-    if (bucket_name.empty()) {
+    if (bucket_name.empty() && buckets.empty()) {
         throw std::runtime_error("Bucket name is required (via config, env, or CLI)");
     }
+    if (!bucket_name.empty() && !buckets.empty()) {
+        throw std::runtime_error("bucket_name and buckets cannot both be set");
+    }
+    for (size_t i = 0; i < buckets.size(); i++) {
+        if (buckets[i].empty() || buckets[i].find('/') != std::string::npos ||
+            buckets[i] == "." || buckets[i] == "..") {
+            throw std::runtime_error("Invalid bucket name in buckets: '" + buckets[i] + "'");
+        }
+        if (std::find(buckets.begin(), buckets.begin() + i, buckets[i]) != buckets.begin() + i) {
+            throw std::runtime_error("Bucket listed twice in buckets: " + buckets[i]);
+        }
+    }
     if (mount_point.empty()) {
         throw std::runtime_error("Mount point is required (via config, env, or CLI)");
     }
     if (stat_cache_timeout < 0) {
         throw std::runtime_error("stat_cache_timeout must be >= 0");
     }
+    if (negative_stat_cache_timeout < 0) {
+        throw std::runtime_error("negative_stat_cache_timeout must be >= 0");
+    }
+    if (stale_while_revalidate < 0) {
+        throw std::runtime_error("stale_while_revalidate must be >= 0");
+    }
+    if (max_stat_cache_entries < 0) {
+        throw std::runtime_error("max_stat_cache_entries must be >= 0");
+    }
+    if (stat_cache_sweep_interval < 0) {
+        throw std::runtime_error("stat_cache_sweep_interval must be >= 0");
+    }
+    if (metadata_snapshot_interval < 0) {
+        throw std::runtime_error("metadata_snapshot_interval must be >= 0");
+    }
+    if (warm_tree_prefetch_dirs < 0) {
+        throw std::runtime_error("warm_tree_prefetch_dirs must be >= 0");
+    }
+    if (warm_tree_concurrency <= 0) {
+        throw std::runtime_error("warm_tree_concurrency must be > 0");
+    }
+    if (small_file_prefetch_kb < 0) {
+        throw std::runtime_error("small_file_prefetch_kb must be >= 0");
+    }
+    if (content_cache_block_size_mb <= 0) {
+        throw std::runtime_error("content_cache_block_size_mb must be > 0");
+    }
+    if (max_content_cache_mb <= 0) {
+        throw std::runtime_error("max_content_cache_mb must be > 0");
+    }
+    if (random_read_kb < 0 || random_read_kb > content_cache_block_size_mb * 1024) {
+        throw std::runtime_error("random_read_kb must be between 0 and the content cache block size");
+    }
+    if (small_object_prefetch_mb < 0) {
+        throw std::runtime_error("small_object_prefetch_mb must be >= 0");
+    }
+    if (max_disk_cache_mb <= 0) {
+        throw std::runtime_error("max_disk_cache_mb must be > 0");
+    }
+    if (read_ahead_chunk_kb <= 0) {
+        throw std::runtime_error("read_ahead_chunk_kb must be > 0");
+    }
+    if (read_ahead_max_chunks <= 0) {
+        throw std::runtime_error("read_ahead_max_chunks must be > 0");
+    }
+    if (max_write_buffer_mb <= 0) {
+        throw std::runtime_error("max_write_buffer_mb must be > 0");
+    }
+    if (chunked_write_threshold_mb < 0) {
+        throw std::runtime_error("chunked_write_threshold_mb must be >= 0");
+    }
+    if (parallel_upload_threshold_mb < 0) {
+        throw std::runtime_error("parallel_upload_threshold_mb must be >= 0");
+    }
+    if (parallel_upload_part_size_mb <= 0) {
+        throw std::runtime_error("parallel_upload_part_size_mb must be > 0");
+    }
+    if (parallel_upload_concurrency <= 0) {
+        throw std::runtime_error("parallel_upload_concurrency must be > 0");
+    }
+    if (write_back_dirty_mb <= 0) {
+        throw std::runtime_error("write_back_dirty_mb must be > 0");
+    }
+    if (write_back_workers <= 0) {
+        throw std::runtime_error("write_back_workers must be > 0");
+    }
+    if (gcs_connection_pool_size < 0) {
+        throw std::runtime_error("gcs_connection_pool_size must be >= 0");
+    }
+    if (gcs_max_concurrent_requests <= 0) {
+        throw std::runtime_error("gcs_max_concurrent_requests must be > 0");
+    }
+    if (gcs_max_bulk_requests <= 0 || gcs_max_bulk_requests > gcs_max_concurrent_requests) {
+        throw std::runtime_error("gcs_max_bulk_requests must be > 0 and <= gcs_max_concurrent_requests");
+    }
 }
 
 void GCSFSConfig::parseFromArgs(int argc, char* argv[]) {
@@ -154,10 +530,44 @@ void GCSFSConfig::parseFromArgs(int argc, char* argv[]) {
     // Define long options
     static struct option long_options[] = {
         {"config",                   required_argument, 0, 'c'},
+        {"buckets",                  required_argument, 0, 'Y'},
         {"disable-stat-cache",        no_argument,       0, 's'},
         {"stat-cache-ttl",           required_argument, 0, 'T'},
+        {"negative-stat-cache-ttl",  required_argument, 0, 'n'},
+        {"stale-while-revalidate",   required_argument, 0, 'L'},
+        {"max-stat-cache-entries",   required_argument, 0, 'E'},
+        {"stat-cache-sweep-interval", required_argument, 0, 'e'},
+        {"metadata-snapshot-dir",    required_argument, 0, 'A'},
+        {"metadata-snapshot-interval", required_argument, 0, 'a'},
+        {"warm-tree-prefetch-dirs",  required_argument, 0, 'w'},
+        {"warm-tree-concurrency",    required_argument, 0, 'y'},
+        {"disable-metadata-batching", no_argument,      0, 'b'},
+        {"small-file-prefetch-kb",   required_argument, 0, 'g'},
         {"disable-file-cache",       no_argument,       0, 'f'},
         {"disable-file-content-cache",no_argument,       0, 'F'},
+        {"content-cache-block-size-mb", required_argument, 0, 'B'},
+        {"max-content-cache-mb",     required_argument, 0, 'M'},
+        {"random-read-kb",           required_argument, 0, 'H'},
+        {"small-object-prefetch-mb", required_argument, 0, 'I'},
+        {"cache-dir",                required_argument, 0, 'C'},
+        {"max-disk-cache-mb",        required_argument, 0, 'Z'},
+        {"disable-read-ahead",       no_argument,       0, 'R'},
+        {"read-ahead-chunk-kb",      required_argument, 0, 'K'},
+        {"read-ahead-max-chunks",    required_argument, 0, 'N'},
+        {"max-write-buffer-mb",      required_argument, 0, 'W'},
+        {"chunked-write-threshold-mb", required_argument, 0, 'i'},
+        {"parallel-upload-threshold-mb", required_argument, 0, 'P'},
+        {"parallel-upload-part-size-mb", required_argument, 0, 'S'},
+        {"parallel-upload-concurrency",  required_argument, 0, 'U'},
+        {"disable-streaming-writes", no_argument,       0, 'X'},
+        {"staging-dir",              required_argument, 0, 'G'},
+        {"write-back",               no_argument,       0, 'k'},
+        {"write-back-dirty-mb",      required_argument, 0, 'l'},
+        {"write-back-workers",       required_argument, 0, 'u'},
+        {"gcs-connection-pool-size", required_argument, 0, 'Q'},
+        {"gcs-max-concurrent-requests", required_argument, 0, 'J'},
+        {"gcs-max-bulk-requests",    required_argument, 0, 'j'},
+        {"disable-metrics",          no_argument,       0, 'm'},
         {"enable-dummy-reader",      no_argument,       0, 'D'},
         {"debug",                    no_argument,       0, 'd'},
         {"verbose",                  no_argument,       0, 'v'},
@@ -191,6 +601,36 @@ void GCSFSConfig::parseFromArgs(int argc, char* argv[]) {
             case 'T':
                 stat_cache_timeout = atoi(optarg);
                 break;
+            case 'n':
+                negative_stat_cache_timeout = atoi(optarg);
+                break;
+            case 'L':
+                stale_while_revalidate = atoi(optarg);
+                break;
+            case 'E':
+                max_stat_cache_entries = atoi(optarg);
+                break;
+            case 'e':
+                stat_cache_sweep_interval = atoi(optarg);
+                break;
+            case 'A':
+                metadata_snapshot_dir = optarg;
+                break;
+            case 'a':
+                metadata_snapshot_interval = atoi(optarg);
+                break;
+            case 'w':
+                warm_tree_prefetch_dirs = atoi(optarg);
+                break;
+            case 'y':
+                warm_tree_concurrency = atoi(optarg);
+                break;
+            case 'b':
+                batch_metadata_lookups = false;
+                break;
+            case 'g':
+                small_file_prefetch_kb = atoi(optarg);
+                break;
             case 'f':
                 // This could be -f for foreground (FUSE) or --disable-file-cache
                 // Check if it's from long option
@@ -205,6 +645,78 @@ void GCSFSConfig::parseFromArgs(int argc, char* argv[]) {
                 // --disable-file-content-cache
                 enable_file_content_cache = false;
                 break;
+            case 'B':
+                content_cache_block_size_mb = atoi(optarg);
+                break;
+            case 'M':
+                max_content_cache_mb = atoi(optarg);
+                break;
+            case 'H':
+                random_read_kb = atoi(optarg);
+                break;
+            case 'I':
+                small_object_prefetch_mb = atoi(optarg);
+                break;
+            case 'C':
+                cache_dir = optarg;
+                break;
+            case 'Z':
+                max_disk_cache_mb = atoi(optarg);
+                break;
+            case 'R':
+                enable_read_ahead = false;
+                break;
+            case 'K':
+                read_ahead_chunk_kb = atoi(optarg);
+                break;
+            case 'N':
+                read_ahead_max_chunks = atoi(optarg);
+                break;
+            case 'W':
+                max_write_buffer_mb = atoi(optarg);
+                break;
+            case 'i':
+                chunked_write_threshold_mb = atoi(optarg);
+                break;
+            case 'P':
+                parallel_upload_threshold_mb = atoi(optarg);
+                break;
+            case 'S':
+                parallel_upload_part_size_mb = atoi(optarg);
+                break;
+            case 'U':
+                parallel_upload_concurrency = atoi(optarg);
+                break;
+            case 'X':
+                enable_streaming_writes = false;
+                break;
+            case 'Y':
+                buckets = parseList(optarg);
+                break;
+            case 'G':
+                staging_dir = optarg;
+                break;
+            case 'k':
+                enable_write_back = true;
+                break;
+            case 'l':
+                write_back_dirty_mb = atoi(optarg);
+                break;
+            case 'u':
+                write_back_workers = atoi(optarg);
+                break;
+            case 'Q':
+                gcs_connection_pool_size = atoi(optarg);
+                break;
+            case 'J':
+                gcs_max_concurrent_requests = atoi(optarg);
+                break;
+            case 'j':
+                gcs_max_bulk_requests = atoi(optarg);
+                break;
+            case 'm':
+                enable_metrics = false;
+                break;
             case 'D':
                 // --enable-dummy-reader
                 enable_dummy_reader = true;
@@ -242,6 +754,12 @@ void GCSFSConfig::parseFromArgs(int argc, char* argv[]) {
         positional_args.push_back(argv[optind++]);
     }
     
+    // With buckets set, a lone positional argument is the mount point
+    if (!buckets.empty() && positional_args.size() == 1) {
+        mount_point = positional_args[0];
+        return;
+    }
+    
     // Override with positional arguments if provided
     if (!positional_args.empty()) {
         bucket_name = positional_args[0];
@@ -256,8 +774,30 @@ void GCSFSConfig::parseFromArgs(int argc, char* argv[]) {
     }
 }
 
+std::vector<std::string> GCSFSConfig::mountedBuckets() const {
+    if (!buckets.empty()) {
+        return buckets;
+    }
+    return {bucket_name};
+}
+
+GCSFSConfig GCSFSConfig::forBucket(const std::string& bucket) const {
+    GCSFSConfig config = *this;
+    config.bucket_name = bucket;
+    config.buckets.clear();
+    config.mount_point = mount_point + "/" + bucket;
+    if (!cache_dir.empty()) {
+        config.cache_dir = cache_dir + "/" + bucket;
+    }
+    if (!buckets.empty()) {
+        config.max_disk_cache_mb = std::max(1, max_disk_cache_mb / static_cast<int>(buckets.size()));
+    }
+    return config;
+}
+
 void GCSFSConfig::printUsage(const char* program_name) {
     std::cout << "Usage: " << program_name << " <bucket_name> <mount_point> [options]\n";
+    std::cout << "   or: " << program_name << " --buckets=<bucket,...> <mount_point> [options]\n";
     std::cout << "   or: " << program_name << " --config <config.yaml> [options]\n\n";
     std::cout << "Required arguments:\n";
     std::cout << "  bucket_name              GCS bucket name to mount\n";
@@ -265,9 +805,43 @@ void GCSFSConfig::printUsage(const char* program_name) {
     
     std::cout << "GCSFS options:\n";
     std::cout << "  --config=FILE            Load configuration from YAML file\n";
+    std::cout << "  --buckets=B1,B2,...      Serve several buckets from one daemon, each at mount_point/<bucket>\n";
     std::cout << "  --disable-stat-cache     Disable stat metadata cache (enabled by default)\n";
     std::cout << "  --stat-cache-ttl=N       Stat cache timeout in seconds (default: 60, 0=no timeout)\n";
+    std::cout << "  --negative-stat-cache-ttl=N  Remember missing paths for N seconds (default: 5, 0=disabled)\n";
+    std::cout << "  --stale-while-revalidate=N  Serve entries up to N seconds past the TTL while refreshing them (default: 0=disabled)\n";
+    std::cout << "  --max-stat-cache-entries=N  Evict the coldest cached paths beyond N (default: 1000000, 0=unlimited)\n";
+    std::cout << "  --stat-cache-sweep-interval=N  Prune expired entries every N seconds (default: 60, 0=disabled)\n";
+    std::cout << "  --metadata-snapshot-dir=DIR  Save the stat cache here and warm-start from it (default: cache_dir)\n";
+    std::cout << "  --metadata-snapshot-interval=N  Snapshot every N seconds (default: 300, 0=only at unmount)\n";
+    std::cout << "  --warm-tree-prefetch-dirs=N  List up to N recently seen subdirectories in the background (default: 0=disabled)\n";
+    std::cout << "  --warm-tree-concurrency=N    Directories prefetched concurrently (default: 4)\n";
+    std::cout << "  --disable-metadata-batching  Look up each cold path on its own instead of sharing a directory listing\n";
+    std::cout << "  --small-file-prefetch-kb=N   Cache files up to N KiB when their directory is listed (default: 0=disabled)\n";
     std::cout << "  --disable-file-cache     Disable file content cache (enabled by default)\n";
+    std::cout << "  --content-cache-block-size-mb=N  Content cache block size in MiB (default: 1)\n";
+    std::cout << "  --max-content-cache-mb=N Content cache memory budget in MiB (default: 512)\n";
+    std::cout << "  --random-read-kb=N       Range fetched per miss for random reads in KiB (default: 128, 0=whole blocks)\n";
+    std::cout << "  --small-object-prefetch-mb=N  Fetch objects up to N MiB whole on first read (default: 8, 0=disabled)\n";
+    std::cout << "  --cache-dir=DIR          Keep a persistent block cache on local disk in DIR\n";
+    std::cout << "  --max-disk-cache-mb=N    Disk cache budget in MiB (default: 10240)\n";
+    std::cout << "  --disable-read-ahead     Disable sequential read-ahead (enabled by default)\n";
+    std::cout << "  --read-ahead-chunk-kb=N  Size of each read-ahead request in KiB (default: 1024)\n";
+    std::cout << "  --read-ahead-max-chunks=N  Max read-ahead requests in flight per file (default: 8)\n";
+    std::cout << "  --max-write-buffer-mb=N  Write buffer memory budget in MiB (default: 2048)\n";
+    std::cout << "  --chunked-write-threshold-mb=N  Edit existing files this large per chunk (default: 64, 0=disabled)\n";
+    std::cout << "  --parallel-upload-threshold-mb=N  Upload files this large as composed parts (default: 128, 0=disabled)\n";
+    std::cout << "  --parallel-upload-part-size-mb=N  Size of each upload part in MiB (default: 32)\n";
+    std::cout << "  --parallel-upload-concurrency=N   Parts uploaded concurrently (default: 8)\n";
+    std::cout << "  --disable-streaming-writes  Buffer new files instead of streaming them to GCS\n";
+    std::cout << "  --staging-dir=DIR        Directory for disk-staged writes (default: cache dir, else $TMPDIR or /tmp)\n";
+    std::cout << "  --write-back             Upload closed files in the background; fsync waits for the upload\n";
+    std::cout << "  --write-back-dirty-mb=N  Bytes queued for upload before close blocks, in MiB (default: 512)\n";
+    std::cout << "  --write-back-workers=N   Background uploads run at once (default: 4)\n";
+    std::cout << "  --gcs-connection-pool-size=N  HTTP connections kept open to GCS (default: 0=SDK default)\n";
+    std::cout << "  --gcs-max-concurrent-requests=N  GCS requests in flight at once (default: 16)\n";
+    std::cout << "  --gcs-max-bulk-requests=N  Of those, content transfers (default: 8)\n";
+    std::cout << "  --disable-metrics        Do not record metrics or serve /.gcscfuse/stats (enabled by default)\n";
     std::cout << "  --enable-dummy-reader    Use dummy reader for testing (returns zeros)\n";
     std::cout << "  --debug                  Enable debug logging\n";
     std::cout << "  --verbose                Enable verbose output\n";
@@ -280,9 +854,43 @@ void GCSFSConfig::printUsage(const char* program_name) {
     
     std::cout << "Environment variables:\n";
     std::cout << "  GCSFUSE_BUCKET           Bucket name (overridden by CLI/config)\n";
+    std::cout << "  GCSFUSE_BUCKETS          Comma-separated buckets served from one daemon\n";
     std::cout << "  GCSFUSE_MOUNT_POINT      Mount point (overridden by CLI/config)\n";
     std::cout << "  GCSFUSE_STAT_CACHE       Enable stat cache (true/false)\n";
+    std::cout << "  GCSFUSE_NEGATIVE_STAT_CACHE_TTL      Seconds to remember missing paths\n";
+    std::cout << "  GCSFUSE_STALE_WHILE_REVALIDATE       Seconds past the TTL stale entries are served\n";
+    std::cout << "  GCSFUSE_MAX_STAT_CACHE_ENTRIES       Cached paths before eviction\n";
+    std::cout << "  GCSFUSE_STAT_CACHE_SWEEP_INTERVAL    Seconds between expired-entry sweeps\n";
+    std::cout << "  GCSFUSE_METADATA_SNAPSHOT_DIR        Directory for stat cache snapshots\n";
+    std::cout << "  GCSFUSE_METADATA_SNAPSHOT_INTERVAL   Seconds between stat cache snapshots\n";
+    std::cout << "  GCSFUSE_WARM_TREE_PREFETCH_DIRS      Subdirectories queued for background listing\n";
+    std::cout << "  GCSFUSE_WARM_TREE_CONCURRENCY        Directories prefetched concurrently\n";
+    std::cout << "  GCSFUSE_BATCH_METADATA_LOOKUPS       Share a listing between concurrent cold lookups (true/false)\n";
+    std::cout << "  GCSFUSE_SMALL_FILE_PREFETCH_KB       Files cached when their directory is listed, up to KiB\n";
     std::cout << "  GCSFUSE_FILE_CACHE       Enable file cache (true/false)\n";
+    std::cout << "  GCSFUSE_CONTENT_CACHE_BLOCK_SIZE_MB  Content cache block size in MiB\n";
+    std::cout << "  GCSFUSE_MAX_CONTENT_CACHE_MB         Content cache memory budget in MiB\n";
+    std::cout << "  GCSFUSE_RANDOM_READ_KB               Range fetched per miss for random reads in KiB\n";
+    std::cout << "  GCSFUSE_SMALL_OBJECT_PREFETCH_MB     Objects fetched whole on first read, up to MiB\n";
+    std::cout << "  GCSFUSE_CACHE_DIR                    Disk cache directory\n";
+    std::cout << "  GCSFUSE_MAX_DISK_CACHE_MB            Disk cache budget in MiB\n";
+    std::cout << "  GCSFUSE_READ_AHEAD                   Enable read-ahead (true/false)\n";
+    std::cout << "  GCSFUSE_READ_AHEAD_CHUNK_KB          Read-ahead request size in KiB\n";
+    std::cout << "  GCSFUSE_READ_AHEAD_MAX_CHUNKS        Max read-ahead requests in flight\n";
+    std::cout << "  GCSFUSE_MAX_WRITE_BUFFER_MB          Write buffer memory budget in MiB\n";
+    std::cout << "  GCSFUSE_CHUNKED_WRITE_THRESHOLD_MB   Edit existing files this large per chunk, in MiB\n";
+    std::cout << "  GCSFUSE_PARALLEL_UPLOAD_THRESHOLD_MB Parallel composite upload threshold in MiB\n";
+    std::cout << "  GCSFUSE_PARALLEL_UPLOAD_PART_SIZE_MB Parallel upload part size in MiB\n";
+    std::cout << "  GCSFUSE_PARALLEL_UPLOAD_CONCURRENCY  Parts uploaded concurrently\n";
+    std::cout << "  GCSFUSE_STREAMING_WRITES             Enable streaming writes (true/false)\n";
+    std::cout << "  GCSFUSE_STAGING_DIR                  Directory for disk-staged writes\n";
+    std::cout << "  GCSFUSE_WRITE_BACK                   Upload closed files in the background (true/false)\n";
+    std::cout << "  GCSFUSE_WRITE_BACK_DIRTY_MB          Bytes queued for upload before close blocks, in MiB\n";
+    std::cout << "  GCSFUSE_WRITE_BACK_WORKERS           Background uploads run at once\n";
+    std::cout << "  GCSFUSE_GCS_CONNECTION_POOL_SIZE     HTTP connections kept open to GCS\n";
+    std::cout << "  GCSFUSE_GCS_MAX_CONCURRENT_REQUESTS  GCS requests in flight at once\n";
+    std::cout << "  GCSFUSE_GCS_MAX_BULK_REQUESTS        Of those, content transfers\n";
+    std::cout << "  GCSFUSE_METRICS                      Enable metrics and /.gcscfuse/stats (true/false)\n";
     std::cout << "  GCSFUSE_DEBUG            Enable debug mode (true/false)\n\n";
     
     std::cout << "Configuration priority (highest to lowest):\n";
@@ -296,6 +904,7 @@ void GCSFSConfig::printUsage(const char* program_name) {
     std::cout << "  " << program_name << " --config config.yaml\n";
     std::cout << "  " << program_name << " my-bucket ~/mnt --disable-stat-cache -f\n";
     std::cout << "  " << program_name << " my-bucket ~/mnt --debug -o allow_other\n";
+    std::cout << "  " << program_name << " --buckets=logs,models ~/mnt\n";
 }
 
 void GCSFSConfig::toFuseArgs(int& out_argc, char**& out_argv) const {
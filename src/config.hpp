@@ -17,9 +17,62 @@ struct GCSFSConfig {
     // Stat cache settings
     bool enable_stat_cache = true;
     int stat_cache_timeout = 60;  // seconds, 0 = no timeout
+    int negative_stat_cache_timeout = 5;  // seconds to remember missing paths, 0 = disabled
+    int stale_while_revalidate = 0;       // seconds past the TTL an entry is served while refreshed, 0 = disabled
+    int max_stat_cache_entries = 1000000; // cached paths before the coldest are evicted, 0 = unlimited
+    int stat_cache_sweep_interval = 60;   // seconds between sweeps of expired entries, 0 = disabled
+    std::string metadata_snapshot_dir;    // stat cache snapshots go here, empty = cache_dir, neither = disabled
+    int metadata_snapshot_interval = 300; // seconds between snapshots, 0 = only at unmount
+    
+    // Warm-tree prefetch (subdirectories of a listed directory are listed in the background)
+    int warm_tree_prefetch_dirs = 0;   // most recently seen subdirectories kept queued, 0 = disabled
+    int warm_tree_concurrency = 4;     // directories listed at once
+    
+    // Small-file settings (directories of many tiny objects)
+    bool batch_metadata_lookups = true; // concurrent cold lookups in one directory share one listing of it
+    int small_file_prefetch_kb = 0;     // files up to this size are cached when their directory is listed, 0 = disabled
     
     // File content cache settings
     bool enable_file_content_cache = true;
+    int content_cache_block_size_mb = 1;  // block granularity of fetches and cache entries
+    int max_content_cache_mb = 512;       // memory budget for cached blocks
+    int random_read_kb = 128;             // range fetched per miss once a file is read randomly, 0 = whole blocks
+    int small_object_prefetch_mb = 8;     // objects up to this size are fetched whole on first read, 0 = disabled
+    
+    // Disk cache tier (between the in-memory cache and GCS), empty cache_dir = disabled
+    std::string cache_dir;
+    int max_disk_cache_mb = 10240;        // disk budget for cached blocks
+    
+    // Read-ahead settings (sequential prefetch per open file)
+    bool enable_read_ahead = true;
+    int read_ahead_chunk_kb = 1024;  // size of each prefetch request
+    int read_ahead_max_chunks = 8;   // max prefetch requests in flight per file handle
+    
+    // Write buffer settings
+    int max_write_buffer_mb = 2048;  // memory budget for write buffers (clean buffers evicted first)
+    int chunked_write_threshold_mb = 64;  // existing objects this large are edited per chunk, 0 = disabled
+    
+    // Parallel composite upload settings (large files are uploaded as parts, then composed)
+    int parallel_upload_threshold_mb = 128;  // files at least this large use parts, 0 = disabled
+    int parallel_upload_part_size_mb = 32;   // size of each part
+    int parallel_upload_concurrency = 8;     // parts uploaded at once
+    
+    // Streaming write settings (new files written sequentially go straight to GCS)
+    bool enable_streaming_writes = true;
+    std::string staging_dir;  // non-sequential writes are staged here, empty = cache_dir or system temp dir
+    
+    // Write-back settings (close() queues the upload, fsync() waits for it)
+    bool enable_write_back = false;
+    int write_back_dirty_mb = 512;  // bytes queued for upload before close() blocks
+    int write_back_workers = 4;     // uploads run at once
+    
+    // GCS request settings
+    int gcs_connection_pool_size = 0;     // HTTP connections kept by the SDK, 0 = SDK default
+    int gcs_max_concurrent_requests = 16; // requests in flight through the async client
+    int gcs_max_bulk_requests = 8;        // of which content transfers, so metadata never starves
+    
+    // Metrics (op latency histograms and cache counters, served at /.gcscfuse/stats)
+    bool enable_metrics = true;
     
     // Testing settings
     bool enable_dummy_reader = false;
@@ -28,9 +81,12 @@ struct GCSFSConfig {
     bool debug_mode = false;
     bool verbose_logging = false;
     
-    // Bucket name (required)
+    // Bucket name (required unless buckets is set)
     std::string bucket_name;
     
+    // Buckets served by one daemon instead, each at mount_point/<bucket>
+    std::vector<std::string> buckets;
+    
     // Mount point (required)
     std::string mount_point;
     
@@ -83,6 +139,18 @@ struct GCSFSConfig {
      */
     void validate() const;
     
+    /**
+     * Buckets this configuration mounts: buckets, or else bucket_name
+     */
+    std::vector<std::string> mountedBuckets() const;
+    
+    /**
+     * Configuration of one bucket of a multi-bucket mount: it is mounted at
+     * mount_point/<bucket>, keeps its disk cache in cache_dir/<bucket> and
+     * gets an equal share of max_disk_cache_mb
+     */
+    GCSFSConfig forBucket(const std::string& bucket) const;
+    
     /**
      * Print usage information
      */
@@ -9,11 +9,45 @@ protected:
     void SetUp() override {
         // Save original environment
         saveEnv("GCSFUSE_BUCKET");
+        saveEnv("GCSFUSE_BUCKETS");
         saveEnv("GCSFUSE_MOUNT_POINT");
         saveEnv("GCSFUSE_STAT_CACHE");
         saveEnv("GCSFUSE_FILE_CACHE");
         saveEnv("GCSFUSE_DEBUG");
         saveEnv("GCSFUSE_VERBOSE");
+        saveEnv("GCSFUSE_CONTENT_CACHE_BLOCK_SIZE_MB");
+        saveEnv("GCSFUSE_MAX_CONTENT_CACHE_MB");
+        saveEnv("GCSFUSE_RANDOM_READ_KB");
+        saveEnv("GCSFUSE_SMALL_OBJECT_PREFETCH_MB");
+        saveEnv("GCSFUSE_MAX_WRITE_BUFFER_MB");
+        saveEnv("GCSFUSE_CHUNKED_WRITE_THRESHOLD_MB");
+        saveEnv("GCSFUSE_PARALLEL_UPLOAD_THRESHOLD_MB");
+        saveEnv("GCSFUSE_PARALLEL_UPLOAD_PART_SIZE_MB");
+        saveEnv("GCSFUSE_PARALLEL_UPLOAD_CONCURRENCY");
+        saveEnv("GCSFUSE_STREAMING_WRITES");
+        saveEnv("GCSFUSE_STAGING_DIR");
+        saveEnv("GCSFUSE_WRITE_BACK");
+        saveEnv("GCSFUSE_WRITE_BACK_DIRTY_MB");
+        saveEnv("GCSFUSE_WRITE_BACK_WORKERS");
+        saveEnv("GCSFUSE_CACHE_DIR");
+        saveEnv("GCSFUSE_NEGATIVE_STAT_CACHE_TTL");
+        saveEnv("GCSFUSE_MAX_STAT_CACHE_ENTRIES");
+        saveEnv("GCSFUSE_STALE_WHILE_REVALIDATE");
+        saveEnv("GCSFUSE_STAT_CACHE_SWEEP_INTERVAL");
+        saveEnv("GCSFUSE_METADATA_SNAPSHOT_DIR");
+        saveEnv("GCSFUSE_METADATA_SNAPSHOT_INTERVAL");
+        saveEnv("GCSFUSE_WARM_TREE_PREFETCH_DIRS");
+        saveEnv("GCSFUSE_WARM_TREE_CONCURRENCY");
+        saveEnv("GCSFUSE_BATCH_METADATA_LOOKUPS");
+        saveEnv("GCSFUSE_SMALL_FILE_PREFETCH_KB");
+        saveEnv("GCSFUSE_GCS_CONNECTION_POOL_SIZE");
+        saveEnv("GCSFUSE_GCS_MAX_CONCURRENT_REQUESTS");
+        saveEnv("GCSFUSE_GCS_MAX_BULK_REQUESTS");
+        saveEnv("GCSFUSE_METRICS");
+        saveEnv("GCSFUSE_MAX_DISK_CACHE_MB");
+        saveEnv("GCSFUSE_READ_AHEAD");
+        saveEnv("GCSFUSE_READ_AHEAD_CHUNK_KB");
+        saveEnv("GCSFUSE_READ_AHEAD_MAX_CHUNKS");
     }
     
     void TearDown() override {
@@ -68,10 +102,44 @@ TEST_F(ConfigTest, LoadDefaults) {
     
     EXPECT_TRUE(config.enable_stat_cache);
     EXPECT_EQ(config.stat_cache_timeout, 60);
+    EXPECT_EQ(config.negative_stat_cache_timeout, 5);
+    EXPECT_EQ(config.stale_while_revalidate, 0);
+    EXPECT_EQ(config.max_stat_cache_entries, 1000000);
+    EXPECT_EQ(config.stat_cache_sweep_interval, 60);
+    EXPECT_EQ(config.metadata_snapshot_dir, "");
+    EXPECT_EQ(config.metadata_snapshot_interval, 300);
+    EXPECT_EQ(config.warm_tree_prefetch_dirs, 0);
+    EXPECT_EQ(config.warm_tree_concurrency, 4);
+    EXPECT_TRUE(config.batch_metadata_lookups);
+    EXPECT_EQ(config.small_file_prefetch_kb, 0);
     EXPECT_TRUE(config.enable_file_content_cache);
+    EXPECT_EQ(config.content_cache_block_size_mb, 1);
+    EXPECT_EQ(config.max_content_cache_mb, 512);
+    EXPECT_EQ(config.random_read_kb, 128);
+    EXPECT_EQ(config.small_object_prefetch_mb, 8);
+    EXPECT_EQ(config.max_write_buffer_mb, 2048);
+    EXPECT_EQ(config.chunked_write_threshold_mb, 64);
+    EXPECT_EQ(config.parallel_upload_threshold_mb, 128);
+    EXPECT_EQ(config.parallel_upload_part_size_mb, 32);
+    EXPECT_EQ(config.parallel_upload_concurrency, 8);
+    EXPECT_TRUE(config.enable_streaming_writes);
+    EXPECT_EQ(config.staging_dir, "");
+    EXPECT_FALSE(config.enable_write_back);
+    EXPECT_EQ(config.write_back_dirty_mb, 512);
+    EXPECT_EQ(config.write_back_workers, 4);
+    EXPECT_EQ(config.gcs_connection_pool_size, 0);
+    EXPECT_EQ(config.gcs_max_concurrent_requests, 16);
+    EXPECT_EQ(config.gcs_max_bulk_requests, 8);
+    EXPECT_TRUE(config.enable_metrics);
+    EXPECT_EQ(config.cache_dir, "");
+    EXPECT_EQ(config.max_disk_cache_mb, 10240);
+    EXPECT_TRUE(config.enable_read_ahead);
+    EXPECT_EQ(config.read_ahead_chunk_kb, 1024);
+    EXPECT_EQ(config.read_ahead_max_chunks, 8);
     EXPECT_FALSE(config.debug_mode);
     EXPECT_FALSE(config.verbose_logging);
     EXPECT_TRUE(config.bucket_name.empty());
+    EXPECT_TRUE(config.buckets.empty());
     EXPECT_TRUE(config.mount_point.empty());
 }
 
@@ -596,6 +664,614 @@ enable_file_content_cache: false
     EXPECT_FALSE(config.enable_file_content_cache);
 }
 
+// Test content cache sizing from all sources
+TEST_F(ConfigTest, ContentCacheSizing_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+content_cache_block_size_mb: 4
+max_content_cache_mb: 256
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.content_cache_block_size_mb, 4);
+    EXPECT_EQ(config.max_content_cache_mb, 256);
+    
+    setEnv("GCSFUSE_CONTENT_CACHE_BLOCK_SIZE_MB", "8");
+    config.loadFromEnv();
+    EXPECT_EQ(config.content_cache_block_size_mb, 8);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--max-content-cache-mb=1024",
+        nullptr
+    };
+    config.parseFromArgs(4, const_cast<char**>(argv));
+    EXPECT_EQ(config.max_content_cache_mb, 1024);
+}
+
+TEST_F(ConfigTest, Validate_NonPositiveContentCacheSizes) {
+    GCSFSConfig config;
+    config.loadDefaults();
+    config.bucket_name = "test-bucket";
+    config.mount_point = "/mnt/test";
+    
+    config.content_cache_block_size_mb = 0;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+    
+    config.content_cache_block_size_mb = 1;
+    config.max_content_cache_mb = -1;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test adaptive read settings from all sources
+TEST_F(ConfigTest, AdaptiveReads_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+random_read_kb: 64
+small_object_prefetch_mb: 2
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.random_read_kb, 64);
+    EXPECT_EQ(config.small_object_prefetch_mb, 2);
+    
+    setEnv("GCSFUSE_RANDOM_READ_KB", "256");
+    setEnv("GCSFUSE_SMALL_OBJECT_PREFETCH_MB", "16");
+    config.loadFromEnv();
+    EXPECT_EQ(config.random_read_kb, 256);
+    EXPECT_EQ(config.small_object_prefetch_mb, 16);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--random-read-kb=0",
+        "--small-object-prefetch-mb=0",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_EQ(config.random_read_kb, 0);
+    EXPECT_EQ(config.small_object_prefetch_mb, 0);
+}
+
+TEST_F(ConfigTest, Validate_RandomReadLargerThanBlock) {
+    GCSFSConfig config;
+    config.loadDefaults();
+    config.bucket_name = "test-bucket";
+    config.mount_point = "/mnt/test";
+    
+    config.random_read_kb = 2048;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+    
+    config.content_cache_block_size_mb = 2;
+    EXPECT_NO_THROW(config.validate());
+    
+    config.small_object_prefetch_mb = -1;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test write buffer budget from all sources
+TEST_F(ConfigTest, WriteBufferBudget_AllSources) {
+    std::string yaml_file = createTestYAML("max_write_buffer_mb: 128\n");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.max_write_buffer_mb, 128);
+    
+    setEnv("GCSFUSE_MAX_WRITE_BUFFER_MB", "256");
+    config.loadFromEnv();
+    EXPECT_EQ(config.max_write_buffer_mb, 256);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--max-write-buffer-mb=64",
+        nullptr
+    };
+    config.parseFromArgs(4, const_cast<char**>(argv));
+    EXPECT_EQ(config.max_write_buffer_mb, 64);
+    
+    config.max_write_buffer_mb = 0;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test chunked write threshold from all sources
+TEST_F(ConfigTest, ChunkedWriteThreshold_AllSources) {
+    std::string yaml_file = createTestYAML("chunked_write_threshold_mb: 16\n");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.chunked_write_threshold_mb, 16);
+    
+    setEnv("GCSFUSE_CHUNKED_WRITE_THRESHOLD_MB", "0");
+    config.loadFromEnv();
+    EXPECT_EQ(config.chunked_write_threshold_mb, 0);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--chunked-write-threshold-mb=256",
+        nullptr
+    };
+    config.parseFromArgs(4, const_cast<char**>(argv));
+    EXPECT_EQ(config.chunked_write_threshold_mb, 256);
+    
+    config.chunked_write_threshold_mb = -1;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test read-ahead settings from all sources
+TEST_F(ConfigTest, ReadAhead_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+read_ahead_chunk_kb: 512
+read_ahead_max_chunks: 16
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.read_ahead_chunk_kb, 512);
+    EXPECT_EQ(config.read_ahead_max_chunks, 16);
+    
+    setEnv("GCSFUSE_READ_AHEAD_MAX_CHUNKS", "4");
+    config.loadFromEnv();
+    EXPECT_EQ(config.read_ahead_max_chunks, 4);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--disable-read-ahead",
+        nullptr
+    };
+    config.parseFromArgs(4, const_cast<char**>(argv));
+    EXPECT_FALSE(config.enable_read_ahead);
+}
+
+// Test parallel composite upload settings from all sources
+TEST_F(ConfigTest, ParallelUpload_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+parallel_upload_threshold_mb: 256
+parallel_upload_part_size_mb: 64
+parallel_upload_concurrency: 4
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.parallel_upload_threshold_mb, 256);
+    EXPECT_EQ(config.parallel_upload_part_size_mb, 64);
+    EXPECT_EQ(config.parallel_upload_concurrency, 4);
+    
+    setEnv("GCSFUSE_PARALLEL_UPLOAD_CONCURRENCY", "16");
+    config.loadFromEnv();
+    EXPECT_EQ(config.parallel_upload_concurrency, 16);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--parallel-upload-threshold-mb=0",
+        "--parallel-upload-part-size-mb=8",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_EQ(config.parallel_upload_threshold_mb, 0);
+    EXPECT_EQ(config.parallel_upload_part_size_mb, 8);
+    EXPECT_NO_THROW(config.validate());
+    
+    config.parallel_upload_part_size_mb = 0;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test streaming write settings from all sources
+TEST_F(ConfigTest, StreamingWrites_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+enable_streaming_writes: false
+staging_dir: /var/tmp/yaml
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_FALSE(config.enable_streaming_writes);
+    EXPECT_EQ(config.staging_dir, "/var/tmp/yaml");
+    
+    setEnv("GCSFUSE_STREAMING_WRITES", "true");
+    setEnv("GCSFUSE_STAGING_DIR", "/var/tmp/env");
+    config.loadFromEnv();
+    EXPECT_TRUE(config.enable_streaming_writes);
+    EXPECT_EQ(config.staging_dir, "/var/tmp/env");
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--disable-streaming-writes",
+        "--staging-dir=/scratch",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_FALSE(config.enable_streaming_writes);
+    EXPECT_EQ(config.staging_dir, "/scratch");
+}
+
+// Test negative stat cache TTL from all sources
+TEST_F(ConfigTest, NegativeStatCacheTTL_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+negative_stat_cache_timeout: 10
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.negative_stat_cache_timeout, 10);
+    
+    setEnv("GCSFUSE_NEGATIVE_STAT_CACHE_TTL", "20");
+    config.loadFromEnv();
+    EXPECT_EQ(config.negative_stat_cache_timeout, 20);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--negative-stat-cache-ttl=0",
+        nullptr
+    };
+    config.parseFromArgs(4, const_cast<char**>(argv));
+    EXPECT_EQ(config.negative_stat_cache_timeout, 0);
+    
+    config.negative_stat_cache_timeout = -1;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test stale-while-revalidate from all sources
+TEST_F(ConfigTest, StaleWhileRevalidate_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+stale_while_revalidate: 300
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.stale_while_revalidate, 300);
+    
+    setEnv("GCSFUSE_STALE_WHILE_REVALIDATE", "600");
+    config.loadFromEnv();
+    EXPECT_EQ(config.stale_while_revalidate, 600);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--stale-while-revalidate=30",
+        nullptr
+    };
+    config.parseFromArgs(4, const_cast<char**>(argv));
+    EXPECT_EQ(config.stale_while_revalidate, 30);
+    
+    config.stale_while_revalidate = -1;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test stat cache bounds from all sources
+TEST_F(ConfigTest, StatCacheBounds_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+max_stat_cache_entries: 5000
+stat_cache_sweep_interval: 30
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.max_stat_cache_entries, 5000);
+    EXPECT_EQ(config.stat_cache_sweep_interval, 30);
+    
+    setEnv("GCSFUSE_MAX_STAT_CACHE_ENTRIES", "6000");
+    setEnv("GCSFUSE_STAT_CACHE_SWEEP_INTERVAL", "15");
+    config.loadFromEnv();
+    EXPECT_EQ(config.max_stat_cache_entries, 6000);
+    EXPECT_EQ(config.stat_cache_sweep_interval, 15);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--max-stat-cache-entries=0",
+        "--stat-cache-sweep-interval=0",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_EQ(config.max_stat_cache_entries, 0);
+    EXPECT_EQ(config.stat_cache_sweep_interval, 0);
+    EXPECT_NO_THROW(config.validate());
+    
+    config.max_stat_cache_entries = -1;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test metadata snapshot settings from all sources
+TEST_F(ConfigTest, MetadataSnapshot_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+metadata_snapshot_dir: /var/lib/gcscfuse
+metadata_snapshot_interval: 120
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.metadata_snapshot_dir, "/var/lib/gcscfuse");
+    EXPECT_EQ(config.metadata_snapshot_interval, 120);
+    
+    setEnv("GCSFUSE_METADATA_SNAPSHOT_DIR", "/var/tmp/meta");
+    setEnv("GCSFUSE_METADATA_SNAPSHOT_INTERVAL", "60");
+    config.loadFromEnv();
+    EXPECT_EQ(config.metadata_snapshot_dir, "/var/tmp/meta");
+    EXPECT_EQ(config.metadata_snapshot_interval, 60);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--metadata-snapshot-dir=/scratch/meta",
+        "--metadata-snapshot-interval=0",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_EQ(config.metadata_snapshot_dir, "/scratch/meta");
+    EXPECT_EQ(config.metadata_snapshot_interval, 0);
+    EXPECT_NO_THROW(config.validate());
+    
+    config.metadata_snapshot_interval = -5;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test warm-tree prefetch settings from all sources
+TEST_F(ConfigTest, WarmTreePrefetch_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+warm_tree_prefetch_dirs: 64
+warm_tree_concurrency: 2
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.warm_tree_prefetch_dirs, 64);
+    EXPECT_EQ(config.warm_tree_concurrency, 2);
+    
+    setEnv("GCSFUSE_WARM_TREE_PREFETCH_DIRS", "128");
+    setEnv("GCSFUSE_WARM_TREE_CONCURRENCY", "8");
+    config.loadFromEnv();
+    EXPECT_EQ(config.warm_tree_prefetch_dirs, 128);
+    EXPECT_EQ(config.warm_tree_concurrency, 8);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--warm-tree-prefetch-dirs=256",
+        "--warm-tree-concurrency=16",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_EQ(config.warm_tree_prefetch_dirs, 256);
+    EXPECT_EQ(config.warm_tree_concurrency, 16);
+    
+    config.warm_tree_concurrency = 0;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test small-file settings from all sources
+TEST_F(ConfigTest, SmallFiles_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+batch_metadata_lookups: false
+small_file_prefetch_kb: 32
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_FALSE(config.batch_metadata_lookups);
+    EXPECT_EQ(config.small_file_prefetch_kb, 32);
+    
+    setEnv("GCSFUSE_BATCH_METADATA_LOOKUPS", "true");
+    setEnv("GCSFUSE_SMALL_FILE_PREFETCH_KB", "64");
+    config.loadFromEnv();
+    EXPECT_TRUE(config.batch_metadata_lookups);
+    EXPECT_EQ(config.small_file_prefetch_kb, 64);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--disable-metadata-batching",
+        "--small-file-prefetch-kb=16",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_FALSE(config.batch_metadata_lookups);
+    EXPECT_EQ(config.small_file_prefetch_kb, 16);
+    
+    config.small_file_prefetch_kb = -1;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test write-back settings from all sources
+TEST_F(ConfigTest, WriteBack_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+enable_write_back: true
+write_back_dirty_mb: 128
+write_back_workers: 2
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_TRUE(config.enable_write_back);
+    EXPECT_EQ(config.write_back_dirty_mb, 128);
+    EXPECT_EQ(config.write_back_workers, 2);
+    
+    setEnv("GCSFUSE_WRITE_BACK", "false");
+    setEnv("GCSFUSE_WRITE_BACK_DIRTY_MB", "256");
+    setEnv("GCSFUSE_WRITE_BACK_WORKERS", "8");
+    config.loadFromEnv();
+    EXPECT_FALSE(config.enable_write_back);
+    EXPECT_EQ(config.write_back_dirty_mb, 256);
+    EXPECT_EQ(config.write_back_workers, 8);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--write-back",
+        "--write-back-dirty-mb=64",
+        "--write-back-workers=16",
+        nullptr
+    };
+    config.parseFromArgs(6, const_cast<char**>(argv));
+    EXPECT_TRUE(config.enable_write_back);
+    EXPECT_EQ(config.write_back_dirty_mb, 64);
+    EXPECT_EQ(config.write_back_workers, 16);
+    
+    config.write_back_workers = 0;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+    config.write_back_workers = 1;
+    config.write_back_dirty_mb = 0;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test GCS request pool settings from all sources
+TEST_F(ConfigTest, GCSRequestPool_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+gcs_connection_pool_size: 32
+gcs_max_concurrent_requests: 24
+gcs_max_bulk_requests: 12
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.gcs_connection_pool_size, 32);
+    EXPECT_EQ(config.gcs_max_concurrent_requests, 24);
+    EXPECT_EQ(config.gcs_max_bulk_requests, 12);
+    
+    setEnv("GCSFUSE_GCS_CONNECTION_POOL_SIZE", "64");
+    setEnv("GCSFUSE_GCS_MAX_CONCURRENT_REQUESTS", "48");
+    setEnv("GCSFUSE_GCS_MAX_BULK_REQUESTS", "16");
+    config.loadFromEnv();
+    EXPECT_EQ(config.gcs_connection_pool_size, 64);
+    EXPECT_EQ(config.gcs_max_concurrent_requests, 48);
+    EXPECT_EQ(config.gcs_max_bulk_requests, 16);
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--gcs-connection-pool-size=8",
+        "--gcs-max-concurrent-requests=4",
+        "--gcs-max-bulk-requests=2",
+        nullptr
+    };
+    config.parseFromArgs(6, const_cast<char**>(argv));
+    EXPECT_EQ(config.gcs_connection_pool_size, 8);
+    EXPECT_EQ(config.gcs_max_concurrent_requests, 4);
+    EXPECT_EQ(config.gcs_max_bulk_requests, 2);
+    EXPECT_NO_THROW(config.validate());
+    
+    config.gcs_max_bulk_requests = 5;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Test multi-bucket settings from all sources
+TEST_F(ConfigTest, Buckets_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+buckets: [logs, models]
+mount_point: /mnt/yaml
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.buckets, (std::vector<std::string>{"logs", "models"}));
+    
+    setEnv("GCSFUSE_BUCKETS", "a, b,");
+    config.loadFromEnv();
+    EXPECT_EQ(config.buckets, (std::vector<std::string>{"a", "b"}));
+    
+    // A lone positional argument is the mount point
+    const char* argv[] = {
+        "gcscfuse", "/mnt/cli",
+        "--buckets=x,y,z",
+        nullptr
+    };
+    config.parseFromArgs(3, const_cast<char**>(argv));
+    EXPECT_EQ(config.buckets, (std::vector<std::string>{"x", "y", "z"}));
+    EXPECT_EQ(config.mount_point, "/mnt/cli");
+    EXPECT_TRUE(config.bucket_name.empty());
+    EXPECT_NO_THROW(config.validate());
+    EXPECT_EQ(config.mountedBuckets(), config.buckets);
+    
+    config.bucket_name = "other";
+    EXPECT_THROW(config.validate(), std::runtime_error);
+    config.bucket_name = "";
+    config.buckets = {"x", "x"};
+    EXPECT_THROW(config.validate(), std::runtime_error);
+    config.buckets = {"x/y"};
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+// Each bucket of a multi-bucket mount gets its own directory and disk cache share
+TEST_F(ConfigTest, ForBucket) {
+    GCSFSConfig config;
+    config.loadDefaults();
+    config.buckets = {"logs", "models"};
+    config.mount_point = "/mnt/gcs";
+    config.cache_dir = "/var/cache/gcs";
+    config.max_disk_cache_mb = 1000;
+    
+    GCSFSConfig logs = config.forBucket("logs");
+    EXPECT_EQ(logs.bucket_name, "logs");
+    EXPECT_TRUE(logs.buckets.empty());
+    EXPECT_EQ(logs.mount_point, "/mnt/gcs/logs");
+    EXPECT_EQ(logs.cache_dir, "/var/cache/gcs/logs");
+    EXPECT_EQ(logs.max_disk_cache_mb, 500);
+    EXPECT_EQ(logs.max_content_cache_mb, config.max_content_cache_mb);
+    EXPECT_NO_THROW(logs.validate());
+    
+    GCSFSConfig single;
+    single.loadDefaults();
+    single.bucket_name = "bucket";
+    EXPECT_EQ(single.mountedBuckets(), std::vector<std::string>{"bucket"});
+}
+
+// Test disk cache settings from all sources
+TEST_F(ConfigTest, DiskCache_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+cache_dir: /mnt/yaml-cache
+max_disk_cache_mb: 2048
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_EQ(config.cache_dir, "/mnt/yaml-cache");
+    EXPECT_EQ(config.max_disk_cache_mb, 2048);
+    
+    setEnv("GCSFUSE_CACHE_DIR", "/mnt/env-cache");
+    config.loadFromEnv();
+    EXPECT_EQ(config.cache_dir, "/mnt/env-cache");
+    
+    const char* argv[] = {
+        "gcscfuse", "bucket", "/mnt",
+        "--cache-dir=/mnt/cli-cache",
+        "--max-disk-cache-mb=512",
+        nullptr
+    };
+    config.parseFromArgs(5, const_cast<char**>(argv));
+    EXPECT_EQ(config.cache_dir, "/mnt/cli-cache");
+    EXPECT_EQ(config.max_disk_cache_mb, 512);
+    
+    config.max_disk_cache_mb = 0;
+    EXPECT_THROW(config.validate(), std::runtime_error);
+}
+
+TEST_F(ConfigTest, Metrics_AllSources) {
+    std::string yaml_file = createTestYAML(R"(
+enable_metrics: false
+)");
+    
+    GCSFSConfig config;
+    config.loadDefaults();
+    EXPECT_TRUE(config.loadFromYAML(yaml_file));
+    EXPECT_FALSE(config.enable_metrics);
+    
+    setEnv("GCSFUSE_METRICS", "true");
+    config.loadFromEnv();
+    EXPECT_TRUE(config.enable_metrics);
+    
+    const char* argv[] = {"gcscfuse", "bucket", "/mnt", "--disable-metrics", nullptr};
+    config.parseFromArgs(4, const_cast<char**>(argv));
+    EXPECT_FALSE(config.enable_metrics);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,254 @@
+#include "content_cache.hpp"
+#include <algorithm>
+#include <functional>
+
+namespace gcscfuse {
+
+ContentCache::ContentCache(size_t block_size, size_t max_bytes, size_t num_shards)
+    : block_size_(block_size > 0 ? block_size : kDefaultBlockSize),
+      max_bytes_(max_bytes)
+{
+    if (num_shards == 0) {
+        num_shards = max_bytes_ / (block_size_ * kMinBlocksPerShard);
+        num_shards = std::clamp<size_t>(num_shards, 1, kMaxShards);
+    }
+
+    // Remember as many ghost keys as would fill half of each shard's budget
+    const size_t shard_bytes = max_bytes_ / num_shards;
+    const size_t ghost_capacity = std::max<size_t>((shard_bytes / 2) / block_size_, 1);
+
+    for (size_t i = 0; i < num_shards; ++i) {
+        auto shard = std::make_unique<Shard>();
+        shard->max_bytes = shard_bytes;
+        shard->ghost_capacity = ghost_capacity;
+        shards_.push_back(std::move(shard));
+    }
+}
+
+ContentCache::Shard& ContentCache::shardFor(const std::string& object_name, std::uint64_t block_index) const {
+    size_t hash = std::hash<std::string>{}(object_name) ^ (std::hash<std::uint64_t>{}(block_index) * 0x9e3779b97f4a7c15ULL);
+    return *shards_[hash % shards_.size()];
+}
+
+ContentCache::Block ContentCache::get(const std::string& object_name, std::uint64_t block_index,
+                                      std::int64_t generation) {
+    Shard& shard = shardFor(object_name, block_index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    return shard.get(BlockKey(object_name, block_index), generation);
+}
+
+bool ContentCache::contains(const std::string& object_name, std::uint64_t block_index,
+                            std::int64_t generation) const {
+    Shard& shard = shardFor(object_name, block_index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto it = shard.blocks.find(BlockKey(object_name, block_index));
+    return it != shard.blocks.end() && (generation == 0 || it->second.generation == generation);
+}
+
+void ContentCache::put(const std::string& object_name, std::uint64_t block_index, Block data,
+                       std::int64_t generation) {
+    Shard& shard = shardFor(object_name, block_index);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.put(BlockKey(object_name, block_index), std::move(data), generation);
+}
+
+void ContentCache::invalidate(const std::string& object_name) {
+    // Blocks of one object are spread across shards
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->invalidate(object_name);
+    }
+}
+
+void ContentCache::clear() {
+    for (auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        shard->clear();
+    }
+}
+
+size_t ContentCache::sizeBytes() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->sizeBytes();
+    }
+    return total;
+}
+
+size_t ContentCache::blockCount() const {
+    size_t total = 0;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total += shard->blocks.size();
+    }
+    return total;
+}
+
+ContentCache::Stats ContentCache::stats() const {
+    Stats total;
+    for (const auto& shard : shards_) {
+        std::lock_guard<std::mutex> lock(shard->mutex);
+        total.hits += shard->stats.hits;
+        total.misses += shard->stats.misses;
+        total.insertions += shard->stats.insertions;
+        total.evictions += shard->stats.evictions;
+        total.evicted_bytes += shard->stats.evicted_bytes;
+        total.ghost_hits += shard->stats.ghost_hits;
+        total.stale += shard->stats.stale;
+    }
+    return total;
+}
+
+// ==================== Shard ====================
+
+ContentCache::Block ContentCache::Shard::get(const BlockKey& key, std::int64_t generation) {
+    auto it = blocks.find(key);
+    if (it != blocks.end() && generation != 0 && it->second.generation != generation) {
+        // Generations only grow, so an older block is of a replaced version
+        // of the object; a newer one is kept for readers already on it
+        if (it->second.generation < generation) {
+            stats.stale++;
+            erase(it);
+        }
+        it = blocks.end();
+    }
+    if (it == blocks.end()) {
+        stats.misses++;
+        return nullptr;
+    }
+
+    stats.hits++;
+
+    // Only blocks in main are reordered; hits in in are correlated references
+    if (it->second.queue == Queue::kMain) {
+        main.splice(main.begin(), main, it->second.pos);
+    }
+    return it->second.data;
+}
+
+void ContentCache::Shard::put(BlockKey key, Block data, std::int64_t generation) {
+    if (!data || data->size() > max_bytes) {
+        return;
+    }
+
+    auto it = blocks.find(key);
+    Queue queue = Queue::kIn;
+    if (it != blocks.end() && generation != 0 && generation < it->second.generation) {
+        return;  // a reader still on a replaced version
+    }
+    if (it != blocks.end()) {
+        // Replacing a resident block keeps its queue
+        queue = it->second.queue;
+        erase(it);
+    } else if (takeGhost(key)) {
+        stats.ghost_hits++;
+        queue = Queue::kMain;
+    }
+
+    Entry entry;
+    entry.generation = generation;
+    entry.queue = queue;
+    if (queue == Queue::kMain) {
+        main.push_front(key);
+        entry.pos = main.begin();
+        main_bytes += data->size();
+    } else {
+        in.push_front(key);
+        entry.pos = in.begin();
+        in_bytes += data->size();
+    }
+    entry.data = std::move(data);
+    blocks.emplace(std::move(key), std::move(entry));
+    stats.insertions++;
+
+    evictIfNeeded();
+}
+
+void ContentCache::Shard::invalidate(const std::string& object_name) {
+    auto it = blocks.lower_bound(BlockKey(object_name, 0));
+    while (it != blocks.end() && it->first.first == object_name) {
+        auto next = std::next(it);
+        erase(it);
+        it = next;
+    }
+
+    auto ghost_it = ghost_index.lower_bound(BlockKey(object_name, 0));
+    while (ghost_it != ghost_index.end() && ghost_it->first.first == object_name) {
+        ghost.erase(ghost_it->second);
+        ghost_it = ghost_index.erase(ghost_it);
+    }
+}
+
+void ContentCache::Shard::clear() {
+    blocks.clear();
+    in.clear();
+    main.clear();
+    ghost.clear();
+    ghost_index.clear();
+    in_bytes = 0;
+    main_bytes = 0;
+}
+
+void ContentCache::Shard::evictIfNeeded() {
+    while (sizeBytes() > max_bytes) {
+        bool from_in = !in.empty() && (in_bytes > inCapacityBytes() || main.empty());
+        KeyList& queue = from_in ? in : main;
+        if (queue.empty()) {
+            break;
+        }
+
+        auto it = blocks.find(queue.back());
+        if (it == blocks.end()) {
+            queue.pop_back();
+            continue;
+        }
+
+        stats.evictions++;
+        stats.evicted_bytes += it->second.data->size();
+
+        BlockKey key = it->first;
+        erase(it);
+        if (from_in) {
+            addGhost(key);
+        }
+    }
+}
+
+void ContentCache::Shard::erase(std::map<BlockKey, Entry>::iterator it) {
+    const size_t size = it->second.data->size();
+    if (it->second.queue == Queue::kMain) {
+        main_bytes -= size;
+        main.erase(it->second.pos);
+    } else {
+        in_bytes -= size;
+        in.erase(it->second.pos);
+    }
+    blocks.erase(it);
+}
+
+void ContentCache::Shard::addGhost(const BlockKey& key) {
+    if (ghost_index.count(key)) {
+        return;
+    }
+
+    ghost.push_front(key);
+    ghost_index[key] = ghost.begin();
+
+    while (ghost.size() > ghost_capacity) {
+        ghost_index.erase(ghost.back());
+        ghost.pop_back();
+    }
+}
+
+bool ContentCache::Shard::takeGhost(const BlockKey& key) {
+    auto it = ghost_index.find(key);
+    if (it == ghost_index.end()) {
+        return false;
+    }
+    ghost.erase(it->second);
+    ghost_index.erase(it);
+    return true;
+}
+
+} // namespace gcscfuse
@@ -0,0 +1,156 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+namespace gcscfuse {
+
+/**
+ * ContentCache - Block-granular in-memory cache for object content
+ *
+ * Object content is split into fixed-size blocks keyed by
+ * (object_name, block_index), so a read only needs the blocks it touches.
+ * Total memory is bounded by a byte budget.
+ *
+ * Replacement follows the 2Q policy, which keeps one sequential scan from
+ * flushing the hot working set:
+ *   - in_    FIFO of blocks seen once (bounded to a quarter of the budget)
+ *   - main_  LRU of blocks that were referenced again after leaving in_
+ *   - ghost_ keys (no data) recently evicted from in_; a block re-inserted
+ *            while its key is still a ghost goes straight to main_
+ * Repeated hits on a block while it sits in in_ (e.g. many small reads of
+ * one block) do not promote it, since they are one correlated reference.
+ *
+ * Thread-safe: blocks are spread over independently locked shards by
+ * hashing (object_name, block_index), each shard owning an equal slice of
+ * the budget, so concurrent readers rarely contend on the same lock.
+ *
+ * Blocks are handed out as shared_ptr so callers can keep using a block
+ * after it has been evicted from the cache.
+ *
+ * Each block records the GCS generation of the object it was read from.
+ * A lookup for one generation never returns a block of another, so reads
+ * pinned to a generation cannot mix stale blocks with fresh ones;
+ * generation 0 means unknown and matches any block.
+ */
+class ContentCache {
+public:
+    using Block = std::shared_ptr<const std::string>;
+
+    static constexpr size_t kDefaultBlockSize = 1024 * 1024;           // 1 MiB
+    static constexpr size_t kDefaultMaxBytes = 512ULL * 1024 * 1024;   // 512 MiB
+    static constexpr size_t kMaxShards = 16;
+    static constexpr size_t kMinBlocksPerShard = 64;
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t insertions = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t evicted_bytes = 0;
+        std::uint64_t ghost_hits = 0;  // re-inserted blocks promoted by their ghost key
+        std::uint64_t stale = 0;       // blocks of an older generation dropped on lookup
+    };
+
+    // num_shards = 0 picks a shard count from the budget, keeping at least
+    // kMinBlocksPerShard blocks per shard so small caches stay exact
+    explicit ContentCache(size_t block_size = kDefaultBlockSize,
+                          size_t max_bytes = kDefaultMaxBytes,
+                          size_t num_shards = 0);
+    ~ContentCache() = default;
+
+    // Block size in bytes
+    size_t blockSize() const { return block_size_; }
+
+    // Memory budget in bytes
+    size_t maxBytes() const { return max_bytes_; }
+
+    // Get a cached block of the generation, or nullptr on miss. A block of
+    // an older generation is dropped and counts as a miss.
+    Block get(const std::string& object_name, std::uint64_t block_index, std::int64_t generation = 0);
+
+    // Whether a block of the generation is cached, without counting a hit or reordering it
+    bool contains(const std::string& object_name, std::uint64_t block_index, std::int64_t generation = 0) const;
+
+    // Insert (or replace) a block read from the generation. Blocks larger
+    // than a shard's budget, or older than the resident block, are not cached.
+    void put(const std::string& object_name, std::uint64_t block_index, Block data,
+             std::int64_t generation = 0);
+
+    // Drop all blocks of an object
+    void invalidate(const std::string& object_name);
+
+    // Drop all blocks
+    void clear();
+
+    // Bytes currently held by cached blocks
+    size_t sizeBytes() const;
+
+    // Number of cached blocks
+    size_t blockCount() const;
+
+    // Hit/miss/eviction counters, summed over shards
+    Stats stats() const;
+
+private:
+    using BlockKey = std::pair<std::string, std::uint64_t>;
+    using KeyList = std::list<BlockKey>;
+
+    enum class Queue { kIn, kMain };
+
+    struct Entry {
+        Block data;
+        std::int64_t generation;
+        Queue queue;
+        KeyList::iterator pos;
+    };
+
+    // One independently locked 2Q cache
+    struct Shard {
+        mutable std::mutex mutex;
+
+        // Ordered so all blocks of one object are contiguous (cheap invalidate)
+        std::map<BlockKey, Entry> blocks;
+
+        KeyList in;    // newest at the front
+        KeyList main;  // most recently used at the front
+        KeyList ghost; // newest at the front
+        std::map<BlockKey, KeyList::iterator> ghost_index;
+
+        size_t max_bytes = 0;
+        size_t ghost_capacity = 1;
+        size_t in_bytes = 0;
+        size_t main_bytes = 0;
+        Stats stats;
+
+        Block get(const BlockKey& key, std::int64_t generation);
+        void put(BlockKey key, Block data, std::int64_t generation);
+        void invalidate(const std::string& object_name);
+        void clear();
+
+        size_t sizeBytes() const { return in_bytes + main_bytes; }
+        size_t inCapacityBytes() const { return max_bytes / 4; }
+
+        // Evict blocks until the budget is respected
+        void evictIfNeeded();
+
+        void erase(std::map<BlockKey, Entry>::iterator it);
+        void addGhost(const BlockKey& key);
+        bool takeGhost(const BlockKey& key);
+    };
+
+    size_t block_size_;
+    size_t max_bytes_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    Shard& shardFor(const std::string& object_name, std::uint64_t block_index) const;
+};
+
+} // namespace gcscfuse
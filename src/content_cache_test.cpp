@@ -0,0 +1,206 @@
+#include <gtest/gtest.h>
+#include "content_cache.hpp"
+#include <thread>
+#include <vector>
+
+using namespace gcscfuse;
+
+namespace {
+ContentCache::Block makeBlock(size_t size, char fill = 'x') {
+    return std::make_shared<const std::string>(size, fill);
+}
+}
+
+// Test fixture for ContentCache tests
+class ContentCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        cache = std::make_unique<ContentCache>(16, 64);
+    }
+
+    std::unique_ptr<ContentCache> cache;
+};
+
+TEST_F(ContentCacheTest, MissReturnsNullptr) {
+    EXPECT_EQ(cache->get("file.txt", 0), nullptr);
+}
+
+TEST_F(ContentCacheTest, PutAndGetBlock) {
+    cache->put("file.txt", 3, makeBlock(16, 'a'));
+
+    auto block = cache->get("file.txt", 3);
+    ASSERT_NE(block, nullptr);
+    EXPECT_EQ(*block, std::string(16, 'a'));
+    EXPECT_EQ(cache->blockCount(), 1u);
+    EXPECT_EQ(cache->sizeBytes(), 16u);
+}
+
+TEST_F(ContentCacheTest, ContainsDoesNotCountHits) {
+    cache->put("file.txt", 0, makeBlock(16));
+
+    EXPECT_TRUE(cache->contains("file.txt", 0));
+    EXPECT_FALSE(cache->contains("file.txt", 1));
+    EXPECT_EQ(cache->stats().hits, 0u);
+    EXPECT_EQ(cache->stats().misses, 0u);
+}
+
+TEST_F(ContentCacheTest, BlocksAreKeyedByObjectAndIndex) {
+    cache->put("a.txt", 0, makeBlock(16, 'a'));
+    cache->put("b.txt", 0, makeBlock(16, 'b'));
+
+    EXPECT_EQ(*cache->get("a.txt", 0), std::string(16, 'a'));
+    EXPECT_EQ(*cache->get("b.txt", 0), std::string(16, 'b'));
+    EXPECT_EQ(cache->get("a.txt", 1), nullptr);
+}
+
+TEST_F(ContentCacheTest, GenerationMismatchIsMiss) {
+    cache->put("file.txt", 0, makeBlock(16, 'o'), 5);
+
+    EXPECT_TRUE(cache->contains("file.txt", 0));
+    EXPECT_TRUE(cache->contains("file.txt", 0, 5));
+    EXPECT_FALSE(cache->contains("file.txt", 0, 6));
+    EXPECT_EQ(*cache->get("file.txt", 0, 5), std::string(16, 'o'));
+
+    // A reader still on an older generation neither sees nor replaces it
+    EXPECT_EQ(cache->get("file.txt", 0, 4), nullptr);
+    cache->put("file.txt", 0, makeBlock(16, 'x'), 4);
+    EXPECT_EQ(*cache->get("file.txt", 0, 5), std::string(16, 'o'));
+    EXPECT_EQ(cache->stats().stale, 0u);
+
+    // A newer generation drops the old block
+    EXPECT_EQ(cache->get("file.txt", 0, 6), nullptr);
+    EXPECT_EQ(cache->stats().stale, 1u);
+    EXPECT_EQ(cache->blockCount(), 0u);
+    cache->put("file.txt", 0, makeBlock(16, 'n'), 6);
+    EXPECT_EQ(*cache->get("file.txt", 0, 6), std::string(16, 'n'));
+}
+
+TEST_F(ContentCacheTest, ReplaceBlockKeepsAccountingExact) {
+    cache->put("file.txt", 0, makeBlock(16));
+    cache->put("file.txt", 0, makeBlock(4));
+
+    EXPECT_EQ(cache->blockCount(), 1u);
+    EXPECT_EQ(cache->sizeBytes(), 4u);
+}
+
+TEST_F(ContentCacheTest, EvictsOldestOnceSeenBlockOverBudget) {
+    for (std::uint64_t i = 0; i < 4; ++i) {
+        cache->put("file.txt", i, makeBlock(16));
+    }
+
+    // Hits while still in the once-seen queue do not protect a block
+    ASSERT_NE(cache->get("file.txt", 0), nullptr);
+    cache->put("file.txt", 4, makeBlock(16));
+
+    EXPECT_LE(cache->sizeBytes(), cache->maxBytes());
+    EXPECT_EQ(cache->get("file.txt", 0), nullptr);
+    EXPECT_NE(cache->get("file.txt", 1), nullptr);
+    EXPECT_NE(cache->get("file.txt", 4), nullptr);
+    EXPECT_EQ(cache->stats().evictions, 1u);
+}
+
+TEST_F(ContentCacheTest, ReinsertedGhostIsPromoted) {
+    for (std::uint64_t i = 0; i < 5; ++i) {
+        cache->put("file.txt", i, makeBlock(16));
+    }
+    ASSERT_EQ(cache->get("file.txt", 0), nullptr);
+
+    // Block 0 was evicted recently, so re-inserting it marks it hot
+    cache->put("file.txt", 0, makeBlock(16));
+    EXPECT_EQ(cache->stats().ghost_hits, 1u);
+
+    cache->put("file.txt", 5, makeBlock(16));
+    EXPECT_NE(cache->get("file.txt", 0), nullptr);
+}
+
+TEST_F(ContentCacheTest, SequentialScanDoesNotFlushHotBlock) {
+    for (std::uint64_t i = 0; i < 5; ++i) {
+        cache->put("hot.bin", i, makeBlock(16));
+    }
+    cache->put("hot.bin", 0, makeBlock(16));
+
+    // A long scan over another object only cycles the once-seen queue
+    for (std::uint64_t i = 0; i < 100; ++i) {
+        cache->put("scan.bin", i, makeBlock(16));
+    }
+
+    EXPECT_NE(cache->get("hot.bin", 0), nullptr);
+    EXPECT_LE(cache->sizeBytes(), cache->maxBytes());
+}
+
+TEST_F(ContentCacheTest, CountsHitsAndMisses) {
+    cache->put("file.txt", 0, makeBlock(16));
+
+    cache->get("file.txt", 0);
+    cache->get("file.txt", 0);
+    cache->get("file.txt", 1);
+
+    EXPECT_EQ(cache->stats().hits, 2u);
+    EXPECT_EQ(cache->stats().misses, 1u);
+    EXPECT_EQ(cache->stats().insertions, 1u);
+}
+
+TEST_F(ContentCacheTest, BlockLargerThanBudgetIsNotCached) {
+    cache->put("file.txt", 0, makeBlock(128));
+
+    EXPECT_EQ(cache->get("file.txt", 0), nullptr);
+    EXPECT_EQ(cache->sizeBytes(), 0u);
+}
+
+TEST_F(ContentCacheTest, InvalidateDropsOnlyThatObject) {
+    cache->put("file.txt", 0, makeBlock(8));
+    cache->put("file.txt", 1, makeBlock(8));
+    cache->put("file.txt.bak", 0, makeBlock(8));
+
+    cache->invalidate("file.txt");
+
+    EXPECT_EQ(cache->get("file.txt", 0), nullptr);
+    EXPECT_EQ(cache->get("file.txt", 1), nullptr);
+    EXPECT_NE(cache->get("file.txt.bak", 0), nullptr);
+    EXPECT_EQ(cache->sizeBytes(), 8u);
+}
+
+TEST_F(ContentCacheTest, ClearDropsEverything) {
+    cache->put("a.txt", 0, makeBlock(8));
+    cache->put("b.txt", 0, makeBlock(8));
+
+    cache->clear();
+
+    EXPECT_EQ(cache->blockCount(), 0u);
+    EXPECT_EQ(cache->sizeBytes(), 0u);
+}
+
+TEST_F(ContentCacheTest, EvictedBlockStaysValidForHolder) {
+    cache->put("file.txt", 0, makeBlock(16, 'z'));
+    auto held = cache->get("file.txt", 0);
+
+    cache->clear();
+
+    ASSERT_NE(held, nullptr);
+    EXPECT_EQ(*held, std::string(16, 'z'));
+}
+
+TEST(ContentCacheShardingTest, ConcurrentAccessRespectsBudget) {
+    ContentCache sharded(16, 16 * 1024);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&sharded, t]() {
+            const std::string name = "file" + std::to_string(t);
+            for (std::uint64_t i = 0; i < 2000; ++i) {
+                sharded.put(name, i % 500, makeBlock(16));
+                sharded.get(name, (i * 7) % 500);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_LE(sharded.sizeBytes(), sharded.maxBytes());
+    EXPECT_EQ(sharded.stats().insertions, 8000u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,93 @@
+#include "directory_prefetcher.hpp"
+#include <algorithm>
+#include <exception>
+#include <iostream>
+
+namespace gcscfuse {
+
+DirectoryPrefetcher::DirectoryPrefetcher(ListFunction list, size_t max_pending, size_t concurrency)
+    : list_(std::move(list)),
+      max_pending_(std::max<size_t>(max_pending, 1))
+{
+    concurrency = std::max<size_t>(concurrency, 1);
+    workers_.reserve(concurrency);
+    for (size_t i = 0; i < concurrency; ++i) {
+        workers_.emplace_back(&DirectoryPrefetcher::workerLoop, this);
+    }
+}
+
+DirectoryPrefetcher::~DirectoryPrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        pending_.clear();
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void DirectoryPrefetcher::schedule(const std::string& path) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_ || !queued_.insert(path).second) {
+            return;
+        }
+        pending_.push_back(path);
+        stats_.scheduled++;
+
+        if (pending_.size() > max_pending_) {
+            queued_.erase(pending_.front());
+            pending_.pop_front();
+            stats_.dropped++;
+        }
+    }
+    work_cv_.notify_one();
+}
+
+void DirectoryPrefetcher::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_cv_.wait(lock, [this] { return pending_.empty() && active_ == 0; });
+}
+
+size_t DirectoryPrefetcher::pendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pending_.size();
+}
+
+DirectoryPrefetcher::Stats DirectoryPrefetcher::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void DirectoryPrefetcher::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        work_cv_.wait(lock, [this] { return stopping_ || !pending_.empty(); });
+        if (stopping_) {
+            return;
+        }
+
+        std::string path = std::move(pending_.back());
+        pending_.pop_back();
+        active_++;
+        lock.unlock();
+
+        try {
+            list_(path);
+        } catch (const std::exception& e) {
+            std::cerr << "Error prefetching directory " << path << ": " << e.what() << std::endl;
+        }
+
+        lock.lock();
+        active_--;
+        queued_.erase(path);
+        stats_.completed++;
+        if (pending_.empty() && active_ == 0) {
+            idle_cv_.notify_all();
+        }
+    }
+}
+
+} // namespace gcscfuse
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <set>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace gcscfuse {
+
+/**
+ * DirectoryPrefetcher - Lists directories ahead of a tree walk
+ *
+ * Directories handed to schedule() are listed by a small pool of background
+ * threads, so a find or du over a deep tree finds most listings already in
+ * the stat cache instead of waiting on one listing round trip per directory
+ * in sequence.
+ *
+ * Only the max_pending most recently scheduled directories are kept; older
+ * ones are dropped, since a walk has usually moved on from them. Workers
+ * take the newest first, which follows a depth-first walk. A directory that
+ * is already queued or being listed is not scheduled twice.
+ *
+ * Thread-safe.
+ */
+class DirectoryPrefetcher {
+public:
+    using ListFunction = std::function<void(const std::string& path)>;
+
+    struct Stats {
+        std::uint64_t scheduled = 0;
+        std::uint64_t completed = 0;
+        std::uint64_t dropped = 0;   // pushed out of the queue before being listed
+    };
+
+    // Starts concurrency worker threads that call list for each scheduled path
+    DirectoryPrefetcher(ListFunction list, size_t max_pending, size_t concurrency);
+
+    // Stops the workers; pending directories are dropped, in-flight ones finish
+    ~DirectoryPrefetcher();
+
+    DirectoryPrefetcher(const DirectoryPrefetcher&) = delete;
+    DirectoryPrefetcher& operator=(const DirectoryPrefetcher&) = delete;
+
+    void schedule(const std::string& path);
+
+    // Block until nothing is queued or being listed
+    void waitIdle();
+
+    size_t pendingCount() const;
+
+    Stats stats() const;
+
+private:
+    ListFunction list_;
+    size_t max_pending_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable idle_cv_;
+    std::deque<std::string> pending_;   // most recently scheduled at the back
+    std::set<std::string> queued_;      // pending or being listed
+    size_t active_ = 0;
+    bool stopping_ = false;
+    Stats stats_;
+
+    std::vector<std::thread> workers_;
+
+    void workerLoop();
+};
+
+} // namespace gcscfuse
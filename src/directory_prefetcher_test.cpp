@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "directory_prefetcher.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+using namespace gcscfuse;
+
+// Records listed paths; can hold workers until released
+class ListRecorder {
+public:
+    void operator()(const std::string& path) {
+        std::unique_lock<std::mutex> lock(mutex);
+        listed.push_back(path);
+        in_flight++;
+        max_in_flight = std::max(max_in_flight, in_flight);
+        cv.notify_all();
+        cv.wait(lock, [this] { return !blocked; });
+        in_flight--;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocked = false;
+        cv.notify_all();
+    }
+
+    void waitForInFlight(int count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(5), [&] { return in_flight >= count; });
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::string> listed;
+    int in_flight = 0;
+    int max_in_flight = 0;
+    bool blocked = false;
+};
+
+TEST(DirectoryPrefetcherTest, ListsScheduledDirectories) {
+    ListRecorder recorder;
+    DirectoryPrefetcher prefetcher([&](const std::string& p) { recorder(p); }, 16, 2);
+
+    prefetcher.schedule("/a");
+    prefetcher.schedule("/b");
+    prefetcher.waitIdle();
+
+    std::set<std::string> listed(recorder.listed.begin(), recorder.listed.end());
+    EXPECT_EQ(listed, (std::set<std::string>{"/a", "/b"}));
+    EXPECT_EQ(prefetcher.stats().completed, 2u);
+}
+
+TEST(DirectoryPrefetcherTest, SkipsDirectoriesAlreadyQueued) {
+    ListRecorder recorder;
+    recorder.blocked = true;
+    DirectoryPrefetcher prefetcher([&](const std::string& p) { recorder(p); }, 16, 1);
+
+    prefetcher.schedule("/busy");
+    recorder.waitForInFlight(1);
+    prefetcher.schedule("/busy");   // in flight
+    prefetcher.schedule("/next");
+    prefetcher.schedule("/next");   // queued
+
+    EXPECT_EQ(prefetcher.stats().scheduled, 2u);
+    recorder.release();
+    prefetcher.waitIdle();
+    EXPECT_EQ(recorder.listed.size(), 2u);
+}
+
+TEST(DirectoryPrefetcherTest, DropsOldestWhenFull) {
+    ListRecorder recorder;
+    recorder.blocked = true;
+    DirectoryPrefetcher prefetcher([&](const std::string& p) { recorder(p); }, 2, 1);
+
+    prefetcher.schedule("/first");
+    recorder.waitForInFlight(1);
+    prefetcher.schedule("/old");
+    prefetcher.schedule("/newer");
+    prefetcher.schedule("/newest");
+
+    EXPECT_EQ(prefetcher.pendingCount(), 2u);
+    EXPECT_EQ(prefetcher.stats().dropped, 1u);
+
+    recorder.release();
+    prefetcher.waitIdle();
+
+    // Newest first, and the oldest pending one never gets listed
+    EXPECT_EQ(recorder.listed, (std::vector<std::string>{"/first", "/newest", "/newer"}));
+}
+
+TEST(DirectoryPrefetcherTest, ListsConcurrently) {
+    ListRecorder recorder;
+    recorder.blocked = true;
+    DirectoryPrefetcher prefetcher([&](const std::string& p) { recorder(p); }, 16, 3);
+
+    prefetcher.schedule("/a");
+    prefetcher.schedule("/b");
+    prefetcher.schedule("/c");
+    recorder.waitForInFlight(3);
+
+    EXPECT_EQ(recorder.max_in_flight, 3);
+    recorder.release();
+    prefetcher.waitIdle();
+}
+
+TEST(DirectoryPrefetcherTest, DestructorDropsPendingWork) {
+    ListRecorder recorder;
+    recorder.blocked = true;
+    std::atomic<int> calls{0};
+    {
+        DirectoryPrefetcher prefetcher([&](const std::string& p) { calls++; recorder(p); }, 16, 1);
+        prefetcher.schedule("/running");
+        recorder.waitForInFlight(1);
+        prefetcher.schedule("/pending");
+        recorder.release();
+    }
+    EXPECT_GE(calls.load(), 1);
+    EXPECT_LE(calls.load(), 2);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
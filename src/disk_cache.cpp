@@ -0,0 +1,370 @@
+#include "disk_cache.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace fs = std::filesystem;
+
+namespace gcscfuse {
+
+namespace {
+    constexpr const char* kNameFile = ".name";
+    constexpr const char* kGenerationFile = ".generation";
+    constexpr const char* kTempPrefix = ".tmp-";
+
+    // FNV-1a, so directory names stay the same across builds and restarts
+    std::uint64_t stableHash(const std::string& value) {
+        std::uint64_t hash = 14695981039346656037ULL;
+        for (unsigned char c : value) {
+            hash ^= c;
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    bool writeFile(const std::string& path, const char* data, size_t size) {
+        int fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0600);
+        if (fd < 0) {
+            return false;
+        }
+        size_t written = 0;
+        while (written < size) {
+            ssize_t n = ::write(fd, data + written, size - written);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                ::close(fd);
+                return false;
+            }
+            written += static_cast<size_t>(n);
+        }
+        return ::close(fd) == 0;
+    }
+}
+
+DiskCache::DiskCache(const std::string& cache_dir, size_t block_size, size_t max_bytes)
+    : cache_dir_(cache_dir),
+      block_size_(block_size > 0 ? block_size : kDefaultBlockSize),
+      max_bytes_(max_bytes)
+{
+    std::error_code ec;
+    fs::create_directories(cache_dir_, ec);
+    if (ec || !fs::is_directory(cache_dir_, ec)) {
+        std::cerr << "Disk cache disabled, cannot use " << cache_dir_ << ": " << ec.message() << std::endl;
+        return;
+    }
+    usable_ = true;
+    recover();
+}
+
+std::string DiskCache::objectDir(const std::string& object_name) const {
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(stableHash(object_name)));
+    return cache_dir_ + "/" + hex;
+}
+
+std::string DiskCache::blockPath(const std::string& object_name, std::uint64_t block_index) const {
+    return objectDir(object_name) + "/" + std::to_string(block_index);
+}
+
+void DiskCache::recover() {
+    struct Found {
+        BlockKey key;
+        size_t size;
+        fs::file_time_type mtime;
+    };
+    std::vector<Found> found;
+    std::error_code ec;
+
+    for (const auto& dir_entry : fs::directory_iterator(cache_dir_, ec)) {
+        if (!dir_entry.is_directory(ec)) {
+            continue;
+        }
+
+        std::string object_name;
+        std::ifstream name_file(dir_entry.path() / kNameFile, std::ios::binary);
+        if (name_file) {
+            object_name.assign(std::istreambuf_iterator<char>(name_file), {});
+        }
+        if (object_name.empty() || fs::path(objectDir(object_name)).filename() != dir_entry.path().filename()) {
+            fs::remove_all(dir_entry.path(), ec);
+            continue;
+        }
+        dir_owner_[dir_entry.path().filename().string()] = object_name;
+
+        std::int64_t generation = 0;
+        std::ifstream generation_file(dir_entry.path() / kGenerationFile);
+        if (generation_file >> generation && generation != 0) {
+            generations_[object_name] = generation;
+        }
+
+        for (const auto& file : fs::directory_iterator(dir_entry.path(), ec)) {
+            const std::string file_name = file.path().filename().string();
+            if (file_name == kNameFile || file_name == kGenerationFile) {
+                continue;
+            }
+            const bool is_index = !file_name.empty() &&
+                std::all_of(file_name.begin(), file_name.end(), ::isdigit);
+            if (!is_index || !file.is_regular_file(ec)) {
+                // Leftover temporary from an interrupted put
+                fs::remove(file.path(), ec);
+                continue;
+            }
+            found.push_back({BlockKey(object_name, std::stoull(file_name)),
+                             static_cast<size_t>(file.file_size(ec)),
+                             file.last_write_time(ec)});
+        }
+    }
+
+    // Oldest first, so the most recently written blocks end up most recently used
+    std::sort(found.begin(), found.end(),
+              [](const Found& a, const Found& b) { return a.mtime < b.mtime; });
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& block : found) {
+        lru_.push_front(block.key);
+        blocks_[block.key] = Entry{block.size, lru_.begin()};
+        total_bytes_ += block.size;
+        stats_.recovered++;
+    }
+    evictFor(0);
+}
+
+int DiskCache::openBlock(const std::string& object_name, std::uint64_t block_index, size_t& block_length,
+                         std::int64_t generation) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = blocks_.find(BlockKey(object_name, block_index));
+        if (it != blocks_.end() && generation != 0) {
+            auto stored = generations_.find(object_name);
+            if (stored == generations_.end() || stored->second != generation) {
+                it = blocks_.end();
+            }
+        }
+        if (it == blocks_.end()) {
+            stats_.misses++;
+            return -1;
+        }
+        stats_.hits++;
+        lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+        block_length = it->second.size;
+    }
+
+    // A block evicted since the lookup reads as a miss. Once open, the
+    // descriptor stays readable even if the block is evicted.
+    return ::open(blockPath(object_name, block_index).c_str(), O_RDONLY | O_CLOEXEC);
+}
+
+ssize_t DiskCache::read(const std::string& object_name, std::uint64_t block_index,
+                        char* buf, size_t size, size_t block_offset, size_t& block_length,
+                        std::int64_t generation) {
+    int fd = openBlock(object_name, block_index, block_length, generation);
+    if (fd < 0) {
+        return -1;
+    }
+    if (block_offset >= block_length) {
+        ::close(fd);
+        return 0;
+    }
+    size = std::min(size, block_length - block_offset);
+
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = ::pread(fd, buf + total, size - total, static_cast<off_t>(block_offset + total));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        total += static_cast<size_t>(n);
+    }
+    ::close(fd);
+
+    return total == size ? static_cast<ssize_t>(total) : -1;
+}
+
+void DiskCache::put(const std::string& object_name, std::uint64_t block_index,
+                    const char* data, size_t size, std::int64_t generation) {
+    if (!usable_ || size == 0 || size > max_bytes_) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!claimObjectDir(object_name, generation)) {
+            return;
+        }
+    }
+
+    // Write outside the lock, then rename into place
+    static std::atomic<std::uint64_t> temp_counter{0};
+    const std::string final_path = blockPath(object_name, block_index);
+    const std::string temp_path = objectDir(object_name) + "/" + kTempPrefix +
+        std::to_string(block_index) + "-" + std::to_string(temp_counter++);
+    if (!writeFile(temp_path, data, size)) {
+        ::unlink(temp_path.c_str());
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto stored = generations_.find(object_name);
+    if ((stored == generations_.end() ? 0 : stored->second) != generation) {
+        // Another generation took over the directory while this block was written
+        ::unlink(temp_path.c_str());
+        return;
+    }
+    BlockKey key(object_name, block_index);
+    auto it = blocks_.find(key);
+    if (it != blocks_.end()) {
+        // The rename below replaces the old file
+        total_bytes_ -= it->second.size;
+        lru_.erase(it->second.lru_pos);
+        blocks_.erase(it);
+    }
+
+    evictFor(size);
+    if (::rename(temp_path.c_str(), final_path.c_str()) != 0) {
+        ::unlink(temp_path.c_str());
+        return;
+    }
+
+    lru_.push_front(key);
+    blocks_[key] = Entry{size, lru_.begin()};
+    total_bytes_ += size;
+    stats_.insertions++;
+}
+
+void DiskCache::invalidate(const std::string& object_name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    eraseObjectLocked(object_name);
+    generations_.erase(object_name);
+
+    const std::string dir = objectDir(object_name);
+    auto owner = dir_owner_.find(fs::path(dir).filename().string());
+    if (owner != dir_owner_.end() && owner->second == object_name) {
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+        dir_owner_.erase(owner);
+    }
+}
+
+void DiskCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::error_code ec;
+    for (const auto& owner : dir_owner_) {
+        fs::remove_all(cache_dir_ + "/" + owner.first, ec);
+    }
+    dir_owner_.clear();
+    generations_.clear();
+    blocks_.clear();
+    lru_.clear();
+    total_bytes_ = 0;
+}
+
+size_t DiskCache::sizeBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return total_bytes_;
+}
+
+size_t DiskCache::blockCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return blocks_.size();
+}
+
+DiskCache::Stats DiskCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool DiskCache::claimObjectDir(const std::string& object_name, std::int64_t generation) {
+    const std::string dir = objectDir(object_name);
+    const std::string key = fs::path(dir).filename().string();
+    const std::string generation_path = dir + "/" + kGenerationFile;
+
+    auto owner = dir_owner_.find(key);
+    if (owner != dir_owner_.end()) {
+        if (owner->second == object_name) {
+            auto stored = generations_.find(object_name);
+            const std::int64_t stored_generation = stored == generations_.end() ? 0 : stored->second;
+            if (stored_generation == generation) {
+                return true;
+            }
+            if (generation != 0 && generation < stored_generation) {
+                return false;  // a reader still on a replaced version
+            }
+            // The object was replaced: its old blocks go
+            eraseObjectLocked(object_name);
+            const std::string value = std::to_string(generation);
+            if (!writeFile(generation_path, value.data(), value.size())) {
+                generations_.erase(object_name);
+                ::unlink(generation_path.c_str());
+                return false;
+            }
+            generations_[object_name] = generation;
+            return true;
+        }
+        // Hash collision: the previous owner loses its blocks
+        eraseObjectLocked(owner->second);
+        generations_.erase(owner->second);
+        std::error_code ec;
+        fs::remove_all(dir, ec);
+        dir_owner_.erase(owner);
+    }
+
+    std::error_code ec;
+    fs::create_directories(dir, ec);
+    if (ec || !writeFile(dir + "/" + kNameFile, object_name.data(), object_name.size())) {
+        return false;
+    }
+    if (generation != 0) {
+        const std::string value = std::to_string(generation);
+        if (!writeFile(generation_path, value.data(), value.size())) {
+            return false;
+        }
+        generations_[object_name] = generation;
+    }
+    dir_owner_[key] = object_name;
+    return true;
+}
+
+void DiskCache::eraseObjectLocked(const std::string& object_name) {
+    auto it = blocks_.lower_bound(BlockKey(object_name, 0));
+    while (it != blocks_.end() && it->first.first == object_name) {
+        auto next = std::next(it);
+        eraseLocked(it);
+        it = next;
+    }
+}
+
+void DiskCache::evictFor(size_t extra_bytes) {
+    while (total_bytes_ + extra_bytes > max_bytes_ && !lru_.empty()) {
+        auto it = blocks_.find(lru_.back());
+        if (it == blocks_.end()) {
+            lru_.pop_back();
+            continue;
+        }
+        eraseLocked(it);
+        stats_.evictions++;
+    }
+}
+
+void DiskCache::eraseLocked(std::map<BlockKey, Entry>::iterator it) {
+    ::unlink(blockPath(it->first.first, it->first.second).c_str());
+    total_bytes_ -= it->second.size;
+    lru_.erase(it->second.lru_pos);
+    blocks_.erase(it);
+}
+
+} // namespace gcscfuse
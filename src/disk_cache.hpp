@@ -0,0 +1,139 @@
+#pragma once
+
+#include <string>
+#include <map>
+#include <list>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+#include <sys/types.h>
+
+namespace gcscfuse {
+
+/**
+ * DiskCache - Block-granular content cache on local disk
+ *
+ * Blocks are stored one file per block under cache_dir:
+ *   <cache_dir>/<hash of object name>/<block_index>
+ * with a ".name" file in each object directory recording the object name,
+ * so the index can be rebuilt when the daemon restarts. Blocks are written
+ * to a temporary file and renamed into place, so a crash never leaves a
+ * torn block behind.
+ *
+ * The blocks of an object all come from one GCS generation, recorded in a
+ * ".generation" file beside ".name". Storing a block of a newer generation
+ * drops the older blocks first, and lookups for a generation other than
+ * the stored one miss; generation 0 means unknown and matches any.
+ *
+ * Total size is bounded by a byte budget with LRU eviction. Reads go
+ * straight from the block file into the caller's buffer with pread.
+ *
+ * Thread-safe: the index is guarded by a mutex that is not held across
+ * file reads; a block evicted mid-read simply reads as a miss.
+ */
+class DiskCache {
+public:
+    static constexpr size_t kDefaultBlockSize = 1024 * 1024;            // 1 MiB
+    static constexpr size_t kDefaultMaxBytes = 10ULL * 1024 * 1024 * 1024; // 10 GiB
+
+    struct Stats {
+        std::uint64_t hits = 0;
+        std::uint64_t misses = 0;
+        std::uint64_t insertions = 0;
+        std::uint64_t evictions = 0;
+        std::uint64_t recovered = 0;  // blocks found on disk at startup
+    };
+
+    // Creates cache_dir if needed and indexes any blocks already in it
+    DiskCache(const std::string& cache_dir,
+              size_t block_size = kDefaultBlockSize,
+              size_t max_bytes = kDefaultMaxBytes);
+    ~DiskCache() = default;
+
+    // False if cache_dir could not be created; the cache then stores nothing
+    bool usable() const { return usable_; }
+
+    size_t blockSize() const { return block_size_; }
+    size_t maxBytes() const { return max_bytes_; }
+
+    /**
+     * Copy up to size bytes starting at block_offset of a cached block into buf
+     * @param block_length Set to the full length of the cached block on a hit
+     * @return Bytes copied, or -1 on miss
+     */
+    ssize_t read(const std::string& object_name, std::uint64_t block_index,
+                 char* buf, size_t size, size_t block_offset, size_t& block_length,
+                 std::int64_t generation = 0);
+
+    /**
+     * Open a cached block file read-only, e.g. to splice it to the kernel
+     * @param block_length Set to the full length of the block on a hit
+     * @return A descriptor the caller must close, or -1 on miss
+     */
+    int openBlock(const std::string& object_name, std::uint64_t block_index, size_t& block_length,
+                  std::int64_t generation = 0);
+
+    // Store (or replace) a block read from the generation. Blocks larger
+    // than the budget, or of a generation older than the stored one, are
+    // not stored.
+    void put(const std::string& object_name, std::uint64_t block_index,
+             const char* data, size_t size, std::int64_t generation = 0);
+
+    // Drop all blocks of an object
+    void invalidate(const std::string& object_name);
+
+    // Drop all blocks
+    void clear();
+
+    // Bytes currently held by cached blocks
+    size_t sizeBytes() const;
+
+    // Number of cached blocks
+    size_t blockCount() const;
+
+    Stats stats() const;
+
+private:
+    using BlockKey = std::pair<std::string, std::uint64_t>;
+
+    struct Entry {
+        size_t size;
+        std::list<BlockKey>::iterator lru_pos;
+    };
+
+    std::string cache_dir_;
+    size_t block_size_;
+    size_t max_bytes_;
+    bool usable_ = false;
+
+    mutable std::mutex mutex_;
+    std::map<BlockKey, Entry> blocks_;       // ordered so an object's blocks are contiguous
+    std::list<BlockKey> lru_;                // most recently used at the front
+    std::map<std::string, std::string> dir_owner_;  // object dir -> object name
+    std::map<std::string, std::int64_t> generations_;  // object name -> generation of its blocks, if not 0
+    size_t total_bytes_ = 0;
+    Stats stats_;
+
+    std::string objectDir(const std::string& object_name) const;
+    std::string blockPath(const std::string& object_name, std::uint64_t block_index) const;
+
+    // Rebuild the index from files left by a previous run
+    void recover();
+
+    // Claim the object's directory for blocks of the generation, wiping it
+    // if another object owned it and dropping blocks of another generation;
+    // false if it cannot be used (caller holds mutex_)
+    bool claimObjectDir(const std::string& object_name, std::int64_t generation);
+
+    // Remove every block of an object (caller holds mutex_)
+    void eraseObjectLocked(const std::string& object_name);
+
+    // Remove blocks until total_bytes_ + extra_bytes fits the budget (caller holds mutex_)
+    void evictFor(size_t extra_bytes);
+
+    // Remove one block file and its index entry (caller holds mutex_)
+    void eraseLocked(std::map<BlockKey, Entry>::iterator it);
+};
+
+} // namespace gcscfuse
@@ -0,0 +1,225 @@
+#include <gtest/gtest.h>
+#include "disk_cache.hpp"
+#include <filesystem>
+#include <cstdlib>
+#include <vector>
+#include <unistd.h>
+
+using namespace gcscfuse;
+
+// Test fixture for DiskCache tests
+class DiskCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        char dir_template[] = "/tmp/gcscfuse-disk-cache-test-XXXXXX";
+        ASSERT_NE(mkdtemp(dir_template), nullptr);
+        dir = dir_template;
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+    }
+
+    std::string readBlock(DiskCache& cache, const std::string& object, std::uint64_t index,
+                          size_t size = 64, size_t offset = 0, std::int64_t generation = 0) {
+        std::vector<char> buf(size);
+        size_t block_length = 0;
+        ssize_t n = cache.read(object, index, buf.data(), size, offset, block_length, generation);
+        if (n < 0) {
+            return "<miss>";
+        }
+        return std::string(buf.data(), static_cast<size_t>(n));
+    }
+
+    std::string dir;
+};
+
+TEST_F(DiskCacheTest, MissOnEmptyCache) {
+    DiskCache cache(dir, 16, 1024);
+    ASSERT_TRUE(cache.usable());
+
+    EXPECT_EQ(readBlock(cache, "a.txt", 0), "<miss>");
+    EXPECT_EQ(cache.stats().misses, 1u);
+}
+
+TEST_F(DiskCacheTest, PutThenRead) {
+    DiskCache cache(dir, 16, 1024);
+    cache.put("a.txt", 0, "hello world", 11);
+
+    EXPECT_EQ(readBlock(cache, "a.txt", 0), "hello world");
+    EXPECT_EQ(readBlock(cache, "a.txt", 0, 5, 6), "world");
+    EXPECT_EQ(cache.sizeBytes(), 11u);
+    EXPECT_EQ(cache.blockCount(), 1u);
+    EXPECT_EQ(cache.stats().hits, 2u);
+}
+
+TEST_F(DiskCacheTest, ReadReportsBlockLength) {
+    DiskCache cache(dir, 16, 1024);
+    cache.put("a.txt", 0, "abcdef", 6);
+
+    char buf[2];
+    size_t block_length = 0;
+    EXPECT_EQ(cache.read("a.txt", 0, buf, sizeof(buf), 0, block_length), 2);
+    EXPECT_EQ(block_length, 6u);
+    EXPECT_EQ(cache.read("a.txt", 0, buf, sizeof(buf), 6, block_length), 0);
+}
+
+TEST_F(DiskCacheTest, OpenBlockSurvivesEviction) {
+    DiskCache cache(dir, 10, 10);
+    cache.put("a", 0, "0123456789", 10);
+
+    size_t block_length = 0;
+    int fd = cache.openBlock("a", 0, block_length);
+    ASSERT_GE(fd, 0);
+    EXPECT_EQ(block_length, 10u);
+
+    cache.put("b", 0, "abcdefghij", 10);  // evicts "a"
+    char buf[10];
+    EXPECT_EQ(pread(fd, buf, sizeof(buf), 0), 10);
+    EXPECT_EQ(std::string(buf, 10), "0123456789");
+    close(fd);
+
+    EXPECT_EQ(cache.openBlock("a", 0, block_length), -1);
+}
+
+TEST_F(DiskCacheTest, EvictsLeastRecentlyUsed) {
+    DiskCache cache(dir, 10, 30);
+    cache.put("a", 0, "0123456789", 10);
+    cache.put("b", 0, "0123456789", 10);
+    cache.put("c", 0, "0123456789", 10);
+
+    // Touch "a" so "b" is now the oldest
+    EXPECT_NE(readBlock(cache, "a", 0), "<miss>");
+    cache.put("d", 0, "0123456789", 10);
+
+    EXPECT_EQ(readBlock(cache, "b", 0), "<miss>");
+    EXPECT_NE(readBlock(cache, "a", 0), "<miss>");
+    EXPECT_NE(readBlock(cache, "d", 0), "<miss>");
+    EXPECT_EQ(cache.sizeBytes(), 30u);
+    EXPECT_EQ(cache.stats().evictions, 1u);
+}
+
+TEST_F(DiskCacheTest, PutReplacesExistingBlock) {
+    DiskCache cache(dir, 16, 1024);
+    cache.put("a.txt", 0, "old content", 11);
+    cache.put("a.txt", 0, "new", 3);
+
+    EXPECT_EQ(readBlock(cache, "a.txt", 0), "new");
+    EXPECT_EQ(cache.sizeBytes(), 3u);
+}
+
+TEST_F(DiskCacheTest, NewGenerationDropsOldBlocks) {
+    DiskCache cache(dir, 16, 1024);
+    cache.put("a.txt", 0, "first", 5, 1);
+    cache.put("a.txt", 1, "first", 5, 1);
+
+    EXPECT_EQ(readBlock(cache, "a.txt", 0, 64, 0, 1), "first");
+    EXPECT_EQ(readBlock(cache, "a.txt", 0, 64, 0, 2), "<miss>");
+
+    cache.put("a.txt", 0, "second", 6, 2);
+    EXPECT_EQ(readBlock(cache, "a.txt", 0, 64, 0, 2), "second");
+    EXPECT_EQ(readBlock(cache, "a.txt", 1, 64, 0, 2), "<miss>");
+    EXPECT_EQ(readBlock(cache, "a.txt", 0, 64, 0, 1), "<miss>");
+    EXPECT_EQ(cache.blockCount(), 1u);
+
+    // A reader still on the old generation does not bring it back
+    cache.put("a.txt", 1, "first", 5, 1);
+    EXPECT_EQ(cache.blockCount(), 1u);
+}
+
+TEST_F(DiskCacheTest, RecoversGeneration) {
+    {
+        DiskCache cache(dir, 16, 1024);
+        cache.put("a.txt", 0, "versioned", 9, 7);
+    }
+
+    DiskCache restarted(dir, 16, 1024);
+    EXPECT_EQ(readBlock(restarted, "a.txt", 0, 64, 0, 7), "versioned");
+    EXPECT_EQ(readBlock(restarted, "a.txt", 0, 64, 0, 8), "<miss>");
+}
+
+TEST_F(DiskCacheTest, InvalidateDropsOnlyThatObject) {
+    DiskCache cache(dir, 16, 1024);
+    cache.put("a.txt", 0, "aaaa", 4);
+    cache.put("a.txt", 1, "aaaa", 4);
+    cache.put("b.txt", 0, "bbbb", 4);
+
+    cache.invalidate("a.txt");
+
+    EXPECT_EQ(readBlock(cache, "a.txt", 0), "<miss>");
+    EXPECT_EQ(readBlock(cache, "a.txt", 1), "<miss>");
+    EXPECT_EQ(readBlock(cache, "b.txt", 0), "bbbb");
+    EXPECT_EQ(cache.sizeBytes(), 4u);
+}
+
+TEST_F(DiskCacheTest, ClearDropsEverything) {
+    DiskCache cache(dir, 16, 1024);
+    cache.put("a.txt", 0, "aaaa", 4);
+    cache.put("b.txt", 0, "bbbb", 4);
+
+    cache.clear();
+
+    EXPECT_EQ(cache.blockCount(), 0u);
+    EXPECT_EQ(cache.sizeBytes(), 0u);
+    EXPECT_EQ(readBlock(cache, "a.txt", 0), "<miss>");
+}
+
+TEST_F(DiskCacheTest, RecoversBlocksAfterRestart) {
+    {
+        DiskCache cache(dir, 16, 1024);
+        cache.put("dir/a.txt", 0, "persisted", 9);
+        cache.put("dir/a.txt", 3, "later", 5);
+    }
+
+    DiskCache restarted(dir, 16, 1024);
+    EXPECT_EQ(restarted.stats().recovered, 2u);
+    EXPECT_EQ(restarted.sizeBytes(), 14u);
+    EXPECT_EQ(readBlock(restarted, "dir/a.txt", 0), "persisted");
+    EXPECT_EQ(readBlock(restarted, "dir/a.txt", 3), "later");
+}
+
+TEST_F(DiskCacheTest, RecoveryEnforcesSmallerBudget) {
+    {
+        DiskCache cache(dir, 10, 100);
+        cache.put("a", 0, "0123456789", 10);
+        cache.put("b", 0, "0123456789", 10);
+        cache.put("c", 0, "0123456789", 10);
+    }
+
+    DiskCache restarted(dir, 10, 20);
+    EXPECT_LE(restarted.sizeBytes(), 20u);
+    EXPECT_EQ(restarted.blockCount(), 2u);
+}
+
+TEST_F(DiskCacheTest, RecoveryRemovesStrayFiles) {
+    std::filesystem::create_directories(dir + "/not-a-cache-dir");
+    {
+        DiskCache cache(dir, 16, 1024);
+        cache.put("a.txt", 0, "aaaa", 4);
+    }
+
+    DiskCache restarted(dir, 16, 1024);
+    EXPECT_FALSE(std::filesystem::exists(dir + "/not-a-cache-dir"));
+    EXPECT_EQ(readBlock(restarted, "a.txt", 0), "aaaa");
+}
+
+TEST_F(DiskCacheTest, SkipsBlocksLargerThanBudget) {
+    DiskCache cache(dir, 16, 4);
+    cache.put("a.txt", 0, "too large", 9);
+
+    EXPECT_EQ(cache.blockCount(), 0u);
+    EXPECT_EQ(readBlock(cache, "a.txt", 0), "<miss>");
+}
+
+TEST(DiskCacheCreateTest, UnusableDirectoryStoresNothing) {
+    DiskCache cache("/proc/gcscfuse-disk-cache", 16, 1024);
+    EXPECT_FALSE(cache.usable());
+
+    cache.put("a.txt", 0, "aaaa", 4);
+    EXPECT_EQ(cache.blockCount(), 0u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,196 @@
+#include "async_gcs_client.hpp"
+#include <algorithm>
+
+namespace gcscfuse {
+
+RequestScheduler::RequestScheduler(size_t max_concurrency, size_t max_bulk)
+    : max_concurrency_(std::max<size_t>(max_concurrency, 1)),
+      max_bulk_(std::clamp<size_t>(max_bulk, 1, std::max<size_t>(max_concurrency, 1))) {}
+
+RequestScheduler::~RequestScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+        metadata_queue_.clear();
+        bulk_queue_.clear();
+    }
+    cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void RequestScheduler::enqueue(RequestPriority priority, std::function<void()> task) {
+    std::call_once(start_once_, [this] {
+        workers_.reserve(max_concurrency_);
+        for (size_t i = 0; i < max_concurrency_; ++i) {
+            workers_.emplace_back(&RequestScheduler::workerLoop, this);
+        }
+    });
+
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (priority == RequestPriority::Metadata) {
+            metadata_queue_.push_back(std::move(task));
+            stats_.metadata_requests++;
+        } else {
+            bulk_queue_.push_back(std::move(task));
+            stats_.bulk_requests++;
+        }
+    }
+    cv_.notify_one();
+}
+
+size_t RequestScheduler::queued() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return metadata_queue_.size() + bulk_queue_.size();
+}
+
+RequestScheduler::Stats RequestScheduler::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void RequestScheduler::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cv_.wait(lock, [this] {
+            return stopping_ || !metadata_queue_.empty() ||
+                   (!bulk_queue_.empty() && bulk_running_ < max_bulk_);
+        });
+        if (stopping_) {
+            return;
+        }
+
+        const bool bulk = metadata_queue_.empty();
+        std::deque<std::function<void()>>& queue = bulk ? bulk_queue_ : metadata_queue_;
+        std::function<void()> task = std::move(queue.front());
+        queue.pop_front();
+        if (bulk) {
+            bulk_running_++;
+        }
+        lock.unlock();
+
+        // packaged_task stores any exception in the future
+        task();
+
+        lock.lock();
+        if (bulk) {
+            bulk_running_--;
+            // A bulk slot opened up; a worker may have been waiting for one
+            cv_.notify_one();
+        }
+    }
+}
+
+bool AsyncGCSClient::Gate::enter() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (closed_) {
+        return false;
+    }
+    running_++;
+    return true;
+}
+
+void AsyncGCSClient::Gate::leave() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--running_ == 0) {
+        cv_.notify_all();
+    }
+}
+
+void AsyncGCSClient::Gate::close() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    closed_ = true;
+    cv_.wait(lock, [this] { return running_ == 0; });
+}
+
+AsyncGCSClient::AsyncGCSClient(const GCSClient& client, size_t max_concurrency, size_t max_bulk)
+    : AsyncGCSClient(client, std::make_shared<RequestScheduler>(max_concurrency, max_bulk)) {}
+
+AsyncGCSClient::AsyncGCSClient(const GCSClient& client, std::shared_ptr<RequestScheduler> scheduler)
+    : client_(client),
+      scheduler_(std::move(scheduler)),
+      gate_(std::make_shared<Gate>()) {}
+
+AsyncGCSClient::~AsyncGCSClient() {
+    gate_->close();
+}
+
+std::future<std::optional<ObjectMetadata>> AsyncGCSClient::getObjectMetadata(
+    const std::string& bucket_name,
+    const std::string& object_name) const
+{
+    return submit(RequestPriority::Metadata, [this, bucket_name, object_name] {
+        return client_.getObjectMetadata(bucket_name, object_name);
+    });
+}
+
+std::future<bool> AsyncGCSClient::directoryExists(
+    const std::string& bucket_name,
+    const std::string& dir_prefix) const
+{
+    return submit(RequestPriority::Metadata, [this, bucket_name, dir_prefix] {
+        return client_.directoryExists(bucket_name, dir_prefix);
+    });
+}
+
+std::future<GCSClient::DirectoryLookup> AsyncGCSClient::lookupDirectory(
+    const std::string& bucket_name,
+    const std::string& dir_prefix) const
+{
+    return submit(RequestPriority::Metadata, [this, bucket_name, dir_prefix] {
+        return client_.lookupDirectory(bucket_name, dir_prefix);
+    });
+}
+
+std::future<std::vector<ObjectMetadata>> AsyncGCSClient::listObjects(
+    const std::string& bucket_name,
+    const std::string& prefix,
+    const std::string& delimiter,
+    int max_results) const
+{
+    return submit(RequestPriority::Metadata, [this, bucket_name, prefix, delimiter, max_results] {
+        return client_.listObjects(bucket_name, prefix, delimiter, max_results);
+    });
+}
+
+std::future<bool> AsyncGCSClient::deleteObject(
+    const std::string& bucket_name,
+    const std::string& object_name) const
+{
+    return submit(RequestPriority::Metadata, [this, bucket_name, object_name] {
+        return client_.deleteObject(bucket_name, object_name);
+    });
+}
+
+std::future<std::string> AsyncGCSClient::readObject(
+    const IGCSSDKClient::ReadObjectRequest& request) const
+{
+    return submit(RequestPriority::Bulk, [this, request] {
+        return client_.readObject(request);
+    });
+}
+
+std::future<ssize_t> AsyncGCSClient::readObject(
+    const IGCSSDKClient::ReadObjectRequest& request,
+    char* buf,
+    size_t size) const
+{
+    return submit(RequestPriority::Bulk, [this, request, buf, size] {
+        return client_.readObject(request, buf, size);
+    });
+}
+
+std::future<bool> AsyncGCSClient::writeObject(
+    const std::string& bucket_name,
+    const std::string& object_name,
+    std::string content) const
+{
+    return submit(RequestPriority::Bulk,
+                             [this, bucket_name, object_name, content = std::move(content)] {
+        return client_.writeObject(bucket_name, object_name, content);
+    });
+}
+
+} // namespace gcscfuse
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <optional>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <type_traits>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+#include "gcs_client.hpp"
+
+namespace gcscfuse {
+
+// Scheduling class of a GCS request. Metadata requests (stat, list,
+// delete) are small and usually block a caller; bulk requests move content.
+enum class RequestPriority {
+    Metadata,
+    Bulk,
+};
+
+/**
+ * RequestScheduler - Bounded pool of threads running GCS requests
+ *
+ * At most max_concurrency requests run at once, of which at most max_bulk
+ * are bulk transfers, so a burst of reads or uploads never takes every
+ * slot. Queued metadata requests always start before queued bulk ones.
+ *
+ * Worker threads start with the first submitted request, so a scheduler
+ * created before FUSE daemonizes still runs in the daemon. Requests still
+ * queued when the scheduler is destroyed are dropped (their futures report
+ * std::future_error); running ones finish first.
+ *
+ * Thread-safe.
+ */
+class RequestScheduler {
+public:
+    struct Stats {
+        std::uint64_t metadata_requests = 0;
+        std::uint64_t bulk_requests = 0;
+    };
+
+    RequestScheduler(size_t max_concurrency, size_t max_bulk);
+    ~RequestScheduler();
+
+    RequestScheduler(const RequestScheduler&) = delete;
+    RequestScheduler& operator=(const RequestScheduler&) = delete;
+
+    // Queue fn and return a future for its result
+    template <typename Fn>
+    auto submit(RequestPriority priority, Fn&& fn) -> std::future<std::invoke_result_t<Fn>> {
+        using Result = std::invoke_result_t<Fn>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        enqueue(priority, [task] { (*task)(); });
+        return future;
+    }
+
+    size_t maxConcurrency() const { return max_concurrency_; }
+    size_t maxBulk() const { return max_bulk_; }
+
+    // Requests waiting for a free slot
+    size_t queued() const;
+
+    Stats stats() const;
+
+private:
+    size_t max_concurrency_;
+    size_t max_bulk_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::function<void()>> metadata_queue_;
+    std::deque<std::function<void()>> bulk_queue_;
+    size_t bulk_running_ = 0;
+    bool stopping_ = false;
+    Stats stats_;
+
+    std::once_flag start_once_;
+    std::vector<std::thread> workers_;
+
+    void enqueue(RequestPriority priority, std::function<void()> task);
+    void workerLoop();
+};
+
+/**
+ * AsyncGCSClient - Asynchronous front end to GCSClient
+ *
+ * Each call is queued on a RequestScheduler and returns a future, so a
+ * caller can have several GCS round trips outstanding without a thread of
+ * its own per request. Requests run through the wrapped GCSClient, so it
+ * is mocked the same way: inject an IGCSSDKClient into that GCSClient.
+ *
+ * Several clients may share one scheduler, and with it one bound on the
+ * requests in flight. Destroying a client waits for its running requests
+ * and drops its queued ones (their futures report std::future_error), as
+ * destroying a scheduler of its own would.
+ *
+ * Buffers and requests passed by pointer or reference must stay valid
+ * until the returned future is ready.
+ */
+class AsyncGCSClient {
+public:
+    AsyncGCSClient(const GCSClient& client, size_t max_concurrency, size_t max_bulk);
+    // Run requests on a scheduler shared with other clients
+    AsyncGCSClient(const GCSClient& client, std::shared_ptr<RequestScheduler> scheduler);
+    ~AsyncGCSClient();
+
+    AsyncGCSClient(const AsyncGCSClient&) = delete;
+    AsyncGCSClient& operator=(const AsyncGCSClient&) = delete;
+
+    // Metadata requests
+    std::future<std::optional<ObjectMetadata>> getObjectMetadata(
+        const std::string& bucket_name,
+        const std::string& object_name) const;
+
+    std::future<bool> directoryExists(
+        const std::string& bucket_name,
+        const std::string& dir_prefix) const;
+
+    std::future<GCSClient::DirectoryLookup> lookupDirectory(
+        const std::string& bucket_name,
+        const std::string& dir_prefix) const;
+
+    std::future<std::vector<ObjectMetadata>> listObjects(
+        const std::string& bucket_name,
+        const std::string& prefix,
+        const std::string& delimiter = "",
+        int max_results = 0) const;
+
+    std::future<bool> deleteObject(
+        const std::string& bucket_name,
+        const std::string& object_name) const;
+
+    // Bulk requests
+    std::future<std::string> readObject(
+        const IGCSSDKClient::ReadObjectRequest& request) const;
+
+    std::future<ssize_t> readObject(
+        const IGCSSDKClient::ReadObjectRequest& request,
+        char* buf,
+        size_t size) const;
+
+    std::future<bool> writeObject(
+        const std::string& bucket_name,
+        const std::string& object_name,
+        std::string content) const;
+
+    // Run fn on the pool, for work made of several GCSClient calls. fn runs
+    // on a worker, so it calls GCSClient directly instead of waiting on
+    // other requests of this client.
+    template <typename Fn>
+    auto submit(RequestPriority priority, Fn&& fn) const {
+        using Result = std::invoke_result_t<Fn>;
+        return scheduler_->submit(priority, [gate = gate_, fn = std::forward<Fn>(fn)]() mutable -> Result {
+            if (!gate->enter()) {
+                throw std::future_error(std::future_errc::broken_promise);
+            }
+            Gate::Leave leave{*gate};
+            return fn();
+        });
+    }
+    
+    const RequestScheduler& scheduler() const { return *scheduler_; }
+
+private:
+    // Requests of this client running on the scheduler. Closed by the
+    // destructor, after which queued requests do not start.
+    class Gate {
+    public:
+        struct Leave {
+            Gate& gate;
+            ~Leave() { gate.leave(); }
+        };
+
+        // Count a request as running; false once closed
+        bool enter();
+        void leave();
+        // Refuse further requests and wait for the running ones
+        void close();
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        size_t running_ = 0;
+        bool closed_ = false;
+    };
+
+    const GCSClient& client_;
+    std::shared_ptr<RequestScheduler> scheduler_;
+    std::shared_ptr<Gate> gate_;
+};
+
+} // namespace gcscfuse
@@ -0,0 +1,192 @@
+#include "async_gcs_client.hpp"
+#include "mock_gcs_sdk_client.hpp"
+#include "google/cloud/mocks/mock_stream_range.h"
+#include <gtest/gtest.h>
+#include <gmock/gmock.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gcs = ::google::cloud::storage;
+using gcscfuse::RequestPriority;
+using gcscfuse::RequestScheduler;
+
+namespace {
+// Spin until pred holds or a generous deadline passes
+template <typename Pred>
+void waitFor(Pred pred) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!pred() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+}
+
+TEST(RequestSchedulerTest, RunsSubmittedRequests) {
+    RequestScheduler scheduler(2, 1);
+    auto a = scheduler.submit(RequestPriority::Metadata, [] { return 1; });
+    auto b = scheduler.submit(RequestPriority::Bulk, [] { return std::string("bulk"); });
+
+    EXPECT_EQ(a.get(), 1);
+    EXPECT_EQ(b.get(), "bulk");
+    EXPECT_EQ(scheduler.stats().metadata_requests, 1u);
+    EXPECT_EQ(scheduler.stats().bulk_requests, 1u);
+}
+
+TEST(RequestSchedulerTest, ExceptionsReachTheFuture) {
+    RequestScheduler scheduler(1, 1);
+    auto failed = scheduler.submit(RequestPriority::Metadata, []() -> int { throw std::runtime_error("boom"); });
+    EXPECT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(RequestSchedulerTest, BulkRequestsLeaveRoomForMetadata) {
+    RequestScheduler scheduler(3, 1);
+    std::atomic<bool> release{false};
+    std::atomic<int> bulk_running{0};
+    std::atomic<int> max_bulk_running{0};
+
+    std::vector<std::future<void>> bulk;
+    for (int i = 0; i < 4; i++) {
+        bulk.push_back(scheduler.submit(RequestPriority::Bulk, [&] {
+            int now = ++bulk_running;
+            max_bulk_running = std::max(max_bulk_running.load(), now);
+            waitFor([&] { return release.load(); });
+            --bulk_running;
+        }));
+    }
+    waitFor([&] { return bulk_running.load() == 1; });
+
+    // Bulk work is capped at one slot, so metadata still runs right away
+    auto metadata = scheduler.submit(RequestPriority::Metadata, [] { return 7; });
+    ASSERT_EQ(metadata.wait_for(std::chrono::seconds(5)), std::future_status::ready);
+    EXPECT_EQ(metadata.get(), 7);
+
+    release = true;
+    for (auto& f : bulk) {
+        f.get();
+    }
+    EXPECT_EQ(max_bulk_running.load(), 1);
+}
+
+TEST(RequestSchedulerTest, MetadataJumpsTheQueue) {
+    RequestScheduler scheduler(1, 1);
+    std::atomic<bool> release{false};
+    std::mutex order_mutex;
+    std::vector<std::string> order;
+    auto record = [&](const std::string& name) {
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(name);
+    };
+
+    // Occupy the only worker, then queue bulk before metadata
+    auto blocker = scheduler.submit(RequestPriority::Metadata, [&] { waitFor([&] { return release.load(); }); });
+    waitFor([&] { return scheduler.queued() == 0; });
+    auto bulk = scheduler.submit(RequestPriority::Bulk, [&] { record("bulk"); });
+    auto metadata = scheduler.submit(RequestPriority::Metadata, [&] { record("metadata"); });
+
+    release = true;
+    blocker.get();
+    bulk.get();
+    metadata.get();
+    EXPECT_EQ(order, (std::vector<std::string>{"metadata", "bulk"}));
+}
+
+TEST(AsyncGCSClientTest, GetObjectMetadataGoesThroughInjectedClient) {
+    auto mock = std::make_unique<MockGCSSDKClient>();
+    EXPECT_CALL(*mock, GetObjectMetadata(::testing::_))
+        .WillOnce(::testing::Invoke([](const gcscfuse::IGCSSDKClient::GetObjectMetadataRequest& req) {
+            EXPECT_EQ(req.object_name, "async.txt");
+            return gcs::ObjectMetadata{}.set_name("async.txt").set_size(5);
+        }));
+
+    gcscfuse::GCSClient client(std::move(mock));
+    gcscfuse::AsyncGCSClient async_client(client, 4, 2);
+
+    auto result = async_client.getObjectMetadata("test-bucket", "async.txt").get();
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->size, 5);
+    EXPECT_EQ(async_client.scheduler().stats().metadata_requests, 1u);
+}
+
+TEST(AsyncGCSClientTest, LookupDirectoryReportsFailure) {
+    auto mock = std::make_unique<MockGCSSDKClient>();
+    EXPECT_CALL(*mock, ListObjectsAndPrefixes(::testing::_))
+        .WillOnce(::testing::Return(::testing::ByMove(google::cloud::mocks::MakeStreamRange<gcs::ObjectOrPrefix>(
+            {}, google::cloud::Status(google::cloud::StatusCode::kUnavailable, "503")))));
+
+    gcscfuse::GCSClient client(std::move(mock));
+    gcscfuse::AsyncGCSClient async_client(client, 4, 2);
+
+    auto result = async_client.lookupDirectory("test-bucket", "dir/").get();
+    EXPECT_FALSE(result.exists);
+    EXPECT_TRUE(result.failed);
+    EXPECT_EQ(async_client.scheduler().stats().metadata_requests, 1u);
+}
+
+TEST(AsyncGCSClientTest, ReadObjectIsBulk) {
+    auto mock = std::make_unique<MockGCSSDKClient>();
+    EXPECT_CALL(*mock, ReadObject(::testing::_))
+        .WillOnce(::testing::Return(::testing::ByMove(gcs::ObjectReadStream())));
+
+    gcscfuse::GCSClient client(std::move(mock));
+    gcscfuse::AsyncGCSClient async_client(client, 4, 2);
+
+    gcscfuse::IGCSSDKClient::ReadObjectRequest req;
+    req.bucket_name = "test-bucket";
+    req.object_name = "missing.bin";
+    char buf[16];
+    EXPECT_EQ(async_client.readObject(req, buf, sizeof(buf)).get(), -1);
+    EXPECT_EQ(async_client.scheduler().stats().bulk_requests, 1u);
+}
+
+TEST(AsyncGCSClientTest, ClientsShareOneScheduler) {
+    gcscfuse::GCSClient client(std::make_unique<MockGCSSDKClient>());
+    auto scheduler = std::make_shared<RequestScheduler>(1, 1);
+    gcscfuse::AsyncGCSClient first(client, scheduler);
+    gcscfuse::AsyncGCSClient second(client, scheduler);
+    std::atomic<bool> release{false};
+
+    // One slot across both clients: the second one's request waits for it
+    auto blocker = first.submit(RequestPriority::Metadata, [&] { waitFor([&] { return release.load(); }); });
+    waitFor([&] { return scheduler->queued() == 0; });
+    auto queued = second.submit(RequestPriority::Metadata, [] { return 2; });
+    EXPECT_EQ(scheduler->queued(), 1u);
+
+    release = true;
+    blocker.get();
+    EXPECT_EQ(queued.get(), 2);
+    EXPECT_EQ(first.scheduler().stats().metadata_requests, 2u);
+}
+
+TEST(AsyncGCSClientTest, DestroyedClientDropsItsQueuedRequests) {
+    gcscfuse::GCSClient client(std::make_unique<MockGCSSDKClient>());
+    auto scheduler = std::make_shared<RequestScheduler>(1, 1);
+    gcscfuse::AsyncGCSClient remaining(client, scheduler);
+    std::atomic<bool> release{false};
+
+    auto blocker = remaining.submit(RequestPriority::Metadata, [&] { waitFor([&] { return release.load(); }); });
+    waitFor([&] { return scheduler->queued() == 0; });
+    std::atomic<bool> ran{false};
+    std::future<void> dropped;
+    {
+        gcscfuse::AsyncGCSClient destroyed(client, scheduler);
+        dropped = destroyed.submit(RequestPriority::Metadata, [&] { ran = true; });
+    }
+
+    // The scheduler outlives the client, but its request must not run
+    release = true;
+    blocker.get();
+    EXPECT_THROW(dropped.get(), std::future_error);
+    EXPECT_FALSE(ran.load());
+    EXPECT_EQ(remaining.submit(RequestPriority::Metadata, [] { return 3; }).get(), 3);
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,356 @@
+#pragma once
+
+#include "gcs_sdk_interface.hpp"
+#include "google/cloud/mocks/mock_stream_range.h"
+#include "google/cloud/storage/internal/http_response.h"
+#include "google/cloud/storage/internal/object_read_source.h"
+#include "google/cloud/storage/internal/object_read_streambuf.h"
+#include "google/cloud/storage/internal/object_requests.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace gcscfuse {
+
+/**
+ * FakeGCSSDKClient - In-process bucket behind the raw SDK interface
+ *
+ * Serves objects added with addObject() after an injectable per-request
+ * latency and at an injectable read bandwidth, so benchmarks drive
+ * GCSClient and everything above it without a network. Listings honour
+ * prefix and delimiter like GCS and come back as a single page.
+ *
+ * Reads go through the SDK's own ObjectReadStreambuf fed by an in-memory
+ * read source. Uploads are not simulated: WriteObject returns a stream
+ * that is not open. Bucket names are ignored.
+ *
+ * Reads of an object can be made to break part way with failReads(), as
+ * a dropped connection or a 503 does, and metadata GETs and listings to
+ * fail outright with failMetadata() and failListings().
+ *
+ * Every addObject() stores a new generation, so tests can replace an
+ * object under a reader. Reads pinned to a replaced generation fail as
+ * not found, and generation preconditions behave as in GCS.
+ *
+ * Thread-safe.
+ */
+class FakeGCSSDKClient : public IGCSSDKClient {
+public:
+    struct Profile {
+        std::chrono::microseconds latency{0};       // before every response
+        std::uint64_t bandwidth_bytes_per_sec = 0;   // for object data, 0 = unlimited
+    };
+
+    struct Stats {
+        std::uint64_t metadata_requests = 0;
+        std::uint64_t list_requests = 0;
+        std::uint64_t read_requests = 0;
+        std::uint64_t bytes_read = 0;
+    };
+
+    FakeGCSSDKClient() = default;
+    explicit FakeGCSSDKClient(Profile profile) : profile_(profile) {}
+
+    // Called before requests are issued
+    void setProfile(Profile profile) { profile_ = profile; }
+
+    void addObject(const std::string& name, std::string content) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        objects_[name] = Stored{std::make_shared<const std::string>(std::move(content)), ++last_generation_};
+    }
+
+    // Object of size bytes filled with a repeating pattern
+    void addObject(const std::string& name, size_t size) {
+        std::string content(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            content[i] = static_cast<char>('a' + i % 26);
+        }
+        addObject(name, std::move(content));
+    }
+
+    // Reads of name fail with kUnavailable once they have streamed
+    // after_bytes (0 fails them before the first byte); restoreReads ends it
+    void failReads(const std::string& name, std::size_t after_bytes) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        read_failures_[name] = after_bytes;
+    }
+
+    void restoreReads(const std::string& name) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        read_failures_.erase(name);
+    }
+
+    // Metadata GETs of name, or listings of exactly prefix, fail with
+    // kUnavailable until restoreRequests
+    void failMetadata(const std::string& name) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        failed_metadata_.insert(name);
+    }
+
+    void failListings(const std::string& prefix) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        failed_listings_.insert(prefix);
+    }
+
+    void restoreRequests() {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        failed_metadata_.clear();
+        failed_listings_.clear();
+    }
+
+    Stats stats() const {
+        Stats result;
+        result.metadata_requests = metadata_requests_.load(std::memory_order_relaxed);
+        result.list_requests = list_requests_.load(std::memory_order_relaxed);
+        result.read_requests = read_requests_.load(std::memory_order_relaxed);
+        result.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    gcs::ObjectReadStream ReadObject(const ReadObjectRequest& request) const override {
+        read_requests_.fetch_add(1, std::memory_order_relaxed);
+        waitForResponse();
+        gcs::internal::ReadObjectRangeRequest sdk_request(request.bucket_name, request.object_name);
+        Stored stored = find(request.object_name);
+        Content content = stored.content;
+        if (content && request.generation && *request.generation != stored.generation) {
+            content = nullptr;
+        }
+        if (!content) {
+            gcs::ObjectReadStream stream(std::make_unique<gcs::internal::ObjectReadStreambuf>(
+                sdk_request, Status(google::cloud::StatusCode::kNotFound, "no such object: " + request.object_name)));
+            stream.setstate(std::ios::badbit | std::ios::eofbit);
+            return stream;
+        }
+        std::size_t begin = 0;
+        std::size_t end = content->size();
+        if (request.range) {
+            begin = static_cast<std::size_t>(std::max<std::int64_t>(request.range->first, 0));
+            end = std::min(end, static_cast<std::size_t>(std::max<std::int64_t>(request.range->second, 0)));
+            begin = std::min(begin, end);
+        } else if (request.read_from_offset) {
+            begin = std::min(end, static_cast<std::size_t>(std::max<std::int64_t>(*request.read_from_offset, 0)));
+        }
+        auto source = std::make_unique<ReadSource>(std::move(content), begin, end,
+                                                   failureOffset(request.object_name, begin),
+                                                   profile_.bandwidth_bytes_per_sec, bytes_read_);
+        return gcs::ObjectReadStream(std::make_unique<gcs::internal::ObjectReadStreambuf>(
+            sdk_request, std::move(source), static_cast<std::streamoff>(begin)));
+    }
+
+    StatusOr<gcs::ObjectMetadata> GetObjectMetadata(const GetObjectMetadataRequest& request) const override {
+        metadata_requests_.fetch_add(1, std::memory_order_relaxed);
+        waitForResponse();
+        if (isFailing(failed_metadata_, request.object_name)) {
+            return Status(google::cloud::StatusCode::kUnavailable, "injected metadata failure");
+        }
+        Stored stored = find(request.object_name);
+        if (!stored.content) {
+            return Status(google::cloud::StatusCode::kNotFound, "no such object: " + request.object_name);
+        }
+        if (request.if_generation_not_match == stored.generation) {
+            return Status(google::cloud::StatusCode::kFailedPrecondition, "not modified");
+        }
+        return metadataOf(request.object_name, stored);
+    }
+
+    gcs::ObjectWriteStream WriteObject(const WriteObjectRequest&) const override {
+        return gcs::ObjectWriteStream();
+    }
+
+    Status DeleteObject(const DeleteObjectRequest& request) const override {
+        waitForResponse();
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (objects_.erase(request.object_name) == 0) {
+            return Status(google::cloud::StatusCode::kNotFound, "no such object: " + request.object_name);
+        }
+        return Status();
+    }
+
+    gcs::ListObjectsReader ListObjects(const ListObjectsRequest& request) const override {
+        std::vector<gcs::ObjectMetadata> objects;
+        list(request,
+             [&objects](gcs::ObjectMetadata object) { objects.push_back(std::move(object)); },
+             [](std::string) {});
+        return google::cloud::mocks::MakeStreamRange<gcs::ObjectMetadata>(std::move(objects),
+                                                                          listingStatus(request));
+    }
+
+    gcs::ListObjectsAndPrefixesReader ListObjectsAndPrefixes(const ListObjectsRequest& request) const override {
+        std::vector<gcs::ObjectOrPrefix> entries;
+        list(request,
+             [&entries](gcs::ObjectMetadata object) { entries.emplace_back(std::move(object)); },
+             [&entries](std::string prefix) { entries.emplace_back(std::move(prefix)); });
+        return google::cloud::mocks::MakeStreamRange<gcs::ObjectOrPrefix>(std::move(entries),
+                                                                          listingStatus(request));
+    }
+
+    StatusOr<gcs::ObjectMetadata> ComposeObject(const ComposeObjectRequest& request) const override {
+        waitForResponse();
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        if (request.if_generation_match) {
+            auto it = objects_.find(request.destination_object);
+            if (it == objects_.end() || it->second.generation != *request.if_generation_match) {
+                return Status(google::cloud::StatusCode::kFailedPrecondition, "generation does not match");
+            }
+        }
+        std::string composed;
+        for (const auto& source : request.source_objects) {
+            auto it = objects_.find(source);
+            if (it == objects_.end()) {
+                return Status(google::cloud::StatusCode::kNotFound, "no such object: " + source);
+            }
+            composed += *it->second.content;
+        }
+        Stored& stored = objects_[request.destination_object];
+        stored = Stored{std::make_shared<const std::string>(std::move(composed)), ++last_generation_};
+        return metadataOf(request.destination_object, stored);
+    }
+
+private:
+    using Content = std::shared_ptr<const std::string>;
+    
+    struct Stored {
+        Content content;
+        std::int64_t generation = 0;
+    };
+
+    // Streams [pos, end) of an object, sleeping to hold the bandwidth
+    class ReadSource : public gcs::internal::ObjectReadSource {
+    public:
+        ReadSource(Content content, std::size_t begin, std::size_t end, std::size_t fail_at,
+                   std::uint64_t bandwidth, std::atomic<std::uint64_t>& bytes_read)
+            : content_(std::move(content)), pos_(begin), end_(end), fail_at_(fail_at),
+              bandwidth_(bandwidth), bytes_read_(bytes_read) {}
+
+        bool IsOpen() const override { return open_; }
+
+        StatusOr<gcs::internal::HttpResponse> Close() override {
+            open_ = false;
+            return gcs::internal::HttpResponse{200, {}, {}};
+        }
+
+        StatusOr<gcs::internal::ReadSourceResult> Read(char* buf, std::size_t n) override {
+            if (pos_ >= fail_at_) {
+                open_ = false;
+                return Status(google::cloud::StatusCode::kUnavailable, "injected read failure");
+            }
+            const std::size_t count = std::min({n, end_ - pos_, fail_at_ - pos_});
+            std::memcpy(buf, content_->data() + pos_, count);
+            pos_ += count;
+            if (pos_ == end_) {
+                open_ = false;
+            }
+            if (bandwidth_ > 0 && count > 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(count * 1000000 / bandwidth_));
+            }
+            bytes_read_.fetch_add(count, std::memory_order_relaxed);
+            return gcs::internal::ReadSourceResult{count, gcs::internal::HttpResponse{200, {}, {}}};
+        }
+
+    private:
+        Content content_;
+        std::size_t pos_;
+        std::size_t end_;
+        std::size_t fail_at_;  // offset reads break at
+        std::uint64_t bandwidth_;
+        std::atomic<std::uint64_t>& bytes_read_;
+        bool open_ = true;
+    };
+
+    Profile profile_;
+    mutable std::shared_mutex mutex_;
+    mutable std::map<std::string, Stored> objects_;
+    std::map<std::string, std::size_t> read_failures_;  // object -> bytes per read before failing
+    std::set<std::string> failed_metadata_;
+    std::set<std::string> failed_listings_;
+    mutable std::int64_t last_generation_ = 0;
+    mutable std::atomic<std::uint64_t> metadata_requests_{0};
+    mutable std::atomic<std::uint64_t> list_requests_{0};
+    mutable std::atomic<std::uint64_t> read_requests_{0};
+    mutable std::atomic<std::uint64_t> bytes_read_{0};
+
+    void waitForResponse() const {
+        if (profile_.latency.count() > 0) {
+            std::this_thread::sleep_for(profile_.latency);
+        }
+    }
+
+    bool isFailing(const std::set<std::string>& names, const std::string& name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        return names.count(name) > 0;
+    }
+
+    // A failing listing returns nothing but its error
+    Status listingStatus(const ListObjectsRequest& request) const {
+        return isFailing(failed_listings_, request.prefix)
+            ? Status(google::cloud::StatusCode::kUnavailable, "injected listing failure") : Status();
+    }
+
+    // Where a read of name starting at begin breaks, or npos if it does not
+    std::size_t failureOffset(const std::string& name, std::size_t begin) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = read_failures_.find(name);
+        return it == read_failures_.end() ? std::string::npos : begin + it->second;
+    }
+
+    Stored find(const std::string& name) const {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        auto it = objects_.find(name);
+        return it == objects_.end() ? Stored{} : it->second;
+    }
+
+    static gcs::ObjectMetadata metadataOf(const std::string& name, const Stored& stored) {
+        return gcs::ObjectMetadata()
+            .set_name(name)
+            .set_size(stored.content->size())
+            .set_generation(stored.generation)
+            .set_metageneration(1);
+    }
+
+    // Objects under the prefix, with names past the delimiter rolled up into prefixes
+    template <typename OnObject, typename OnPrefix>
+    void list(const ListObjectsRequest& request, OnObject on_object, OnPrefix on_prefix) const {
+        list_requests_.fetch_add(1, std::memory_order_relaxed);
+        waitForResponse();
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        if (failed_listings_.count(request.prefix) > 0) {
+            return;
+        }
+        std::string last_prefix;
+        size_t entries = 0;
+        for (auto it = objects_.lower_bound(request.prefix);
+             it != objects_.end() && it->first.compare(0, request.prefix.size(), request.prefix) == 0;
+             ++it) {
+            if (request.max_results > 0 && entries >= static_cast<size_t>(request.max_results)) {
+                break;
+            }
+            if (!request.delimiter.empty()) {
+                auto pos = it->first.find(request.delimiter, request.prefix.size());
+                if (pos != std::string::npos) {
+                    // Names sharing a rolled-up prefix are adjacent in the sorted map
+                    std::string prefix = it->first.substr(0, pos + request.delimiter.size());
+                    if (prefix != last_prefix) {
+                        last_prefix = prefix;
+                        on_prefix(std::move(prefix));
+                        ++entries;
+                    }
+                    continue;
+                }
+            }
+            on_object(metadataOf(it->first, it->second));
+            ++entries;
+        }
+    }
+};
+
+} // namespace gcscfuse
@@ -1,8 +1,136 @@
 #include "gcs_client.hpp"
+#include "metrics.hpp"
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <type_traits>
 
 namespace gcscfuse {
 
+namespace {
+    // GCS reports CRC32C as the base64 of its four big-endian bytes; 0 if
+    // missing or malformed
+    std::uint32_t decodeCrc32c(const std::string& encoded) {
+        static constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        std::uint64_t bits = 0;
+        int count = 0;
+        for (char c : encoded) {
+            if (c == '=') {
+                break;
+            }
+            const char* digit = c != '\0' ? std::strchr(kAlphabet, c) : nullptr;
+            if (!digit || count > 56) {
+                return 0;
+            }
+            bits = (bits << 6) | static_cast<std::uint64_t>(digit - kAlphabet);
+            count += 6;
+        }
+        return count >= 32 ? static_cast<std::uint32_t>(bits >> (count - 32)) : 0;
+    }
+    
+    // A read that starts past the end of the object, or of an object (or
+    // pinned generation) that is gone, has nothing to read: that is EOF.
+    // Any other failure is an error, however many bytes arrived before it.
+    bool isEndOfObject(const google::cloud::Status& status) {
+        return status.code() == google::cloud::StatusCode::kOutOfRange ||
+               status.code() == google::cloud::StatusCode::kNotFound;
+    }
+    
+    ObjectMetadata toObjectMetadata(const gcs::ObjectMetadata& metadata) {
+        ObjectMetadata obj_meta;
+        obj_meta.name = metadata.name();
+        obj_meta.size = static_cast<std::int64_t>(metadata.size());
+        obj_meta.updated = metadata.updated();
+        obj_meta.is_directory = false;
+        obj_meta.generation = metadata.generation();
+        obj_meta.metageneration = metadata.metageneration();
+        obj_meta.crc32c = decodeCrc32c(metadata.crc32c());
+        return obj_meta;
+    }
+}
+
+ObjectUploadStream::ObjectUploadStream(gcs::ObjectWriteStream stream)
+    : stream_(std::move(stream)) {}
+
+ObjectUploadStream::~ObjectUploadStream() {
+    // Never finalize implicitly; a stream that was not closed is abandoned
+    abort();
+}
+
+bool ObjectUploadStream::write(const char* data, size_t size) {
+    if (finished_ || stream_.bad()) {
+        return false;
+    }
+    stream_.write(data, static_cast<std::streamsize>(size));
+    if (stream_.bad()) {
+        std::cerr << "Error streaming upload: " << stream_.last_status().message() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        return false;
+    }
+    bytes_written_ += size;
+    Metrics::global().add(MetricCounter::GCSBytesWritten, size);
+    return true;
+}
+
+std::optional<ObjectMetadata> ObjectUploadStream::close() {
+    if (finished_) {
+        return std::nullopt;
+    }
+    finished_ = true;
+    
+    auto timer = Metrics::global().time(GCSRpc::FinalizeUpload);
+    stream_.Close();
+    if (!stream_.metadata()) {
+        std::cerr << "Error finalizing upload: " << stream_.metadata().status().message() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        precondition_failed_ = stream_.metadata().status().code() == google::cloud::StatusCode::kFailedPrecondition;
+        return std::nullopt;
+    }
+    return toObjectMetadata(*stream_.metadata());
+}
+
+void ObjectUploadStream::abort() {
+    if (!finished_) {
+        finished_ = true;
+        std::move(stream_).Suspend();
+    }
+}
+
+ObjectDownloadStream::ObjectDownloadStream(gcs::ObjectReadStream stream, std::int64_t offset,
+                                           std::int64_t generation)
+    : stream_(std::move(stream)), offset_(offset), generation_(generation) {}
+
+ssize_t ObjectDownloadStream::read(char* buf, size_t size) {
+    if (done_) {
+        return 0;
+    }
+    size_t total = 0;
+    while (total < size && stream_) {
+        stream_.read(buf + total, static_cast<std::streamsize>(size - total));
+        total += static_cast<size_t>(stream_.gcount());
+    }
+    if (total < size) {
+        done_ = true;
+    }
+    if (stream_.bad()) {
+        done_ = true;
+        if (total == 0 && isEndOfObject(stream_.status())) {
+            return 0;
+        }
+        // Bytes before a broken stream do not end the object
+        std::cerr << "Error reading object: " << stream_.status().message() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        return -1;
+    }
+    offset_ += static_cast<std::int64_t>(total);
+    Metrics::global().add(MetricCounter::GCSBytesRead, total);
+    return static_cast<ssize_t>(total);
+}
+
 GCSClient::GCSClient() : sdk_client_(std::make_unique<GCSSDKClientImpl>()) {}
 
 GCSClient::GCSClient(const gcs::Client& client) 
@@ -15,62 +143,348 @@ std::optional<ObjectMetadata> GCSClient::getObjectMetadata(
     const std::string& bucket_name,
     const std::string& object_name) const 
 {
+    return lookupObject(bucket_name, object_name).metadata;
+}
+
+GCSClient::ObjectLookup GCSClient::lookupObject(
+    const std::string& bucket_name,
+    const std::string& object_name) const 
+{
+    // Concurrent lookups of one object share a single GET
+    return metadata_flights_.run({bucket_name, object_name}, [&] {
+        ObjectLookup lookup;
+        try {
+            IGCSSDKClient::GetObjectMetadataRequest req;
+            req.bucket_name = bucket_name;
+            req.object_name = object_name;
+            
+            auto timer = Metrics::global().time(GCSRpc::GetObjectMetadata);
+            auto metadata = sdk_client_->GetObjectMetadata(req);
+            if (metadata) {
+                lookup.metadata = toObjectMetadata(*metadata);
+            } else if (metadata.status().code() != google::cloud::StatusCode::kNotFound) {
+                // 5xx, 429, 403, timeouts: the object may well exist
+                std::cerr << "Error getting metadata for " << object_name << ": "
+                          << metadata.status().message() << std::endl;
+                Metrics::global().add(MetricCounter::GCSErrors);
+                lookup.failed = true;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error getting metadata for " << object_name << ": " << e.what() << std::endl;
+            Metrics::global().add(MetricCounter::GCSErrors);
+            lookup.failed = true;
+        }
+        return lookup;
+    });
+}
+
+GCSClient::ObjectCheck GCSClient::checkObject(
+    const std::string& bucket_name,
+    const std::string& object_name,
+    std::int64_t generation) const 
+{
+    ObjectCheck check;
     try {
         IGCSSDKClient::GetObjectMetadataRequest req;
         req.bucket_name = bucket_name;
         req.object_name = object_name;
+        req.if_generation_not_match = generation;
         
+        auto timer = Metrics::global().time(GCSRpc::GetObjectMetadata);
         auto metadata = sdk_client_->GetObjectMetadata(req);
-        if (!metadata) {
-            return std::nullopt;
+        if (metadata) {
+            check.metadata = toObjectMetadata(*metadata);
+        } else if (metadata.status().code() == google::cloud::StatusCode::kFailedPrecondition) {
+            // 304 Not Modified
+            check.unchanged = true;
         }
-        
-        ObjectMetadata obj_meta;
-        obj_meta.name = metadata->name();
-        obj_meta.size = metadata->size();
-        obj_meta.updated = metadata->updated();
-        obj_meta.is_directory = false;
-        
-        return obj_meta;
     } catch (const std::exception& e) {
-        std::cerr << "Error getting metadata for " << object_name << ": " << e.what() << std::endl;
-        return std::nullopt;
+        std::cerr << "Error checking " << object_name << ": " << e.what() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
     }
+    return check;
 }
 
 std::string GCSClient::readObject(const IGCSSDKClient::ReadObjectRequest& request) const {
+    auto timer = Metrics::global().time(GCSRpc::ReadObject);
     auto reader = sdk_client_->ReadObject(request);
     if (!reader) {
         std::cerr << "Error reading object: " << reader.status().message() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
         return "";
     }
     std::string content{std::istreambuf_iterator<char>{reader}, {}};
+    Metrics::global().add(MetricCounter::GCSBytesRead, content.size());
     return content;
 }
 
+ssize_t GCSClient::readObject(const IGCSSDKClient::ReadObjectRequest& request,
+                              char* buf, size_t size) const {
+    auto timer = Metrics::global().time(GCSRpc::ReadObject);
+    auto reader = sdk_client_->ReadObject(request);
+    if (!reader && isEndOfObject(reader.status())) {
+        return 0;
+    }
+    size_t total = 0;
+    while (total < size && reader) {
+        reader.read(buf + total, static_cast<std::streamsize>(size - total));
+        total += static_cast<size_t>(reader.gcount());
+    }
+    if (reader.bad()) {
+        // Bytes before a broken stream do not end the range
+        std::cerr << "Error reading object: " << reader.status().message() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        return -1;
+    }
+    Metrics::global().add(MetricCounter::GCSBytesRead, total);
+    return static_cast<ssize_t>(total);
+}
+
+std::unique_ptr<ObjectDownloadStream> GCSClient::openDownloadStream(
+    const std::string& bucket_name,
+    const std::string& object_name,
+    std::int64_t offset,
+    std::int64_t generation) const
+{
+    IGCSSDKClient::ReadObjectRequest req;
+    req.bucket_name = bucket_name;
+    req.object_name = object_name;
+    req.read_from_offset = offset;
+    if (generation != 0) {
+        req.generation = generation;
+    }
+    
+    auto timer = Metrics::global().time(GCSRpc::ReadObject);
+    auto reader = sdk_client_->ReadObject(req);
+    // Nothing past the end: the stream reads as EOF
+    if (!reader && !isEndOfObject(reader.status())) {
+        std::cerr << "Error reading object: " << reader.status().message() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        return nullptr;
+    }
+    return std::make_unique<ObjectDownloadStream>(std::move(reader), offset, generation);
+}
+
 bool GCSClient::writeObject(
     const std::string& bucket_name,
     const std::string& object_name,
     const std::string& content) const 
+{
+    return writeObjectData(bucket_name, object_name, content.data(), content.size()).has_value();
+}
+
+std::optional<ObjectMetadata> GCSClient::writeObjectData(
+    const std::string& bucket_name,
+    const std::string& object_name,
+    const char* data,
+    size_t size) const 
 {
     try {
         IGCSSDKClient::WriteObjectRequest req;
         req.bucket_name = bucket_name;
         req.object_name = object_name;
         
+        auto timer = Metrics::global().time(GCSRpc::WriteObject);
         auto writer = sdk_client_->WriteObject(req);
-        writer << content;
+        writer.write(data, static_cast<std::streamsize>(size));
         writer.Close();
         
         if (!writer.metadata()) {
             std::cerr << "Error writing object: " << writer.metadata().status().message() << std::endl;
-            return false;
+            Metrics::global().add(MetricCounter::GCSErrors);
+            return std::nullopt;
         }
         
-        return true;
+        Metrics::global().add(MetricCounter::GCSBytesWritten, size);
+        return toObjectMetadata(*writer.metadata());
     } catch (const std::exception& e) {
         std::cerr << "Error writing object " << object_name << ": " << e.what() << std::endl;
-        return false;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        return std::nullopt;
+    }
+}
+
+std::unique_ptr<ObjectUploadStream> GCSClient::openUploadStream(
+    const std::string& bucket_name,
+    const std::string& object_name,
+    std::int64_t if_generation_match) const 
+{
+    try {
+        IGCSSDKClient::WriteObjectRequest req;
+        req.bucket_name = bucket_name;
+        req.object_name = object_name;
+        if (if_generation_match != 0) {
+            req.if_generation_match = if_generation_match;
+        }
+        
+        return std::make_unique<ObjectUploadStream>(sdk_client_->WriteObject(req));
+    } catch (const std::exception& e) {
+        std::cerr << "Error opening upload of " << object_name << ": " << e.what() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        return nullptr;
+    }
+}
+
+std::optional<ObjectMetadata> GCSClient::writeObjectComposite(
+    const std::string& bucket_name,
+    const std::string& object_name,
+    std::string_view content,
+    size_t part_size,
+    size_t max_concurrency) const 
+{
+    if (part_size == 0 || content.size() <= part_size) {
+        return writeObjectData(bucket_name, object_name, content.data(), content.size());
+    }
+    
+    const std::string temp_prefix = tempPrefix(object_name);
+    
+    const size_t part_count = (content.size() + part_size - 1) / part_size;
+    std::vector<std::string> parts(part_count);
+    for (size_t i = 0; i < part_count; ++i) {
+        parts[i] = temp_prefix + std::to_string(i);
+    }
+    
+    // Workers pull the next part index until all parts are sent or one fails
+    std::vector<char> uploaded(part_count, 0);
+    std::atomic<size_t> next_part{0};
+    std::atomic<bool> failed{false};
+    auto upload_parts = [&]() {
+        while (!failed) {
+            const size_t i = next_part++;
+            if (i >= part_count) {
+                return;
+            }
+            const size_t offset = i * part_size;
+            const size_t size = std::min(part_size, content.size() - offset);
+            if (writeObjectData(bucket_name, parts[i], content.data() + offset, size)) {
+                uploaded[i] = 1;
+            } else {
+                failed = true;
+            }
+        }
+    };
+    
+    const size_t worker_count = std::clamp<size_t>(max_concurrency, 1, part_count);
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < worker_count; ++i) {
+        workers.emplace_back(upload_parts);
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    std::vector<std::string> temporaries;
+    for (size_t i = 0; i < part_count; ++i) {
+        if (uploaded[i]) {
+            temporaries.push_back(parts[i]);
+        }
+    }
+    
+    std::optional<ObjectMetadata> composed;
+    if (!failed) {
+        composed = composeAll(bucket_name, std::move(parts), object_name, temp_prefix, temporaries);
+    } else {
+        std::cerr << "Error uploading parts of " << object_name << ", abandoning composite upload" << std::endl;
+    }
+    
+    for (const auto& temporary : temporaries) {
+        deleteObject(bucket_name, temporary);
+    }
+    
+    return composed;
+}
+
+std::optional<ObjectMetadata> GCSClient::appendObject(
+    const std::string& bucket_name,
+    const std::string& object_name,
+    const std::function<bool(ObjectUploadStream&)>& fill,
+    std::int64_t generation) const 
+{
+    // Without a generation the tail could land on an object replaced since
+    if (generation == 0) {
+        std::cerr << "Refusing to append to " << object_name << " of unknown generation" << std::endl;
+        return std::nullopt;
+    }
+    const std::string tail = tempPrefix(object_name) + "tail";
+    auto stream = openUploadStream(bucket_name, tail);
+    if (!stream) {
+        return std::nullopt;
+    }
+    if (!fill(*stream)) {
+        std::cerr << "Error writing appended data of " << object_name << ", abandoning append" << std::endl;
+        stream->abort();
+        return std::nullopt;
+    }
+    if (!stream->close()) {
+        std::cerr << "Error uploading appended data of " << object_name << std::endl;
+        return std::nullopt;
+    }
+    
+    auto composed = composeObject(bucket_name, {object_name, tail}, object_name, generation);
+    deleteObject(bucket_name, tail);
+    return composed;
+}
+
+std::string GCSClient::tempPrefix(const std::string& object_name)
+{
+    // Unique per upload so concurrent uploads of one object do not collide
+    std::ostringstream token;
+    token << std::hex << std::random_device{}() << std::random_device{}();
+    return std::string(kCompositePartPrefix) + object_name + "." + token.str() + ".";
+}
+
+std::optional<ObjectMetadata> GCSClient::composeAll(
+    const std::string& bucket_name,
+    std::vector<std::string> sources,
+    const std::string& destination_object,
+    const std::string& temp_prefix,
+    std::vector<std::string>& temporaries) const 
+{
+    for (int level = 0; sources.size() > kMaxComposeSources; ++level) {
+        std::vector<std::string> next;
+        for (size_t i = 0; i < sources.size(); i += kMaxComposeSources) {
+            const size_t end = std::min(i + kMaxComposeSources, sources.size());
+            std::vector<std::string> group(sources.begin() + i, sources.begin() + end);
+            std::string intermediate = temp_prefix + "c" + std::to_string(level) + "-" + std::to_string(next.size());
+            if (!composeObject(bucket_name, group, intermediate)) {
+                return std::nullopt;
+            }
+            temporaries.push_back(intermediate);
+            next.push_back(std::move(intermediate));
+        }
+        sources = std::move(next);
+    }
+    
+    return composeObject(bucket_name, sources, destination_object);
+}
+
+std::optional<ObjectMetadata> GCSClient::composeObject(
+    const std::string& bucket_name,
+    const std::vector<std::string>& source_objects,
+    const std::string& destination_object,
+    std::int64_t if_generation_match) const 
+{
+    try {
+        IGCSSDKClient::ComposeObjectRequest req;
+        req.bucket_name = bucket_name;
+        req.source_objects = source_objects;
+        req.destination_object = destination_object;
+        if (if_generation_match != 0) {
+            req.if_generation_match = if_generation_match;
+        }
+        
+        auto timer = Metrics::global().time(GCSRpc::ComposeObject);
+        auto metadata = sdk_client_->ComposeObject(req);
+        if (!metadata) {
+            std::cerr << "Error composing object " << destination_object << ": " << metadata.status().message() << std::endl;
+            Metrics::global().add(MetricCounter::GCSErrors);
+            return std::nullopt;
+        }
+        return toObjectMetadata(*metadata);
+    } catch (const std::exception& e) {
+        std::cerr << "Error composing object " << destination_object << ": " << e.what() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        return std::nullopt;
     }
 }
 
@@ -82,50 +496,98 @@ bool GCSClient::deleteObject(
     req.bucket_name = bucket_name;
     req.object_name = object_name;
     
+    auto timer = Metrics::global().time(GCSRpc::DeleteObject);
     auto status = sdk_client_->DeleteObject(req);
     if (!status.ok()) {
         std::cerr << "Error deleting object: " << status.message() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
         return false;
     }
     return true;
 }
 
-std::vector<ObjectMetadata> GCSClient::listObjects(
-    const std::string& bucket_name,
-    const std::string& prefix,
-    const std::string& delimiter,
-    int max_results) const 
-{
-    std::vector<ObjectMetadata> results;
+ObjectLister::ObjectLister(gcs::ListObjectsAndPrefixesReader reader)
+    : reader_(std::move(reader)) {}
+
+std::optional<ObjectMetadata> ObjectLister::next() {
+    if (done_) {
+        return std::nullopt;
+    }
     
     try {
-        IGCSSDKClient::ListObjectsRequest req;
-        req.bucket_name = bucket_name;
-        req.prefix = prefix;
-        req.delimiter = delimiter;
-        req.max_results = max_results;
+        // begin() fetches the first page, so defer it to the first call
+        if (!it_) {
+            auto timer = Metrics::global().time(GCSRpc::ListObjects);
+            it_.emplace(reader_.begin());
+        } else {
+            ++*it_;
+        }
+        if (*it_ == reader_.end()) {
+            done_ = true;
+            return std::nullopt;
+        }
         
-        auto objects = sdk_client_->ListObjects(req);
+        auto& item = **it_;
+        if (!item) {
+            std::cerr << "Error listing objects: " << item.status().message() << std::endl;
+            Metrics::global().add(MetricCounter::GCSErrors);
+            done_ = failed_ = true;
+            return std::nullopt;
+        }
         
-        for (auto&& object_metadata : objects) {
-            if (!object_metadata) {
-                std::cerr << "Error listing objects: " << object_metadata.status().message() << std::endl;
-                break;
+        // Unqualified so the SDK's variant type (std or absl) finds its visit
+        ObjectMetadata obj_meta{};
+        visit([&obj_meta](const auto& entry) {
+            using Entry = std::decay_t<decltype(entry)>;
+            if constexpr (std::is_same_v<Entry, gcs::ObjectMetadata>) {
+                obj_meta = toObjectMetadata(entry);
+            } else {
+                obj_meta.name = entry;  // prefix
+                obj_meta.size = 0;
+                obj_meta.is_directory = true;
             }
-            
-            ObjectMetadata obj_meta;
-            obj_meta.name = object_metadata->name();
-            obj_meta.size = object_metadata->size();
-            obj_meta.updated = object_metadata->updated();
-            obj_meta.is_directory = false;
-            
-            results.push_back(obj_meta);
-        }
+        }, *item);
+        return obj_meta;
     } catch (const std::exception& e) {
         std::cerr << "Error listing objects: " << e.what() << std::endl;
+        Metrics::global().add(MetricCounter::GCSErrors);
+        done_ = failed_ = true;
+        return std::nullopt;
     }
+}
+
+std::unique_ptr<ObjectLister> GCSClient::openListing(
+    const std::string& bucket_name,
+    const std::string& prefix,
+    const std::string& delimiter,
+    int page_size) const 
+{
+    IGCSSDKClient::ListObjectsRequest req;
+    req.bucket_name = bucket_name;
+    req.prefix = prefix;
+    req.delimiter = delimiter;
+    req.max_results = page_size;
     
-    return results;
+    return std::make_unique<ObjectLister>(sdk_client_->ListObjectsAndPrefixes(req));
+}
+
+std::vector<ObjectMetadata> GCSClient::listObjects(
+    const std::string& bucket_name,
+    const std::string& prefix,
+    const std::string& delimiter,
+    int max_results) const 
+{
+    // Concurrent identical listings share one
+    return list_flights_.run({bucket_name, prefix, delimiter, max_results}, [&] {
+        std::vector<ObjectMetadata> results;
+        
+        auto lister = openListing(bucket_name, prefix, delimiter, max_results);
+        while (auto object = lister->next()) {
+            results.push_back(std::move(*object));
+        }
+        
+        return results;
+    });
 }
 
 bool GCSClient::objectExists(
@@ -140,21 +602,22 @@ bool GCSClient::directoryExists(
     const std::string& bucket_name,
     const std::string& dir_prefix) const 
 {
-    IGCSSDKClient::ListObjectsRequest req;
-    req.bucket_name = bucket_name;
-    req.prefix = dir_prefix;
-    req.delimiter = "";
-    req.max_results = 1;
-    
-    auto objects = sdk_client_->ListObjects(req);
-    
-    try {
-        auto it = objects.begin();
-        return it != objects.end();
-    } catch (const std::exception& e) {
-        std::cerr << "Error checking directory: " << e.what() << std::endl;
-        return false;
-    }
+    return lookupDirectory(bucket_name, dir_prefix).exists;
+}
+
+GCSClient::DirectoryLookup GCSClient::lookupDirectory(
+    const std::string& bucket_name,
+    const std::string& dir_prefix) const 
+{
+    // With the delimiter, the first result is a direct child or the prefix
+    // of a subdirectory, so one single-entry page answers the question
+    return directory_flights_.run({bucket_name, dir_prefix}, [&] {
+        DirectoryLookup lookup;
+        auto lister = openListing(bucket_name, dir_prefix, "/", 1);
+        lookup.exists = lister->next().has_value();
+        lookup.failed = !lookup.exists && lister->failed();
+        return lookup;
+    });
 }
 
 } // namespace gcscfuse
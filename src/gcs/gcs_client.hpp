@@ -1,11 +1,16 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <functional>
 #include <vector>
 #include <optional>
 #include <memory>
+#include <tuple>
+#include <sys/types.h>
 #include "google/cloud/storage/client.h"
 #include "gcs_sdk_interface.hpp"
+#include "single_flight.hpp"
 
 namespace gcs = ::google::cloud::storage;
 
@@ -13,12 +18,119 @@ namespace gcscfuse {
 
 /**
  * ObjectMetadata - Simplified metadata structure for GCS objects
+ *
+ * Listings with a delimiter also return the prefixes the delimiter rolled
+ * up; those come back with is_directory set and name ending in the delimiter.
+ *
+ * generation changes whenever the object's content is replaced and
+ * metageneration whenever only its metadata is; together with the CRC32C
+ * of the content they identify one version of the object. All are 0 for
+ * prefixes and when GCS did not report them.
  */
 struct ObjectMetadata {
     std::string name;
     std::int64_t size;
     std::chrono::system_clock::time_point updated;
     bool is_directory;
+    std::int64_t generation = 0;
+    std::int64_t metageneration = 0;
+    std::uint32_t crc32c = 0;
+};
+
+/**
+ * ObjectUploadStream - Incremental upload of one object
+ *
+ * Wraps a resumable SDK write stream. The SDK only keeps its upload buffer
+ * in memory, so arbitrarily large objects can be written in sequence.
+ * The object becomes visible once close() succeeds.
+ */
+class ObjectUploadStream {
+public:
+    explicit ObjectUploadStream(gcs::ObjectWriteStream stream);
+    ~ObjectUploadStream();
+    
+    // Append data; false once the stream has failed
+    bool write(const char* data, size_t size);
+    
+    // Finalize the object; returns its metadata, nullopt if the upload failed
+    std::optional<ObjectMetadata> close();
+    
+    // Give up without finalizing; the object is left unchanged
+    void abort();
+    
+    size_t bytesWritten() const { return bytes_written_; }
+    
+    // True if close() failed because the object's generation precondition
+    // no longer held, i.e. it was replaced during the upload
+    bool preconditionFailed() const { return precondition_failed_; }
+    
+private:
+    gcs::ObjectWriteStream stream_;
+    size_t bytes_written_ = 0;
+    bool finished_ = false;
+    bool precondition_failed_ = false;
+};
+
+/**
+ * ObjectDownloadStream - Open-ended read of one object from an offset
+ *
+ * Keeps a single GET open so consecutive reads continue on the same
+ * connection instead of paying connection setup and time to first byte
+ * again. The stream only moves forward; reading elsewhere needs a new one.
+ */
+class ObjectDownloadStream {
+public:
+    ObjectDownloadStream(gcs::ObjectReadStream stream, std::int64_t offset, std::int64_t generation = 0);
+    ObjectDownloadStream(const ObjectDownloadStream&) = delete;
+    ObjectDownloadStream& operator=(const ObjectDownloadStream&) = delete;
+    
+    // Read up to size bytes at offset(); returns bytes read (short or 0 at
+    // the end of the object), or -1 on error, even if some bytes arrived
+    // before it
+    ssize_t read(char* buf, size_t size);
+    
+    // Offset the next read() starts at
+    std::int64_t offset() const { return offset_; }
+    
+    // True once the end of the object was reached or the stream failed
+    bool done() const { return done_; }
+    
+    // Generation the stream was opened on, 0 if not pinned
+    std::int64_t generation() const { return generation_; }
+    
+private:
+    gcs::ObjectReadStream stream_;
+    std::int64_t offset_;
+    std::int64_t generation_;
+    bool done_ = false;
+};
+
+/**
+ * ObjectLister - Incremental listing of a prefix
+ *
+ * Hands out listed objects and prefixes one at a time. The SDK fetches the
+ * next page of results only when the current one is used up, so a consumer
+ * can start on the first entries of a huge prefix before the rest have been
+ * listed, and can stop early without paying for the remaining pages. With
+ * a delimiter, everything below a subdirectory comes back as one prefix.
+ */
+class ObjectLister {
+public:
+    explicit ObjectLister(gcs::ListObjectsAndPrefixesReader reader);
+    ObjectLister(const ObjectLister&) = delete;
+    ObjectLister& operator=(const ObjectLister&) = delete;
+    
+    // Next listed object or prefix, or nullopt once the listing is done or has failed
+    std::optional<ObjectMetadata> next();
+    
+    // True if the listing stopped on an error rather than reaching its end
+    bool failed() const { return failed_; }
+    
+private:
+    gcs::ListObjectsAndPrefixesReader reader_;
+    std::optional<gcs::ListObjectsAndPrefixesReader::iterator> it_;  // set by the first next()
+    bool done_ = false;
+    bool failed_ = false;
 };
 
 /**
@@ -35,24 +147,123 @@ public:
     explicit GCSClient(std::unique_ptr<IGCSSDKClient> sdk_client);
     virtual ~GCSClient() = default;
     
-    // Object operations
+    // Outcome of checkObject
+    struct ObjectCheck {
+        bool unchanged = false;                  // still at the generation checked
+        std::optional<ObjectMetadata> metadata;  // current metadata if it was replaced
+    };
+    
+    // Outcome of lookupObject and lookupDirectory. failed is set when GCS
+    // gave no answer (any error but a 404 on the object, or a listing that
+    // broke off); nothing is known about the path then.
+    struct ObjectLookup {
+        std::optional<ObjectMetadata> metadata;  // set if the object exists
+        bool failed = false;
+    };
+    struct DirectoryLookup {
+        bool exists = false;  // something is listed under the prefix
+        bool failed = false;
+    };
+    
+    // Object operations. getObjectMetadata is nullopt both for a missing
+    // object and for a failed request; lookupObject tells them apart.
     virtual std::optional<ObjectMetadata> getObjectMetadata(
         const std::string& bucket_name,
         const std::string& object_name) const;
     
+    virtual ObjectLookup lookupObject(
+        const std::string& bucket_name,
+        const std::string& object_name) const;
+    
+    // Revalidate an object cached at generation with a conditional GET,
+    // which comes back without a body while the object is unchanged.
+    // Neither field is set if the object is gone or the request failed.
+    virtual ObjectCheck checkObject(
+        const std::string& bucket_name,
+        const std::string& object_name,
+        std::int64_t generation) const;
+    
     virtual std::string readObject(
         const IGCSSDKClient::ReadObjectRequest& request) const;
     
+    // Read straight into buf (up to size bytes), without an intermediate
+    // string. Returns bytes read (0 past the end of the object, or for an
+    // object or generation that is gone), or -1 on any other error, even
+    // after partial data.
+    virtual ssize_t readObject(
+        const IGCSSDKClient::ReadObjectRequest& request,
+        char* buf,
+        size_t size) const;
+    
+    // Open a read of object_name from offset to its end, of the given
+    // generation unless it is 0; nullptr on failure (an offset past the
+    // end, or an object that is gone, gives a stream that reads as EOF)
+    virtual std::unique_ptr<ObjectDownloadStream> openDownloadStream(
+        const std::string& bucket_name,
+        const std::string& object_name,
+        std::int64_t offset,
+        std::int64_t generation = 0) const;
+    
     virtual bool writeObject(
         const std::string& bucket_name,
         const std::string& object_name,
         const std::string& content) const;
     
+    // Open a streaming upload of object_name; nullptr on failure. With
+    // if_generation_match, the upload only finalizes while object_name is
+    // still at that generation.
+    virtual std::unique_ptr<ObjectUploadStream> openUploadStream(
+        const std::string& bucket_name,
+        const std::string& object_name,
+        std::int64_t if_generation_match = 0) const;
+    
+    // Upload content as parts of part_size bytes, at most max_concurrency at
+    // a time, then compose them into object_name. Content that fits in one
+    // part (or part_size 0) is written in one stream. Temporary parts are
+    // deleted afterwards whether or not the upload succeeded. Returns the
+    // new object's metadata, nullopt on failure.
+    virtual std::optional<ObjectMetadata> writeObjectComposite(
+        const std::string& bucket_name,
+        const std::string& object_name,
+        std::string_view content,
+        size_t part_size,
+        size_t max_concurrency) const;
+    
+    // Add bytes to the end of object_name without rewriting it: fill writes
+    // them to a temporary object, which is composed onto object_name and
+    // deleted. fill returns false to abandon the append. The append fails
+    // if object_name is no longer at generation, and is refused outright
+    // when generation is 0 (unknown). Returns the new object's metadata,
+    // nullopt on failure.
+    virtual std::optional<ObjectMetadata> appendObject(
+        const std::string& bucket_name,
+        const std::string& object_name,
+        const std::function<bool(ObjectUploadStream&)>& fill,
+        std::int64_t generation) const;
+    
+    // Concatenate source objects (at most kMaxComposeSources) into
+    // destination; with if_generation_match, only while destination is at
+    // that generation. Returns the destination's metadata, nullopt on failure.
+    virtual std::optional<ObjectMetadata> composeObject(
+        const std::string& bucket_name,
+        const std::vector<std::string>& source_objects,
+        const std::string& destination_object,
+        std::int64_t if_generation_match = 0) const;
+    
     virtual bool deleteObject(
         const std::string& bucket_name,
         const std::string& object_name) const;
     
     // List operations
+    
+    // Start an incremental listing (page_size 0 = server default); results
+    // are fetched page by page as the lister is advanced
+    virtual std::unique_ptr<ObjectLister> openListing(
+        const std::string& bucket_name,
+        const std::string& prefix,
+        const std::string& delimiter = "",
+        int page_size = 0) const;
+    
     virtual std::vector<ObjectMetadata> listObjects(
         const std::string& bucket_name,
         const std::string& prefix,
@@ -67,9 +278,43 @@ public:
     virtual bool directoryExists(
         const std::string& bucket_name,
         const std::string& dir_prefix) const;
+    
+    virtual DirectoryLookup lookupDirectory(
+        const std::string& bucket_name,
+        const std::string& dir_prefix) const;
+
+    // GCS limit on the number of sources in one compose request
+    static constexpr size_t kMaxComposeSources = 32;
+    
+    // Prefix under which composite upload parts are staged
+    static constexpr const char* kCompositePartPrefix = ".gcscfuse-parts/";
 
 private:
     std::unique_ptr<IGCSSDKClient> sdk_client_;
+    
+    // Identical metadata requests in flight at the same time are sent once
+    mutable SingleFlight<std::pair<std::string, std::string>, ObjectLookup> metadata_flights_;
+    mutable SingleFlight<std::tuple<std::string, std::string, std::string, int>,
+                         std::vector<ObjectMetadata>> list_flights_;
+    mutable SingleFlight<std::pair<std::string, std::string>, DirectoryLookup> directory_flights_;
+    
+    std::optional<ObjectMetadata> writeObjectData(
+        const std::string& bucket_name,
+        const std::string& object_name,
+        const char* data,
+        size_t size) const;
+    
+    // Prefix for the temporary objects of one upload of object_name
+    static std::string tempPrefix(const std::string& object_name);
+    
+    // Compose sources into destination, composing groups into temporary
+    // objects first when there are more than kMaxComposeSources
+    std::optional<ObjectMetadata> composeAll(
+        const std::string& bucket_name,
+        std::vector<std::string> sources,
+        const std::string& destination_object,
+        const std::string& temp_prefix,
+        std::vector<std::string>& temporaries) const;
 };
 
 } // namespace gcscfuse
@@ -1,55 +1,20 @@
 #include "gcs_client.hpp"
 #include "gcs_sdk_interface.hpp"
+#include "mock_gcs_sdk_client.hpp"
+#include "metrics.hpp"
+#include "google/cloud/mocks/mock_stream_range.h"
 #include <gtest/gtest.h>
 #include <gmock/gmock.h>
 #include <memory>
 #include <string>
 #include <sstream>
+#include <vector>
 
 using ::testing::Return;
 using ::testing::_;
 using ::testing::Invoke;
 namespace gcs = ::google::cloud::storage;
 
-// Mock the raw GCS SDK interface
-class MockGCSSDKClient : public gcscfuse::IGCSSDKClient {
-public:
-    MOCK_METHOD(
-        gcs::ObjectReadStream,
-        ReadObject,
-        (const gcscfuse::IGCSSDKClient::ReadObjectRequest& request),
-        (const, override)
-    );
-    
-    MOCK_METHOD(
-        (google::cloud::StatusOr<gcs::ObjectMetadata>),
-        GetObjectMetadata,
-        (const gcscfuse::IGCSSDKClient::GetObjectMetadataRequest& request),
-        (const, override)
-    );
-    
-    MOCK_METHOD(
-        gcs::ObjectWriteStream,
-        WriteObject,
-        (const gcscfuse::IGCSSDKClient::WriteObjectRequest& request),
-        (const, override)
-    );
-    
-    MOCK_METHOD(
-        google::cloud::Status,
-        DeleteObject,
-        (const gcscfuse::IGCSSDKClient::DeleteObjectRequest& request),
-        (const, override)
-    );
-    
-    MOCK_METHOD(
-        gcs::ListObjectsReader,
-        ListObjects,
-        (const gcscfuse::IGCSSDKClient::ListObjectsRequest& request),
-        (const, override)
-    );
-};
-
 class GCSClientTest : public ::testing::Test {
 protected:
     void SetUp() override {
@@ -111,6 +76,59 @@ TEST_F(GCSClientTest, GetObjectMetadata_NotFound) {
     EXPECT_FALSE(result.has_value());
 }
 
+TEST_F(GCSClientTest, GetObjectMetadata_CarriesVersion) {
+    auto mock_metadata = createMockMetadata("v.txt", 10)
+        .set_generation(1700000000123456)
+        .set_metageneration(3)
+        .set_crc32c("EjRWeA==");
+    
+    EXPECT_CALL(*mock_sdk_client_ptr, GetObjectMetadata(::testing::_))
+        .WillOnce(::testing::Return(mock_metadata));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto result = client.getObjectMetadata("test-bucket", "v.txt");
+    
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->generation, 1700000000123456);
+    EXPECT_EQ(result->metageneration, 3);
+    EXPECT_EQ(result->crc32c, 0x12345678u);
+}
+
+TEST_F(GCSClientTest, CheckObject_NotModifiedIsUnchanged) {
+    EXPECT_CALL(*mock_sdk_client_ptr, GetObjectMetadata(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::GetObjectMetadataRequest& req) {
+            EXPECT_EQ(req.if_generation_not_match, std::optional<std::int64_t>(42));
+            return google::cloud::Status(google::cloud::StatusCode::kFailedPrecondition, "not modified");
+        }));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto check = client.checkObject("test-bucket", "v.txt", 42);
+    EXPECT_TRUE(check.unchanged);
+    EXPECT_FALSE(check.metadata.has_value());
+}
+
+TEST_F(GCSClientTest, CheckObject_ReplacedReturnsMetadata) {
+    EXPECT_CALL(*mock_sdk_client_ptr, GetObjectMetadata(::testing::_))
+        .WillOnce(::testing::Return(createMockMetadata("v.txt", 20).set_generation(43)));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto check = client.checkObject("test-bucket", "v.txt", 42);
+    EXPECT_FALSE(check.unchanged);
+    ASSERT_TRUE(check.metadata.has_value());
+    EXPECT_EQ(check.metadata->generation, 43);
+    EXPECT_EQ(check.metadata->size, 20);
+}
+
+TEST_F(GCSClientTest, CheckObject_MissingSetsNeither) {
+    EXPECT_CALL(*mock_sdk_client_ptr, GetObjectMetadata(::testing::_))
+        .WillOnce(::testing::Return(google::cloud::Status(google::cloud::StatusCode::kNotFound, "gone")));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto check = client.checkObject("test-bucket", "v.txt", 42);
+    EXPECT_FALSE(check.unchanged);
+    EXPECT_FALSE(check.metadata.has_value());
+}
+
 // Test readObject - Error handling (tests error handling for failed streams)
 TEST_F(GCSClientTest, ReadObject_ErrorHandling) {
     gcscfuse::IGCSSDKClient::ReadObjectRequest req;
@@ -126,6 +144,47 @@ TEST_F(GCSClientTest, ReadObject_ErrorHandling) {
 }
 
 
+// Test readObject into a caller buffer - Error handling
+TEST_F(GCSClientTest, ReadObjectIntoBuffer_ErrorHandling) {
+    gcscfuse::IGCSSDKClient::ReadObjectRequest req;
+    req.bucket_name = "test-bucket";
+    req.object_name = "test-object.txt";
+
+    EXPECT_CALL(*mock_sdk_client_ptr, ReadObject(req))
+        .WillOnce(::testing::Return(gcs::ObjectReadStream()));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    char buf[16];
+    EXPECT_EQ(client.readObject(req, buf, sizeof(buf)), -1);
+}
+
+TEST_F(GCSClientTest, OpenDownloadStream_ReadsFromOffset) {
+    gcscfuse::IGCSSDKClient::ReadObjectRequest req;
+    req.bucket_name = "test-bucket";
+    req.object_name = "test-object.txt";
+    req.read_from_offset = 4096;
+
+    EXPECT_CALL(*mock_sdk_client_ptr, ReadObject(req))
+        .WillOnce(::testing::Return(gcs::ObjectReadStream()));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_EQ(client.openDownloadStream("test-bucket", "test-object.txt", 4096), nullptr);
+}
+
+TEST_F(GCSClientTest, OpenDownloadStream_PinsGeneration) {
+    gcscfuse::IGCSSDKClient::ReadObjectRequest req;
+    req.bucket_name = "test-bucket";
+    req.object_name = "test-object.txt";
+    req.read_from_offset = 4096;
+    req.generation = 7;
+
+    EXPECT_CALL(*mock_sdk_client_ptr, ReadObject(req))
+        .WillOnce(::testing::Return(gcs::ObjectReadStream()));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_EQ(client.openDownloadStream("test-bucket", "test-object.txt", 4096, 7), nullptr);
+}
+
 // Test objectExists - Tests logic that uses getObjectMetadata
 TEST_F(GCSClientTest, ObjectExists_True) {
     const std::string bucket = "test-bucket";
@@ -219,6 +278,286 @@ TEST_F(GCSClientTest, ReadObject_WithRangeOption) {
     EXPECT_EQ(result, ""); // Default-constructed stream returns empty string
 }
 
+// Test composeObject - Success (tests request construction)
+TEST_F(GCSClientTest, ComposeObject_Success) {
+    const std::string bucket = "test-bucket";
+    const std::vector<std::string> sources = {"part-0", "part-1", "part-2"};
+    
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ComposeObjectRequest& req) {
+            EXPECT_EQ(req.bucket_name, bucket);
+            EXPECT_EQ(req.source_objects, sources);
+            EXPECT_EQ(req.destination_object, "big.bin");
+            return createMockMetadata("big.bin", 300).set_generation(42);
+        }));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto composed = client.composeObject(bucket, sources, "big.bin");
+    ASSERT_TRUE(composed.has_value());
+    EXPECT_EQ(composed->size, 300);
+    EXPECT_EQ(composed->generation, 42);
+}
+
+TEST_F(GCSClientTest, ComposeObject_GenerationPrecondition) {
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ComposeObjectRequest& req) {
+            EXPECT_EQ(req.if_generation_match, std::optional<std::int64_t>(9));
+            return google::cloud::Status(google::cloud::StatusCode::kFailedPrecondition, "generation mismatch");
+        }));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_FALSE(client.composeObject("test-bucket", {"big.bin", "tail"}, "big.bin", 9));
+}
+
+// Test composeObject - Failure (tests error handling)
+TEST_F(GCSClientTest, ComposeObject_Failure) {
+    google::cloud::Status error_status(google::cloud::StatusCode::kInvalidArgument, "Too many sources");
+    
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_))
+        .WillOnce(::testing::Return(error_status));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_FALSE(client.composeObject("test-bucket", {"a", "b"}, "big.bin"));
+}
+
+// Test writeObjectComposite - Content that fits in one part is written directly
+TEST_F(GCSClientTest, WriteObjectComposite_SmallContentUsesSingleWrite) {
+    EXPECT_CALL(*mock_sdk_client_ptr, WriteObject(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::WriteObjectRequest& req) {
+            EXPECT_EQ(req.object_name, "small.txt");
+            return gcs::ObjectWriteStream();
+        }));
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_)).Times(0);
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    client.writeObjectComposite("test-bucket", "small.txt", std::string(100, 'x'), 100, 4);
+}
+
+// Test writeObjectComposite - A failed part skips compose and leaves nothing to clean up
+TEST_F(GCSClientTest, WriteObjectComposite_PartFailureSkipsCompose) {
+    const std::string prefix = gcscfuse::GCSClient::kCompositePartPrefix;
+    
+    EXPECT_CALL(*mock_sdk_client_ptr, WriteObject(::testing::_))
+        .Times(::testing::AtLeast(1))
+        .WillRepeatedly(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::WriteObjectRequest& req) {
+            // Parts are staged under the temporary prefix, never the destination
+            EXPECT_EQ(req.object_name.rfind(prefix + "big.bin.", 0), 0u);
+            return gcs::ObjectWriteStream();  // default stream fails on Close()
+        }));
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_)).Times(0);
+    EXPECT_CALL(*mock_sdk_client_ptr, DeleteObject(::testing::_)).Times(0);
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_FALSE(client.writeObjectComposite("test-bucket", "big.bin", std::string(1000, 'x'), 100, 4));
+}
+
+// Test appendObject - The tail goes to a temporary object; a failed upload skips compose
+TEST_F(GCSClientTest, AppendObject_FailedTailSkipsCompose) {
+    const std::string prefix = gcscfuse::GCSClient::kCompositePartPrefix;
+    
+    EXPECT_CALL(*mock_sdk_client_ptr, WriteObject(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::WriteObjectRequest& req) {
+            EXPECT_EQ(req.object_name.rfind(prefix + "log.txt.", 0), 0u);
+            return gcs::ObjectWriteStream();  // default stream fails on Close()
+        }));
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_)).Times(0);
+    EXPECT_CALL(*mock_sdk_client_ptr, DeleteObject(::testing::_)).Times(0);
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    bool filled = false;
+    EXPECT_FALSE(client.appendObject("test-bucket", "log.txt", [&](gcscfuse::ObjectUploadStream&) {
+        filled = true;
+        return true;
+    }, 7));
+    EXPECT_TRUE(filled);
+}
+
+// Test appendObject - Without a generation to pin, nothing is uploaded
+TEST_F(GCSClientTest, AppendObject_RefusesUnknownGeneration) {
+    EXPECT_CALL(*mock_sdk_client_ptr, WriteObject(::testing::_)).Times(0);
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_)).Times(0);
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_FALSE(client.appendObject("test-bucket", "log.txt",
+                                     [](gcscfuse::ObjectUploadStream&) { return true; }, 0));
+}
+
+// Test appendObject - fill can abandon the append
+TEST_F(GCSClientTest, AppendObject_FillFailureAbandons) {
+    EXPECT_CALL(*mock_sdk_client_ptr, WriteObject(::testing::_))
+        .WillOnce(::testing::Invoke([](const gcscfuse::IGCSSDKClient::WriteObjectRequest&) {
+            return gcs::ObjectWriteStream();
+        }));
+    EXPECT_CALL(*mock_sdk_client_ptr, ComposeObject(::testing::_)).Times(0);
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_FALSE(client.appendObject("test-bucket", "log.txt",
+                                     [](gcscfuse::ObjectUploadStream&) { return false; }, 7));
+}
+
+// Test openUploadStream - A failed stream reports failure on write/close
+TEST_F(GCSClientTest, OpenUploadStream_FailedStream) {
+    EXPECT_CALL(*mock_sdk_client_ptr, WriteObject(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::WriteObjectRequest& req) {
+            EXPECT_EQ(req.object_name, "stream.bin");
+            return gcs::ObjectWriteStream();
+        }));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto stream = client.openUploadStream("test-bucket", "stream.bin");
+    ASSERT_NE(stream, nullptr);
+    
+    EXPECT_FALSE(stream->write("data", 4));
+    EXPECT_EQ(stream->bytesWritten(), 0u);
+    EXPECT_FALSE(stream->close());
+}
+
+// Test openUploadStream - The generation precondition reaches the SDK
+TEST_F(GCSClientTest, OpenUploadStream_GenerationPrecondition) {
+    EXPECT_CALL(*mock_sdk_client_ptr, WriteObject(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::WriteObjectRequest& req) {
+            EXPECT_EQ(req.if_generation_match, std::optional<std::int64_t>(12));
+            return gcs::ObjectWriteStream();
+        }))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::WriteObjectRequest& req) {
+            // 0 is an unknown generation, not "must not exist"
+            EXPECT_FALSE(req.if_generation_match.has_value());
+            return gcs::ObjectWriteStream();
+        }));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_NE(client.openUploadStream("test-bucket", "big.bin", 12), nullptr);
+    EXPECT_NE(client.openUploadStream("test-bucket", "big.bin"), nullptr);
+}
+
+// Test openListing - Page size is forwarded and an empty listing ends cleanly
+TEST_F(GCSClientTest, OpenListing_EmptyPrefix) {
+    EXPECT_CALL(*mock_sdk_client_ptr, ListObjectsAndPrefixes(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ListObjectsRequest& req) {
+            EXPECT_EQ(req.prefix, "dir/");
+            EXPECT_EQ(req.delimiter, "/");
+            EXPECT_EQ(req.max_results, 500);
+            return gcs::ListObjectsAndPrefixesReader();
+        }));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto lister = client.openListing("test-bucket", "dir/", "/", 500);
+    ASSERT_NE(lister, nullptr);
+
+    EXPECT_FALSE(lister->next().has_value());
+    EXPECT_FALSE(lister->next().has_value());
+    EXPECT_FALSE(lister->failed());
+}
+
+// Test listObjects - Delimiter prefixes come back as directories
+TEST_F(GCSClientTest, ListObjects_ReturnsPrefixesAsDirectories) {
+    EXPECT_CALL(*mock_sdk_client_ptr, ListObjectsAndPrefixes(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ListObjectsRequest& req) {
+            EXPECT_EQ(req.delimiter, "/");
+            return google::cloud::mocks::MakeStreamRange<gcs::ObjectOrPrefix>({
+                gcs::ObjectOrPrefix(createMockMetadata("dir/file.txt", 42)),
+                gcs::ObjectOrPrefix(std::string("dir/sub/")),
+            });
+        }));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto results = client.listObjects("test-bucket", "dir/", "/");
+
+    ASSERT_EQ(results.size(), 2u);
+    EXPECT_EQ(results[0].name, "dir/file.txt");
+    EXPECT_EQ(results[0].size, 42);
+    EXPECT_FALSE(results[0].is_directory);
+    EXPECT_EQ(results[1].name, "dir/sub/");
+    EXPECT_TRUE(results[1].is_directory);
+}
+
+// Test openListing - A listing error is reported as failure
+TEST_F(GCSClientTest, OpenListing_ErrorMarksFailed) {
+    EXPECT_CALL(*mock_sdk_client_ptr, ListObjectsAndPrefixes(::testing::_))
+        .WillOnce(::testing::Return(::testing::ByMove(google::cloud::mocks::MakeStreamRange<gcs::ObjectOrPrefix>(
+            {gcs::ObjectOrPrefix(createMockMetadata("a.txt", 1))},
+            google::cloud::Status(google::cloud::StatusCode::kUnavailable, "try again")))));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto lister = client.openListing("test-bucket", "", "/");
+
+    ASSERT_TRUE(lister->next().has_value());
+    EXPECT_FALSE(lister->next().has_value());
+    EXPECT_TRUE(lister->failed());
+}
+
+// Test directoryExists - A prefix alone makes the directory exist
+TEST_F(GCSClientTest, DirectoryExists_FromPrefix) {
+    EXPECT_CALL(*mock_sdk_client_ptr, ListObjectsAndPrefixes(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ListObjectsRequest& req) {
+            EXPECT_EQ(req.prefix, "dir/");
+            EXPECT_EQ(req.delimiter, "/");
+            EXPECT_EQ(req.max_results, 1);
+            return google::cloud::mocks::MakeStreamRange<gcs::ObjectOrPrefix>({
+                gcs::ObjectOrPrefix(std::string("dir/deep/")),
+            });
+        }))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ListObjectsRequest&) {
+            return gcs::ListObjectsAndPrefixesReader();
+        }));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_TRUE(client.directoryExists("test-bucket", "dir/"));
+    EXPECT_FALSE(client.directoryExists("test-bucket", "dir/"));
+}
+
+// Only a 404 says the object is missing; any other error says nothing
+TEST_F(GCSClientTest, LookupObject_SeparatesMissingFromFailed) {
+    EXPECT_CALL(*mock_sdk_client_ptr, GetObjectMetadata(::testing::_))
+        .WillOnce(::testing::Return(google::cloud::Status(google::cloud::StatusCode::kNotFound, "Not found")))
+        .WillOnce(::testing::Return(google::cloud::Status(google::cloud::StatusCode::kUnavailable, "503")));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto missing = client.lookupObject("test-bucket", "gone.txt");
+    EXPECT_FALSE(missing.metadata.has_value());
+    EXPECT_FALSE(missing.failed);
+    auto failed = client.lookupObject("test-bucket", "gone.txt");
+    EXPECT_FALSE(failed.metadata.has_value());
+    EXPECT_TRUE(failed.failed);
+}
+
+TEST_F(GCSClientTest, LookupDirectory_ReportsFailedListing) {
+    EXPECT_CALL(*mock_sdk_client_ptr, ListObjectsAndPrefixes(::testing::_))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ListObjectsRequest&) {
+            return google::cloud::mocks::MakeStreamRange<gcs::ObjectOrPrefix>(
+                {}, google::cloud::Status(google::cloud::StatusCode::kUnavailable, "503"));
+        }))
+        .WillOnce(::testing::Invoke([&](const gcscfuse::IGCSSDKClient::ListObjectsRequest&) {
+            return google::cloud::mocks::MakeStreamRange<gcs::ObjectOrPrefix>({});
+        }));
+
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    auto failed = client.lookupDirectory("test-bucket", "dir/");
+    EXPECT_FALSE(failed.exists);
+    EXPECT_TRUE(failed.failed);
+    auto empty = client.lookupDirectory("test-bucket", "dir/");
+    EXPECT_FALSE(empty.exists);
+    EXPECT_FALSE(empty.failed);
+}
+
+// Requests are timed and failures counted in the process-wide metrics
+TEST_F(GCSClientTest, Metrics_RecordRequestsAndErrors) {
+    auto& metrics = gcscfuse::Metrics::global();
+    const auto calls_before = metrics.histogram(gcscfuse::GCSRpc::DeleteObject).snapshot().count;
+    const auto errors_before = metrics.value(gcscfuse::MetricCounter::GCSErrors);
+    
+    EXPECT_CALL(*mock_sdk_client_ptr, DeleteObject(::testing::_))
+        .WillOnce(::testing::Return(google::cloud::Status()))
+        .WillOnce(::testing::Return(google::cloud::Status(google::cloud::StatusCode::kPermissionDenied, "denied")));
+    
+    gcscfuse::GCSClient client(std::move(mock_sdk_client));
+    EXPECT_TRUE(client.deleteObject("test-bucket", "a.txt"));
+    EXPECT_FALSE(client.deleteObject("test-bucket", "b.txt"));
+    
+    EXPECT_EQ(metrics.histogram(gcscfuse::GCSRpc::DeleteObject).snapshot().count, calls_before + 2);
+    EXPECT_EQ(metrics.value(gcscfuse::MetricCounter::GCSErrors), errors_before + 1);
+}
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
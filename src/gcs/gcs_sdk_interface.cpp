@@ -7,15 +7,42 @@ GCSSDKClientImpl::GCSSDKClientImpl() : client_(gcs::Client()) {}
 GCSSDKClientImpl::GCSSDKClientImpl(const gcs::Client& client) : client_(client) {}
 
 gcs::ObjectReadStream GCSSDKClientImpl::ReadObject(const ReadObjectRequest& request) const {
-    return client_.ReadObject(request.bucket_name, request.object_name);
+    // A default-constructed option is not sent
+    const gcs::Generation generation = request.generation ? gcs::Generation(*request.generation) : gcs::Generation();
+    if (request.range) {
+        return client_.ReadObject(
+            request.bucket_name,
+            request.object_name,
+            gcs::ReadRange(request.range->first, request.range->second),
+            generation
+        );
+    }
+    if (request.read_from_offset) {
+        return client_.ReadObject(
+            request.bucket_name,
+            request.object_name,
+            gcs::ReadFromOffset(*request.read_from_offset),
+            generation
+        );
+    }
+    return client_.ReadObject(request.bucket_name, request.object_name, generation);
 }
 
 StatusOr<gcs::ObjectMetadata> GCSSDKClientImpl::GetObjectMetadata(const GetObjectMetadataRequest& request) const {
-    return client_.GetObjectMetadata(request.bucket_name, request.object_name);
+    return client_.GetObjectMetadata(
+        request.bucket_name,
+        request.object_name,
+        request.if_generation_not_match ? gcs::IfGenerationNotMatch(*request.if_generation_not_match)
+                                        : gcs::IfGenerationNotMatch()
+    );
 }
 
 gcs::ObjectWriteStream GCSSDKClientImpl::WriteObject(const WriteObjectRequest& request) const {
-    return client_.WriteObject(request.bucket_name, request.object_name);
+    return client_.WriteObject(
+        request.bucket_name,
+        request.object_name,
+        request.if_generation_match ? gcs::IfGenerationMatch(*request.if_generation_match) : gcs::IfGenerationMatch()
+    );
 }
 
 Status GCSSDKClientImpl::DeleteObject(const DeleteObjectRequest& request) const {
@@ -31,4 +58,27 @@ gcs::ListObjectsReader GCSSDKClientImpl::ListObjects(const ListObjectsRequest& r
     );
 }
 
+gcs::ListObjectsAndPrefixesReader GCSSDKClientImpl::ListObjectsAndPrefixes(const ListObjectsRequest& request) const {
+    return client_.ListObjectsAndPrefixes(
+        request.bucket_name,
+        gcs::Prefix(request.prefix),
+        gcs::Delimiter(request.delimiter),
+        gcs::MaxResults(request.max_results)
+    );
+}
+
+StatusOr<gcs::ObjectMetadata> GCSSDKClientImpl::ComposeObject(const ComposeObjectRequest& request) const {
+    std::vector<gcs::ComposeSourceObject> sources;
+    sources.reserve(request.source_objects.size());
+    for (const auto& name : request.source_objects) {
+        sources.push_back(gcs::ComposeSourceObject{name, {}, {}});
+    }
+    return client_.ComposeObject(
+        request.bucket_name,
+        std::move(sources),
+        request.destination_object,
+        request.if_generation_match ? gcs::IfGenerationMatch(*request.if_generation_match) : gcs::IfGenerationMatch()
+    );
+}
+
 } // namespace gcscfuse
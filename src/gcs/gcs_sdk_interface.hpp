@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include <optional>
 #include <chrono>
 #include "google/cloud/storage/client.h"
@@ -27,9 +28,14 @@ public:
         std::string object_name;
         // Optional range: [start, end) (inclusive, exclusive)
         std::optional<std::pair<std::int64_t, std::int64_t>> range;
+        // Optional start of an open-ended read to the end of the object
+        std::optional<std::int64_t> read_from_offset;
+        // Optional generation to read; the read fails once it is replaced
+        std::optional<std::int64_t> generation;
 
         bool operator==(const ReadObjectRequest& other) const {
-            return bucket_name == other.bucket_name && object_name == other.object_name && range == other.range;
+            return bucket_name == other.bucket_name && object_name == other.object_name && range == other.range &&
+                   read_from_offset == other.read_from_offset && generation == other.generation;
         }
     };
 
@@ -37,9 +43,13 @@ public:
     struct GetObjectMetadataRequest {
         std::string bucket_name;
         std::string object_name;
+        // Optional precondition: GCS answers "not modified" (kFailedPrecondition)
+        // without a body while the object is still at this generation
+        std::optional<std::int64_t> if_generation_not_match;
 
         bool operator==(const GetObjectMetadataRequest& other) const {
-            return bucket_name == other.bucket_name && object_name == other.object_name;
+            return bucket_name == other.bucket_name && object_name == other.object_name &&
+                   if_generation_not_match == other.if_generation_not_match;
         }
     };
 
@@ -47,9 +57,12 @@ public:
     struct WriteObjectRequest {
         std::string bucket_name;
         std::string object_name;
+        // Optional precondition: the upload only finalizes while the object is at this generation
+        std::optional<std::int64_t> if_generation_match;
 
         bool operator==(const WriteObjectRequest& other) const {
-            return bucket_name == other.bucket_name && object_name == other.object_name;
+            return bucket_name == other.bucket_name && object_name == other.object_name &&
+                   if_generation_match == other.if_generation_match;
         }
     };
 
@@ -63,6 +76,22 @@ public:
         }
     };
 
+    // Request struct for ComposeObject
+    struct ComposeObjectRequest {
+        std::string bucket_name;
+        std::vector<std::string> source_objects;  // concatenated in order
+        std::string destination_object;
+        // Optional precondition: only compose while the destination is at this generation
+        std::optional<std::int64_t> if_generation_match;
+
+        bool operator==(const ComposeObjectRequest& other) const {
+            return bucket_name == other.bucket_name &&
+                   source_objects == other.source_objects &&
+                   destination_object == other.destination_object &&
+                   if_generation_match == other.if_generation_match;
+        }
+    };
+
     // Request struct for ListObjects
     struct ListObjectsRequest {
         std::string bucket_name;
@@ -92,6 +121,12 @@ public:
     
     // List objects - returns SDK's ListObjectsReader
     virtual gcs::ListObjectsReader ListObjects(const ListObjectsRequest& request) const = 0;
+    
+    // List objects and the prefixes rolled up by the delimiter - returns SDK's ListObjectsAndPrefixesReader
+    virtual gcs::ListObjectsAndPrefixesReader ListObjectsAndPrefixes(const ListObjectsRequest& request) const = 0;
+    
+    // Compose objects - returns SDK's StatusOr with the destination metadata
+    virtual StatusOr<gcs::ObjectMetadata> ComposeObject(const ComposeObjectRequest& request) const = 0;
 };
 
 /**
@@ -112,6 +147,10 @@ public:
     Status DeleteObject(const DeleteObjectRequest& request) const override;
     
     gcs::ListObjectsReader ListObjects(const ListObjectsRequest& request) const override;
+    
+    gcs::ListObjectsAndPrefixesReader ListObjectsAndPrefixes(const ListObjectsRequest& request) const override;
+    
+    StatusOr<gcs::ObjectMetadata> ComposeObject(const ComposeObjectRequest& request) const override;
 
 private:
     mutable gcs::Client client_;
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "gcs_sdk_interface.hpp"
+#include <gmock/gmock.h>
+
+namespace gcs = ::google::cloud::storage;
+
+// Mock the raw GCS SDK interface
+class MockGCSSDKClient : public gcscfuse::IGCSSDKClient {
+public:
+    MOCK_METHOD(
+        gcs::ObjectReadStream,
+        ReadObject,
+        (const gcscfuse::IGCSSDKClient::ReadObjectRequest& request),
+        (const, override)
+    );
+    
+    MOCK_METHOD(
+        (google::cloud::StatusOr<gcs::ObjectMetadata>),
+        GetObjectMetadata,
+        (const gcscfuse::IGCSSDKClient::GetObjectMetadataRequest& request),
+        (const, override)
+    );
+    
+    MOCK_METHOD(
+        gcs::ObjectWriteStream,
+        WriteObject,
+        (const gcscfuse::IGCSSDKClient::WriteObjectRequest& request),
+        (const, override)
+    );
+    
+    MOCK_METHOD(
+        google::cloud::Status,
+        DeleteObject,
+        (const gcscfuse::IGCSSDKClient::DeleteObjectRequest& request),
+        (const, override)
+    );
+    
+    MOCK_METHOD(
+        gcs::ListObjectsReader,
+        ListObjects,
+        (const gcscfuse::IGCSSDKClient::ListObjectsRequest& request),
+        (const, override)
+    );
+    
+    MOCK_METHOD(
+        gcs::ListObjectsAndPrefixesReader,
+        ListObjectsAndPrefixes,
+        (const gcscfuse::IGCSSDKClient::ListObjectsRequest& request),
+        (const, override)
+    );
+    
+    MOCK_METHOD(
+        (google::cloud::StatusOr<gcs::ObjectMetadata>),
+        ComposeObject,
+        (const gcscfuse::IGCSSDKClient::ComposeObjectRequest& request),
+        (const, override)
+    );
+};
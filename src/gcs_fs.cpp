@@ -1,18 +1,101 @@
 // GCS filesystem class implementation
 
 #include "gcs_fs.hpp"
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <algorithm>
-#include <set>
+#include <limits>
+#include <future>
 #include <chrono>
 #include <cstdarg>
+#include <filesystem>
+#include <sstream>
+#include <string_view>
 #include <fuse_log.h>
 
+namespace {
+// Fill a stat buffer from cached metadata
+void fillStat(const StatCache::StatInfo& info, struct stat *stbuf)
+{
+    stbuf->st_mode = info.mode;
+    stbuf->st_nlink = info.is_directory ? 2 : 1;
+    stbuf->st_size = info.size;
+    stbuf->st_mtime = info.mtime;
+}
+
+// Payload of a FUSE buffer vector as one contiguous range, copied into
+// scratch only when it is not already a single memory buffer
+const char* contiguousPayload(struct fuse_bufvec *src, size_t size, std::vector<char>& scratch)
+{
+    if (src->count - src->idx == 1 && !(src->buf[src->idx].flags & FUSE_BUF_IS_FD)) {
+        return static_cast<const char *>(src->buf[src->idx].mem) + src->off;
+    }
+    scratch.resize(size);
+    struct fuse_bufvec dst = FUSE_BUFVEC_INIT(size);
+    dst.buf[0].mem = scratch.data();
+    ssize_t copied = fuse_buf_copy(&dst, src, FUSE_BUF_NO_SPLICE);
+    return copied == static_cast<ssize_t>(size) ? scratch.data() : nullptr;
+}
+
+// FUSE path of an entry in a directory
+std::string childPath(const std::string& dir, const std::string& name)
+{
+    return (dir.empty() || dir.back() == '/') ? dir + name : dir + "/" + name;
+}
+
+// FUSE path of the directory holding path
+std::string parentPath(const std::string& path)
+{
+    const size_t slash = path.find_last_of('/');
+    return (slash == 0 || slash == std::string::npos) ? "/" : path.substr(0, slash);
+}
+
+// Time the enclosing FUSE callback
+gcscfuse::ScopedLatency timeOp(gcscfuse::FuseOp op)
+{
+    return gcscfuse::Metrics::global().time(op);
+}
+
+void countEvent(gcscfuse::MetricCounter counter, std::uint64_t n = 1)
+{
+    gcscfuse::Metrics::global().add(counter, n);
+}
+
+}
+
+std::unique_ptr<gcscfuse::IGCSSDKClient> GCSFS::makeSDKClient(const GCSFSConfig& config)
+{
+    if (config.gcs_connection_pool_size <= 0) {
+        return std::make_unique<gcscfuse::GCSSDKClientImpl>();
+    }
+    auto options = google::cloud::Options{}.set<google::cloud::storage::ConnectionPoolSizeOption>(
+        static_cast<std::size_t>(config.gcs_connection_pool_size));
+    return std::make_unique<gcscfuse::GCSSDKClientImpl>(
+        google::cloud::storage::Client(std::move(options)));
+}
+
 GCSFS::GCSFS(const std::string& bucket_name, const GCSFSConfig& config)
+    : GCSFS(bucket_name, config, makeSDKClient(config))
+{
+}
+
+GCSFS::GCSFS(const std::string& bucket_name, const GCSFSConfig& config,
+             std::unique_ptr<gcscfuse::IGCSSDKClient> sdk_client)
+    : GCSFS(bucket_name, config, Shared{std::make_shared<gcscfuse::GCSClient>(std::move(sdk_client)), nullptr, nullptr})
+{
+}
+
+GCSFS::GCSFS(const std::string& bucket_name, const GCSFSConfig& config, const Shared& shared)
     : bucket_name_(bucket_name),
       config_(config),
-      gcs_client_()
+      gcs_client_owner_(shared.gcs_client),
+      gcs_client_(*gcs_client_owner_),
+      async_gcs_client_(gcs_client_,
+                        shared.scheduler ? shared.scheduler
+                                         : std::make_shared<gcscfuse::RequestScheduler>(
+                                               static_cast<size_t>(config.gcs_max_concurrent_requests),
+                                               static_cast<size_t>(config.gcs_max_bulk_requests)))
 {
     // Set up FUSE logging if debug or verbose mode enabled
     if (config_.debug_mode || config_.verbose_logging) {
@@ -41,11 +124,42 @@ GCSFS::GCSFS(const std::string& bucket_name, const GCSFSConfig& config)
             std::cout << "[DEBUG] Stat cache TTL: " << config_.stat_cache_timeout << " seconds" << std::endl;
         }
         std::cout << "[DEBUG] File content cache: " << (config_.enable_file_content_cache ? "enabled" : "disabled") << std::endl;
+        if (config_.enable_file_content_cache) {
+            std::cout << "[DEBUG] Content cache block size: " << config_.content_cache_block_size_mb << " MiB, budget: "
+                      << config_.max_content_cache_mb << " MiB" << std::endl;
+            std::cout << "[DEBUG] Random read range: " << config_.random_read_kb << " KiB, small object prefetch: "
+                      << config_.small_object_prefetch_mb << " MiB" << std::endl;
+        }
+        std::cout << "[DEBUG] Metadata lookup batching: " << (config_.batch_metadata_lookups ? "enabled" : "disabled")
+                  << ", small file prefetch: " << config_.small_file_prefetch_kb << " KiB" << std::endl;
+        std::cout << "[DEBUG] Read-ahead: " << (config_.enable_read_ahead ? "enabled" : "disabled") << std::endl;
+        if (!config_.cache_dir.empty()) {
+            std::cout << "[DEBUG] Disk cache: " << config_.cache_dir << ", budget: "
+                      << config_.max_disk_cache_mb << " MiB" << std::endl;
+        }
         if (config_.enable_dummy_reader) {
             std::cout << "[DEBUG] Using dummy reader (returns zeros)" << std::endl;
         }
     }
+    gcscfuse::Metrics::global().setEnabled(config_.enable_metrics);
+    
     stat_cache_.setCacheTimeout(config_.stat_cache_timeout);
+    stat_cache_.setNegativeTimeout(config_.negative_stat_cache_timeout);
+    stat_cache_.setStaleWhileRevalidate(config_.stale_while_revalidate);
+    stat_cache_.setMaxEntries(static_cast<size_t>(config_.max_stat_cache_entries));
+    
+    const std::string& snapshot_dir = config_.metadata_snapshot_dir.empty()
+        ? config_.cache_dir : config_.metadata_snapshot_dir;
+    if (config_.enable_stat_cache && !snapshot_dir.empty()) {
+        std::error_code ec;
+        std::filesystem::create_directories(snapshot_dir, ec);
+        if (ec) {
+            std::cerr << "Stat cache snapshots disabled, cannot use " << snapshot_dir << ": "
+                      << ec.message() << std::endl;
+        } else {
+            snapshot_path_ = snapshot_dir + "/" + bucket_name_ + ".statcache";
+        }
+    }
     
     // Initialize reader based on configuration
     std::unique_ptr<gcscfuse::IReader> base_reader;
@@ -61,11 +175,52 @@ GCSFS::GCSFS(const std::string& bucket_name, const GCSFSConfig& config)
             config_.debug_mode);
     }
     
-    if (config_.enable_file_content_cache) {
-        reader_ = std::make_unique<gcscfuse::CachedReader>(
+    if (config_.enable_read_ahead) {
+        base_reader = std::make_unique<gcscfuse::ReadAheadReader>(
+            std::move(base_reader),
+            static_cast<size_t>(config_.read_ahead_chunk_kb) * 1024,
+            static_cast<size_t>(config_.read_ahead_max_chunks),
+            config_.debug_mode);
+    }
+    
+    // Persistent disk tier below the in-memory cache
+    if (!config_.cache_dir.empty()) {
+        auto disk_reader = std::make_unique<gcscfuse::DiskCachedReader>(
             std::move(base_reader),
-            config_.debug_mode,
-            config_.verbose_logging);
+            config_.cache_dir,
+            static_cast<size_t>(config_.content_cache_block_size_mb) * 1024 * 1024,
+            static_cast<size_t>(config_.max_disk_cache_mb) * 1024 * 1024,
+            config_.debug_mode);
+        disk_cache_ = &disk_reader->cache();
+        base_reader = std::move(disk_reader);
+    }
+    
+    if (config_.enable_file_content_cache) {
+        std::unique_ptr<gcscfuse::CachedReader> cached_reader;
+        if (shared.content_cache) {
+            // One memory budget across the daemon's mounts; objects are kept
+            // apart by bucket
+            cached_reader = std::make_unique<gcscfuse::CachedReader>(
+                std::move(base_reader),
+                shared.content_cache,
+                bucket_name_ + "/",
+                config_.debug_mode,
+                config_.verbose_logging,
+                static_cast<size_t>(config_.random_read_kb) * 1024,
+                static_cast<size_t>(config_.small_object_prefetch_mb) * 1024 * 1024);
+        } else {
+            cached_reader = std::make_unique<gcscfuse::CachedReader>(
+                std::move(base_reader),
+                config_.debug_mode,
+                config_.verbose_logging,
+                static_cast<size_t>(config_.content_cache_block_size_mb) * 1024 * 1024,
+                static_cast<size_t>(config_.max_content_cache_mb) * 1024 * 1024,
+                static_cast<size_t>(config_.random_read_kb) * 1024,
+                static_cast<size_t>(config_.small_object_prefetch_mb) * 1024 * 1024);
+        }
+        content_cache_ = &cached_reader->cache();
+        cached_reader_ = cached_reader.get();
+        reader_ = std::move(cached_reader);
     } else {
         reader_ = std::move(base_reader);
     }
@@ -77,66 +232,540 @@ void GCSFS::loadFileList() const
     // Kept for compatibility but does nothing
 }
 
-bool GCSFS::isValidPath(const std::string& path) const
+std::optional<StatCache::StatInfo> GCSFS::lookupPath(const std::string& path, int* error) const
 {
-    if (path == root_path_) return true;
+    if (error) {
+        *error = -ENOENT;
+    }
+    StatCache::StatInfo info;
+    if (path == root_path_) {
+        info.mode = S_IFDIR | 0755;
+        info.is_directory = true;
+        info.metadata_loaded = true;
+        return info;
+    }
+    
+    // Upload temporaries are not files of the mount, even while they exist
+    if (isCompositePartPath(path)) {
+        return std::nullopt;
+    }
     
-    // Check stat cache first
+    // Check stat cache first, including paths known to be missing
     if (config_.enable_stat_cache) {
         auto cached = stat_cache_.getStat(path);
         if (cached.has_value()) {
-            return true;
+            if (config_.debug_mode) {
+                std::cout << "[DEBUG] ✓ Stat cache HIT for: " << path
+                          << (cached->stale ? " (stale, revalidating)" : "") << std::endl;
+            }
+            if (cached->stale) {
+                countEvent(gcscfuse::MetricCounter::StatCacheStaleHits);
+                revalidatePath(path);
+            } else {
+                countEvent(gcscfuse::MetricCounter::StatCacheHits);
+            }
+            return cached;
+        }
+        if (stat_cache_.isKnownMissing(path)) {
+            if (config_.debug_mode) {
+                std::cout << "[DEBUG] ✓ Negative stat cache HIT for: " << path << std::endl;
+            }
+            countEvent(gcscfuse::MetricCounter::StatCacheNegativeHits);
+            return std::nullopt;
+        }
+        if (config_.debug_mode) {
+            std::cout << "[DEBUG] ✗ Stat cache MISS for: " << path << " (expired or not cached)" << std::endl;
+        }
+        countEvent(gcscfuse::MetricCounter::StatCacheMisses);
+        if (config_.batch_metadata_lookups) {
+            return fetchPathBatched(path, error);
         }
     }
     
-    std::string object_name = path;
-    if (!object_name.empty() && object_name[0] == '/') {
-        object_name = object_name.substr(1);
+    return fetchPath(path, true, error);
+}
+
+std::optional<StatCache::StatInfo> GCSFS::fetchPathBatched(const std::string& path, int* error) const
+{
+    const std::string parent = parentPath(path);
+    bool concurrent = false;
+    {
+        std::lock_guard<std::mutex> lock(cold_lookups_mutex_);
+        concurrent = cold_lookups_[parent]++ > 0;
     }
     
-    // Check if it's a file by trying to get its metadata
-    if (gcs_client_.objectExists(bucket_name_, object_name)) {
-        return true;
+    // A burst of lookups in one directory (a loader stat'ing its shards, a
+    // tool opening every file) costs one listing rather than a GET each.
+    // Paths the listing did not reach are still fetched on their own.
+    std::optional<StatCache::StatInfo> result;
+    bool resolved = false;
+    if (concurrent) {
+        listForLookups(parent);
+        result = stat_cache_.getStat(path);
+        resolved = result.has_value() || stat_cache_.isKnownMissing(path);
+        if (resolved) {
+            countEvent(gcscfuse::MetricCounter::BatchedLookups);
+            if (config_.debug_mode) {
+                std::cout << "[DEBUG] Lookup answered by listing of " << parent << ": " << path << std::endl;
+            }
+        }
+    }
+    if (!resolved) {
+        result = fetchPath(path, true, error);
     }
     
-    // Check if it's a directory by listing with prefix
+    std::lock_guard<std::mutex> lock(cold_lookups_mutex_);
+    auto it = cold_lookups_.find(parent);
+    if (--it->second == 0) {
+        cold_lookups_.erase(it);
+    }
+    return result;
+}
+
+void GCSFS::listForLookups(const std::string& dir_path) const
+{
+    batch_listings_.run(dir_path, [&] {
+        if (config_.debug_mode) {
+            std::cout << "[DEBUG] Listing " << dir_path << " for concurrent lookups" << std::endl;
+        }
+        // prefetch_subdirectories is off: nobody asked to walk this directory
+        auto dir = startDirectoryListing(dir_path, false);
+        std::lock_guard<std::mutex> lock(dir->mutex);
+        fillDirectoryListing(*dir, kBatchListingMaxEntries);
+        return true;
+    });
+}
+
+std::optional<StatCache::StatInfo> GCSFS::fetchPath(const std::string& path, bool parallel_probe, int* error) const
+{
+    StatCache::StatInfo info;
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
     std::string dir_prefix = object_name;
     if (!dir_prefix.empty() && dir_prefix.back() != '/') {
         dir_prefix += '/';
     }
     
-    return gcs_client_.directoryExists(bucket_name_, dir_prefix);
+    // The object GET and the prefix listing go out together, so a cold
+    // lookup costs one round trip whichever of the two it turns out to be
+    gcscfuse::GCSClient::ObjectLookup object;
+    gcscfuse::GCSClient::DirectoryLookup directory;
+    if (parallel_probe) {
+        auto dir_probe = async_gcs_client_.lookupDirectory(bucket_name_, dir_prefix);
+        object = gcs_client_.lookupObject(bucket_name_, object_name);
+        directory = dir_probe.get();
+    } else {
+        object = gcs_client_.lookupObject(bucket_name_, object_name);
+        if (!object.metadata && !object.failed) {
+            directory = gcs_client_.lookupDirectory(bucket_name_, dir_prefix);
+        }
+    }
+    
+    // An object wins over a directory of the same name, so a failed GET
+    // leaves the answer open whatever the listing found
+    if (object.metadata.has_value()) {
+        return cacheFileMetadata(path, *object.metadata);
+    }
+    if (object.failed) {
+        return lookupFailed(path, error);
+    }
+    
+    if (directory.exists) {
+        info.mode = S_IFDIR | 0755;
+        info.mtime = time(nullptr);
+        info.is_directory = true;
+        info.metadata_loaded = true;
+        if (config_.enable_stat_cache) {
+            stat_cache_.insertDirectory(path);
+        }
+        return info;
+    }
+    if (directory.failed) {
+        return lookupFailed(path, error);
+    }
+    
+    // Only a confirmed miss is recorded
+    if (config_.enable_stat_cache) {
+        // Drop whatever was cached (e.g. a stale snapshot entry) before
+        // recording the miss
+        stat_cache_.remove(path);
+        stat_cache_.insertNegative(path);
+    }
+    return std::nullopt;
 }
 
-bool GCSFS::isDirectory(const std::string& path) const
+std::optional<StatCache::StatInfo> GCSFS::lookupFailed(const std::string& path, int* error) const
 {
-    if (path == root_path_) return true;
-    
-    // Check stat cache first
+    // Whatever is cached stays, and nothing is recorded as missing: a
+    // transient GCS error must not make the file vanish for the negative
+    // TTL, here or in the kernel
+    std::cerr << "Lookup of " << path << " failed" << std::endl;
+    if (error) {
+        *error = -EIO;
+    }
+    return std::nullopt;
+}
+
+bool GCSFS::beginRevalidation(const std::string& key) const
+{
+    std::lock_guard<std::mutex> lock(revalidate_mutex_);
+    return revalidating_.insert(key).second;
+}
+
+void GCSFS::endRevalidation(const std::string& key) const
+{
+    std::lock_guard<std::mutex> lock(revalidate_mutex_);
+    revalidating_.erase(key);
+}
+
+StatCache::StatInfo GCSFS::cacheFileMetadata(const std::string& path, const gcscfuse::ObjectMetadata& obj_meta) const
+{
+    StatCache::StatInfo info;
+    info.mode = S_IFREG | 0644;
+    info.size = static_cast<off_t>(obj_meta.size);
+    info.mtime = std::chrono::system_clock::to_time_t(obj_meta.updated);
+    info.generation = obj_meta.generation;
+    info.metageneration = obj_meta.metageneration;
+    info.crc32c = obj_meta.crc32c;
+    info.metadata_loaded = true;
+    info.cache_time = time(nullptr);
     if (config_.enable_stat_cache) {
-        auto cached = stat_cache_.getStat(path);
-        if (cached.has_value() && cached->is_directory) {
-            return true;
+        auto previous = stat_cache_.getStat(path);
+        stat_cache_.insertFile(path, info.size, info.mtime, info.generation, info.metageneration, info.crc32c);
+        // Replaced in GCS: blocks of the old generation would only be dropped
+        // when a pinned read reaches them, so let them go now
+        if (previous && previous->generation != 0 && info.generation != 0 &&
+            previous->generation != info.generation) {
+            if (config_.debug_mode) {
+                std::cout << "[DEBUG] Generation of " << path << " changed from " << previous->generation
+                          << " to " << info.generation << std::endl;
+            }
+            std::string object_name = path;
+            if (!object_name.empty() && object_name[0] == '/') {
+                object_name = object_name.substr(1);
+            }
+            reader_->invalidate(object_name);
         }
     }
+    return info;
+}
+
+std::optional<StatCache::StatInfo> GCSFS::refreshPath(const std::string& path) const
+{
+    auto cached = config_.enable_stat_cache ? stat_cache_.getStat(path) : std::nullopt;
+    if (!cached || cached->is_directory || cached->generation == 0) {
+        return fetchPath(path, false);
+    }
     
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
         object_name = object_name.substr(1);
     }
+    auto check = gcs_client_.checkObject(bucket_name_, object_name, cached->generation);
+    if (check.unchanged) {
+        countEvent(gcscfuse::MetricCounter::GenerationChecksUnchanged);
+        stat_cache_.insertFile(path, cached->size, cached->mtime, cached->generation,
+                               cached->metageneration, cached->crc32c);
+        cached->stale = false;
+        return cached;
+    }
+    if (check.metadata) {
+        countEvent(gcscfuse::MetricCounter::GenerationChecksChanged);
+        return cacheFileMetadata(path, *check.metadata);
+    }
+    // Gone, or the check failed: look the path up afresh
+    return fetchPath(path, false);
+}
+
+void GCSFS::revalidatePath(const std::string& path) const
+{
+    if (!beginRevalidation(path)) {
+        return;
+    }
+    // Bulk priority, so refreshes never hold up lookups someone is waiting on
+    async_gcs_client_.submit(gcscfuse::RequestPriority::Bulk, [this, path] {
+        refreshPath(path);
+        endRevalidation(path);
+    });
+}
+
+void GCSFS::revalidateListing(const std::string& path) const
+{
+    const std::string key = path + "/";
+    if (!beginRevalidation(key)) {
+        return;
+    }
+    async_gcs_client_.submit(gcscfuse::RequestPriority::Bulk, [this, path, key] {
+        auto dir = startDirectoryListing(path, false, false);
+        {
+            std::lock_guard<std::mutex> lock(dir->mutex);
+            fillDirectoryListing(*dir, std::numeric_limits<size_t>::max());
+        }
+        endRevalidation(key);
+    });
+}
+
+void GCSFS::saveSnapshot() const
+{
+    if (snapshot_path_.empty()) {
+        return;
+    }
+    const bool saved = stat_cache_.saveSnapshot(snapshot_path_, bucket_name_);
+    if (saved && config_.debug_mode) {
+        std::cout << "[DEBUG] Saved " << stat_cache_.size() << " stat cache entries to "
+                  << snapshot_path_ << std::endl;
+    }
+}
+
+void GCSFS::stopSnapshots()
+{
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex_);
+        stop_snapshots_ = true;
+    }
+    snapshot_cv_.notify_all();
+    if (snapshot_thread_.joinable()) {
+        snapshot_thread_.join();
+    }
+}
+
+int GCSFS::checkPath(const std::string& path) const
+{
+    int error = 0;
+    return lookupPath(path, &error).has_value() ? 0 : error;
+}
+
+bool GCSFS::isStatsPath(const char *path) const
+{
+    if (!config_.enable_metrics) {
+        return false;
+    }
+    const std::string_view name(path);
+    const std::string_view dir(kStatsDir);
+    return name.substr(0, dir.size()) == dir && (name.size() == dir.size() || name[dir.size()] == '/');
+}
+
+bool GCSFS::isCompositePartPath(const std::string& path)
+{
+    std::string_view name(path);
+    if (!name.empty() && name[0] == '/') {
+        name.remove_prefix(1);
+    }
+    std::string_view dir(gcscfuse::GCSClient::kCompositePartPrefix);
+    dir.remove_suffix(1);  // trailing '/'
+    return name.substr(0, dir.size()) == dir && (name.size() == dir.size() || name[dir.size()] == '/');
+}
+
+std::string GCSFS::renderStats() const
+{
+    std::ostringstream out;
+    gcscfuse::Metrics::global().render(out);
     
-    // Check if any objects exist with this prefix
-    std::string dir_prefix = object_name;
-    if (!dir_prefix.empty() && dir_prefix.back() != '/') {
-        dir_prefix += '/';
+    // Cache state is kept by the caches themselves and read when rendering
+    const auto stat_evictions = stat_cache_.evictionStats();
+    const auto content_stats = content_cache_ ? content_cache_->stats() : gcscfuse::ContentCache::Stats{};
+    const auto disk_stats = disk_cache_ ? disk_cache_->stats() : gcscfuse::DiskCache::Stats{};
+    
+    gcscfuse::writeMetricHeader(out, "gcscfuse_cache_hits_total", "counter", "Content block lookups served by a cache tier.");
+    if (content_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_hits_total", "cache=\"content\"", content_stats.hits);
+    }
+    if (disk_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_hits_total", "cache=\"disk\"", disk_stats.hits);
+    }
+    gcscfuse::writeMetricHeader(out, "gcscfuse_cache_misses_total", "counter", "Content block lookups a cache tier could not serve.");
+    if (content_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_misses_total", "cache=\"content\"", content_stats.misses);
+    }
+    if (disk_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_misses_total", "cache=\"disk\"", disk_stats.misses);
+    }
+    gcscfuse::writeMetricHeader(out, "gcscfuse_cache_evictions_total", "counter", "Entries dropped to stay within a cache budget.");
+    gcscfuse::writeSample(out, "gcscfuse_cache_evictions_total", "cache=\"stat\"", stat_evictions.evicted);
+    if (content_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_evictions_total", "cache=\"content\"", content_stats.evictions);
+    }
+    if (disk_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_evictions_total", "cache=\"disk\"", disk_stats.evictions);
+    }
+    gcscfuse::writeMetricHeader(out, "gcscfuse_cache_bytes", "gauge", "Bytes held by a content cache tier.");
+    if (content_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_bytes", "cache=\"content\"", content_cache_->sizeBytes());
+    }
+    if (disk_cache_) {
+        gcscfuse::writeSample(out, "gcscfuse_cache_bytes", "cache=\"disk\"", disk_cache_->sizeBytes());
+    }
+    
+    if (cached_reader_) {
+        const auto fetches = cached_reader_->strategyStats();
+        gcscfuse::writeMetricHeader(out, "gcscfuse_content_fetches_total", "counter", "Content cache misses fetched, by strategy.");
+        gcscfuse::writeSample(out, "gcscfuse_content_fetches_total", "strategy=\"block\"", fetches.blocks);
+        gcscfuse::writeSample(out, "gcscfuse_content_fetches_total", "strategy=\"whole_object\"", fetches.whole_objects);
+        gcscfuse::writeSample(out, "gcscfuse_content_fetches_total", "strategy=\"range\"", fetches.ranges);
+        gcscfuse::writeMetricHeader(out, "gcscfuse_content_range_bytes_total", "counter", "Bytes fetched by random-read ranges.");
+        gcscfuse::writeSample(out, "gcscfuse_content_range_bytes_total", "", fetches.range_bytes);
+        gcscfuse::writeMetricHeader(out, "gcscfuse_small_file_prefetches_total", "counter", "Small files cached when their directory was listed.");
+        gcscfuse::writeSample(out, "gcscfuse_small_file_prefetches_total", "", fetches.prefetches);
+    }
+    
+    gcscfuse::writeMetricHeader(out, "gcscfuse_stat_cache_expired_total", "counter", "Stat cache entries pruned after expiring.");
+    gcscfuse::writeSample(out, "gcscfuse_stat_cache_expired_total", "", stat_evictions.expired);
+    gcscfuse::writeMetricHeader(out, "gcscfuse_stat_cache_entries", "gauge", "Paths held by the stat cache.");
+    gcscfuse::writeSample(out, "gcscfuse_stat_cache_entries", "", stat_cache_.size());
+    gcscfuse::writeMetricHeader(out, "gcscfuse_stat_cache_memory_bytes", "gauge", "Memory used by the stat cache.");
+    gcscfuse::writeSample(out, "gcscfuse_stat_cache_memory_bytes", "", stat_cache_.memoryStats().bytes());
+    
+    size_t write_buffer_bytes = 0;
+    std::uint64_t write_buffer_evictions = 0;
+    {
+        std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+        write_buffer_bytes = write_buffer_bytes_;
+        write_buffer_evictions = write_buffer_evictions_;
+    }
+    gcscfuse::writeMetricHeader(out, "gcscfuse_write_buffer_bytes", "gauge", "Memory held by write buffers.");
+    gcscfuse::writeSample(out, "gcscfuse_write_buffer_bytes", "", write_buffer_bytes);
+    gcscfuse::writeMetricHeader(out, "gcscfuse_write_buffer_evictions_total", "counter", "Clean write buffers dropped to stay within budget.");
+    gcscfuse::writeSample(out, "gcscfuse_write_buffer_evictions_total", "", write_buffer_evictions);
+    
+    if (write_back_) {
+        const auto write_back = write_back_->stats();
+        gcscfuse::writeMetricHeader(out, "gcscfuse_write_back_uploads_total", "counter", "Background uploads of closed files, by outcome.");
+        gcscfuse::writeSample(out, "gcscfuse_write_back_uploads_total", "result=\"ok\"", write_back.uploaded);
+        gcscfuse::writeSample(out, "gcscfuse_write_back_uploads_total", "result=\"failed\"", write_back.failed);
+        gcscfuse::writeMetricHeader(out, "gcscfuse_write_back_coalesced_total", "counter", "Closes whose upload was already queued.");
+        gcscfuse::writeSample(out, "gcscfuse_write_back_coalesced_total", "", write_back.coalesced);
+        gcscfuse::writeMetricHeader(out, "gcscfuse_write_back_throttled_total", "counter", "Closes that waited for queued uploads to fit write_back_dirty_mb.");
+        gcscfuse::writeSample(out, "gcscfuse_write_back_throttled_total", "", write_back.throttled);
+        gcscfuse::writeMetricHeader(out, "gcscfuse_write_back_pending_bytes", "gauge", "Bytes queued or being uploaded in the background.");
+        gcscfuse::writeSample(out, "gcscfuse_write_back_pending_bytes", "", write_back.pending_bytes);
     }
     
-    return gcs_client_.directoryExists(bucket_name_, dir_prefix);
+    gcscfuse::writeMetricHeader(out, "gcscfuse_gcs_requests_queued", "gauge", "GCS requests waiting for a slot in the request pool.");
+    gcscfuse::writeSample(out, "gcscfuse_gcs_requests_queued", "", async_gcs_client_.scheduler().queued());
+    return out.str();
+}
+
+int GCSFS::readStatsFile(std::uint64_t handle, char *buf, size_t size, off_t offset) const
+{
+    std::shared_ptr<const std::string> content;
+    {
+        std::lock_guard<std::mutex> lock(stats_files_mutex_);
+        auto it = stats_files_.find(handle);
+        if (it != stats_files_.end()) {
+            content = it->second;
+        }
+    }
+    if (!content) {
+        return -EBADF;
+    }
+    if (offset < 0 || static_cast<size_t>(offset) >= content->size()) {
+        return 0;
+    }
+    const size_t n = std::min(size, content->size() - static_cast<size_t>(offset));
+    memcpy(buf, content->data() + offset, n);
+    return static_cast<int>(n);
+}
+
+std::shared_mutex& GCSFS::objectLock(const std::string& object_name) const
+{
+    return object_locks_[std::hash<std::string>{}(object_name) % kObjectLockStripes];
+}
+
+void *GCSFS::init(struct fuse_conn_info *conn, struct fuse_config *cfg)
+{
+    const auto ptr = this_();
+    
+    // Let write payloads and read replies move through a pipe, so data
+    // going to or from local files is not copied through user space
+    conn->want |= conn->capable & (FUSE_CAP_SPLICE_READ | FUSE_CAP_SPLICE_WRITE);
+    
+    // Let the kernel keep entries and attributes as long as the stat cache
+    // would, so most lookups never reach the daemon. A stat cache without
+    // timeout maps to a day.
+    if (ptr->config_.enable_stat_cache) {
+        const double ttl = ptr->config_.stat_cache_timeout > 0
+            ? static_cast<double>(ptr->config_.stat_cache_timeout) : 86400.0;
+        cfg->entry_timeout = ttl;
+        cfg->attr_timeout = ttl;
+        cfg->negative_timeout = static_cast<double>(ptr->config_.negative_stat_cache_timeout);
+        if (ptr->config_.debug_mode) {
+            std::cout << "[DEBUG] Kernel entry/attr timeout: " << ttl << "s, negative: "
+                      << cfg->negative_timeout << "s" << std::endl;
+        }
+    }
+    
+    // Warm start: entries from the last run are served as stale and
+    // revalidated as they are used
+    if (!ptr->snapshot_path_.empty()) {
+        size_t loaded = ptr->stat_cache_.loadSnapshot(ptr->snapshot_path_, ptr->bucket_name_);
+        if (ptr->config_.debug_mode) {
+            std::cout << "[DEBUG] Loaded " << loaded << " stat cache entries from "
+                      << ptr->snapshot_path_ << std::endl;
+        }
+    }
+    
+    // Threads started before FUSE daemonizes would not survive the fork
+    if (ptr->config_.enable_stat_cache) {
+        ptr->stat_cache_.startSweeper(ptr->config_.stat_cache_sweep_interval);
+    }
+    if (!ptr->snapshot_path_.empty() && ptr->config_.metadata_snapshot_interval > 0) {
+        ptr->snapshot_thread_ = std::thread([ptr] {
+            const auto interval = std::chrono::seconds(ptr->config_.metadata_snapshot_interval);
+            std::unique_lock<std::mutex> lock(ptr->snapshot_mutex_);
+            while (!ptr->snapshot_cv_.wait_for(lock, interval, [ptr] { return ptr->stop_snapshots_; })) {
+                lock.unlock();
+                ptr->saveSnapshot();
+                lock.lock();
+            }
+        });
+    }
+    if (ptr->config_.enable_stat_cache && ptr->config_.warm_tree_prefetch_dirs > 0) {
+        ptr->dir_prefetcher_ = std::make_unique<gcscfuse::DirectoryPrefetcher>(
+            [ptr](const std::string& dir_path) { ptr->prefetchDirectory(dir_path); },
+            static_cast<size_t>(ptr->config_.warm_tree_prefetch_dirs),
+            static_cast<size_t>(ptr->config_.warm_tree_concurrency));
+        if (ptr->config_.debug_mode) {
+            std::cout << "[DEBUG] Warm-tree prefetch: " << ptr->config_.warm_tree_prefetch_dirs
+                      << " directories, " << ptr->config_.warm_tree_concurrency << " at once" << std::endl;
+        }
+    }
+    
+    if (ptr->config_.enable_write_back) {
+        ptr->write_back_ = std::make_unique<gcscfuse::WriteBackQueue>(
+            [ptr](const std::string& object_name) { return ptr->writeBack(object_name); },
+            static_cast<size_t>(ptr->config_.write_back_dirty_mb) * 1024 * 1024,
+            static_cast<size_t>(ptr->config_.write_back_workers));
+        if (ptr->config_.debug_mode) {
+            std::cout << "[DEBUG] Write-back: " << ptr->config_.write_back_workers << " uploads at once, "
+                      << ptr->config_.write_back_dirty_mb << " MiB queued before close blocks" << std::endl;
+        }
+    }
+    
+    // The return value becomes private_data; keep it pointing at this
+    return ptr;
+}
+
+void GCSFS::destroy(void *private_data)
+{
+    const auto ptr = static_cast<GCSFS *>(private_data);
+    if (ptr->write_back_) {
+        ptr->write_back_->drain();
+    }
+    ptr->stopSnapshots();
+    ptr->saveSnapshot();
+}
+
+GCSFS::~GCSFS()
+{
+    stopSnapshots();
 }
 
 int GCSFS::getattr(const char *path, struct stat *stbuf, struct fuse_file_info *)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Getattr);
     
     memset(stbuf, 0, sizeof(struct stat));
     
@@ -147,17 +776,33 @@ int GCSFS::getattr(const char *path, struct stat *stbuf, struct fuse_file_info *
         return 0;
     }
     
+    // The stats file is rendered when opened and read with direct I/O, so
+    // like a /proc file it reports size 0
+    if (ptr->isStatsPath(path)) {
+        if (strcmp(path, kStatsDir) == 0) {
+            stbuf->st_mode = S_IFDIR | 0555;
+            stbuf->st_nlink = 2;
+        } else if (strcmp(path, kStatsFile) == 0) {
+            stbuf->st_mode = S_IFREG | 0444;
+            stbuf->st_nlink = 1;
+        } else {
+            return -ENOENT;
+        }
+        stbuf->st_mtime = time(nullptr);
+        return 0;
+    }
+    
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
         object_name = object_name.substr(1);
     }
     
     // 1. Check write buffer first (for dirty/modified files)
-    auto wb_it = ptr->write_buffers_.find(object_name);
-    if (wb_it != ptr->write_buffers_.end()) {
+    std::shared_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
+    if (auto buffer = ptr->findWriteBuffer(object_name)) {
         stbuf->st_mode = S_IFREG | 0644;
         stbuf->st_nlink = 1;
-        stbuf->st_size = static_cast<off_t>(wb_it->second.length());
+        stbuf->st_size = static_cast<off_t>(buffer->length());
         stbuf->st_mtime = time(nullptr);
         if (ptr->config_.debug_mode) {
             std::cout << "[DEBUG] getattr from write buffer: " << path << std::endl;
@@ -165,66 +810,155 @@ int GCSFS::getattr(const char *path, struct stat *stbuf, struct fuse_file_info *
         return 0;
     }
     
-    // 2. Try to get stat from cache (if enabled)
-    if (ptr->config_.enable_stat_cache) {
-        auto cached_stat = ptr->stat_cache_.getStat(path);
-        if (cached_stat.has_value()) {
-            const auto& info = cached_stat.value();
-            stbuf->st_mode = info.mode;
-            stbuf->st_nlink = info.is_directory ? 2 : 1;
-            stbuf->st_size = info.size;
-            stbuf->st_mtime = info.mtime;
-            
-            if (ptr->config_.debug_mode) {
-                std::cout << "[DEBUG] ✓ Stat cache HIT for: " << path << std::endl;
-            }
-            return 0;
-        } else if (ptr->config_.debug_mode) {
-            std::cout << "[DEBUG] ✗ Stat cache MISS for: " << path << " (expired or not cached)" << std::endl;
-        }
+    off_t pending_size = -1;
+    if (auto stream = ptr->findStreamingWrite(object_name)) {
+        pending_size = static_cast<off_t>(stream->bytesWritten());
+    } else if (auto staged = ptr->findStagedWrite(object_name)) {
+        pending_size = static_cast<off_t>(staged->size());
+    } else if (auto chunked = ptr->findChunkedWrite(object_name)) {
+        pending_size = static_cast<off_t>(chunked->size());
     }
-    
-    // 3. Not in write buffer or cache - fetch from GCS and populate cache
-    if (!ptr->isValidPath(path)) {
-        return -ENOENT;
+    if (pending_size >= 0) {
+        stbuf->st_mode = S_IFREG | 0644;
+        stbuf->st_nlink = 1;
+        stbuf->st_size = pending_size;
+        stbuf->st_mtime = time(nullptr);
+        return 0;
     }
+    object_lock.unlock();
     
-    // Check if it's a directory
-    if (ptr->isDirectory(path)) {
-        stbuf->st_mode = S_IFDIR | 0755;
-        stbuf->st_nlink = 2;
-        
-        // Populate stat cache for directory
-        if (ptr->config_.enable_stat_cache) {
-            ptr->stat_cache_.insertDirectory(path);
+    // 2. Stat cache, or a single lookup in GCS that populates it
+    int error = 0;
+    auto info = ptr->lookupPath(path, &error);
+    if (!info.has_value()) {
+        return error;
+    }
+    fillStat(*info, stbuf);
+    return 0;
+}
+
+int GCSFS::opendir(const char *path, struct fuse_file_info *fi)
+{
+    const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Opendir);
+    fi->fh = ptr->next_file_handle_++;
+    return 0;
+}
+
+int GCSFS::readdir(const char *path, void *buf, fuse_fill_dir_t filler,
+                   off_t offset, struct fuse_file_info *fi, enum fuse_readdir_flags flags)
+{
+    const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Readdir);
+    const std::uint64_t handle = fi ? fi->fh : 0;
+    
+    if (ptr->isStatsPath(path)) {
+        if (offset == 0) {
+            filler(buf, ".", nullptr, 0, static_cast<enum fuse_fill_dir_flags>(0));
+            filler(buf, "..", nullptr, 0, static_cast<enum fuse_fill_dir_flags>(0));
+            filler(buf, "stats", nullptr, 0, static_cast<enum fuse_fill_dir_flags>(0));
         }
         return 0;
     }
     
-    // It's a file - fetch metadata from GCS
-    stbuf->st_mode = S_IFREG | 0644;
-    stbuf->st_nlink = 1;
-    
-    auto obj_meta = ptr->gcs_client_.getObjectMetadata(ptr->bucket_name_, object_name);
-    if (!obj_meta.has_value()) {
-        return -ENOENT;
+    // A listing is started when reading starts; later calls continue the
+    // same listing at the offset the kernel hands back
+    std::shared_ptr<DirectoryHandle> dir;
+    if (offset > 0 && handle != 0) {
+        std::lock_guard<std::mutex> lock(ptr->dir_listings_mutex_);
+        auto it = ptr->dir_listings_.find(handle);
+        if (it != ptr->dir_listings_.end()) {
+            dir = it->second;
+        }
+    }
+    if (!dir) {
+        dir = ptr->startDirectoryListing(path, true);
+        if (handle != 0) {
+            std::lock_guard<std::mutex> lock(ptr->dir_listings_mutex_);
+            ptr->dir_listings_[handle] = dir;
+        }
     }
     
-    stbuf->st_size = static_cast<off_t>(obj_meta->size);
-    stbuf->st_mtime = std::chrono::system_clock::to_time_t(obj_meta->updated);
-    
-    // Populate stat cache for future requests
-    if (ptr->config_.enable_stat_cache) {
-        ptr->stat_cache_.insertFile(path, stbuf->st_size, stbuf->st_mtime);
+    // Offsets: 0 is ".", 1 is "..", 2 + i is listing entry i. Each entry is
+    // passed the offset of the next one; filler returns 1 once the kernel
+    // buffer is full, and the next call resumes there.
+    std::lock_guard<std::mutex> dir_lock(dir->mutex);
+    const bool plus = (flags & FUSE_READDIR_PLUS) != 0;
+    for (off_t pos = std::max<off_t>(offset, 0); ; ++pos) {
+        int full = 0;
+        if (pos < 2) {
+            full = filler(buf, pos == 0 ? "." : "..", nullptr, pos + 1, static_cast<enum fuse_fill_dir_flags>(0));
+        } else {
+            const size_t index = static_cast<size_t>(pos - 2);
+            if (index >= dir->entries.size()) {
+                int result = ptr->fillDirectoryListing(*dir, index + 1);
+                if (result != 0) {
+                    // Entries filled in by this call are returned first; the
+                    // error comes with the next call, which resumes here
+                    if (pos > std::max<off_t>(offset, 0)) {
+                        break;
+                    }
+                    return result;
+                }
+                if (index >= dir->entries.size()) {
+                    break;
+                }
+            }
+            
+            // With readdirplus the kernel caches these attributes, which
+            // spares a getattr per entry (e.g. for ls -l)
+            const DirectoryEntry& entry = dir->entries[index];
+            const bool with_stat = plus && entry.has_stat;
+            full = filler(buf, entry.name.c_str(), with_stat ? &entry.st : nullptr, pos + 1,
+                          with_stat ? FUSE_FILL_DIR_PLUS : static_cast<enum fuse_fill_dir_flags>(0));
+        }
+        if (full) {
+            break;
+        }
     }
     
     return 0;
 }
 
-int GCSFS::readdir(const char *path, void *buf, fuse_fill_dir_t filler,
-                   off_t, struct fuse_file_info *, enum fuse_readdir_flags)
+int GCSFS::releasedir(const char *, struct fuse_file_info *fi)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Releasedir);
+    if (fi && fi->fh != 0) {
+        std::lock_guard<std::mutex> lock(ptr->dir_listings_mutex_);
+        ptr->dir_listings_.erase(fi->fh);
+    }
+    return 0;
+}
+
+std::shared_ptr<GCSFS::DirectoryHandle> GCSFS::startDirectoryListing(
+    const std::string& path, bool prefetch_subdirectories, bool use_cache) const
+{
+    auto dir = std::make_shared<DirectoryHandle>();
+    dir->path = path;
+    dir->prefetch_subdirectories = prefetch_subdirectories;
+    
+    // Repeated ls/find within the TTL never reach GCS
+    if (use_cache && config_.enable_stat_cache && stat_cache_.isListingFresh(path)) {
+        const bool stale = stat_cache_.isListingStale(path);
+        if (config_.debug_mode) {
+            std::cout << "[DEBUG] ✓ Listing cache HIT for: " << path
+                      << (stale ? " (stale, revalidating)" : "") << std::endl;
+        }
+        if (stale) {
+            countEvent(gcscfuse::MetricCounter::ListingCacheStaleHits);
+            revalidateListing(path);
+        } else {
+            countEvent(gcscfuse::MetricCounter::ListingCacheHits);
+        }
+        dir->entries = toDirectoryEntries(stat_cache_.listDirectoryWithStats(path));
+        prefetchSubdirectories(*dir);
+        return dir;
+    }
+    
+    if (use_cache && config_.enable_stat_cache) {
+        countEvent(gcscfuse::MetricCounter::ListingCacheMisses);
+    }
     
     std::string dir_path = path;
     if (!dir_path.empty() && dir_path[0] == '/') {
@@ -236,86 +970,194 @@ int GCSFS::readdir(const char *path, void *buf, fuse_fill_dir_t filler,
         dir_path += '/';
     }
     
-    filler(buf, ".", nullptr, 0, FUSE_FILL_DIR_PLUS);
-    filler(buf, "..", nullptr, 0, FUSE_FILL_DIR_PLUS);
-    
     // Lazy load: List objects with this directory as prefix
-    if (ptr->config_.debug_mode) {
+    if (config_.debug_mode) {
         std::cout << "[DEBUG] Listing directory: " << (dir_path.empty() ? "/" : dir_path) << std::endl;
     }
     
-    // Track subdirectories and files at this level
-    std::set<std::string> entries;
+    // List objects with this directory prefix and delimiter to get immediate children
+    dir->prefix = dir_path;
+    dir->lister = gcs_client_.openListing(bucket_name_, dir_path, "/");
+    return dir;
+}
+
+int GCSFS::fillDirectoryListing(DirectoryHandle& dir, size_t count) const
+{
+    while (dir.lister && dir.entries.size() < count) {
+        auto obj_meta = dir.lister->next();
+        if (obj_meta) {
+            addListedObject(dir, *obj_meta);
+            continue;
+        }
+        
+        if (dir.lister->failed()) {
+            // Entries already handed out stay valid, but an incomplete
+            // listing is never cached as the directory's contents
+            dir.lister.reset();
+            dir.failed = true;
+            break;
+        }
+        finishDirectoryListing(dir);
+    }
+    // Reading past what was listed before the failure is an error, never
+    // the end of the directory
+    return dir.failed && dir.entries.size() < count ? -EIO : 0;
+}
+
+void GCSFS::addListedObject(DirectoryHandle& dir, const gcscfuse::ObjectMetadata& obj_meta) const
+{
+    // Remove directory prefix
+    std::string entry_name = obj_meta.name.substr(std::min(dir.prefix.length(), obj_meta.name.size()));
+    
+    // Subdirectories come back as one prefix ("sub/") however much is below
+    // them; objects are the files directly in this directory
+    const bool is_subdir = obj_meta.is_directory;
+    if (is_subdir && !entry_name.empty() && entry_name.back() == '/') {
+        entry_name.pop_back();
+    }
+    
+    // Skip the directory's own marker object and anything malformed. Pages
+    // list objects and prefixes separately, so a file and a subdirectory of
+    // the same name can arrive apart; the first one wins.
+    if (entry_name.empty() || entry_name.find('/') != std::string::npos ||
+        isCompositePartPath(childPath(dir.path, entry_name)) || !dir.names.insert(entry_name).second) {
+        return;
+    }
     
-    try {
-        // List objects with this directory prefix and delimiter to get immediate children
-        auto objects = ptr->gcs_client_.listObjects(ptr->bucket_name_, dir_path, "/");
+    DirectoryEntry entry;
+    entry.name = entry_name;
+    entry.has_stat = true;
+    if (is_subdir) {
+        entry.st.st_mode = S_IFDIR | 0755;
+        entry.st.st_nlink = 2;
+    } else {
+        entry.st.st_mode = S_IFREG | 0644;
+        entry.st.st_nlink = 1;
+        entry.st.st_size = static_cast<off_t>(obj_meta.size);
+        entry.st.st_mtime = std::chrono::system_clock::to_time_t(obj_meta.updated);
+        entry.generation = obj_meta.generation;
+    }
+    
+    // Populate stat cache
+    if (config_.enable_stat_cache) {
+        std::string full_path = childPath(dir.path, entry_name);
+        if (is_subdir) {
+            stat_cache_.insertDirectory(full_path);
+        } else {
+            cacheFileMetadata(full_path, obj_meta);
+        }
+    }
+    
+    if (config_.debug_mode) {
+        std::cout << "[DEBUG] Found entry: " << entry_name 
+                  << (is_subdir ? " (dir)" : " (file)") << std::endl;
+    }
+    dir.entries.push_back(std::move(entry));
+}
+
+void GCSFS::finishDirectoryListing(DirectoryHandle& dir) const
+{
+    dir.lister.reset();
+    
+    if (config_.enable_stat_cache) {
+        // Files and subdirectories are both listed, so a child missing from
+        // the listing is known not to exist until the listing goes stale
+        stat_cache_.markDirectoryListed(dir.path, true, dir.entries.size());
         
-        for (const auto& obj_meta : objects) {
-            std::string name = obj_meta.name;
-            
-            // Remove directory prefix
-            std::string relative = dir_path.empty() ? name : name.substr(dir_path.length());
-            
-            // Skip if empty or is a directory marker (ends with /)
-            if (relative.empty() || relative.back() == '/') {
-                continue;
-            }
-            
-            // Find first slash to determine if subdirectory or file
-            size_t slash_pos = relative.find('/');
-            std::string entry_name;
-            bool is_subdir = false;
-            
-            if (slash_pos != std::string::npos) {
-                // Subdirectory
-                entry_name = relative.substr(0, slash_pos);
-                is_subdir = true;
-            } else {
-                // File in this directory
-                entry_name = relative;
-                is_subdir = false;
-            }
-            
-            if (!entry_name.empty() && entries.find(entry_name) == entries.end()) {
-                entries.insert(entry_name);
-                
-                // Populate stat cache
-                if (ptr->config_.enable_stat_cache) {
-                    std::string full_path = path;
-                    if (full_path != "/" && full_path.back() != '/') {
-                        full_path += "/";
-                    }
-                    full_path += entry_name;
-                    
-                    if (is_subdir) {
-                        ptr->stat_cache_.insertDirectory(full_path);
-                    } else {
-                        off_t size = static_cast<off_t>(obj_meta.size);
-                        time_t mtime = std::chrono::system_clock::to_time_t(obj_meta.updated);
-                        ptr->stat_cache_.insertFile(full_path, size, mtime);
-                    }
-                }
-                
-                if (ptr->config_.debug_mode) {
-                    std::cout << "[DEBUG] Found entry: " << entry_name 
-                              << (is_subdir ? " (dir)" : " (file)") << std::endl;
-                }
-                
-                filler(buf, entry_name.c_str(), nullptr, 0, FUSE_FILL_DIR_PLUS);
+        // Before local files join the entries: only listed objects exist in GCS
+        prefetchSmallFiles(dir);
+        
+        // Files created locally are only in the cache; they go after the
+        // listed entries
+        for (auto& entry : toDirectoryEntries(stat_cache_.listDirectoryWithStats(dir.path))) {
+            if (dir.names.insert(entry.name).second) {
+                dir.entries.push_back(std::move(entry));
             }
         }
-    } catch (const std::exception& e) {
-        std::cerr << "Error listing directory: " << e.what() << std::endl;
-        return -EIO;
     }
     
-    return 0;
+    prefetchSubdirectories(dir);
+}
+
+void GCSFS::prefetchSubdirectories(const DirectoryHandle& dir) const
+{
+    if (!dir_prefetcher_ || !dir.prefetch_subdirectories) {
+        return;
+    }
+    for (const auto& entry : dir.entries) {
+        if (entry.has_stat && S_ISDIR(entry.st.st_mode)) {
+            dir_prefetcher_->schedule(childPath(dir.path, entry.name));
+        }
+    }
+}
+
+void GCSFS::prefetchSmallFiles(const DirectoryHandle& dir) const
+{
+    if (!cached_reader_ || config_.small_file_prefetch_kb <= 0) {
+        return;
+    }
+    const off_t max_size = static_cast<off_t>(config_.small_file_prefetch_kb) * 1024;
+    
+    // A quarter of the content cache per listing, so one directory of
+    // small files cannot push everything else out
+    size_t budget = static_cast<size_t>(config_.max_content_cache_mb) * 1024 * 1024 / 4;
+    for (const auto& entry : dir.entries) {
+        if (!entry.has_stat || !S_ISREG(entry.st.st_mode) ||
+            entry.st.st_size <= 0 || entry.st.st_size > max_size) {
+            continue;
+        }
+        const size_t size = static_cast<size_t>(entry.st.st_size);
+        if (size > budget) {
+            break;
+        }
+        budget -= size;
+        
+        const std::string object_name = dir.prefix + entry.name;
+        const std::int64_t generation = entry.generation;
+        if (cached_reader_->isCached(object_name, 0, generation)) {
+            continue;
+        }
+        async_gcs_client_.submit(gcscfuse::RequestPriority::Bulk, [this, object_name, size, generation] {
+            cached_reader_->prefetch(object_name, size, generation);
+        });
+    }
+}
+
+void GCSFS::prefetchDirectory(const std::string& path) const
+{
+    if (stat_cache_.isListingFresh(path)) {
+        return;
+    }
+    if (config_.debug_mode) {
+        std::cout << "[DEBUG] Prefetching directory: " << path << std::endl;
+    }
+    
+    // Only one level: the prefetched directory's own subdirectories are
+    // scheduled once the walk actually reads it
+    auto dir = startDirectoryListing(path, false);
+    std::lock_guard<std::mutex> lock(dir->mutex);
+    fillDirectoryListing(*dir, std::numeric_limits<size_t>::max());
+}
+
+std::vector<GCSFS::DirectoryEntry> GCSFS::toDirectoryEntries(
+    const std::vector<std::pair<std::string, StatCache::StatInfo>>& children)
+{
+    std::vector<DirectoryEntry> entries(children.size());
+    for (size_t i = 0; i < children.size(); ++i) {
+        entries[i].name = children[i].first;
+        if (children[i].second.metadata_loaded) {
+            fillStat(children[i].second, &entries[i].st);
+            entries[i].generation = children[i].second.generation;
+            entries[i].has_stat = true;
+        }
+    }
+    return entries;
 }
 
 int GCSFS::open(const char *path, struct fuse_file_info *fi)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Open);
     
     // Allow opening files for write
     int flags = fi->flags & O_ACCMODE;
@@ -323,49 +1165,81 @@ int GCSFS::open(const char *path, struct fuse_file_info *fi)
         return -EINVAL;
     }
     
-    // For write access, ensure file exists or can be created
-    if (flags == O_WRONLY || flags == O_RDWR) {
-        if (!ptr->isValidPath(path)) {
-            // File doesn't exist yet - that's okay, create will be called
-            return 0;
-        }
-        
-        if (ptr->isDirectory(path)) {
+    if (ptr->isStatsPath(path)) {
+        if (strcmp(path, kStatsDir) == 0) {
             return -EISDIR;
         }
-    } else {
-        // Read-only access
-        if (!ptr->isValidPath(path)) {
+        if (strcmp(path, kStatsFile) != 0) {
             return -ENOENT;
         }
-        
-        if (ptr->isDirectory(path)) {
-            return -EISDIR;
+        if (flags != O_RDONLY) {
+            return -EACCES;
         }
+        fi->fh = ptr->next_file_handle_++;
+        fi->direct_io = 1;
+        auto content = std::make_shared<const std::string>(ptr->renderStats());
+        std::lock_guard<std::mutex> lock(ptr->stats_files_mutex_);
+        ptr->stats_files_[fi->fh] = std::move(content);
+        return 0;
+    }
+    
+    int error = 0;
+    auto info = ptr->lookupPath(path, &error);
+    if (!info.has_value()) {
+        // For write access the file may not exist yet - create will be
+        // called - unless GCS could not tell
+        if (flags == O_RDONLY || error != -ENOENT) {
+            return error;
+        }
+        fi->fh = ptr->next_file_handle_++;
+        return 0;
+    }
+    if (info->is_directory) {
+        return -EISDIR;
     }
     
+    fi->fh = ptr->next_file_handle_++;
+    
+    // The size lets the reader fetch small objects whole on first read
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
+    ptr->reader_->open(fi->fh, object_name, info->metadata_loaded ? info->size : -1);
+    if (info->generation != 0) {
+        std::lock_guard<std::mutex> lock(ptr->handle_pins_mutex_);
+        ptr->handle_pins_[fi->fh] = HandlePin{object_name, info->generation, info->size, false};
+    }
     return 0;
 }
 
 int GCSFS::read(const char *path, char *buf, size_t size, off_t offset,
-                struct fuse_file_info *)
+                struct fuse_file_info *fi)
 {
     const auto ptr = this_();
     
-    if (!ptr->isValidPath(path)) {
-        return -ENOENT;
+    if (ptr->isStatsPath(path)) {
+        return ptr->readStatsFile(fi ? fi->fh : 0, buf, size, offset);
+    }
+    if (int error = ptr->checkPath(path)) {
+        return error;
     }
     
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
         object_name = object_name.substr(1);
     }
-    
+    return ptr->readContents(path, object_name, buf, size, offset, fi ? fi->fh : 0);
+}
+
+int GCSFS::readContents(const std::string& path, const std::string& object_name,
+                        char *buf, size_t size, off_t offset, std::uint64_t handle) const
+{
     // Check write buffer first (for recently written data)
-    auto wb_it = ptr->write_buffers_.find(object_name);
-    if (wb_it != ptr->write_buffers_.end()) {
-        const std::string& content = wb_it->second;
-        if (ptr->config_.debug_mode) {
+    std::shared_lock<std::shared_mutex> object_lock(objectLock(object_name));
+    if (auto buffer = findWriteBuffer(object_name)) {
+        const std::string& content = *buffer;
+        if (config_.debug_mode) {
             std::cout << "[DEBUG] Reading from write buffer: " << object_name << std::endl;
         }
         size_t len = content.length();
@@ -379,9 +1253,224 @@ int GCSFS::read(const char *path, char *buf, size_t size, off_t offset,
         }
         return static_cast<int>(size);
     }
+    if (auto staged = findStagedWrite(object_name)) {
+        return static_cast<int>(staged->read(buf, size, offset));
+    }
+    if (auto chunked = findChunkedWrite(object_name)) {
+        const auto read_base = baseReader(object_name, chunked->baseGeneration(), chunked->baseSize());
+        return static_cast<int>(chunked->read(buf, size, offset, read_base));
+    }
+    bool streaming = findStreamingWrite(object_name) != nullptr;
+    object_lock.unlock();
+    
+    // Data handed to a streaming upload cannot be read back until the
+    // object is finalized
+    if (streaming) {
+        std::unique_lock<std::shared_mutex> write_lock(objectLock(object_name));
+        int result = finishStreamingWrite(path);
+        if (result != 0) {
+            return result;
+        }
+    }
 
     // Fall back to reader for persistent storage (GCS/Cache)
-    return ptr->reader_->read(object_name, buf, size, offset);
+    return readPinned(path, object_name, buf, size, offset, handle);
+}
+
+int GCSFS::readPinned(const std::string& path, const std::string& object_name,
+                      char *buf, size_t size, off_t offset, std::uint64_t handle) const
+{
+    std::optional<HandlePin> pin;
+    {
+        std::lock_guard<std::mutex> lock(handle_pins_mutex_);
+        auto it = handle_pins_.find(handle);
+        if (it != handle_pins_.end()) {
+            pin = it->second;
+        }
+    }
+    // The readers report errors as -1 or -errno; the kernel gets EIO
+    if (!pin) {
+        int result = reader_->read(object_name, buf, size, offset, handle);
+        return result < 0 ? -EIO : result;
+    }
+    
+    int result = reader_->read(object_name, buf, size, offset, handle, pin->generation);
+    if (result < 0) {
+        return -EIO;
+    }
+    
+    // A pinned read cut short before the end the handle expects may mean
+    // that generation is gone from GCS
+    if (result >= 0 && static_cast<size_t>(result) < size && offset + result < pin->size) {
+        auto info = refreshPath(path);
+        if (info && !info->is_directory && info->generation != 0 && info->generation != pin->generation) {
+            {
+                std::lock_guard<std::mutex> lock(handle_pins_mutex_);
+                auto it = handle_pins_.find(handle);
+                if (it == handle_pins_.end()) {
+                    return result;
+                }
+                if (it->second.served) {
+                    countEvent(gcscfuse::MetricCounter::StaleHandles);
+                    std::cerr << "Open file replaced in GCS: " << object_name << std::endl;
+                    return -ESTALE;
+                }
+                it->second.generation = info->generation;
+                it->second.size = info->size;
+            }
+            reader_->open(handle, object_name, info->size);
+            result = reader_->read(object_name, buf, size, offset, handle, info->generation);
+            if (result < 0) {
+                return -EIO;
+            }
+        }
+    }
+    
+    if (result > 0) {
+        std::lock_guard<std::mutex> lock(handle_pins_mutex_);
+        auto it = handle_pins_.find(handle);
+        if (it != handle_pins_.end()) {
+            it->second.served = true;
+        }
+    }
+    return result;
+}
+
+std::int64_t GCSFS::pinnedGeneration(std::uint64_t handle) const
+{
+    std::lock_guard<std::mutex> lock(handle_pins_mutex_);
+    auto it = handle_pins_.find(handle);
+    return it != handle_pins_.end() ? it->second.generation : 0;
+}
+
+void GCSFS::unpinObject(const std::string& object_name) const
+{
+    std::lock_guard<std::mutex> lock(handle_pins_mutex_);
+    for (auto it = handle_pins_.begin(); it != handle_pins_.end();) {
+        it = it->second.object_name == object_name ? handle_pins_.erase(it) : std::next(it);
+    }
+}
+
+int GCSFS::read_buf(const char *path, struct fuse_bufvec **bufp, size_t size,
+                    off_t offset, struct fuse_file_info *fi)
+{
+    const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Read);
+    
+    // libfuse sends the reply from the returned vector before this worker
+    // thread takes its next request, so anything pinned for the previous
+    // reply on this thread is no longer in use
+    thread_local std::vector<std::shared_ptr<const void>> pinned;
+    pinned.clear();
+    
+    const bool stats_file = ptr->isStatsPath(path);
+    if (!stats_file) {
+        if (int error = ptr->checkPath(path)) {
+            return error;
+        }
+    }
+    
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
+    
+    // Bytes that sit in local files (staging file, disk cache blocks) are
+    // handed to libfuse as descriptors and spliced to the kernel; the rest
+    // goes through one buffer filled by read()
+    std::vector<gcscfuse::FileExtent> extents;
+    size_t covered = 0;
+    bool use_reader = !stats_file;
+    if (use_reader) {
+        std::shared_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
+        if (auto staged = ptr->findStagedWrite(object_name)) {
+            gcscfuse::FileExtent extent;
+            extent.fd = staged->fd();
+            extent.pos = offset;
+            extent.size = static_cast<size_t>(offset) < staged->size()
+                ? std::min(size, staged->size() - static_cast<size_t>(offset)) : 0;
+            extent.owner = staged;
+            covered = size;
+            extents.push_back(std::move(extent));
+            use_reader = false;
+        } else if (ptr->findWriteBuffer(object_name) || ptr->findStreamingWrite(object_name) ||
+                   ptr->findChunkedWrite(object_name)) {
+            use_reader = false;
+        }
+    }
+    
+    const std::int64_t generation = fi ? ptr->pinnedGeneration(fi->fh) : 0;
+    while (use_reader && covered < size) {
+        gcscfuse::FileExtent extent;
+        if (!ptr->reader_->locate(object_name, size - covered, offset + static_cast<off_t>(covered), extent,
+                                  generation)) {
+            break;
+        }
+        if (extent.size == 0) {
+            covered = size;  // EOF
+            break;
+        }
+        covered += extent.size;
+        extents.push_back(std::move(extent));
+    }
+    
+    const size_t remaining = size - covered;
+    const size_t count = std::max<size_t>(1, extents.size() + (remaining > 0 ? 1 : 0));
+    auto *bufv = static_cast<struct fuse_bufvec *>(
+        malloc(sizeof(struct fuse_bufvec) + (count - 1) * sizeof(struct fuse_buf)));
+    if (!bufv) {
+        return -ENOMEM;
+    }
+    *bufv = FUSE_BUFVEC_INIT(0);
+    bufv->count = 0;
+    
+    for (auto& extent : extents) {
+        struct fuse_buf& out = bufv->buf[bufv->count++];
+        out.size = extent.size;
+        out.flags = static_cast<enum fuse_buf_flags>(FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK | FUSE_BUF_FD_RETRY);
+        out.mem = nullptr;
+        out.fd = extent.fd;
+        out.pos = extent.pos;
+        pinned.push_back(std::move(extent.owner));
+    }
+    
+    if (remaining > 0) {
+        // libfuse frees memory buffers with free()
+        char *mem = static_cast<char *>(malloc(remaining));
+        // The path was validated above; read() would look it up again
+        const off_t pos = offset + static_cast<off_t>(covered);
+        const std::uint64_t handle = fi ? fi->fh : 0;
+        int result = !mem ? -ENOMEM
+            : stats_file ? ptr->readStatsFile(handle, mem, remaining, pos)
+            : ptr->readContents(path, object_name, mem, remaining, pos, handle);
+        if (result < 0) {
+            free(mem);
+            if (bufv->count == 0) {
+                free(bufv);
+                return result;
+            }
+            result = 0;  // keep what was already located
+            mem = nullptr;
+        }
+        struct fuse_buf& out = bufv->buf[bufv->count++];
+        out.size = static_cast<size_t>(result);
+        out.flags = static_cast<enum fuse_buf_flags>(0);
+        out.mem = mem;
+        out.fd = -1;
+        out.pos = 0;
+    }
+    
+    if (bufv->count == 0) {
+        bufv->count = 1;  // empty reply
+    }
+    countEvent(gcscfuse::MetricCounter::FuseBytesRead, fuse_buf_size(bufv));
+    if (ptr->config_.debug_mode && !extents.empty()) {
+        std::cout << "[DEBUG] Splicing " << covered << " of " << size << " bytes of "
+                  << object_name << " from local files" << std::endl;
+    }
+    
+    *bufp = bufv;
+    return 0;
 }
 
 // ==================== Write Operations ====================
@@ -389,7 +1478,11 @@ int GCSFS::read(const char *path, char *buf, size_t size, off_t offset,
 int GCSFS::create(const char *path, mode_t mode, struct fuse_file_info *fi)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Create);
     
+    if (ptr->isStatsPath(path) || isCompositePartPath(path)) {
+        return -EACCES;
+    }
     if (ptr->config_.debug_mode) {
         std::cout << "[DEBUG] Creating file: " << path << std::endl;
     }
@@ -399,9 +1492,28 @@ int GCSFS::create(const char *path, mode_t mode, struct fuse_file_info *fi)
         object_name = object_name.substr(1);
     }
     
-    // Initialize empty file in write buffer
-    ptr->write_buffers_[object_name] = "";
-    ptr->markDirty(object_name);
+    std::unique_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
+    if (ptr->config_.enable_streaming_writes) {
+        // Stream the new file straight to GCS while it is written in order
+        std::shared_ptr<gcscfuse::ObjectUploadStream> stream =
+            ptr->gcs_client_.openUploadStream(ptr->bucket_name_, object_name);
+        if (!stream) {
+            return -EIO;
+        }
+        std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+        ptr->dropWriteBuffer(object_name);
+        ptr->streaming_writes_[object_name] = std::move(stream);
+    } else {
+        // Initialize empty file in write buffer
+        std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+        auto wb_it = ptr->write_buffers_.find(object_name);
+        if (wb_it != ptr->write_buffers_.end()) {
+            ptr->resizeWriteBuffer(*wb_it->second, 0);
+        } else {
+            ptr->write_buffers_[object_name] = std::make_shared<std::string>();
+        }
+        ptr->markDirty(object_name);
+    }
     
     // Update stat cache
     if (ptr->config_.enable_stat_cache) {
@@ -409,13 +1521,28 @@ int GCSFS::create(const char *path, mode_t mode, struct fuse_file_info *fi)
     }
     
     fi->flags |= O_CREAT;
+    fi->fh = ptr->next_file_handle_++;
     return 0;
 }
 
 int GCSFS::write(const char *path, const char *buf, size_t size, off_t offset,
-                 struct fuse_file_info *)
+                 struct fuse_file_info *fi)
+{
+    struct fuse_bufvec src = FUSE_BUFVEC_INIT(size);
+    src.buf[0].mem = const_cast<char *>(buf);
+    return write_buf(path, &src, offset, fi);
+}
+
+int GCSFS::write_buf(const char *path, struct fuse_bufvec *buf, off_t offset,
+                     struct fuse_file_info *)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Write);
+    const size_t size = fuse_buf_size(buf);
+    
+    if (ptr->isStatsPath(path)) {
+        return -EACCES;
+    }
     
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
@@ -427,33 +1554,151 @@ int GCSFS::write(const char *path, const char *buf, size_t size, off_t offset,
                   << " at offset " << offset << std::endl;
     }
     
-    // Get or create write buffer
-    std::string& content = ptr->write_buffers_[object_name];
+    std::unique_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
+    
+    // Sequential writes to a streaming file go straight to GCS. Anything else
+    // finalizes what was streamed and continues on a disk-staged copy.
+    bool stage = false;
+    if (auto stream = ptr->findStreamingWrite(object_name)) {
+        if (static_cast<size_t>(offset) == stream->bytesWritten()) {
+            std::vector<char> scratch;
+            const char* data = contiguousPayload(buf, size, scratch);
+            if (!data || !stream->write(data, size)) {
+                std::cerr << "Streaming upload of " << object_name << " failed" << std::endl;
+                std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+                ptr->streaming_writes_.erase(object_name);
+                return -EIO;
+            }
+            if (ptr->config_.enable_stat_cache) {
+                ptr->stat_cache_.insertFile(path, stream->bytesWritten(), time(nullptr));
+            }
+            countEvent(gcscfuse::MetricCounter::FuseBytesWritten, size);
+            return static_cast<int>(size);
+        }
+        
+        if (ptr->config_.debug_mode) {
+            std::cout << "[DEBUG] Non-sequential write to " << object_name
+                      << ", switching to disk staging" << std::endl;
+        }
+        int result = ptr->finishStreamingWrite(path);
+        if (result != 0) {
+            return result;
+        }
+        stage = true;
+    }
     
-    // If writing beyond current size, expand with zeros
-    if (static_cast<size_t>(offset) > content.size()) {
-        content.resize(offset, '\0');
+    if (stage || ptr->findStagedWrite(object_name)) {
+        std::shared_ptr<gcscfuse::StagingFile> staged;
+        int result = ptr->stageObject(path, staged);
+        if (result != 0) {
+            return result;
+        }
+        
+        // Copy into the staging file directly; a spliced payload never
+        // passes through user space
+        struct fuse_bufvec dst = FUSE_BUFVEC_INIT(size);
+        dst.buf[0].flags = static_cast<enum fuse_buf_flags>(FUSE_BUF_IS_FD | FUSE_BUF_FD_SEEK);
+        dst.buf[0].fd = staged->fd();
+        dst.buf[0].pos = offset;
+        ssize_t written = fuse_buf_copy(&dst, buf, static_cast<enum fuse_buf_copy_flags>(0));
+        if (written < 0) {
+            return static_cast<int>(written);
+        }
+        staged->extendTo(static_cast<size_t>(offset) + static_cast<size_t>(written));
+        if (ptr->config_.enable_stat_cache) {
+            ptr->stat_cache_.insertFile(path, staged->size(), time(nullptr));
+        }
+        countEvent(gcscfuse::MetricCounter::FuseBytesWritten, static_cast<std::uint64_t>(written));
+        return static_cast<int>(written);
     }
     
-    // Write data
-    if (static_cast<size_t>(offset) + size > content.size()) {
-        content.resize(offset + size);
+    // Large existing objects are edited per chunk instead of being loaded whole
+    std::shared_ptr<gcscfuse::ChunkedWrite> chunked;
+    int result = ptr->chunkObject(path, chunked);
+    if (result != 0) {
+        return result;
+    }
+    if (chunked) {
+        std::vector<char> scratch;
+        const char* data = contiguousPayload(buf, size, scratch);
+        if (!data) {
+            return -EIO;
+        }
+        const size_t before = chunked->memoryBytes();
+        const size_t growth = chunked->growth(offset, size);
+        {
+            std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+            if (!ptr->reserveWriteBuffer(growth)) {
+                std::cerr << "Write buffer budget exhausted writing " << object_name << std::endl;
+                return -ENOSPC;
+            }
+            ptr->write_buffer_bytes_ += growth;
+        }
+        const auto read_base = ptr->baseReader(object_name, chunked->baseGeneration(), chunked->baseSize());
+        ssize_t written = chunked->write(data, size, offset, read_base);
+        {
+            // A failed base read leaves fewer chunks than reserved for
+            std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+            ptr->write_buffer_bytes_ -= before + growth - chunked->memoryBytes();
+        }
+        if (written < 0) {
+            return static_cast<int>(written);
+        }
+        if (ptr->config_.enable_stat_cache) {
+            ptr->stat_cache_.insertFile(path, chunked->size(), time(nullptr));
+        }
+        countEvent(gcscfuse::MetricCounter::FuseBytesWritten, static_cast<std::uint64_t>(written));
+        return static_cast<int>(written);
+    }
+    
+    // Get or create write buffer. An existing object is loaded first so a
+    // partial write does not drop the rest of its content.
+    std::shared_ptr<std::string> buffer;
+    result = ptr->getWriteBuffer(path, true, buffer);
+    if (result != 0) {
+        return result;
+    }
+    std::string& content = *buffer;
+    
+    {
+        std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+        
+        // If writing beyond current size, expand (gaps are zero-filled)
+        if (static_cast<size_t>(offset) + size > content.size()) {
+            if (!ptr->reserveWriteBuffer(offset + size - content.size())) {
+                std::cerr << "Write buffer budget exhausted writing " << object_name << std::endl;
+                return -ENOSPC;
+            }
+            ptr->resizeWriteBuffer(content, offset + size);
+        }
     }
     
-    memcpy(&content[offset], buf, size);
-    ptr->markDirty(object_name);
+    // Copy straight into the buffer, without an intermediate copy for
+    // payloads that arrive through a pipe
+    struct fuse_bufvec dst = FUSE_BUFVEC_INIT(size);
+    dst.buf[0].mem = &content[offset];
+    ssize_t copied = fuse_buf_copy(&dst, buf, FUSE_BUF_NO_SPLICE);
+    if (copied < 0) {
+        return static_cast<int>(copied);
+    }
     
     // Update stat cache with new size
     if (ptr->config_.enable_stat_cache) {
         ptr->stat_cache_.insertFile(path, content.size(), time(nullptr));
     }
     
-    return static_cast<int>(size);
+    countEvent(gcscfuse::MetricCounter::FuseBytesWritten, static_cast<std::uint64_t>(copied));
+    return static_cast<int>(copied);
 }
 
 int GCSFS::truncate(const char *path, off_t size, struct fuse_file_info *)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Truncate);
+    
+    if (ptr->isStatsPath(path)) {
+        return -EACCES;
+    }
     
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
@@ -464,37 +1709,71 @@ int GCSFS::truncate(const char *path, off_t size, struct fuse_file_info *)
         std::cout << "[DEBUG] Truncating " << object_name << " to " << size << " bytes" << std::endl;
     }
     
-    // Get current content
-    std::string& content = ptr->write_buffers_[object_name];
-    if (content.empty() && ptr->isValidPath(path)) {
-        // Load from persistent storage if not in write buffer yet
-        content.resize(1024 * 1024); // Start with 1MB
-        off_t total_read = 0;
-        
-        while (true) {
-            if (total_read >= static_cast<off_t>(content.size())) {
-                content.resize(content.size() * 2);
-            }
-            
-            int bytes_read = ptr->reader_->read(
-                object_name,
-                &content[total_read],
-                content.size() - total_read,
-                total_read);
-            
-            if (bytes_read <= 0) {
-                break;
-            }
-            
-            total_read += bytes_read;
+    // Get current content, loading it from persistent storage if not in the
+    // write buffer yet (not needed when truncating to zero)
+    std::unique_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
+    
+    // A streaming file can only stay streaming if its size does not change
+    bool stage = false;
+    if (auto stream = ptr->findStreamingWrite(object_name)) {
+        if (static_cast<size_t>(size) == stream->bytesWritten()) {
+            return 0;
+        }
+        int result = ptr->finishStreamingWrite(path);
+        if (result != 0) {
+            return result;
+        }
+        stage = true;
+    }
+    
+    if (stage || ptr->findStagedWrite(object_name)) {
+        std::shared_ptr<gcscfuse::StagingFile> staged;
+        int result = ptr->stageObject(path, staged);
+        if (result == 0) {
+            result = staged->truncate(static_cast<size_t>(size));
+        }
+        if (result == 0 && ptr->config_.enable_stat_cache) {
+            ptr->stat_cache_.insertFile(path, size, time(nullptr));
+        }
+        return result;
+    }
+    
+    // Truncating a large object keeps it chunked; only the chunk at the
+    // new end is touched. Truncating to zero needs nothing from GCS.
+    std::shared_ptr<gcscfuse::ChunkedWrite> chunked;
+    if (size > 0 || ptr->findChunkedWrite(object_name)) {
+        int result = ptr->chunkObject(path, chunked);
+        if (result != 0) {
+            return result;
         }
-        
-        content.resize(total_read);
     }
+    if (chunked) {
+        std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+        ptr->write_buffer_bytes_ -= chunked->memoryBytes();
+        chunked->truncate(static_cast<size_t>(size));
+        ptr->write_buffer_bytes_ += chunked->memoryBytes();
+        if (ptr->config_.enable_stat_cache) {
+            ptr->stat_cache_.insertFile(path, size, time(nullptr));
+        }
+        return 0;
+    }
+    
+    std::shared_ptr<std::string> buffer;
+    int result = ptr->getWriteBuffer(path, size > 0, buffer);
+    if (result != 0) {
+        return result;
+    }
+    std::string& content = *buffer;
     
     // Resize
-    content.resize(size, '\0');
-    ptr->markDirty(object_name);
+    {
+        std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+        if (static_cast<size_t>(size) > content.size() &&
+            !ptr->reserveWriteBuffer(size - content.size())) {
+            return -ENOSPC;
+        }
+        ptr->resizeWriteBuffer(content, size);
+    }
     
     // Update stat cache
     if (ptr->config_.enable_stat_cache) {
@@ -507,13 +1786,35 @@ int GCSFS::truncate(const char *path, off_t size, struct fuse_file_info *)
 int GCSFS::flush(const char *path, struct fuse_file_info *)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Flush);
     
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
         object_name = object_name.substr(1);
     }
     
-    // Only flush if file is dirty
+    // A streaming upload is finalized on close
+    if (ptr->findStreamingWrite(object_name)) {
+        std::unique_lock<std::shared_mutex> write_lock(ptr->objectLock(object_name));
+        return ptr->finishStreamingWrite(path);
+    }
+    
+    // With write-back, close() reports a failed background upload of what
+    // was written before and queues what is dirty now
+    if (ptr->write_back_) {
+        int error = ptr->write_back_->takeError(object_name);
+        if (error != 0) {
+            std::cerr << "Background upload of " << object_name << " failed" << std::endl;
+            return error;
+        }
+        ptr->queueWriteBack(object_name);
+        return 0;
+    }
+    
+    // Only flush if file is dirty. The stripe is held exclusively from the
+    // check to the end of the upload, so a close() on a dup'd descriptor
+    // finds the file clean instead of uploading it a second time.
+    std::unique_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
     if (!ptr->isDirty(object_name)) {
         return 0;
     }
@@ -525,9 +1826,25 @@ int GCSFS::flush(const char *path, struct fuse_file_info *)
     return ptr->uploadToGCS(path);
 }
 
-int GCSFS::release(const char *path, struct fuse_file_info *)
+int GCSFS::release(const char *path, struct fuse_file_info *fi)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Release);
+    
+    if (ptr->isStatsPath(path)) {
+        if (fi) {
+            std::lock_guard<std::mutex> lock(ptr->stats_files_mutex_);
+            ptr->stats_files_.erase(fi->fh);
+        }
+        return 0;
+    }
+    
+    // Drop per-handle reader state (read-ahead windows, in-flight prefetches)
+    if (fi && fi->fh != 0) {
+        ptr->reader_->release(fi->fh);
+        std::lock_guard<std::mutex> lock(ptr->handle_pins_mutex_);
+        ptr->handle_pins_.erase(fi->fh);
+    }
     
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
@@ -535,6 +1852,17 @@ int GCSFS::release(const char *path, struct fuse_file_info *)
     }
     
     // Sync any pending writes on file close
+    if (ptr->findStreamingWrite(object_name)) {
+        std::unique_lock<std::shared_mutex> write_lock(ptr->objectLock(object_name));
+        return ptr->finishStreamingWrite(path);
+    }
+    if (ptr->write_back_) {
+        // Picks up writes made after the last flush; the worker drops the
+        // staged copy once uploaded
+        ptr->queueWriteBack(object_name);
+        return 0;
+    }
+    std::unique_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
     if (ptr->isDirty(object_name)) {
         if (ptr->config_.debug_mode) {
             std::cout << "[DEBUG] Releasing and syncing " << object_name << std::endl;
@@ -545,12 +1873,63 @@ int GCSFS::release(const char *path, struct fuse_file_info *)
         }
     }
     
+    // Staged copies live on disk only while the file is being written
+    if (ptr->findStagedWrite(object_name) && !ptr->isDirty(object_name)) {
+        std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+        ptr->staged_writes_.erase(object_name);
+        ptr->dirty_files_.erase(object_name);
+    }
+    
     return 0;
 }
 
+int GCSFS::fsync(const char *path, int, struct fuse_file_info *)
+{
+    const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Fsync);
+    
+    if (ptr->isStatsPath(path)) {
+        return 0;
+    }
+    
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
+    
+    // A streamed file is only in GCS once its upload is finalized
+    if (ptr->findStreamingWrite(object_name)) {
+        std::unique_lock<std::shared_mutex> write_lock(ptr->objectLock(object_name));
+        return ptr->finishStreamingWrite(path);
+    }
+    
+    // Wait for a queued or running background upload, without holding the
+    // stripe it needs
+    int error = 0;
+    if (ptr->write_back_) {
+        error = ptr->write_back_->wait(object_name);
+    }
+    
+    // Whatever is still dirty (never closed, or its background upload
+    // failed) is uploaded now; that result is the one that counts
+    std::unique_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
+    if (ptr->isDirty(object_name)) {
+        if (ptr->config_.debug_mode) {
+            std::cout << "[DEBUG] fsync uploading " << object_name << std::endl;
+        }
+        return ptr->uploadToGCS(path);
+    }
+    return error;
+}
+
 int GCSFS::unlink(const char *path)
 {
     const auto ptr = this_();
+    auto timer = timeOp(gcscfuse::FuseOp::Unlink);
+    
+    if (ptr->isStatsPath(path)) {
+        return -EACCES;
+    }
     
     std::string object_name = path;
     if (!object_name.empty() && object_name[0] == '/') {
@@ -561,14 +1940,32 @@ int GCSFS::unlink(const char *path)
         std::cout << "[DEBUG] Deleting " << object_name << std::endl;
     }
     
-    if (!ptr->isValidPath(path)) {
-        return -ENOENT;
+    int error = 0;
+    auto info = ptr->lookupPath(path, &error);
+    if (!info.has_value()) {
+        return error;
     }
-    
-    if (ptr->isDirectory(path)) {
+    if (info->is_directory) {
         return -EISDIR;
     }
     
+    // A closed file may not have reached GCS yet; let its upload finish
+    // so the delete has something to remove
+    if (ptr->write_back_) {
+        ptr->write_back_->wait(object_name);
+    }
+    
+    // A file still being streamed does not exist in GCS yet; abandon the upload
+    std::unique_lock<std::shared_mutex> object_lock(ptr->objectLock(object_name));
+    if (ptr->findStreamingWrite(object_name)) {
+        {
+            std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+            ptr->dropWriteBuffer(object_name);
+        }
+        ptr->stat_cache_.remove(std::string("/") + object_name);
+        return 0;
+    }
+    
     // Delete from GCS
     try {
         bool success = ptr->gcs_client_.deleteObject(ptr->bucket_name_, object_name);
@@ -579,8 +1976,10 @@ int GCSFS::unlink(const char *path)
         
         // Remove from caches
         ptr->reader_->invalidate(object_name);
-        ptr->write_buffers_.erase(object_name);
-        ptr->dirty_files_.erase(object_name);
+        {
+            std::lock_guard<std::mutex> state_lock(ptr->write_state_mutex_);
+            ptr->dropWriteBuffer(object_name);
+        }
         ptr->stat_cache_.remove(std::string("/") + object_name);
         
         if (ptr->config_.verbose_logging) {
@@ -603,37 +2002,71 @@ int GCSFS::uploadToGCS(const std::string& path) const
         object_name = object_name.substr(1);
     }
     
-    auto it = write_buffers_.find(object_name);
-    if (it == write_buffers_.end()) {
+    // Upload from the memory buffer, or straight from a mapping of the
+    // staging file so disk-staged files are never copied into memory
+    auto buffer = findWriteBuffer(object_name);
+    auto staged = buffer ? nullptr : findStagedWrite(object_name);
+    std::unique_ptr<gcscfuse::StagingFile::View> view;
+    std::string_view content;
+    if (buffer) {
+        content = *buffer;
+    } else if (staged) {
+        view = staged->view();
+        if (!view) {
+            return -EIO;
+        }
+        content = std::string_view(view->data(), view->size());
+    } else if (auto chunked = findChunkedWrite(object_name)) {
+        return uploadChunkedWrite(path, object_name, *chunked);
+    } else {
         // Nothing to upload
         return 0;
     }
     
-    const std::string& content = it->second;
-    
     if (config_.verbose_logging) {
         std::cout << "Uploading " << content.size() << " bytes to " << object_name << std::endl;
     }
     
     try {
-        bool success = gcs_client_.writeObject(bucket_name_, object_name, content);
+        // Large files go up as parallel parts composed server-side, so one
+        // TCP stream does not bound the time close() takes. Part size 0
+        // uploads in a single stream.
+        const size_t threshold = static_cast<size_t>(config_.parallel_upload_threshold_mb) * 1024 * 1024;
+        size_t part_size = 0;
+        if (threshold > 0 && content.size() >= threshold) {
+            part_size = static_cast<size_t>(config_.parallel_upload_part_size_mb) * 1024 * 1024;
+            if (config_.debug_mode) {
+                std::cout << "[DEBUG] Parallel composite upload of " << object_name
+                          << " in " << (content.size() + part_size - 1) / part_size << " parts" << std::endl;
+            }
+        }
+        auto uploaded = gcs_client_.writeObjectComposite(
+            bucket_name_, object_name, content, part_size,
+            static_cast<size_t>(config_.parallel_upload_concurrency));
         
-        if (!success) {
+        if (!uploaded) {
             std::cerr << "Error uploading object: " << object_name << std::endl;
             return -EIO;
         }
         
         // Invalidate cache to ensure fresh read on next access
         reader_->invalidate(object_name);
+        unpinObject(object_name);
         
-        // Clear dirty flag
-        dirty_files_[object_name] = false;
-        
-        // Update stat cache
-        if (config_.enable_stat_cache) {
-            stat_cache_.insertFile(path, content.size(), time(nullptr));
+        // Clear dirty flag; a memory buffer stays around as an evictable
+        // clean copy, a staged file until the file is released
+        {
+            std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+            if (buffer) {
+                markClean(object_name);
+            } else {
+                dirty_files_[object_name] = false;
+            }
         }
         
+        // The new generation lets later opens pin it and revalidate conditionally
+        cacheFileMetadata(path, *uploaded);
+        
         if (config_.debug_mode) {
             std::cout << "[DEBUG] Successfully uploaded " << object_name << std::endl;
         }
@@ -645,13 +2078,477 @@ int GCSFS::uploadToGCS(const std::string& path) const
     }
 }
 
+void GCSFS::queueWriteBack(const std::string& object_name) const
+{
+    size_t bytes = 0;
+    {
+        std::shared_lock<std::shared_mutex> object_lock(objectLock(object_name));
+        if (!isDirty(object_name)) {
+            return;
+        }
+        if (auto buffer = findWriteBuffer(object_name)) {
+            bytes = buffer->size();
+        } else if (auto staged = findStagedWrite(object_name)) {
+            bytes = staged->size();
+        } else if (auto chunked = findChunkedWrite(object_name)) {
+            bytes = chunked->memoryBytes();
+        }
+    }
+    
+    if (config_.debug_mode) {
+        std::cout << "[DEBUG] Queueing background upload of " << object_name
+                  << " (" << bytes << " bytes)" << std::endl;
+    }
+    // Blocks while the queue is over write_back_dirty_mb
+    write_back_->enqueue(object_name, bytes);
+}
+
+int GCSFS::writeBack(const std::string& object_name) const
+{
+    std::unique_lock<std::shared_mutex> object_lock(objectLock(object_name));
+    
+    // Deleted, or already uploaded by fsync, since it was queued
+    if (!isDirty(object_name)) {
+        return 0;
+    }
+    
+    int result = uploadToGCS("/" + object_name);
+    
+    // The staged copy is only needed again if the file is written again,
+    // which restages it from GCS
+    if (result == 0 && findStagedWrite(object_name) && !isDirty(object_name)) {
+        std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+        staged_writes_.erase(object_name);
+        dirty_files_.erase(object_name);
+    }
+    return result;
+}
+
 void GCSFS::markDirty(const std::string& path) const
 {
     dirty_files_[path] = true;
+    
+    auto it = clean_buffer_pos_.find(path);
+    if (it != clean_buffer_pos_.end()) {
+        clean_buffer_lru_.erase(it->second);
+        clean_buffer_pos_.erase(it);
+    }
+}
+
+void GCSFS::markClean(const std::string& path) const
+{
+    dirty_files_[path] = false;
+    
+    auto it = clean_buffer_pos_.find(path);
+    if (it != clean_buffer_pos_.end()) {
+        clean_buffer_lru_.erase(it->second);
+    }
+    clean_buffer_lru_.push_front(path);
+    clean_buffer_pos_[path] = clean_buffer_lru_.begin();
+    
+    // Trim clean buffers back under the budget
+    reserveWriteBuffer(0);
 }
 
 bool GCSFS::isDirty(const std::string& path) const
 {
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
     auto it = dirty_files_.find(path);
     return it != dirty_files_.end() && it->second;
 }
+
+// ==================== Write Buffer Management ====================
+
+int GCSFS::getWriteBuffer(const std::string& path, bool load_existing, std::shared_ptr<std::string>& content) const
+{
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
+    
+    {
+        std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+        auto it = write_buffers_.find(object_name);
+        if (it != write_buffers_.end()) {
+            // Dirty right away so the buffer cannot be evicted under the caller
+            markDirty(object_name);
+            content = it->second;
+            return 0;
+        }
+    }
+    
+    // Load without holding write_state_mutex_; the exclusive stripe held by
+    // the caller keeps anyone else from creating this buffer meanwhile
+    auto existing = std::make_shared<std::string>();
+    if (load_existing) {
+        // An unanswered lookup is no empty file to write over the object
+        int error = 0;
+        auto info = lookupPath(path, &error);
+        if (!info && error != -ENOENT) {
+            return error;
+        }
+        if (info && loadObjectContent(object_name, *existing, info->metadata_loaded ? info->size : -1,
+                                      info->generation) < 0) {
+            return -EIO;
+        }
+    }
+    
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+    if (!reserveWriteBuffer(existing->size())) {
+        return -ENOSPC;
+    }
+    write_buffer_bytes_ += existing->size();
+    write_buffers_[object_name] = existing;
+    markDirty(object_name);
+    content = std::move(existing);
+    return 0;
+}
+
+std::shared_ptr<std::string> GCSFS::findWriteBuffer(const std::string& object_name) const
+{
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+    auto it = write_buffers_.find(object_name);
+    return it != write_buffers_.end() ? it->second : nullptr;
+}
+
+int GCSFS::loadObjectContent(const std::string& object_name, std::string& content, off_t size_hint,
+                             std::int64_t generation) const
+{
+    // One byte past a known size, so the read that finds the end does not
+    // grow the buffer; otherwise start with 1MB and double
+    content.resize(size_hint >= 0 ? static_cast<size_t>(size_hint) + 1 : 1024 * 1024);
+    size_t total_read = 0;
+    
+    while (true) {
+        if (total_read >= content.size()) {
+            content.resize(content.size() * 2);
+        }
+        
+        int bytes_read = reader_->read(
+            object_name,
+            &content[total_read],
+            content.size() - total_read,
+            static_cast<off_t>(total_read),
+            0,
+            generation);
+        
+        if (bytes_read < 0) {
+            content.clear();
+            return -1;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+        
+        total_read += bytes_read;
+    }
+    
+    // Less than the known size means the version being loaded was replaced
+    // (or, unpinned, shrank) part way; a truncated copy would be uploaded
+    // over the object
+    if (size_hint >= 0 && total_read < static_cast<size_t>(size_hint)) {
+        std::cerr << "Object changed while loading: " << object_name << std::endl;
+        content.clear();
+        return -1;
+    }
+    
+    content.resize(total_read);
+    if (size_hint < 0) {
+        content.shrink_to_fit();
+    }
+    return 0;
+}
+
+bool GCSFS::reserveWriteBuffer(size_t extra_bytes) const
+{
+    const size_t budget = static_cast<size_t>(config_.max_write_buffer_mb) * 1024 * 1024;
+    
+    // Clean buffers are already in GCS, so drop the least recently used first
+    while (write_buffer_bytes_ + extra_bytes > budget && !clean_buffer_lru_.empty()) {
+        std::string victim = clean_buffer_lru_.back();
+        if (config_.debug_mode) {
+            std::cout << "[DEBUG] Evicting clean write buffer: " << victim << std::endl;
+        }
+        dropWriteBuffer(victim);
+        write_buffer_evictions_++;
+    }
+    
+    // Dirty buffers cannot be dropped without losing data
+    return write_buffer_bytes_ + extra_bytes <= budget;
+}
+
+void GCSFS::resizeWriteBuffer(std::string& content, size_t new_size) const
+{
+    write_buffer_bytes_ -= content.size();
+    content.resize(new_size, '\0');
+    write_buffer_bytes_ += content.size();
+}
+
+void GCSFS::dropWriteBuffer(const std::string& object_name) const
+{
+    auto it = write_buffers_.find(object_name);
+    if (it != write_buffers_.end()) {
+        write_buffer_bytes_ -= it->second->size();
+        write_buffers_.erase(it);
+    }
+    dirty_files_.erase(object_name);
+    
+    // Dropping an unfinished stream abandons the upload
+    streaming_writes_.erase(object_name);
+    staged_writes_.erase(object_name);
+    auto chunked = chunked_writes_.find(object_name);
+    if (chunked != chunked_writes_.end()) {
+        write_buffer_bytes_ -= chunked->second->memoryBytes();
+        chunked_writes_.erase(chunked);
+    }
+    
+    auto pos = clean_buffer_pos_.find(object_name);
+    if (pos != clean_buffer_pos_.end()) {
+        clean_buffer_lru_.erase(pos->second);
+        clean_buffer_pos_.erase(pos);
+    }
+}
+
+// ==================== Streaming and Staged Writes ====================
+
+std::shared_ptr<gcscfuse::ObjectUploadStream> GCSFS::findStreamingWrite(const std::string& object_name) const
+{
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+    auto it = streaming_writes_.find(object_name);
+    return it != streaming_writes_.end() ? it->second : nullptr;
+}
+
+std::shared_ptr<gcscfuse::StagingFile> GCSFS::findStagedWrite(const std::string& object_name) const
+{
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+    auto it = staged_writes_.find(object_name);
+    return it != staged_writes_.end() ? it->second : nullptr;
+}
+
+int GCSFS::finishStreamingWrite(const std::string& path) const
+{
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
+    
+    std::shared_ptr<gcscfuse::ObjectUploadStream> stream;
+    {
+        std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+        auto it = streaming_writes_.find(object_name);
+        if (it == streaming_writes_.end()) {
+            return 0;
+        }
+        stream = std::move(it->second);
+        streaming_writes_.erase(it);
+    }
+    
+    if (config_.debug_mode) {
+        std::cout << "[DEBUG] Finalizing streamed upload of " << object_name
+                  << " (" << stream->bytesWritten() << " bytes)" << std::endl;
+    }
+    
+    auto uploaded = stream->close();
+    if (!uploaded) {
+        std::cerr << "Error finalizing streamed upload: " << object_name << std::endl;
+        return -EIO;
+    }
+    
+    reader_->invalidate(object_name);
+    unpinObject(object_name);
+    cacheFileMetadata(path, *uploaded);
+    return 0;
+}
+
+int GCSFS::stageObject(const std::string& path, std::shared_ptr<gcscfuse::StagingFile>& staged) const
+{
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
+    
+    staged = findStagedWrite(object_name);
+    if (!staged) {
+        // Seed the staging file with the current object content
+        std::shared_ptr<gcscfuse::StagingFile> file = gcscfuse::StagingFile::create(
+            config_.staging_dir.empty() ? config_.cache_dir : config_.staging_dir);
+        if (!file) {
+            return -EIO;
+        }
+        int error = 0;
+        auto info = lookupPath(path, &error);
+        if (!info && error != -ENOENT) {
+            return error;
+        }
+        if (info && !info->is_directory &&
+            loadObjectToStaging(object_name, *file, info->generation, info->size) < 0) {
+            return -EIO;
+        }
+        
+        std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+        staged_writes_[object_name] = file;
+        staged = std::move(file);
+    }
+    
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+    markDirty(object_name);
+    return 0;
+}
+
+int GCSFS::loadObjectToStaging(const std::string& object_name, gcscfuse::StagingFile& staged,
+                               std::int64_t generation, off_t size) const
+{
+    std::vector<char> chunk(1024 * 1024);
+    off_t offset = 0;
+    
+    while (true) {
+        int bytes_read = reader_->read(object_name, chunk.data(), chunk.size(), offset, 0, generation);
+        if (bytes_read < 0) {
+            return -1;
+        }
+        if (bytes_read == 0) {
+            break;
+        }
+        if (staged.write(chunk.data(), static_cast<size_t>(bytes_read), offset) < 0) {
+            return -1;
+        }
+        offset += bytes_read;
+    }
+    
+    // As in loadObjectContent: an object that ends early was replaced
+    if (offset < size) {
+        std::cerr << "Object changed while staging: " << object_name << std::endl;
+        return -1;
+    }
+    return 0;
+}
+
+// ==================== Chunked Writes ====================
+
+std::shared_ptr<gcscfuse::ChunkedWrite> GCSFS::findChunkedWrite(const std::string& object_name) const
+{
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+    auto it = chunked_writes_.find(object_name);
+    return it != chunked_writes_.end() ? it->second : nullptr;
+}
+
+int GCSFS::chunkObject(const std::string& path, std::shared_ptr<gcscfuse::ChunkedWrite>& chunked) const
+{
+    std::string object_name = path;
+    if (!object_name.empty() && object_name[0] == '/') {
+        object_name = object_name.substr(1);
+    }
+    
+    chunked = findChunkedWrite(object_name);
+    if (!chunked) {
+        const size_t threshold = static_cast<size_t>(config_.chunked_write_threshold_mb) * 1024 * 1024;
+        if (threshold == 0 || findWriteBuffer(object_name)) {
+            return 0;
+        }
+        int error = 0;
+        auto info = lookupPath(path, &error);
+        if (!info && error != -ENOENT) {
+            return error;
+        }
+        if (!info || info->is_directory || !info->metadata_loaded ||
+            static_cast<size_t>(info->size) < threshold) {
+            return 0;
+        }
+        
+        // Chunks line up with content cache blocks, so bringing one in is
+        // a single block read
+        const size_t chunk_size = static_cast<size_t>(config_.content_cache_block_size_mb) * 1024 * 1024;
+        if (config_.debug_mode) {
+            std::cout << "[DEBUG] Editing " << object_name << " (" << info->size
+                      << " bytes) in chunks of " << chunk_size << " bytes" << std::endl;
+        }
+        std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+        chunked = std::make_shared<gcscfuse::ChunkedWrite>(static_cast<size_t>(info->size), chunk_size,
+                                                           info->generation);
+        chunked_writes_[object_name] = chunked;
+    }
+    
+    std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+    markDirty(object_name);
+    return 0;
+}
+
+int GCSFS::uploadChunkedWrite(const std::string& path, const std::string& object_name,
+                              const gcscfuse::ChunkedWrite& chunked) const
+{
+    const auto read_base = baseReader(object_name, chunked.baseGeneration(), chunked.baseSize());
+    bool success = true;
+    std::optional<gcscfuse::ObjectMetadata> uploaded;
+    if (!chunked.changed()) {
+        // Opened for writing but nothing written: the object is unchanged
+    } else if (chunked.appendOnly() && chunked.baseGeneration() != 0) {
+        if (config_.debug_mode) {
+            std::cout << "[DEBUG] Appending " << chunked.size() - chunked.baseSize() << " bytes to "
+                      << object_name << " by compose" << std::endl;
+        }
+        uploaded = gcs_client_.appendObject(bucket_name_, object_name, [&](gcscfuse::ObjectUploadStream& stream) {
+            return chunked.copyTo(chunked.baseSize(), [&stream](const char* data, size_t size) {
+                return stream.write(data, size);
+            }, read_base);
+        }, chunked.baseGeneration());
+        success = uploaded.has_value();
+        countEvent(gcscfuse::MetricCounter::ChunkedAppends);
+    } else {
+        // GCS cannot compose part of an object, so any other edit uploads the
+        // object anew, one chunk at a time: clean chunks are read from the
+        // old object (still readable until the upload is finalized). So is
+        // an append onto a base of unknown generation, which compose could
+        // not pin. The upload only finalizes while the base is still live,
+        // so an update from elsewhere is never silently overwritten.
+        if (config_.debug_mode) {
+            std::cout << "[DEBUG] Rewriting " << object_name << " from chunks" << std::endl;
+        }
+        auto stream = gcs_client_.openUploadStream(bucket_name_, object_name, chunked.baseGeneration());
+        success = stream && chunked.copyTo(0, [&stream](const char* data, size_t size) {
+            return stream->write(data, size);
+        }, read_base);
+        if (success) {
+            uploaded = stream->close();
+            success = uploaded.has_value();
+        }
+        countEvent(gcscfuse::MetricCounter::ChunkedRewrites);
+        if (!success && stream && stream->preconditionFailed()) {
+            std::cerr << "Error uploading object: " << object_name
+                      << " was replaced in GCS while it was being edited" << std::endl;
+            return -ESTALE;
+        }
+    }
+    
+    if (!success) {
+        std::cerr << "Error uploading object: " << object_name << std::endl;
+        return -EIO;
+    }
+    
+    // The object in GCS is now the file's content; later edits start a new
+    // chunked write from it
+    reader_->invalidate(object_name);
+    unpinObject(object_name);
+    {
+        std::lock_guard<std::mutex> state_lock(write_state_mutex_);
+        dropWriteBuffer(object_name);
+    }
+    // An unchanged object keeps the entry it has
+    if (uploaded) {
+        cacheFileMetadata(path, *uploaded);
+    }
+    return 0;
+}
+
+gcscfuse::ChunkedWrite::BaseReader GCSFS::baseReader(const std::string& object_name, std::int64_t generation,
+                                                     size_t base_size) const
+{
+    return [this, object_name, generation, base_size](char* buf, size_t size, off_t offset) -> ssize_t {
+        int n = reader_->read(object_name, buf, size, offset, 0, generation);
+        // The pinned base was replaced: its bytes are gone, and zeros in
+        // their place would corrupt the file
+        if (n == 0 && generation != 0 && static_cast<size_t>(offset) < base_size) {
+            return -ESTALE;
+        }
+        return n;
+    };
+}
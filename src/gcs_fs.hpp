@@ -4,13 +4,27 @@
 
 #include <string>
 #include <map>
+#include <unordered_set>
+#include <list>
 #include <vector>
 #include <memory>
+#include <atomic>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <condition_variable>
 #include "fuse_cpp_wrapper.hpp"
 #include "gcs/gcs_client.hpp"
+#include "gcs/async_gcs_client.hpp"
 #include "stat_cache.hpp"
 #include "config.hpp"
 #include "reader.hpp"
+#include "staging_file.hpp"
+#include "chunked_write.hpp"
+#include "directory_prefetcher.hpp"
+#include "write_back_queue.hpp"
+#include "metrics.hpp"
 
 /**
  * GCSFS - A FUSE filesystem that reads files from Google Cloud Storage
@@ -21,58 +35,348 @@
 class GCSFS : public Fusepp::Fuse<GCSFS>
 {
 public:
+    // Resources one daemon shares between the mounts it serves
+    struct Shared {
+        std::shared_ptr<gcscfuse::GCSClient> gcs_client;
+        // Null gives the mount a content cache of its own
+        std::shared_ptr<gcscfuse::ContentCache> content_cache;
+        // Null gives the mount a request pool of its own
+        std::shared_ptr<gcscfuse::RequestScheduler> scheduler;
+    };
+    
     explicit GCSFS(const std::string& bucket_name, const GCSFSConfig& config);
-    ~GCSFS() override = default;
+    // Serve the bucket through the given SDK client (a fake, in benchmarks)
+    GCSFS(const std::string& bucket_name, const GCSFSConfig& config,
+          std::unique_ptr<gcscfuse::IGCSSDKClient> sdk_client);
+    // Serve the bucket through resources shared with other mounts
+    GCSFS(const std::string& bucket_name, const GCSFSConfig& config, const Shared& shared);
+    
+    // SDK client with the configured HTTP connection pool, or the SDK default
+    static std::unique_ptr<gcscfuse::IGCSSDKClient> makeSDKClient(const GCSFSConfig& config);
+    ~GCSFS() override;
 
     // FUSE operations - read
     static int getattr(const char *path, struct stat *stbuf, struct fuse_file_info *);
+    static int opendir(const char *path, struct fuse_file_info *fi);
     static int readdir(const char *path, void *buf, fuse_fill_dir_t filler,
                        off_t offset, struct fuse_file_info *fi,
                        enum fuse_readdir_flags);
+    static int releasedir(const char *path, struct fuse_file_info *fi);
     static int open(const char *path, struct fuse_file_info *fi);
     static int read(const char *path, char *buf, size_t size, off_t offset,
                     struct fuse_file_info *);
+    static int read_buf(const char *path, struct fuse_bufvec **bufp, size_t size,
+                        off_t offset, struct fuse_file_info *fi);
+    static void *init(struct fuse_conn_info *conn, struct fuse_config *cfg);
+    static void destroy(void *private_data);
     
     // FUSE operations - write
     static int create(const char *path, mode_t mode, struct fuse_file_info *fi);
     static int write(const char *path, const char *buf, size_t size, off_t offset,
                      struct fuse_file_info *);
+    static int write_buf(const char *path, struct fuse_bufvec *buf, off_t offset,
+                         struct fuse_file_info *);
     static int truncate(const char *path, off_t size, struct fuse_file_info *fi);
     static int flush(const char *path, struct fuse_file_info *fi);
     static int release(const char *path, struct fuse_file_info *fi);
+    static int fsync(const char *path, int datasync, struct fuse_file_info *fi);
     static int unlink(const char *path);
 
     // Accessors
     const std::string& bucketName() const { return bucket_name_; }
     const std::string& rootPath() const { return root_path_; }
+    
+    // Virtual read-only directory holding the metrics file, when metrics are enabled
+    static constexpr const char* kStatsDir = "/.gcscfuse";
+    static constexpr const char* kStatsFile = "/.gcscfuse/stats";
 
 private:
     std::string bucket_name_;
     std::string root_path_ = "/";
     GCSFSConfig config_;
-    mutable gcscfuse::GCSClient gcs_client_;
+    std::shared_ptr<gcscfuse::GCSClient> gcs_client_owner_;
+    gcscfuse::GCSClient& gcs_client_;
     
     // Stat cache for metadata
     mutable StatCache stat_cache_;
     
+    // Stat cache snapshot file, empty when snapshots are disabled. It is
+    // loaded in init(), rewritten every metadata_snapshot_interval seconds
+    // by snapshot_thread_ and once more at unmount.
+    std::string snapshot_path_;
+    std::thread snapshot_thread_;
+    std::mutex snapshot_mutex_;
+    std::condition_variable snapshot_cv_;
+    bool stop_snapshots_ = false;
+    
+    // Stale entries being refreshed in the background ("path" for its
+    // attributes, "path/" for its listing), so each goes out once
+    mutable std::mutex revalidate_mutex_;
+    mutable std::unordered_set<std::string> revalidating_;
+    
+    // Cold lookups in flight per parent directory. With batch_metadata_lookups
+    // a lookup that finds another under way in its directory joins a single
+    // listing of the directory instead of sending its own requests.
+    mutable std::mutex cold_lookups_mutex_;
+    mutable std::unordered_map<std::string, size_t> cold_lookups_;
+    mutable gcscfuse::SingleFlight<std::string, bool> batch_listings_;
+    
     // Reader abstraction for persistent storage (GCS/Cache/Dummy)
     std::unique_ptr<gcscfuse::IReader> reader_;
     
+    // Caches inside the reader chain, for the stats file; null when not configured
+    const gcscfuse::ContentCache* content_cache_ = nullptr;
+    const gcscfuse::DiskCache* disk_cache_ = nullptr;
+    gcscfuse::CachedReader* cached_reader_ = nullptr;
+    
+    // Stats file content rendered at open (handle -> text), so each open
+    // handle reads one consistent snapshot
+    mutable std::mutex stats_files_mutex_;
+    mutable std::map<std::uint64_t, std::shared_ptr<const std::string>> stats_files_;
+    
+    // File handles handed out in fi->fh so readers can keep per-handle state
+    std::atomic<std::uint64_t> next_file_handle_{1};
+    
+    // Generation each open file reads (handle -> pin), so a handle never
+    // mixes bytes of two versions of its object. A handle that has not
+    // served anything yet moves to a replacement; one that has gets -ESTALE.
+    // Objects uploaded by this mount are unpinned: their handles read on.
+    struct HandlePin {
+        std::string object_name;
+        std::int64_t generation = 0;
+        off_t size = 0;         // object size at that generation
+        bool served = false;
+    };
+    mutable std::mutex handle_pins_mutex_;
+    mutable std::map<std::uint64_t, HandlePin> handle_pins_;
+    
+    // Directory listings being read through an open directory handle
+    // (handle -> listing). readdir resumes from an offset into the entries
+    // gathered since offset 0, so entries are neither skipped nor repeated.
+    // A GCS listing is pulled page by page only as far as readdir has got,
+    // so the first entries of a huge directory come back after one page.
+    // Attributes go out with readdirplus, so ls -l needs no getattr calls.
+    struct DirectoryEntry {
+        std::string name;
+        struct stat st {};
+        std::int64_t generation = 0;  // of a listed file, 0 if unknown
+        bool has_stat = false;
+    };
+    using DirectoryListing = std::vector<DirectoryEntry>;
+    struct DirectoryHandle {
+        std::mutex mutex;  // guards the fields below
+        std::string path;
+        std::string prefix;  // object prefix being listed
+        DirectoryListing entries;
+        std::unordered_set<std::string> names;  // of entries, to drop repeats
+        std::unique_ptr<gcscfuse::ObjectLister> lister;  // set while the GCS listing is in progress
+        bool failed = false;  // the GCS listing broke off before its end
+        bool prefetch_subdirectories = true;
+    };
+    mutable std::mutex dir_listings_mutex_;
+    mutable std::map<std::uint64_t, std::shared_ptr<DirectoryHandle>> dir_listings_;
+    
     // Deprecated: file_list_ and files_loaded_ are no longer used (lazy loading per-directory now)
     // mutable std::vector<std::string> file_list_;
     // mutable bool files_loaded_ = false;
     
-    // Write buffers for modified files (path -> content)
-    mutable std::map<std::string, std::string> write_buffers_;
+    // Write buffers for modified files (path -> content). Buffers are held by
+    // shared_ptr so one can be read or uploaded after its map entry is gone.
+    //
+    // Locking: FUSE runs callbacks on several threads. write_state_mutex_
+    // guards the maps, the clean LRU and the byte counters below; it is only
+    // held for bookkeeping, never across GCS calls. The content of a buffer is
+    // guarded by its object's stripe in object_locks_: shared to read,
+    // exclusive to modify or upload (so that every dirty state is uploaded
+    // once). Lock order is stripe, then write_state_mutex_.
+    mutable std::mutex write_state_mutex_;
+    mutable std::map<std::string, std::shared_ptr<std::string>> write_buffers_;
     mutable std::map<std::string, bool> dirty_files_;  // Track which files need sync
+    
+    // New files written sequentially stream straight to GCS (object -> upload);
+    // once a write is out of order the stream is finalized and the file is
+    // staged on disk instead (object -> staging file). Existing objects of
+    // at least chunked_write_threshold_mb are edited per chunk, the rest
+    // staying in GCS (object -> chunked write; its chunks count against the
+    // write buffer budget). A file is in at most one of write_buffers_,
+    // streaming_writes_, staged_writes_ and chunked_writes_.
+    mutable std::map<std::string, std::shared_ptr<gcscfuse::ObjectUploadStream>> streaming_writes_;
+    mutable std::map<std::string, std::shared_ptr<gcscfuse::StagingFile>> staged_writes_;
+    mutable std::map<std::string, std::shared_ptr<gcscfuse::ChunkedWrite>> chunked_writes_;
+    
+    // Write buffer memory accounting. Clean (already uploaded) buffers are kept
+    // in LRU order and dropped first when max_write_buffer_mb is exceeded.
+    mutable size_t write_buffer_bytes_ = 0;
+    mutable std::list<std::string> clean_buffer_lru_;  // most recently used at the front
+    mutable std::map<std::string, std::list<std::string>::iterator> clean_buffer_pos_;
+    mutable std::uint64_t write_buffer_evictions_ = 0;
+
+    // Striped per-object locks, so operations on different files run in parallel
+    static constexpr size_t kObjectLockStripes = 64;
+    mutable std::array<std::shared_mutex, kObjectLockStripes> object_locks_;
 
     // Helper functions
     void loadFileList() const;
-    bool isValidPath(const std::string& path) const;
-    bool isDirectory(const std::string& path) const;
+    // Attributes of a path from the stat cache, else from one round of GCS
+    // requests (object GET and prefix listing in parallel); the answer,
+    // including "missing", is cached. nullopt if the path does not exist
+    // (error, if given, is set to -ENOENT) or if GCS could not be asked
+    // (-EIO; nothing is cached then).
+    // Stale hits (snapshot-loaded, or past the TTL within the stale-while-revalidate
+    // window) are served and refreshed in the background.
+    std::optional<StatCache::StatInfo> lookupPath(const std::string& path, int* error = nullptr) const;
+    // 0 if the path exists, else lookupPath's error
+    int checkPath(const std::string& path) const;
+    
+    // The GCS half of lookupPath; with parallel_probe the prefix listing
+    // goes out on the request pool alongside the object GET. Only a
+    // confirmed miss is recorded as one; lookupFailed answers the rest.
+    std::optional<StatCache::StatInfo> fetchPath(const std::string& path, bool parallel_probe,
+                                                 int* error = nullptr) const;
+    std::optional<StatCache::StatInfo> lookupFailed(const std::string& path, int* error) const;
+    
+    // Cache the attributes of a listed or fetched object, dropping cached
+    // content of the generation it replaced
+    StatCache::StatInfo cacheFileMetadata(const std::string& path, const gcscfuse::ObjectMetadata& obj_meta) const;
+    
+    // fetchPath for a stale entry; a file cached with its generation is
+    // checked with a conditional GET that has no body while it is unchanged
+    std::optional<StatCache::StatInfo> refreshPath(const std::string& path) const;
+    
+    // read() of a path already validated by the caller: from the object's
+    // write state if it has one, otherwise through readPinned
+    int readContents(const std::string& path, const std::string& object_name,
+                     char *buf, size_t size, off_t offset, std::uint64_t handle) const;
+    
+    // Read an open file at its pinned generation, following the object to
+    // a new generation only while the handle has served nothing
+    int readPinned(const std::string& path, const std::string& object_name,
+                   char *buf, size_t size, off_t offset, std::uint64_t handle) const;
+    std::int64_t pinnedGeneration(std::uint64_t handle) const;
+    void unpinObject(const std::string& object_name) const;
     
-    // Write helpers
+    // fetchPath, or for a lookup concurrent with another in the same
+    // directory, the answer from a shared listing of that directory
+    std::optional<StatCache::StatInfo> fetchPathBatched(const std::string& path, int* error = nullptr) const;
+    
+    // List up to kBatchListingMaxEntries of a directory into the stat cache,
+    // once for all concurrent callers
+    void listForLookups(const std::string& dir_path) const;
+    static constexpr size_t kBatchListingMaxEntries = 5000;
+    
+    // Refresh a stale entry or listing on the request pool, at most once at a time
+    void revalidatePath(const std::string& path) const;
+    void revalidateListing(const std::string& path) const;
+    bool beginRevalidation(const std::string& key) const;
+    void endRevalidation(const std::string& key) const;
+    
+    // The stats file and its directory. Paths under kStatsDir never reach
+    // GCS: objects named .gcscfuse/... are hidden while metrics are enabled.
+    bool isStatsPath(const char *path) const;
+    
+    // Composite parts and append tails staged under
+    // GCSClient::kCompositePartPrefix in the bucket; they are never listed
+    // and never found by a lookup
+    static bool isCompositePartPath(const std::string& path);
+    std::string renderStats() const;
+    int readStatsFile(std::uint64_t handle, char *buf, size_t size, off_t offset) const;
+    
+    void saveSnapshot() const;
+    void stopSnapshots();
+    std::shared_mutex& objectLock(const std::string& object_name) const;
+    
+    // Start reading a directory: from the stat cache while its listing is
+    // fresh (unless use_cache is false), otherwise by opening a GCS listing
+    // that fillDirectoryListing advances. Subdirectories are handed to the
+    // warm-tree prefetcher unless prefetch_subdirectories is false.
+    std::shared_ptr<DirectoryHandle> startDirectoryListing(const std::string& path,
+                                                           bool prefetch_subdirectories,
+                                                           bool use_cache = true) const;
+    
+    // Pull listed objects (and cache them) until dir holds count entries or
+    // the listing ends. Caller holds dir.mutex. Returns 0 or -errno; -EIO
+    // whenever a failed listing stops short of count.
+    int fillDirectoryListing(DirectoryHandle& dir, size_t count) const;
+    void addListedObject(DirectoryHandle& dir, const gcscfuse::ObjectMetadata& obj_meta) const;
+    
+    // A listing ran to its end: mark it fresh, add entries only known
+    // locally, and prefetch subdirectories
+    void finishDirectoryListing(DirectoryHandle& dir) const;
+    void prefetchSubdirectories(const DirectoryHandle& dir) const;
+    
+    // Queue the listed files of at most small_file_prefetch_kb for the
+    // content cache (bulk priority)
+    void prefetchSmallFiles(const DirectoryHandle& dir) const;
+    
+    // List one directory into the stat cache (warm-tree prefetch worker)
+    void prefetchDirectory(const std::string& path) const;
+    
+    // Directory entries from stat cache children, with attributes where known
+    static std::vector<DirectoryEntry> toDirectoryEntries(
+        const std::vector<std::pair<std::string, StatCache::StatInfo>>& children);
+    
+    // Write helpers. Callers hold the object's stripe (exclusively for
+    // uploadToGCS, from the isDirty check on); markDirty/markClean also need
+    // write_state_mutex_.
     int uploadToGCS(const std::string& path) const;
     void markDirty(const std::string& path) const;
+    void markClean(const std::string& path) const;
     bool isDirty(const std::string& path) const;
+    
+    // Write-back: queue a dirty object for background upload (takes the
+    // stripe shared itself, so callers must not hold it), and the upload
+    // run by the queue's workers
+    void queueWriteBack(const std::string& object_name) const;
+    int writeBack(const std::string& object_name) const;
+    
+    // Write buffer helpers. getWriteBuffer returns the buffer marked dirty; it
+    // expects the object's stripe held exclusively and takes write_state_mutex_
+    // itself, as does findWriteBuffer. The rest expect write_state_mutex_ held.
+    int getWriteBuffer(const std::string& path, bool load_existing, std::shared_ptr<std::string>& content) const;
+    std::shared_ptr<std::string> findWriteBuffer(const std::string& object_name) const;
+    // size_hint (the object's size if known, else -1) sizes content up front,
+    // and the load fails if the object ends before it
+    int loadObjectContent(const std::string& object_name, std::string& content, off_t size_hint = -1,
+                          std::int64_t generation = 0) const;
+    bool reserveWriteBuffer(size_t extra_bytes) const;
+    void resizeWriteBuffer(std::string& content, size_t new_size) const;
+    void dropWriteBuffer(const std::string& object_name) const;
+    
+    // Streaming and staging helpers. Finishing a stream and staging expect
+    // the object's stripe held exclusively; the find helpers lock on their own.
+    std::shared_ptr<gcscfuse::ObjectUploadStream> findStreamingWrite(const std::string& object_name) const;
+    std::shared_ptr<gcscfuse::StagingFile> findStagedWrite(const std::string& object_name) const;
+    int finishStreamingWrite(const std::string& path) const;
+    int stageObject(const std::string& path, std::shared_ptr<gcscfuse::StagingFile>& staged) const;
+    int loadObjectToStaging(const std::string& object_name, gcscfuse::StagingFile& staged,
+                            std::int64_t generation = 0, off_t size = 0) const;
+    
+    // Chunked write helpers. chunkObject returns the object's chunked write
+    // marked dirty, starting one if the object is large enough (chunked is
+    // null otherwise); it expects the stripe held exclusively. Uploading
+    // appends a tail by compose when only the end changed, and otherwise
+    // streams the object anew from its clean and dirty chunks. Base reads
+    // are pinned to the base generation and fail with -ESTALE once it is
+    // replaced, and an append only lands on that generation.
+    std::shared_ptr<gcscfuse::ChunkedWrite> findChunkedWrite(const std::string& object_name) const;
+    int chunkObject(const std::string& path, std::shared_ptr<gcscfuse::ChunkedWrite>& chunked) const;
+    int uploadChunkedWrite(const std::string& path, const std::string& object_name,
+                           const gcscfuse::ChunkedWrite& chunked) const;
+    gcscfuse::ChunkedWrite::BaseReader baseReader(const std::string& object_name, std::int64_t generation,
+                                                  size_t base_size) const;
+    
+    // Prioritized request pool over gcs_client_ for concurrent GCS calls,
+    // possibly shared with other mounts. Declared late so background
+    // revalidations finish before the caches they update are destroyed.
+    gcscfuse::AsyncGCSClient async_gcs_client_;
+    
+    // Background uploads of closed files, null unless enable_write_back.
+    // Started in init(); its destructor uploads whatever is still queued,
+    // so it is declared after everything uploads use.
+    std::unique_ptr<gcscfuse::WriteBackQueue> write_back_;
+    
+    // Warm-tree prefetch of subdirectories, null when disabled. Started in
+    // init() so its threads run in the daemonized process; declared last so
+    // it is stopped before anything its workers use is destroyed.
+    std::unique_ptr<gcscfuse::DirectoryPrefetcher> dir_prefetcher_;
 };
@@ -0,0 +1,149 @@
+#include "gcs_fs.hpp"
+#include "gcs/fake_gcs_sdk_client.hpp"
+#include <benchmark/benchmark.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+
+using gcscfuse::FakeGCSSDKClient;
+
+// GCSFS callbacks find their instance through the FUSE context. There is
+// no mount here, so this binary supplies the context in place of libfuse's.
+static struct fuse_context bench_context;
+
+struct fuse_context *fuse_get_context(void)
+{
+    return &bench_context;
+}
+
+namespace {
+
+constexpr int kDirectories = 100;
+constexpr int kFilesPerDirectory = 100;
+constexpr size_t kFileSize = 256 * 1024;
+
+std::string filePath(int dir, int file)
+{
+    return "/dir" + std::to_string(dir) + "/file" + std::to_string(file) + ".dat";
+}
+
+// One filesystem over a fake bucket of kDirectories x kFilesPerDirectory
+// files, shared by every benchmark in this file and kept until exit
+GCSFS& benchFS()
+{
+    static GCSFS* fs = [] {
+        auto fake = std::make_unique<FakeGCSSDKClient>();
+        for (int dir = 0; dir < kDirectories; ++dir) {
+            for (int file = 0; file < kFilesPerDirectory; ++file) {
+                fake->addObject(filePath(dir, file).substr(1), kFileSize);
+            }
+        }
+        GCSFSConfig config;
+        config.bucket_name = "bench-bucket";
+        auto* created = new GCSFS(config.bucket_name, config, std::move(fake));
+        bench_context.private_data = created;
+        struct fuse_conn_info conn;
+        struct fuse_config cfg;
+        std::memset(&conn, 0, sizeof(conn));
+        std::memset(&cfg, 0, sizeof(cfg));
+        GCSFS::init(&conn, &cfg);
+        return created;
+    }();
+    return *fs;
+}
+
+int countEntries(void *buf, const char *, const struct stat *, off_t, enum fuse_fill_dir_flags)
+{
+    ++*static_cast<size_t*>(buf);
+    return 0;
+}
+
+// Arg 0 toggles metrics, to show what instrumentation costs per call
+void setMetrics(benchmark::State& state)
+{
+    gcscfuse::Metrics::global().setEnabled(state.range(0) != 0);
+}
+
+void BM_GetattrCached(benchmark::State& state)
+{
+    benchFS();
+    setMetrics(state);
+    std::vector<std::string> paths;
+    struct stat st;
+    for (int dir = 0; dir < kDirectories; ++dir) {
+        paths.push_back(filePath(dir, dir % kFilesPerDirectory));
+        GCSFS::getattr(paths.back().c_str(), &st, nullptr);
+    }
+    size_t next = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GCSFS::getattr(paths[next].c_str(), &st, nullptr));
+        next = (next + 1) % paths.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetattrCached)->Arg(0)->Arg(1)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_GetattrNegative(benchmark::State& state)
+{
+    benchFS();
+    setMetrics(state);
+    struct stat st;
+    const char* missing = "/dir0/missing.dat";
+    GCSFS::getattr(missing, &st, nullptr);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(GCSFS::getattr(missing, &st, nullptr));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GetattrNegative)->Arg(1);
+
+void BM_ReaddirCached(benchmark::State& state)
+{
+    benchFS();
+    setMetrics(state);
+    const char* dir = "/dir1";
+    for (auto _ : state) {
+        struct fuse_file_info fi;
+        std::memset(&fi, 0, sizeof(fi));
+        GCSFS::opendir(dir, &fi);
+        size_t entries = 0;
+        GCSFS::readdir(dir, &entries, countEntries, 0, &fi, static_cast<enum fuse_readdir_flags>(0));
+        GCSFS::releasedir(dir, &fi);
+        if (entries != kFilesPerDirectory + 2) {
+            state.SkipWithError("unexpected listing");
+            break;
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * kFilesPerDirectory);
+}
+BENCHMARK(BM_ReaddirCached)->Arg(1);
+
+// open + whole-file read + release of files already in the content cache
+void BM_OpenReadRelease(benchmark::State& state)
+{
+    benchFS();
+    setMetrics(state);
+    const size_t read_size = static_cast<size_t>(state.range(1));
+    std::vector<char> buf(read_size);
+    const std::string path = filePath(2, 0);
+    for (auto _ : state) {
+        struct fuse_file_info fi;
+        std::memset(&fi, 0, sizeof(fi));
+        fi.flags = O_RDONLY;
+        if (GCSFS::open(path.c_str(), &fi) != 0) {
+            state.SkipWithError("open failed");
+            break;
+        }
+        for (off_t offset = 0; offset < static_cast<off_t>(kFileSize); offset += static_cast<off_t>(read_size)) {
+            benchmark::DoNotOptimize(GCSFS::read(path.c_str(), buf.data(), read_size, offset, &fi));
+        }
+        GCSFS::release(path.c_str(), &fi);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * kFileSize));
+}
+BENCHMARK(BM_OpenReadRelease)->ArgsProduct({{0, 1}, {4 << 10, 128 << 10}});
+
+}
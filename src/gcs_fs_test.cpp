@@ -0,0 +1,97 @@
+// Unit tests for GCSFS (FUSE callbacks over a fake bucket)
+
+#include <gtest/gtest.h>
+#include "gcs_fs.hpp"
+#include "gcs/fake_gcs_sdk_client.hpp"
+#include <sys/stat.h>
+#include <cstring>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+
+using gcscfuse::FakeGCSSDKClient;
+
+// GCSFS callbacks find their instance through the FUSE context. There is
+// no mount here, so this binary supplies the context in place of libfuse's.
+static struct fuse_context test_context;
+
+struct fuse_context *fuse_get_context(void)
+{
+    return &test_context;
+}
+
+class GCSFSTest : public ::testing::Test {
+protected:
+    void mount(GCSFSConfig config = GCSFSConfig())
+    {
+        auto fake = std::make_unique<FakeGCSSDKClient>();
+        fake_ = fake.get();
+        fake_->addObject("a.txt", "hello");
+        fake_->addObject("dir/b.txt", "world");
+        config.bucket_name = "test-bucket";
+        config.metadata_snapshot_interval = 0;
+        fs_ = std::make_unique<GCSFS>(config.bucket_name, config, std::move(fake));
+        test_context.private_data = fs_.get();
+    }
+
+    void TearDown() override
+    {
+        test_context.private_data = nullptr;
+    }
+
+    int getattr(const char *path)
+    {
+        struct stat st;
+        return GCSFS::getattr(path, &st, nullptr);
+    }
+
+    FakeGCSSDKClient* fake_ = nullptr;
+    std::unique_ptr<GCSFS> fs_;
+};
+
+TEST_F(GCSFSTest, FailedLookupIsNotCachedAsMissing)
+{
+    mount();
+
+    // A 503 on the metadata GET is an error, not ENOENT
+    fake_->failMetadata("a.txt");
+    EXPECT_EQ(getattr("/a.txt"), -EIO);
+
+    // Nothing negative was cached: the file is there once GCS answers
+    fake_->restoreRequests();
+    EXPECT_EQ(getattr("/a.txt"), 0);
+
+    // A confirmed miss still is one
+    EXPECT_EQ(getattr("/missing.txt"), -ENOENT);
+}
+
+TEST_F(GCSFSTest, FailedDirectoryProbeIsNotCachedAsMissing)
+{
+    mount();
+
+    // The object GET finds nothing, but the prefix listing sent with it
+    // fails: the path may still be a directory
+    fake_->failListings("dir/");
+    EXPECT_EQ(getattr("/dir"), -EIO);
+
+    fake_->restoreRequests();
+    EXPECT_EQ(getattr("/dir"), 0);
+}
+
+TEST_F(GCSFSTest, FailedRevalidationKeepsCachedEntry)
+{
+    GCSFSConfig config;
+    config.stat_cache_timeout = 1;
+    config.stale_while_revalidate = 60;
+    mount(config);
+    ASSERT_EQ(getattr("/a.txt"), 0);
+
+    // Past the TTL the entry is served while it is refreshed; the refresh
+    // fails and must leave it in place
+    fake_->failMetadata("a.txt");
+    std::this_thread::sleep_for(std::chrono::milliseconds(2100));
+    EXPECT_EQ(getattr("/a.txt"), 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    EXPECT_EQ(getattr("/a.txt"), 0);
+}
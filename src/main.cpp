@@ -2,6 +2,7 @@
 
 #include "gcs_fs.hpp"
 #include "config.hpp"
+#include "multi_mount.hpp"
 #include <iostream>
 
 int main(int argc, char *argv[])
@@ -10,6 +11,12 @@ int main(int argc, char *argv[])
         // Load configuration from all sources (YAML, env, CLI)
         GCSFSConfig config = GCSFSConfig::load(argc, argv);
         
+        // Several buckets are served by one daemon, one mount each
+        if (!config.buckets.empty()) {
+            MultiMount daemon(config);
+            return daemon.run(argv[0]);
+        }
+        
         // Convert config back to FUSE arguments
         int fuse_argc;
         char** fuse_argv;
@@ -0,0 +1,241 @@
+#include "metrics.hpp"
+#include <cstdio>
+
+namespace gcscfuse {
+
+namespace {
+struct CounterInfo {
+    const char* name;
+    const char* labels;
+    const char* help;
+};
+
+// Counters sharing a name are one metric family and must stay adjacent
+constexpr CounterInfo kCounters[] = {
+    {"gcscfuse_fuse_bytes_total", "direction=\"read\"", "Bytes read and written through the mount."},
+    {"gcscfuse_fuse_bytes_total", "direction=\"write\"", nullptr},
+    {"gcscfuse_gcs_bytes_total", "direction=\"read\"", "Bytes downloaded from and uploaded to GCS."},
+    {"gcscfuse_gcs_bytes_total", "direction=\"write\"", nullptr},
+    {"gcscfuse_gcs_errors_total", "", "GCS requests that failed."},
+    {"gcscfuse_stat_cache_lookups_total", "result=\"hit\"", "Path lookups by stat cache outcome."},
+    {"gcscfuse_stat_cache_lookups_total", "result=\"stale\"", nullptr},
+    {"gcscfuse_stat_cache_lookups_total", "result=\"negative\"", nullptr},
+    {"gcscfuse_stat_cache_lookups_total", "result=\"miss\"", nullptr},
+    {"gcscfuse_listing_cache_lookups_total", "result=\"hit\"", "Directory listings by stat cache outcome."},
+    {"gcscfuse_listing_cache_lookups_total", "result=\"stale\"", nullptr},
+    {"gcscfuse_listing_cache_lookups_total", "result=\"miss\"", nullptr},
+    {"gcscfuse_read_streams_total", "result=\"opened\"", "Reads on open file handles by whether they opened or continued a GCS stream."},
+    {"gcscfuse_read_streams_total", "result=\"reused\"", nullptr},
+    {"gcscfuse_batched_lookups_total", "", "Cold lookups answered by a directory listing shared with concurrent lookups."},
+    {"gcscfuse_chunked_uploads_total", "mode=\"append\"", "Uploads of files edited per chunk, by whether the edit was composed on as a tail or rewrote the object."},
+    {"gcscfuse_chunked_uploads_total", "mode=\"rewrite\"", nullptr},
+    {"gcscfuse_generation_checks_total", "result=\"unchanged\"", "Stale entries revalidated by a conditional GET on their generation, by outcome."},
+    {"gcscfuse_generation_checks_total", "result=\"changed\"", nullptr},
+    {"gcscfuse_stale_handle_reads_total", "", "Reads failed with ESTALE because an open file was replaced in GCS."},
+};
+static_assert(sizeof(kCounters) / sizeof(kCounters[0]) == static_cast<size_t>(MetricCounter::Count),
+              "every MetricCounter needs an entry in kCounters");
+
+// Histogram bucket bounds reported to Prometheus: powers of two from
+// ~1 us to ~17 s, which fall on bucket edges of LatencyHistogram
+constexpr int kFirstReportedExponent = 10;
+constexpr int kLastReportedExponent = 34;
+
+std::string formatSeconds(double seconds)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.9g", seconds);
+    return buf;
+}
+
+void writeHistogram(std::ostream& out, const std::string& name, const char* label,
+                    const char* value, const LatencyHistogram::Snapshot& snapshot)
+{
+    const std::string labels = std::string(label) + "=\"" + value + "\"";
+    for (int exponent = kFirstReportedExponent; exponent <= kLastReportedExponent; ++exponent) {
+        const std::uint64_t limit = 1ULL << exponent;
+        out << name << "_bucket{" << labels << ",le=\"" << formatSeconds(static_cast<double>(limit) / 1e9)
+            << "\"} " << snapshot.countBelow(limit) << "\n";
+    }
+    out << name << "_bucket{" << labels << ",le=\"+Inf\"} " << snapshot.count << "\n";
+    out << name << "_sum{" << labels << "} " << formatSeconds(static_cast<double>(snapshot.sum_ns) / 1e9) << "\n";
+    out << name << "_count{" << labels << "} " << snapshot.count << "\n";
+}
+}
+
+const char* fuseOpName(FuseOp op)
+{
+    switch (op) {
+        case FuseOp::Getattr:    return "getattr";
+        case FuseOp::Opendir:    return "opendir";
+        case FuseOp::Readdir:    return "readdir";
+        case FuseOp::Releasedir: return "releasedir";
+        case FuseOp::Open:       return "open";
+        case FuseOp::Read:       return "read";
+        case FuseOp::Create:     return "create";
+        case FuseOp::Write:      return "write";
+        case FuseOp::Truncate:   return "truncate";
+        case FuseOp::Flush:      return "flush";
+        case FuseOp::Release:    return "release";
+        case FuseOp::Fsync:      return "fsync";
+        case FuseOp::Unlink:     return "unlink";
+        case FuseOp::Count:      break;
+    }
+    return "unknown";
+}
+
+const char* gcsRpcName(GCSRpc rpc)
+{
+    switch (rpc) {
+        case GCSRpc::GetObjectMetadata: return "get_object_metadata";
+        case GCSRpc::ListObjects:       return "list_objects";
+        case GCSRpc::ReadObject:        return "read_object";
+        case GCSRpc::WriteObject:       return "write_object";
+        case GCSRpc::FinalizeUpload:    return "finalize_upload";
+        case GCSRpc::ComposeObject:     return "compose_object";
+        case GCSRpc::DeleteObject:      return "delete_object";
+        case GCSRpc::Count:             break;
+    }
+    return "unknown";
+}
+
+size_t StripedCounter::stripeIndex()
+{
+    static std::atomic<size_t> next_stripe{0};
+    thread_local const size_t stripe = next_stripe.fetch_add(1, std::memory_order_relaxed) % kStripes;
+    return stripe;
+}
+
+std::uint64_t StripedCounter::value() const
+{
+    std::uint64_t total = 0;
+    for (const auto& stripe : stripes_) {
+        total += stripe.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+size_t LatencyHistogram::bucketIndex(std::uint64_t value_ns)
+{
+    constexpr std::uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+    constexpr std::uint64_t kMaxValue = (1ULL << kMaxExponent) - 1;
+    if (value_ns > kMaxValue) {
+        value_ns = kMaxValue;
+    }
+    if (value_ns < kSubBuckets) {
+        return static_cast<size_t>(value_ns);
+    }
+    // The top kSubBucketBits + 1 bits pick the bucket within the value's power of two
+    const int exponent = 63 - __builtin_clzll(value_ns);
+    const int shift = exponent - kSubBucketBits;
+    const std::uint64_t sub_bucket = (value_ns >> shift) - kSubBuckets;
+    return (static_cast<size_t>(shift + 1) << kSubBucketBits) + static_cast<size_t>(sub_bucket);
+}
+
+std::uint64_t LatencyHistogram::bucketLowerBound(size_t index)
+{
+    constexpr std::uint64_t kSubBuckets = 1ULL << kSubBucketBits;
+    const size_t group = index >> kSubBucketBits;
+    const std::uint64_t sub_bucket = index & (kSubBuckets - 1);
+    if (group == 0) {
+        return sub_bucket;
+    }
+    return (kSubBuckets + sub_bucket) << (group - 1);
+}
+
+std::uint64_t LatencyHistogram::bucketUpperBound(size_t index)
+{
+    const size_t group = index >> kSubBucketBits;
+    return bucketLowerBound(index) + (group == 0 ? 1 : (1ULL << (group - 1)));
+}
+
+LatencyHistogram::Snapshot LatencyHistogram::snapshot() const
+{
+    Snapshot result;
+    for (const auto& stripe : stripes_) {
+        for (size_t i = 0; i < kBuckets; ++i) {
+            const std::uint64_t n = stripe.counts[i].load(std::memory_order_relaxed);
+            result.counts[i] += n;
+            result.count += n;
+        }
+        result.sum_ns += stripe.sum_ns.load(std::memory_order_relaxed);
+    }
+    return result;
+}
+
+std::uint64_t LatencyHistogram::Snapshot::percentile(double q) const
+{
+    if (count == 0) {
+        return 0;
+    }
+    const double target = q * static_cast<double>(count);
+    std::uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += counts[i];
+        if (counts[i] > 0 && static_cast<double>(seen) >= target) {
+            return bucketUpperBound(i);
+        }
+    }
+    return bucketUpperBound(kBuckets - 1);
+}
+
+std::uint64_t LatencyHistogram::Snapshot::countBelow(std::uint64_t limit_ns) const
+{
+    std::uint64_t total = 0;
+    for (size_t i = 0; i < kBuckets && bucketUpperBound(i) <= limit_ns; ++i) {
+        total += counts[i];
+    }
+    return total;
+}
+
+Metrics& Metrics::global()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+void Metrics::render(std::ostream& out) const
+{
+    const std::string op_metric = "gcscfuse_fuse_op_duration_seconds";
+    writeMetricHeader(out, op_metric, "histogram", "Latency of FUSE operations.");
+    for (size_t i = 0; i < ops_.size(); ++i) {
+        auto snapshot = ops_[i].snapshot();
+        if (snapshot.count > 0) {
+            writeHistogram(out, op_metric, "op", fuseOpName(static_cast<FuseOp>(i)), snapshot);
+        }
+    }
+
+    const std::string rpc_metric = "gcscfuse_gcs_request_duration_seconds";
+    writeMetricHeader(out, rpc_metric, "histogram", "Latency of GCS requests.");
+    for (size_t i = 0; i < rpcs_.size(); ++i) {
+        auto snapshot = rpcs_[i].snapshot();
+        if (snapshot.count > 0) {
+            writeHistogram(out, rpc_metric, "rpc", gcsRpcName(static_cast<GCSRpc>(i)), snapshot);
+        }
+    }
+
+    for (size_t i = 0; i < counters_.size(); ++i) {
+        const CounterInfo& info = kCounters[i];
+        if (info.help) {
+            writeMetricHeader(out, info.name, "counter", info.help);
+        }
+        writeSample(out, info.name, info.labels, counters_[i].value());
+    }
+}
+
+void writeMetricHeader(std::ostream& out, const std::string& name, const char* type, const std::string& help)
+{
+    out << "# HELP " << name << " " << help << "\n";
+    out << "# TYPE " << name << " " << type << "\n";
+}
+
+void writeSample(std::ostream& out, const std::string& name, const std::string& labels, std::uint64_t value)
+{
+    out << name;
+    if (!labels.empty()) {
+        out << "{" << labels << "}";
+    }
+    out << " " << value << "\n";
+}
+
+} // namespace gcscfuse
@@ -0,0 +1,220 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace gcscfuse {
+
+// FUSE callbacks timed by Metrics
+enum class FuseOp {
+    Getattr,
+    Opendir,
+    Readdir,
+    Releasedir,
+    Open,
+    Read,
+    Create,
+    Write,
+    Truncate,
+    Flush,
+    Release,
+    Fsync,
+    Unlink,
+    Count,
+};
+
+// GCS requests timed by Metrics
+enum class GCSRpc {
+    GetObjectMetadata,
+    ListObjects,      // time to the first page of a listing
+    ReadObject,
+    WriteObject,
+    FinalizeUpload,   // closing a streaming upload
+    ComposeObject,
+    DeleteObject,
+    Count,
+};
+
+// Event counters kept by Metrics
+enum class MetricCounter {
+    FuseBytesRead,
+    FuseBytesWritten,
+    GCSBytesRead,
+    GCSBytesWritten,
+    GCSErrors,
+    StatCacheHits,
+    StatCacheStaleHits,
+    StatCacheNegativeHits,
+    StatCacheMisses,
+    ListingCacheHits,
+    ListingCacheStaleHits,
+    ListingCacheMisses,
+    ReadStreamsOpened,
+    ReadStreamsReused,
+    BatchedLookups,
+    ChunkedAppends,
+    ChunkedRewrites,
+    GenerationChecksUnchanged,
+    GenerationChecksChanged,
+    StaleHandles,
+    Count,
+};
+
+const char* fuseOpName(FuseOp op);
+const char* gcsRpcName(GCSRpc rpc);
+
+/**
+ * StripedCounter - Lock-free counter for hot paths
+ *
+ * Each thread adds to one of kStripes cache-line-sized slots, so threads
+ * counting the same event do not bounce a cache line between cores.
+ * value() sums the slots and may miss adds that race with it.
+ */
+class StripedCounter {
+public:
+    static constexpr size_t kStripes = 8;
+
+    void add(std::uint64_t n = 1) {
+        stripes_[stripeIndex()].value.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    std::uint64_t value() const;
+
+    // Slot used by the calling thread, assigned round-robin on first use
+    static size_t stripeIndex();
+
+private:
+    struct alignas(64) Stripe {
+        std::atomic<std::uint64_t> value{0};
+    };
+    std::array<Stripe, kStripes> stripes_{};
+};
+
+/**
+ * LatencyHistogram - HDR-style histogram of durations in nanoseconds
+ *
+ * Buckets are log-linear: each power of two is split into 2^kSubBucketBits
+ * equal buckets, so any recorded value is known to within 12.5% while the
+ * whole range from 1 ns to ~18 minutes (longer durations are clamped) fits
+ * in kBuckets counters. Recording is two relaxed atomic adds on the
+ * caller's stripe; snapshot() merges the stripes.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int kSubBucketBits = 3;
+    static constexpr int kMaxExponent = 40;  // values below 2^40 ns are bucketed exactly
+    static constexpr size_t kBuckets = static_cast<size_t>(kMaxExponent - kSubBucketBits + 1) << kSubBucketBits;
+
+    struct Snapshot {
+        std::array<std::uint64_t, kBuckets> counts{};
+        std::uint64_t count = 0;
+        std::uint64_t sum_ns = 0;
+
+        // Upper bound of the bucket holding quantile q (0..1), 0 when empty
+        std::uint64_t percentile(double q) const;
+        // Recorded values below limit_ns, counted by whole buckets
+        std::uint64_t countBelow(std::uint64_t limit_ns) const;
+    };
+
+    void record(std::uint64_t value_ns) {
+        Stripe& stripe = stripes_[StripedCounter::stripeIndex()];
+        stripe.counts[bucketIndex(value_ns)].fetch_add(1, std::memory_order_relaxed);
+        stripe.sum_ns.fetch_add(value_ns, std::memory_order_relaxed);
+    }
+
+    Snapshot snapshot() const;
+
+    static size_t bucketIndex(std::uint64_t value_ns);
+    static std::uint64_t bucketLowerBound(size_t index);
+    // Exclusive upper bound
+    static std::uint64_t bucketUpperBound(size_t index);
+
+private:
+    struct alignas(64) Stripe {
+        std::array<std::atomic<std::uint64_t>, kBuckets> counts{};
+        std::atomic<std::uint64_t> sum_ns{0};
+    };
+    std::array<Stripe, StripedCounter::kStripes> stripes_{};
+};
+
+/**
+ * ScopedLatency - Records the time from construction to destruction
+ *
+ * A null histogram records nothing, so disabled metrics cost no clock reads.
+ */
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyHistogram* histogram)
+        : histogram_(histogram),
+          start_(histogram ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+
+    ~ScopedLatency() {
+        if (histogram_) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            histogram_->record(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+    ScopedLatency(const ScopedLatency&) = delete;
+    ScopedLatency& operator=(const ScopedLatency&) = delete;
+
+private:
+    LatencyHistogram* histogram_;
+    std::chrono::steady_clock::time_point start_;
+};
+
+/**
+ * Metrics - Latency histograms and counters for FUSE ops and GCS requests
+ *
+ * The process-wide instance (global()) is shared by GCSFS and GCSClient and
+ * is rendered by GCSFS into the virtual stats file. Everything is recorded
+ * with relaxed atomics and never takes a lock. When disabled, timers and
+ * counters are no-ops.
+ */
+class Metrics {
+public:
+    static Metrics& global();
+
+    void setEnabled(bool enabled) { enabled_.store(enabled, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // Time the enclosing scope as one call of op / rpc
+    ScopedLatency time(FuseOp op) {
+        return ScopedLatency(enabled() ? &ops_[static_cast<size_t>(op)] : nullptr);
+    }
+    ScopedLatency time(GCSRpc rpc) {
+        return ScopedLatency(enabled() ? &rpcs_[static_cast<size_t>(rpc)] : nullptr);
+    }
+
+    void add(MetricCounter counter, std::uint64_t n = 1) {
+        if (enabled()) {
+            counters_[static_cast<size_t>(counter)].add(n);
+        }
+    }
+
+    const LatencyHistogram& histogram(FuseOp op) const { return ops_[static_cast<size_t>(op)]; }
+    const LatencyHistogram& histogram(GCSRpc rpc) const { return rpcs_[static_cast<size_t>(rpc)]; }
+    std::uint64_t value(MetricCounter counter) const { return counters_[static_cast<size_t>(counter)].value(); }
+
+    // Everything recorded so far, in the Prometheus text exposition format
+    void render(std::ostream& out) const;
+
+private:
+    std::atomic<bool> enabled_{true};
+    std::array<LatencyHistogram, static_cast<size_t>(FuseOp::Count)> ops_;
+    std::array<LatencyHistogram, static_cast<size_t>(GCSRpc::Count)> rpcs_;
+    std::array<StripedCounter, static_cast<size_t>(MetricCounter::Count)> counters_;
+};
+
+// Prometheus text exposition helpers, for values kept outside Metrics.
+// labels is preformatted (e.g. cache="content"), empty for none.
+void writeMetricHeader(std::ostream& out, const std::string& name, const char* type, const std::string& help);
+void writeSample(std::ostream& out, const std::string& name, const std::string& labels, std::uint64_t value);
+
+} // namespace gcscfuse
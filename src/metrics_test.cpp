@@ -0,0 +1,125 @@
+#include "metrics.hpp"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using gcscfuse::FuseOp;
+using gcscfuse::GCSRpc;
+using gcscfuse::LatencyHistogram;
+using gcscfuse::MetricCounter;
+using gcscfuse::Metrics;
+
+TEST(LatencyHistogramTest, BucketsCoverValuesWithBoundedError) {
+    for (std::uint64_t value : {0ULL, 1ULL, 7ULL, 8ULL, 9ULL, 100ULL, 1023ULL, 1024ULL,
+                                123456789ULL, (1ULL << 39) + 12345}) {
+        size_t index = LatencyHistogram::bucketIndex(value);
+        ASSERT_LT(index, LatencyHistogram::kBuckets);
+        EXPECT_LE(LatencyHistogram::bucketLowerBound(index), value);
+        EXPECT_GT(LatencyHistogram::bucketUpperBound(index), value);
+        // Bucket width never exceeds 1/8 of its lower bound
+        EXPECT_LE(LatencyHistogram::bucketUpperBound(index) - LatencyHistogram::bucketLowerBound(index),
+                  std::max<std::uint64_t>(1, LatencyHistogram::bucketLowerBound(index) / 8));
+    }
+}
+
+TEST(LatencyHistogramTest, BucketsAreContiguous) {
+    for (size_t i = 1; i < LatencyHistogram::kBuckets; ++i) {
+        EXPECT_EQ(LatencyHistogram::bucketLowerBound(i), LatencyHistogram::bucketUpperBound(i - 1));
+    }
+}
+
+TEST(LatencyHistogramTest, HugeValuesAreClamped) {
+    EXPECT_EQ(LatencyHistogram::bucketIndex(~0ULL), LatencyHistogram::kBuckets - 1);
+}
+
+TEST(LatencyHistogramTest, PercentilesAndCounts) {
+    LatencyHistogram histogram;
+    for (int i = 0; i < 99; i++) {
+        histogram.record(1000);     // 1 us
+    }
+    histogram.record(1000000);      // 1 ms
+
+    auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count, 100u);
+    EXPECT_EQ(snapshot.sum_ns, 99u * 1000 + 1000000);
+    EXPECT_GT(snapshot.percentile(0.5), 1000u);
+    EXPECT_LE(snapshot.percentile(0.5), 1125u);
+    EXPECT_GT(snapshot.percentile(1.0), 1000000u);
+    EXPECT_EQ(snapshot.countBelow(1024), 99u);
+    EXPECT_EQ(snapshot.countBelow(1ULL << 20), 100u);
+}
+
+TEST(LatencyHistogramTest, ConcurrentRecordsAreAllCounted) {
+    LatencyHistogram histogram;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 16; t++) {
+        threads.emplace_back([&histogram] {
+            for (int i = 0; i < 10000; i++) {
+                histogram.record(static_cast<std::uint64_t>(i));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(histogram.snapshot().count, 160000u);
+}
+
+TEST(MetricsTest, TimersAndCountersRecord) {
+    Metrics metrics;
+    {
+        auto timer = metrics.time(FuseOp::Getattr);
+    }
+    {
+        auto timer = metrics.time(GCSRpc::ReadObject);
+    }
+    metrics.add(MetricCounter::FuseBytesRead, 4096);
+    metrics.add(MetricCounter::StatCacheHits);
+
+    EXPECT_EQ(metrics.histogram(FuseOp::Getattr).snapshot().count, 1u);
+    EXPECT_EQ(metrics.histogram(GCSRpc::ReadObject).snapshot().count, 1u);
+    EXPECT_EQ(metrics.value(MetricCounter::FuseBytesRead), 4096u);
+    EXPECT_EQ(metrics.value(MetricCounter::StatCacheHits), 1u);
+}
+
+TEST(MetricsTest, DisabledMetricsRecordNothing) {
+    Metrics metrics;
+    metrics.setEnabled(false);
+    {
+        auto timer = metrics.time(FuseOp::Read);
+    }
+    metrics.add(MetricCounter::FuseBytesRead, 10);
+
+    EXPECT_EQ(metrics.histogram(FuseOp::Read).snapshot().count, 0u);
+    EXPECT_EQ(metrics.value(MetricCounter::FuseBytesRead), 0u);
+}
+
+TEST(MetricsTest, RendersPrometheusText) {
+    Metrics metrics;
+    {
+        auto timer = metrics.time(FuseOp::Read);
+    }
+    metrics.add(MetricCounter::GCSBytesRead, 123);
+
+    std::ostringstream out;
+    metrics.render(out);
+    const std::string text = out.str();
+
+    EXPECT_NE(text.find("# TYPE gcscfuse_fuse_op_duration_seconds histogram\n"), std::string::npos);
+    EXPECT_NE(text.find("gcscfuse_fuse_op_duration_seconds_count{op=\"read\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("gcscfuse_fuse_op_duration_seconds_bucket{op=\"read\",le=\"+Inf\"} 1\n"), std::string::npos);
+    EXPECT_NE(text.find("gcscfuse_gcs_bytes_total{direction=\"read\"} 123\n"), std::string::npos);
+    // Ops never called are left out
+    EXPECT_EQ(text.find("op=\"unlink\""), std::string::npos);
+    // One header per metric family
+    const std::string header = "# TYPE gcscfuse_stat_cache_lookups_total counter";
+    EXPECT_EQ(text.find(header), text.rfind(header));
+}
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,188 @@
+// Multi-bucket daemon: one FUSE session per bucket over shared resources
+
+#include "multi_mount.hpp"
+#include "gcs_fs.hpp"
+#include <fuse_lowlevel.h>
+#include <atomic>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <pthread.h>
+
+struct MultiMount::Mount {
+    GCSFSConfig config;
+    std::unique_ptr<GCSFS> fs;
+    struct fuse *fuse = nullptr;
+    bool mounted = false;
+    bool single_thread = false;
+    struct fuse_loop_config loop_config{};
+    std::thread loop;
+    std::atomic<bool> done{false};
+    int status = 0;
+};
+
+MultiMount::MultiMount(const GCSFSConfig& config)
+    : config_(config)
+{
+}
+
+MultiMount::~MultiMount()
+{
+    stop();
+}
+
+int MultiMount::run(const char* program_name)
+{
+    // Signals are taken by waitForStop(); they are blocked before any thread
+    // starts, so every thread inherits the mask and none is killed by one
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    sigaddset(&signals, SIGHUP);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    GCSFS::Shared shared;
+    shared.gcs_client = std::make_shared<gcscfuse::GCSClient>(GCSFS::makeSDKClient(config_));
+    if (config_.enable_file_content_cache) {
+        shared.content_cache = std::make_shared<gcscfuse::ContentCache>(
+            static_cast<size_t>(config_.content_cache_block_size_mb) * 1024 * 1024,
+            static_cast<size_t>(config_.max_content_cache_mb) * 1024 * 1024);
+    }
+    shared.scheduler = std::make_shared<gcscfuse::RequestScheduler>(
+        static_cast<size_t>(config_.gcs_max_concurrent_requests),
+        static_cast<size_t>(config_.gcs_max_bulk_requests));
+
+    bool foreground = false;
+    for (const auto& bucket : config_.mountedBuckets()) {
+        auto entry = std::make_unique<Mount>();
+        entry->config = config_.forBucket(bucket);
+
+        std::error_code ec;
+        std::filesystem::create_directories(entry->config.mount_point, ec);
+        if (ec) {
+            std::cerr << "Cannot create mount point " << entry->config.mount_point << ": "
+                      << ec.message() << std::endl;
+            stop();
+            return 1;
+        }
+
+        entry->fs = std::make_unique<GCSFS>(bucket, entry->config, shared);
+        const bool mounted = mount(*entry, program_name, foreground);
+        mounts_.push_back(std::move(entry));
+        if (!mounted) {
+            stop();
+            return 1;
+        }
+    }
+
+    if (fuse_daemonize(foreground ? 1 : 0) != 0) {
+        stop();
+        return 1;
+    }
+
+    for (auto& entry : mounts_) {
+        Mount* m = entry.get();
+        m->loop = std::thread([m] {
+            m->status = m->single_thread ? fuse_loop(m->fuse) : fuse_loop_mt(m->fuse, &m->loop_config);
+            m->done = true;
+        });
+    }
+    std::cout << "Serving " << mounts_.size() << " buckets under " << config_.mount_point << std::endl;
+
+    waitForStop(signals);
+    return stop();
+}
+
+bool MultiMount::mount(Mount& mount, const char* program_name, bool& foreground)
+{
+    // The same FUSE arguments as a single mount, with the bucket's mount point
+    std::vector<std::string> arg_strings{program_name, mount.config.mount_point};
+    arg_strings.insert(arg_strings.end(), config_.fuse_args.begin(), config_.fuse_args.end());
+    std::vector<char *> argv;
+    for (auto& arg : arg_strings) {
+        argv.push_back(&arg[0]);
+    }
+    argv.push_back(nullptr);
+
+    struct fuse_args args = FUSE_ARGS_INIT(static_cast<int>(arg_strings.size()), argv.data());
+    struct fuse_cmdline_opts opts;
+    if (fuse_parse_cmdline(&args, &opts) != 0) {
+        fuse_opt_free_args(&args);
+        return false;
+    }
+    std::free(opts.mountpoint);
+    foreground = opts.foreground != 0;
+    mount.single_thread = opts.singlethread != 0;
+    mount.loop_config.clone_fd = opts.clone_fd;
+    mount.loop_config.max_idle_threads = opts.max_idle_threads;
+
+    mount.fuse = fuse_new(&args, GCSFS::Operations(), sizeof(*GCSFS::Operations()), mount.fs.get());
+    fuse_opt_free_args(&args);
+    if (mount.fuse == nullptr) {
+        std::cerr << "Cannot create FUSE session for bucket " << mount.config.bucket_name << std::endl;
+        return false;
+    }
+    if (fuse_mount(mount.fuse, mount.config.mount_point.c_str()) != 0) {
+        std::cerr << "Cannot mount bucket " << mount.config.bucket_name << " at "
+                  << mount.config.mount_point << std::endl;
+        return false;
+    }
+    mount.mounted = true;
+    return true;
+}
+
+void MultiMount::waitForStop(const sigset_t& signals) const
+{
+    while (true) {
+        bool all_done = true;
+        for (const auto& entry : mounts_) {
+            all_done = all_done && entry->done;
+        }
+        if (all_done) {
+            return;
+        }
+
+        // Wake up now and then to notice mounts that ended on their own
+        struct timespec timeout = {1, 0};
+        int signal = sigtimedwait(&signals, nullptr, &timeout);
+        if (signal > 0) {
+            std::cout << "Received signal " << signal << ", unmounting all buckets" << std::endl;
+            return;
+        }
+    }
+}
+
+int MultiMount::stop()
+{
+    // Unmounting ends each session's loop, as an outside unmount would
+    for (auto& entry : mounts_) {
+        if (entry->fuse != nullptr) {
+            fuse_exit(entry->fuse);
+        }
+        if (entry->mounted) {
+            fuse_unmount(entry->fuse);
+            entry->mounted = false;
+        }
+    }
+
+    int status = 0;
+    for (auto& entry : mounts_) {
+        if (entry->loop.joinable()) {
+            entry->loop.join();
+        }
+        if (entry->status != 0) {
+            status = 1;
+        }
+        // Calls GCSFS::destroy(), which drains write-back and saves the stat cache
+        if (entry->fuse != nullptr) {
+            fuse_destroy(entry->fuse);
+            entry->fuse = nullptr;
+        }
+    }
+    mounts_.clear();
+    return status;
+}
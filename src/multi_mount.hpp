@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <signal.h>
+#include "config.hpp"
+
+/**
+ * MultiMount - Several buckets served by one daemon
+ *
+ * Each bucket of config.buckets is mounted at mount_point/<bucket> as a FUSE
+ * session of its own, with its own loop thread. The mounts share one
+ * GCSClient, and with it one pool of HTTP connections, one request scheduler,
+ * so gcs_max_concurrent_requests bounds the daemon and not each mount, and
+ * one content cache holding max_content_cache_mb across all of them. Metrics
+ * are process-wide, so /.gcscfuse/stats in any mount shows the daemon's
+ * totals. Stat caches and write buffers stay per mount, and each disk cache
+ * gets a fixed share of max_disk_cache_mb (see GCSFSConfig::forBucket).
+ *
+ * SIGINT, SIGTERM and SIGHUP unmount every bucket; the daemon also exits once
+ * all of its buckets have been unmounted from outside.
+ */
+class MultiMount {
+public:
+    explicit MultiMount(const GCSFSConfig& config);
+    ~MultiMount();
+
+    MultiMount(const MultiMount&) = delete;
+    MultiMount& operator=(const MultiMount&) = delete;
+
+    // Mount every bucket and serve them until stopped; returns the exit status
+    int run(const char* program_name);
+
+private:
+    struct Mount;
+
+    // Create the bucket's session and mount it; false on failure
+    bool mount(Mount& mount, const char* program_name, bool& foreground);
+
+    // Wait for a signal, or for every session to end on its own
+    void waitForStop(const sigset_t& signals) const;
+
+    // Unmount and tear down every session; returns the exit status
+    int stop();
+
+    GCSFSConfig config_;
+    std::vector<std::unique_ptr<Mount>> mounts_;
+};
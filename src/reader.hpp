@@ -2,11 +2,35 @@
 
 #include <string>
 #include <memory>
+#include <algorithm>
+#include <cerrno>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
+#include <unistd.h>
 #include "gcs/gcs_client.hpp"
+#include "content_cache.hpp"
+#include "disk_cache.hpp"
+#include "single_flight.hpp"
+#include "metrics.hpp"
 
 namespace gcscfuse {
 
+// A range of object content that already sits in a local file, so it can be
+// spliced to the kernel without being copied through user space. `owner`
+// keeps the descriptor open for as long as the extent is referenced.
+struct FileExtent {
+    std::shared_ptr<const void> owner;
+    int fd = -1;
+    off_t pos = 0;
+    size_t size = 0;
+};
+
 // Interface for reading file content from persistent storage
 // This abstracts away the actual source (GCS, cache, dummy data)
 class IReader {
@@ -14,11 +38,36 @@ public:
     virtual ~IReader() = default;
     
     // Read content from a file at the given object name
-    // Returns the number of bytes read, or -1 on error
+    // `handle` identifies the open file (fi->fh) for readers that keep
+    // per-handle state; 0 means the read is not tied to an open file.
+    // A nonzero `generation` pins the read to that GCS generation of the
+    // object: cached bytes of any other generation are not served, and a
+    // replaced object reads as EOF rather than as the new content.
+    // Returns the number of bytes read, or a negative value on error. A
+    // read cut short by an error fails rather than returning the bytes
+    // before it, which would pass for the end of the object.
     virtual int read(const std::string& object_name, 
                      char* buf, 
                      size_t size, 
-                     off_t offset) = 0;
+                     off_t offset,
+                     std::uint64_t handle = 0,
+                     std::int64_t generation = 0) = 0;
+    
+    // Optional: Report where bytes starting at offset sit in a local file.
+    // The extent may cover less than size (e.g. up to a block boundary).
+    // Returns false when the data is not available that way; use read().
+    virtual bool locate(const std::string& object_name,
+                        size_t size,
+                        off_t offset,
+                        FileExtent& extent,
+                        std::int64_t generation = 0) { return false; }
+    
+    // Optional: Note a newly opened file handle and the object size known at
+    // open (-1 if unknown), for readers that adapt to each handle
+    virtual void open(std::uint64_t handle, const std::string& object_name, off_t object_size) {}
+    
+    // Optional: Drop any state kept for a released file handle
+    virtual void release(std::uint64_t handle) {}
     
     // Optional: Invalidate cache for a specific object
     virtual void invalidate(const std::string& object_name) {}
@@ -27,9 +76,19 @@ public:
     virtual void clear() {}
 };
 
-// Direct GCS reader - terminal implementation that always reads from GCS
+// Direct GCS reader - terminal implementation that always reads from GCS.
+// Reads without a file handle are one ranged GET each. Handles announced
+// through open() keep their GETs open as ObjectDownloadStreams, so a read
+// that starts where an earlier one stopped continues on the same stream
+// rather than opening another connection; a read anywhere else opens a
+// new stream from its offset. Pinned reads ask GCS for their generation,
+// so they never see a newer version of the object.
 class GCSDirectReader : public IReader {
 public:
+    // Idle streams kept per handle. Read-ahead has several chunks of one
+    // handle in flight at once, each on a stream of its own.
+    static constexpr size_t kMaxStreamsPerHandle = 4;
+    
     GCSDirectReader(const std::string& bucket_name, 
                     gcscfuse::GCSClient& gcs_client,
                     bool debug_mode = false)
@@ -37,141 +96,1108 @@ public:
           gcs_client_(gcs_client),
           debug_mode_(debug_mode) {}
     
+    void open(std::uint64_t handle, const std::string& object_name, off_t) override {
+        if (handle == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        HandleStreams& streams = streams_[handle];
+        streams.object_name = object_name;
+        streams.epoch++;
+        streams.idle.clear();
+    }
+    
     int read(const std::string& object_name, 
              char* buf, 
              size_t size, 
-             off_t offset) override {
+             off_t offset,
+             std::uint64_t handle = 0,
+             std::int64_t generation = 0) override {
         if (debug_mode_) {
             std::cout << "[DEBUG] Reading from GCS: " << object_name << std::endl;
         }
         
-        gcscfuse::IGCSSDKClient::ReadObjectRequest req;
-        req.bucket_name = bucket_name_;
-        req.object_name = object_name;
-        req.range = std::make_optional(std::make_pair(
-            static_cast<std::int64_t>(offset), 
-            static_cast<std::int64_t>(offset + size)));
-        
-        std::string content = gcs_client_.readObject(req);
-        size_t len = content.length();
-        
-        if (len > 0) {
-            if (len < size) size = len;
-            std::memcpy(buf, content.c_str(), size);
-            return static_cast<int>(size);
+        std::optional<std::uint64_t> epoch;
+        std::unique_ptr<gcscfuse::ObjectDownloadStream> stream =
+            takeStream(handle, object_name, offset, generation, epoch);
+        if (!epoch) {
+            gcscfuse::IGCSSDKClient::ReadObjectRequest req;
+            req.bucket_name = bucket_name_;
+            req.object_name = object_name;
+            req.range = std::make_optional(std::make_pair(
+                static_cast<std::int64_t>(offset), 
+                static_cast<std::int64_t>(offset + size)));
+            if (generation != 0) {
+                req.generation = generation;
+            }
+            
+            // The SDK stream fills buf directly. A failed read is never a
+            // short one: the caches above take a short read as the end.
+            ssize_t len = gcs_client_.readObject(req, buf, size);
+            return len >= 0 ? static_cast<int>(len) : -EIO;
         }
         
-        return 0;
+        ssize_t len = -1;
+        if (stream) {
+            gcscfuse::Metrics::global().add(gcscfuse::MetricCounter::ReadStreamsReused);
+            len = stream->read(buf, size);
+            if (len < 0 && debug_mode_) {
+                std::cout << "[DEBUG] Reopening failed read stream: " << object_name
+                          << " at offset " << offset << std::endl;
+            }
+        }
+        // A stream left idle may have been closed by the server; one fresh
+        // stream gets the read either way
+        if (len < 0) {
+            stream = gcs_client_.openDownloadStream(bucket_name_, object_name, offset, generation);
+            if (!stream) {
+                return -EIO;
+            }
+            gcscfuse::Metrics::global().add(gcscfuse::MetricCounter::ReadStreamsOpened);
+            len = stream->read(buf, size);
+        }
+        if (len > 0 && !stream->done()) {
+            putStream(handle, *epoch, std::move(stream));
+        }
+        return len >= 0 ? static_cast<int>(len) : -EIO;
+    }
+    
+    void release(std::uint64_t handle) override {
+        std::unique_ptr<HandleStreams> released;
+        {
+            std::lock_guard<std::mutex> lock(streams_mutex_);
+            auto it = streams_.find(handle);
+            if (it == streams_.end()) {
+                return;
+            }
+            // Closed outside the lock
+            released = std::make_unique<HandleStreams>(std::move(it->second));
+            streams_.erase(it);
+        }
+    }
+    
+    void invalidate(const std::string& object_name) override {
+        std::vector<std::unique_ptr<gcscfuse::ObjectDownloadStream>> dropped;
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        for (auto& [handle, streams] : streams_) {
+            if (streams.object_name == object_name) {
+                streams.epoch++;
+                for (auto& stream : streams.idle) {
+                    dropped.push_back(std::move(stream));
+                }
+                streams.idle.clear();
+            }
+        }
+    }
+    
+    // Handles with a stream table, for tests
+    size_t trackedHandles() const {
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        return streams_.size();
     }
 
 private:
+    struct HandleStreams {
+        std::string object_name;
+        std::uint64_t epoch = 0;  // bumped when the content may have changed
+        std::vector<std::unique_ptr<gcscfuse::ObjectDownloadStream>> idle;
+    };
+    
+    // Take the idle stream positioned at offset on the generation, if any.
+    // epoch is set when the handle was opened for object_name and so may
+    // keep streams.
+    std::unique_ptr<gcscfuse::ObjectDownloadStream> takeStream(std::uint64_t handle, const std::string& object_name,
+                                                               off_t offset, std::int64_t generation,
+                                                               std::optional<std::uint64_t>& epoch) {
+        if (handle == 0) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        auto it = streams_.find(handle);
+        if (it == streams_.end() || it->second.object_name != object_name) {
+            return nullptr;
+        }
+        epoch = it->second.epoch;
+        auto& idle = it->second.idle;
+        for (auto stream = idle.begin(); stream != idle.end(); ++stream) {
+            if ((*stream)->offset() == static_cast<std::int64_t>(offset) &&
+                (*stream)->generation() == generation) {
+                auto taken = std::move(*stream);
+                idle.erase(stream);
+                return taken;
+            }
+        }
+        return nullptr;
+    }
+    
+    void putStream(std::uint64_t handle, std::uint64_t epoch,
+                   std::unique_ptr<gcscfuse::ObjectDownloadStream> stream) {
+        std::unique_ptr<gcscfuse::ObjectDownloadStream> dropped;
+        std::lock_guard<std::mutex> lock(streams_mutex_);
+        auto it = streams_.find(handle);
+        // Released or invalidated while the read was in flight
+        if (it == streams_.end() || it->second.epoch != epoch) {
+            dropped = std::move(stream);
+            return;
+        }
+        auto& idle = it->second.idle;
+        if (idle.size() >= kMaxStreamsPerHandle) {
+            dropped = std::move(idle.front());
+            idle.erase(idle.begin());
+        }
+        idle.push_back(std::move(stream));
+    }
+
     std::string bucket_name_;
     gcscfuse::GCSClient& gcs_client_;
     bool debug_mode_;
+    mutable std::mutex streams_mutex_;
+    std::unordered_map<std::uint64_t, HandleStreams> streams_;
 };
 
-// Cached reader - decorator that wraps another reader with caching
+// Cached reader - decorator that wraps another reader with a block cache.
+// Only the blocks touched by a read are fetched from the underlying reader.
+//
+// Handles opened with the object size (open()) pick how misses are fetched
+// from their access pattern:
+//  - objects of at most small_object_bytes are fetched whole in one request
+//  - once a handle keeps seeking in a larger object, a miss fetches only the
+//    random_read_bytes-aligned range around the read; that range is kept for
+//    the handle but not cached, so a 4K random read costs no whole block
+//  - anything else is read in whole blocks, which read-ahead below streams
+//
+// Pinned reads only use blocks cached from their generation; a block of an
+// older generation is dropped rather than mixed with newer bytes.
 class CachedReader : public IReader {
 public:
+    // Misses fetched per strategy
+    struct StrategyStats {
+        std::uint64_t blocks = 0;
+        std::uint64_t whole_objects = 0;
+        std::uint64_t ranges = 0;
+        std::uint64_t range_bytes = 0;
+        std::uint64_t prefetches = 0;   // objects cached by prefetch() ahead of any read
+    };
+    
+    // Consecutive seeks that switch a handle to range reads, and
+    // consecutive sequential reads that switch it back to blocks
+    static constexpr int kSeeksToRandom = 2;
+    static constexpr int kReadsToSequential = 2;
+    
     CachedReader(std::unique_ptr<IReader> underlying_reader,
                  bool debug_mode = false,
-                 bool verbose_logging = false)
+                 bool verbose_logging = false,
+                 size_t block_size = ContentCache::kDefaultBlockSize,
+                 size_t max_cache_bytes = ContentCache::kDefaultMaxBytes,
+                 size_t random_read_bytes = 0,
+                 size_t small_object_bytes = 0)
         : underlying_reader_(std::move(underlying_reader)),
+          cache_owner_(std::make_shared<ContentCache>(block_size, max_cache_bytes)),
+          cache_(*cache_owner_),
+          random_read_bytes_(std::min(random_read_bytes, block_size)),
+          small_object_bytes_(small_object_bytes),
           debug_mode_(debug_mode),
           verbose_logging_(verbose_logging) {}
     
+    // Keep blocks in a cache shared with other readers, e.g. those of other
+    // buckets; key_prefix keeps their objects apart within it
+    CachedReader(std::unique_ptr<IReader> underlying_reader,
+                 std::shared_ptr<ContentCache> shared_cache,
+                 std::string key_prefix,
+                 bool debug_mode = false,
+                 bool verbose_logging = false,
+                 size_t random_read_bytes = 0,
+                 size_t small_object_bytes = 0)
+        : underlying_reader_(std::move(underlying_reader)),
+          cache_owner_(std::move(shared_cache)),
+          cache_(*cache_owner_),
+          key_prefix_(std::move(key_prefix)),
+          random_read_bytes_(std::min(random_read_bytes, cache_.blockSize())),
+          small_object_bytes_(small_object_bytes),
+          debug_mode_(debug_mode),
+          verbose_logging_(verbose_logging) {}
+    
+    void open(std::uint64_t handle, const std::string& object_name, off_t object_size) override {
+        if (handle != 0 && (random_read_bytes_ > 0 || small_object_bytes_ > 0)) {
+            auto state = std::make_shared<HandleState>();
+            state->object_name = object_name;
+            state->object_size = object_size;
+            std::lock_guard<std::mutex> lock(handles_mutex_);
+            handles_[handle] = std::move(state);
+        }
+        underlying_reader_->open(handle, object_name, object_size);
+    }
+    
     int read(const std::string& object_name, 
              char* buf, 
              size_t size, 
-             off_t offset) override {
-        // Check cache first
-        auto it = cache_.find(object_name);
-        if (it != cache_.end()) {
-            if (debug_mode_) {
-                std::cout << "[DEBUG] Cache hit for: " << object_name << std::endl;
+             off_t offset,
+             std::uint64_t handle = 0,
+             std::int64_t generation = 0) override {
+        std::shared_ptr<HandleState> state = findHandle(handle, object_name);
+        if (state && size > 0) {
+            std::unique_lock<std::mutex> state_lock(state->mutex);
+            switch (state->strategy(offset, size, cache_.blockSize(), random_read_bytes_, small_object_bytes_)) {
+                case Strategy::WholeObject: {
+                    const size_t object_size = static_cast<size_t>(state->object_size);
+                    state_lock.unlock();
+                    const std::uint64_t block_index = static_cast<std::uint64_t>(offset) / cache_.blockSize();
+                    if (!cache_.contains(cacheKey(object_name), block_index, generation)) {
+                        return readWholeObject(object_name, object_size, buf, size, offset, generation);
+                    }
+                    break;
+                }
+                case Strategy::Range:
+                    if (!blocksCached(object_name, size, offset, generation)) {
+                        return readRange(*state, buf, size, offset, handle, generation);
+                    }
+                    break;
+                case Strategy::Blocks:
+                    break;
             }
-            return readFromCache(it->second, buf, size, offset);
-        }
-        
-        // Cache miss - need to read full object for caching
-        if (debug_mode_) {
-            std::cout << "[DEBUG] Cache miss for: " << object_name << std::endl;
         }
         
-        // Read entire object from beginning
-        std::string full_content;
-        full_content.resize(1024 * 1024); // Start with 1MB
-        int total_read = 0;
+        const size_t block_size = cache_.blockSize();
+        size_t copied = 0;
         
-        // Read in chunks until we get the full object
-        while (true) {
-            if (total_read >= static_cast<int>(full_content.size())) {
-                full_content.resize(full_content.size() * 2);
+        while (copied < size) {
+            const std::uint64_t pos = static_cast<std::uint64_t>(offset) + copied;
+            const std::uint64_t block_index = pos / block_size;
+            const size_t block_offset = static_cast<size_t>(pos % block_size);
+            
+            // Check cache first
+            ContentCache::Block block = cache_.get(cacheKey(object_name), block_index, generation);
+            if (block) {
+                if (debug_mode_) {
+                    std::cout << "[DEBUG] Cache hit for: " << object_name
+                              << " block " << block_index << std::endl;
+                }
+            } else {
+                if (debug_mode_) {
+                    std::cout << "[DEBUG] Cache miss for: " << object_name
+                              << " block " << block_index << std::endl;
+                }
+                
+                int result = fetchBlock(object_name, block_index, handle, generation, block);
+                if (result < 0) {
+                    return copied > 0 ? static_cast<int>(copied) : result;
+                }
             }
             
-            int bytes_read = underlying_reader_->read(
-                object_name,
-                &full_content[total_read],
-                full_content.size() - total_read,
-                0);  // Always read from offset 0 to get full object
+            if (!block || block_offset >= block->size()) {
+                break;  // EOF
+            }
             
-            if (bytes_read <= 0) {
+            size_t n = std::min(size - copied, block->size() - block_offset);
+            std::memcpy(buf + copied, block->data() + block_offset, n);
+            copied += n;
+            
+            // A short block is the last block of the object
+            if (block->size() < block_size) {
                 break;
             }
+        }
+        
+        return static_cast<int>(copied);
+    }
+    
+    // Blocks held in memory are served by read(); anything else may still
+    // be spliced from a lower tier
+    bool locate(const std::string& object_name, size_t size, off_t offset,
+                FileExtent& extent, std::int64_t generation = 0) override {
+        const std::uint64_t block_index = static_cast<std::uint64_t>(offset) / cache_.blockSize();
+        if (cache_.contains(cacheKey(object_name), block_index, generation)) {
+            return false;
+        }
+        return underlying_reader_->locate(object_name, size, offset, extent, generation);
+    }
+    
+    void release(std::uint64_t handle) override {
+        {
+            std::lock_guard<std::mutex> lock(handles_mutex_);
+            handles_.erase(handle);
+        }
+        underlying_reader_->release(handle);
+    }
+    
+    void invalidate(const std::string& object_name) override {
+        cache_.invalidate(cacheKey(object_name));
+        {
+            std::lock_guard<std::mutex> lock(handles_mutex_);
+            for (auto& [handle, state] : handles_) {
+                if (state->object_name == object_name) {
+                    std::lock_guard<std::mutex> state_lock(state->mutex);
+                    state->object_size = -1;
+                    state->range.clear();
+                }
+            }
+        }
+        underlying_reader_->invalidate(object_name);
+    }
+    
+    // Drops every block of a shared cache, other readers' included
+    void clear() override {
+        cache_.clear();
+        underlying_reader_->clear();
+    }
+    
+    const ContentCache& cache() const { return cache_; }
+    
+    // Whether a block of object_name at generation is in memory
+    bool isCached(const std::string& object_name, std::uint64_t block_index, std::int64_t generation = 0) const {
+        return cache_.contains(cacheKey(object_name), block_index, generation);
+    }
+    
+    // Cache an object of object_size bytes whole ahead of any read, as its
+    // first read would; false if the fetch failed
+    bool prefetch(const std::string& object_name, size_t object_size, std::int64_t generation = 0) {
+        if (object_size == 0 || cache_.contains(cacheKey(object_name), 0, generation)) {
+            return true;
+        }
+        prefetches_.fetch_add(1, std::memory_order_relaxed);
+        char first;
+        return readWholeObject(object_name, object_size, &first, 1, 0, generation) >= 0;
+    }
+
+    // Concurrent misses on one block of one generation wait for a single fetch
+    using BlockFetches = SingleFlight<std::tuple<std::string, std::uint64_t, std::int64_t>,
+                                      std::pair<int, ContentCache::Block>>;
+    BlockFetches::Stats fetchStats() const { return fetches_.stats(); }
+    
+    StrategyStats strategyStats() const {
+        StrategyStats stats;
+        stats.blocks = block_fetches_.load(std::memory_order_relaxed);
+        stats.whole_objects = whole_object_fetches_.load(std::memory_order_relaxed);
+        stats.ranges = range_fetches_.load(std::memory_order_relaxed);
+        stats.range_bytes = range_bytes_.load(std::memory_order_relaxed);
+        stats.prefetches = prefetches_.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+private:
+    enum class Strategy {
+        Blocks,
+        WholeObject,
+        Range,
+    };
+    
+    // Block index standing for the whole object in fetches_
+    static constexpr std::uint64_t kWholeObject = ~0ULL;
+    
+    struct HandleState {
+        std::mutex mutex;
+        std::string object_name;
+        off_t object_size = -1;   // from open(), -1 if unknown
+        off_t next_offset = -1;   // where a sequential read would start
+        int seeks = 0;            // consecutive reads elsewhere
+        int sequential = 0;       // consecutive reads at next_offset
+        bool random = false;
+        // Last range fetched in random mode; short when it reached EOF
+        off_t range_offset = 0;
+        size_t range_requested = 0;
+        std::int64_t range_generation = 0;
+        std::string range;
+        
+        // Follow the access pattern and pick the strategy for this read
+        Strategy strategy(off_t offset, size_t size, size_t block_size,
+                          size_t random_read_bytes, size_t small_object_bytes) {
+            if (offset == next_offset || (next_offset < 0 && offset == 0)) {
+                seeks = 0;
+                if (++sequential >= kReadsToSequential) {
+                    random = false;
+                }
+            } else {
+                sequential = 0;
+                if (++seeks >= kSeeksToRandom) {
+                    random = true;
+                }
+            }
+            next_offset = offset + static_cast<off_t>(size);
             
-            // If we got less than requested, we're done
-            if (bytes_read < static_cast<int>(full_content.size() - total_read)) {
-                total_read += bytes_read;
+            // An object within one block is fetched whole by the block path
+            const bool multi_block = object_size < 0 || static_cast<size_t>(object_size) > block_size;
+            if (multi_block && object_size >= 0 && static_cast<size_t>(object_size) <= small_object_bytes) {
+                return Strategy::WholeObject;
+            }
+            if (multi_block && random && random_read_bytes > 0) {
+                return Strategy::Range;
+            }
+            return Strategy::Blocks;
+        }
+    };
+    
+    std::shared_ptr<HandleState> findHandle(std::uint64_t handle, const std::string& object_name) {
+        if (handle == 0) {
+            return nullptr;
+        }
+        std::lock_guard<std::mutex> lock(handles_mutex_);
+        auto it = handles_.find(handle);
+        if (it == handles_.end() || it->second->object_name != object_name) {
+            return nullptr;
+        }
+        return it->second;
+    }
+    
+    bool blocksCached(const std::string& object_name, size_t size, off_t offset,
+                      std::int64_t generation) const {
+        const size_t block_size = cache_.blockSize();
+        const std::uint64_t first = static_cast<std::uint64_t>(offset) / block_size;
+        const std::uint64_t last = (static_cast<std::uint64_t>(offset) + size - 1) / block_size;
+        const std::string key = cacheKey(object_name);
+        for (std::uint64_t block_index = first; block_index <= last; ++block_index) {
+            if (!cache_.contains(key, block_index, generation)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Fill buf from the underlying reader until size bytes or EOF;
+    // returns the bytes read, or -1 if nothing could be read. failed is set
+    // when an error cut the read short: the bytes are still returned, but
+    // they do not end at EOF and must not be cached.
+    ssize_t readFully(const std::string& object_name, char* buf, size_t size, off_t offset,
+                      std::uint64_t handle, std::int64_t generation, bool& failed) {
+        size_t total_read = 0;
+        failed = false;
+        while (total_read < size) {
+            int n = underlying_reader_->read(object_name, buf + total_read, size - total_read,
+                                             offset + static_cast<off_t>(total_read), handle, generation);
+            if (n < 0) {
+                failed = true;
+                if (total_read == 0) {
+                    return -1;
+                }
                 break;
             }
-            
-            total_read += bytes_read;
+            if (n == 0) {
+                break;
+            }
+            total_read += static_cast<size_t>(n);
         }
+        return static_cast<ssize_t>(total_read);
+    }
+    
+    // Fetch the whole object in one request, cache it as blocks and serve
+    // the read from it. object_size comes from the stat cache; getting that
+    // many bytes is taken as the end of the object, which spares small
+    // files a second request just to find EOF. Anything shorter is served
+    // but not cached, since a failed download can look like an early EOF.
+    int readWholeObject(const std::string& object_name, size_t object_size,
+                        char* buf, size_t size, off_t offset, std::int64_t generation) {
+        const size_t block_size = cache_.blockSize();
+        auto fetched = fetches_.run(std::make_tuple(object_name, kWholeObject, generation), [&] {
+            const size_t length = object_size;
+            std::string data(length, '\0');
+            // Not tied to the handle, so read-ahead passes it through as one request
+            bool failed;
+            ssize_t total_read = readFully(object_name, &data[0], length, 0, 0, generation, failed);
+            if (total_read <= 0) {
+                return std::make_pair(-1, ContentCache::Block());
+            }
+            const bool complete = !failed && static_cast<size_t>(total_read) == length;
+            data.resize(static_cast<size_t>(total_read));
+            whole_object_fetches_.fetch_add(1, std::memory_order_relaxed);
+            for (size_t start = 0; complete && start < data.size(); start += block_size) {
+                const size_t n = std::min(block_size, data.size() - start);
+                cache_.put(cacheKey(object_name), start / block_size,
+                           std::make_shared<const std::string>(data, start, n), generation);
+            }
+            if (debug_mode_) {
+                std::cout << "[DEBUG] Fetched whole object: " << object_name
+                          << " (" << data.size() << " bytes)" << std::endl;
+            }
+            return std::make_pair(0, ContentCache::Block(std::make_shared<const std::string>(std::move(data))));
+        });
+        if (fetched.first < 0) {
+            return -1;
+        }
+        const std::string& whole = *fetched.second;
+        if (static_cast<size_t>(offset) >= whole.size()) {
+            return 0;
+        }
+        const size_t n = std::min(size, whole.size() - static_cast<size_t>(offset));
+        std::memcpy(buf, whole.data() + offset, n);
+        return static_cast<int>(n);
+    }
+    
+    // Serve a random read from the handle's last range, fetching the
+    // aligned range around it on a miss. Called with state.mutex held.
+    int readRange(HandleState& state, char* buf, size_t size, off_t offset, std::uint64_t handle,
+                  std::int64_t generation) {
+        const off_t range_end = state.range_offset + static_cast<off_t>(state.range.size());
+        const bool at_eof = state.range.size() < state.range_requested;
+        const bool covered = state.range_requested > 0 && state.range_generation == generation &&
+                             offset >= state.range_offset &&
+                             (offset + static_cast<off_t>(size) <= range_end || at_eof);
+        if (!covered) {
+            const off_t unit = static_cast<off_t>(random_read_bytes_);
+            const off_t start = offset / unit * unit;
+            const off_t end = (offset + static_cast<off_t>(size) + unit - 1) / unit * unit;
+            state.range.resize(static_cast<size_t>(end - start));
+            bool failed;
+            ssize_t total_read = readFully(state.object_name, &state.range[0], state.range.size(), start,
+                                           handle, generation, failed);
+            if (total_read < 0) {
+                state.range.clear();
+                state.range_requested = 0;
+                return -1;
+            }
+            // A range cut short by an error would read as EOF; keep it only
+            // long enough to serve this read
+            state.range_requested = failed ? 0 : state.range.size();
+            state.range.resize(static_cast<size_t>(total_read));
+            state.range_offset = start;
+            state.range_generation = generation;
+            range_fetches_.fetch_add(1, std::memory_order_relaxed);
+            range_bytes_.fetch_add(static_cast<std::uint64_t>(total_read), std::memory_order_relaxed);
+            if (debug_mode_) {
+                std::cout << "[DEBUG] Random read range: " << state.object_name << " ["
+                          << start << ", " << end << ")" << std::endl;
+            }
+        }
+        const size_t range_pos = static_cast<size_t>(offset - state.range_offset);
+        if (range_pos >= state.range.size()) {
+            return 0;  // EOF
+        }
+        const size_t n = std::min(size, state.range.size() - range_pos);
+        std::memcpy(buf, state.range.data() + range_pos, n);
+        return static_cast<int>(n);
+    }
+    
+    // Read one block from the underlying reader and cache it. Concurrent
+    // misses on the same block share one fetch.
+    // Returns 0 on success (block is nullptr past EOF), or -1 on error.
+    int fetchBlock(const std::string& object_name, std::uint64_t block_index,
+                   std::uint64_t handle, std::int64_t generation, ContentCache::Block& block) {
+        auto fetched = fetches_.run(std::make_tuple(object_name, block_index, generation), [&] {
+            ContentCache::Block loaded;
+            int result = loadBlock(object_name, block_index, handle, generation, loaded);
+            return std::make_pair(result, loaded);
+        });
+        block = fetched.second;
+        return fetched.first;
+    }
+    
+    int loadBlock(const std::string& object_name, std::uint64_t block_index,
+                  std::uint64_t handle, std::int64_t generation, ContentCache::Block& block) {
+        const size_t block_size = cache_.blockSize();
+        const off_t block_start = static_cast<off_t>(block_index * block_size);
         
-        full_content.resize(total_read);
+        // Ranged reads may return less than requested; keep going until the
+        // block is full or the object ends
+        std::string data(block_size, '\0');
+        bool failed;
+        ssize_t total_read = readFully(object_name, &data[0], block_size, block_start, handle, generation,
+                                       failed);
+        if (total_read < 0) {
+            return -1;
+        }
+        block_fetches_.fetch_add(1, std::memory_order_relaxed);
         
         if (total_read == 0) {
+            block = nullptr;
             return 0;
         }
         
-        // Cache it
-        cache_[object_name] = full_content;
+        data.resize(static_cast<size_t>(total_read));
+        block = std::make_shared<const std::string>(std::move(data));
+        if (failed) {
+            // Serve what arrived, but a truncated block must not be cached:
+            // a short block reads as the object's last
+            return 0;
+        }
+        cache_.put(cacheKey(object_name), block_index, block, generation);
         
         if (verbose_logging_) {
-            std::cout << "Cached " << total_read << " bytes for " << object_name << std::endl;
+            std::cout << "Cached " << total_read << " bytes for " << object_name
+                      << " block " << block_index << std::endl;
+        }
+        
+        return 0;
+    }
+
+    std::string cacheKey(const std::string& object_name) const {
+        return key_prefix_.empty() ? object_name : key_prefix_ + object_name;
+    }
+
+    std::unique_ptr<IReader> underlying_reader_;
+    std::shared_ptr<ContentCache> cache_owner_;
+    ContentCache& cache_;
+    std::string key_prefix_;
+    BlockFetches fetches_;
+    size_t random_read_bytes_;
+    size_t small_object_bytes_;
+    bool debug_mode_;
+    bool verbose_logging_;
+    std::mutex handles_mutex_;
+    std::unordered_map<std::uint64_t, std::shared_ptr<HandleState>> handles_;
+    std::atomic<std::uint64_t> block_fetches_{0};
+    std::atomic<std::uint64_t> whole_object_fetches_{0};
+    std::atomic<std::uint64_t> range_fetches_{0};
+    std::atomic<std::uint64_t> range_bytes_{0};
+    std::atomic<std::uint64_t> prefetches_{0};
+};
+
+// Disk-cached reader - decorator that keeps blocks in a DiskCache on local
+// disk, below the in-memory cache. Misses fetch whole blocks from the
+// underlying reader; hits are read straight from the block file into the
+// caller's buffer. Cached blocks survive restarts.
+class DiskCachedReader : public IReader {
+public:
+    DiskCachedReader(std::unique_ptr<IReader> underlying_reader,
+                     const std::string& cache_dir,
+                     size_t block_size = DiskCache::kDefaultBlockSize,
+                     size_t max_cache_bytes = DiskCache::kDefaultMaxBytes,
+                     bool debug_mode = false)
+        : underlying_reader_(std::move(underlying_reader)),
+          cache_(cache_dir, block_size, max_cache_bytes),
+          debug_mode_(debug_mode) {}
+    
+    int read(const std::string& object_name, 
+             char* buf, 
+             size_t size, 
+             off_t offset,
+             std::uint64_t handle = 0,
+             std::int64_t generation = 0) override {
+        if (!cache_.usable()) {
+            return underlying_reader_->read(object_name, buf, size, offset, handle, generation);
+        }
+        
+        const size_t block_size = cache_.blockSize();
+        size_t copied = 0;
+        
+        while (copied < size) {
+            const std::uint64_t pos = static_cast<std::uint64_t>(offset) + copied;
+            const std::uint64_t block_index = pos / block_size;
+            const size_t block_offset = static_cast<size_t>(pos % block_size);
+            const size_t want = size - copied;
+            
+            size_t block_length = 0;
+            ssize_t n = cache_.read(object_name, block_index, buf + copied, want, block_offset, block_length,
+                                    generation);
+            if (n < 0) {
+                if (debug_mode_) {
+                    std::cout << "[DEBUG] Disk cache miss for: " << object_name
+                              << " block " << block_index << std::endl;
+                }
+                
+                auto fetched = fetches_.run(std::make_tuple(object_name, block_index, generation), [&] {
+                    auto block = std::make_shared<std::string>();
+                    int result = fetchBlock(object_name, block_index, handle, generation, *block);
+                    return std::make_pair(result, std::shared_ptr<const std::string>(std::move(block)));
+                });
+                if (fetched.first < 0) {
+                    return copied > 0 ? static_cast<int>(copied) : -1;
+                }
+                const std::string& block = *fetched.second;
+                block_length = block.size();
+                n = 0;
+                if (block_offset < block_length) {
+                    n = static_cast<ssize_t>(std::min(want, block_length - block_offset));
+                    std::memcpy(buf + copied, block.data() + block_offset, static_cast<size_t>(n));
+                }
+            }
+            
+            copied += static_cast<size_t>(n);
+            
+            // A short block is the last block of the object
+            if (n == 0 || block_length < block_size) {
+                break;
+            }
+        }
+        
+        return static_cast<int>(copied);
+    }
+    
+    void open(std::uint64_t handle, const std::string& object_name, off_t object_size) override {
+        underlying_reader_->open(handle, object_name, object_size);
+    }
+    
+    void release(std::uint64_t handle) override {
+        underlying_reader_->release(handle);
+    }
+    
+    // Cached blocks are handed out as their block file; misses are left to
+    // read(), which fetches and persists them
+    bool locate(const std::string& object_name, size_t size, off_t offset,
+                FileExtent& extent, std::int64_t generation = 0) override {
+        if (!cache_.usable()) {
+            return false;
+        }
+        const size_t block_size = cache_.blockSize();
+        const std::uint64_t block_index = static_cast<std::uint64_t>(offset) / block_size;
+        const size_t block_offset = static_cast<size_t>(offset % block_size);
+        
+        size_t block_length = 0;
+        int fd = cache_.openBlock(object_name, block_index, block_length, generation);
+        if (fd < 0) {
+            return false;
         }
+        auto owner = std::shared_ptr<int>(new int(fd), [](int* p) { ::close(*p); delete p; });
         
-        // Return requested portion
-        return readFromCache(full_content, buf, size, offset);
+        extent.owner = owner;
+        extent.fd = fd;
+        extent.pos = static_cast<off_t>(block_offset);
+        extent.size = block_offset < block_length ? std::min(size, block_length - block_offset) : 0;
+        return true;
     }
     
     void invalidate(const std::string& object_name) override {
-        cache_.erase(object_name);
+        cache_.invalidate(object_name);
+        underlying_reader_->invalidate(object_name);
     }
     
     void clear() override {
         cache_.clear();
+        underlying_reader_->clear();
     }
+    
+    const DiskCache& cache() const { return cache_; }
+    
+    // Concurrent misses on one block of one generation wait for a single fetch
+    using BlockFetches = SingleFlight<std::tuple<std::string, std::uint64_t, std::int64_t>,
+                                      std::pair<int, std::shared_ptr<const std::string>>>;
+    BlockFetches::Stats fetchStats() const { return fetches_.stats(); }
 
 private:
-    int readFromCache(const std::string& content, char* buf, size_t size, off_t offset) {
-        size_t len = content.length();
-        if (static_cast<size_t>(offset) >= len) {
-            return 0;
+    // Read one whole block from the underlying reader and store it on disk.
+    // Returns 0 on success (empty block past EOF), or -1 on error.
+    int fetchBlock(const std::string& object_name, std::uint64_t block_index,
+                   std::uint64_t handle, std::int64_t generation, std::string& block) {
+        const size_t block_size = cache_.blockSize();
+        const off_t block_start = static_cast<off_t>(block_index * block_size);
+        
+        block.assign(block_size, '\0');
+        size_t total_read = 0;
+        while (total_read < block_size) {
+            int bytes_read = underlying_reader_->read(
+                object_name,
+                &block[total_read],
+                block_size - total_read,
+                block_start + static_cast<off_t>(total_read),
+                handle,
+                generation);
+            
+            if (bytes_read < 0) {
+                if (total_read == 0) {
+                    return -1;
+                }
+                // Serve what arrived, but a truncated block must not be persisted
+                block.resize(total_read);
+                return 0;
+            }
+            if (bytes_read == 0) {
+                break;
+            }
+            total_read += static_cast<size_t>(bytes_read);
+        }
+        
+        block.resize(total_read);
+        cache_.put(object_name, block_index, block.data(), block.size(), generation);
+        return 0;
+    }
+
+    std::unique_ptr<IReader> underlying_reader_;
+    DiskCache cache_;
+    BlockFetches fetches_;
+    bool debug_mode_;
+};
+
+// Read-ahead reader - decorator that detects sequential access per file
+// handle and keeps up to max_chunks ranged fetches in flight ahead of the
+// reader. The window starts at one chunk, doubles on every sequential read
+// and collapses back to zero on a seek, so random access pays no extra I/O.
+// Each handle's state has its own lock, so different files never contend.
+class ReadAheadReader : public IReader {
+public:
+    static constexpr size_t kDefaultChunkSize = 1024 * 1024;  // 1 MiB
+    static constexpr size_t kDefaultMaxChunks = 8;
+    
+    ReadAheadReader(std::unique_ptr<IReader> underlying_reader,
+                    size_t chunk_size = kDefaultChunkSize,
+                    size_t max_chunks = kDefaultMaxChunks,
+                    bool debug_mode = false)
+        : underlying_reader_(std::move(underlying_reader)),
+          chunk_size_(chunk_size > 0 ? chunk_size : kDefaultChunkSize),
+          max_chunks_(max_chunks > 0 ? max_chunks : 1),
+          debug_mode_(debug_mode) {}
+    
+    int read(const std::string& object_name, 
+             char* buf, 
+             size_t size, 
+             off_t offset,
+             std::uint64_t handle = 0,
+             std::int64_t generation = 0) override {
+        reapDiscarded();
+        
+        // Reads without a file handle have no access pattern to follow
+        if (handle == 0) {
+            return underlying_reader_->read(object_name, buf, size, offset, handle, generation);
         }
         
-        if (offset + size > len) {
-            size = len - offset;
+        std::shared_ptr<HandleState> state_ptr;
+        {
+            std::lock_guard<std::mutex> lock(handles_mutex_);
+            auto& slot = handles_[handle];
+            if (!slot) {
+                slot = std::make_shared<HandleState>();
+            }
+            state_ptr = slot;
         }
+        HandleState& state = *state_ptr;
+        std::lock_guard<std::mutex> state_lock(state.mutex);
         
-        std::memcpy(buf, content.c_str() + offset, size);
-        return static_cast<int>(size);
+        // Chunks fetched for another object or generation are not this read's
+        if (state.object_name != object_name || state.generation != generation) {
+            resetState(state);
+            state.object_name = object_name;
+            state.generation = generation;
+        }
+        
+        bool fresh = state.next_offset < 0;
+        if (offset == state.next_offset || (fresh && offset == 0)) {
+            // Streaming: ramp the window up
+            state.window = state.window == 0 ? 1 : std::min(state.window * 2, max_chunks_);
+        } else {
+            if (!fresh && debug_mode_) {
+                std::cout << "[DEBUG] Read-ahead reset on seek: " << object_name
+                          << " to offset " << offset << std::endl;
+            }
+            resetState(state);
+        }
+        
+        if (state.window == 0) {
+            state.next_offset = offset;
+            int result = underlying_reader_->read(object_name, buf, size, offset, handle, generation);
+            if (result > 0) {
+                state.next_offset = offset + result;
+            }
+            return result;
+        }
+        
+        size_t copied = 0;
+        while (copied < size) {
+            const off_t pos = offset + static_cast<off_t>(copied);
+            
+            // Drop chunks that end before the current position
+            while (!state.chunks.empty() &&
+                   state.chunks.front().offset + static_cast<off_t>(state.chunks.front().size) <= pos) {
+                discard(state.chunks.front());
+                state.chunks.pop_front();
+            }
+            if (!state.chunks.empty() && state.chunks.front().offset > pos) {
+                dropChunks(state);
+            }
+            if (state.chunks.empty()) {
+                if (state.eof_offset >= 0 && pos >= state.eof_offset) {
+                    break;
+                }
+                state.eof_offset = -1;
+                schedule(state, handle, pos);
+            }
+            
+            Chunk& chunk = state.chunks.front();
+            const ChunkData& data = chunk.result.get();
+            if (data.status < 0) {
+                dropChunks(state);
+                state.window = 0;
+                if (copied == 0) {
+                    state.next_offset = -1;
+                    return -1;
+                }
+                break;
+            }
+            
+            const size_t chunk_offset = static_cast<size_t>(pos - chunk.offset);
+            if (chunk_offset >= data.content.size()) {
+                break;  // EOF
+            }
+            
+            size_t n = std::min(size - copied, data.content.size() - chunk_offset);
+            std::memcpy(buf + copied, data.content.data() + chunk_offset, n);
+            copied += n;
+            
+            // A short chunk is the end of the object
+            if (data.content.size() < chunk.size) {
+                state.eof_offset = chunk.offset + static_cast<off_t>(data.content.size());
+                break;
+            }
+        }
+        
+        state.next_offset = offset + static_cast<off_t>(copied);
+        
+        // Keep the window full
+        while (state.chunks.size() < state.window && !reachedEof(state)) {
+            off_t next = state.chunks.empty()
+                ? state.next_offset
+                : state.chunks.back().offset + static_cast<off_t>(state.chunks.back().size);
+            schedule(state, handle, next);
+        }
+        
+        return static_cast<int>(copied);
+    }
+    
+    void open(std::uint64_t handle, const std::string& object_name, off_t object_size) override {
+        underlying_reader_->open(handle, object_name, object_size);
+    }
+    
+    void release(std::uint64_t handle) override {
+        std::shared_ptr<HandleState> state;
+        {
+            std::lock_guard<std::mutex> lock(handles_mutex_);
+            auto it = handles_.find(handle);
+            if (it != handles_.end()) {
+                state = std::move(it->second);
+                handles_.erase(it);
+            }
+        }
+        if (state) {
+            std::lock_guard<std::mutex> state_lock(state->mutex);
+            dropChunks(*state);
+        }
+        underlying_reader_->release(handle);
+    }
+    
+    void invalidate(const std::string& object_name) override {
+        for (auto& state : snapshotHandles()) {
+            std::lock_guard<std::mutex> state_lock(state->mutex);
+            if (state->object_name == object_name) {
+                resetState(*state);
+            }
+        }
+        underlying_reader_->invalidate(object_name);
+    }
+    
+    void clear() override {
+        for (auto& state : snapshotHandles()) {
+            std::lock_guard<std::mutex> state_lock(state->mutex);
+            resetState(*state);
+        }
+        underlying_reader_->clear();
+    }
+
+private:
+    struct ChunkData {
+        int status = 0;  // -1 on error
+        std::string content;
+    };
+    
+    struct Chunk {
+        off_t offset;
+        size_t size;
+        std::shared_future<ChunkData> result;
+    };
+    
+    struct HandleState {
+        std::mutex mutex;
+        std::string object_name;
+        std::int64_t generation = 0;
+        off_t next_offset = -1;  // where the next sequential read starts
+        off_t eof_offset = -1;   // end of object once a short chunk was seen
+        size_t window = 0;       // chunks to keep in flight
+        std::deque<Chunk> chunks;
+    };
+    
+    void schedule(HandleState& state, std::uint64_t handle, off_t offset) {
+        IReader* reader = underlying_reader_.get();
+        const size_t size = chunk_size_;
+        const std::string object_name = state.object_name;
+        const std::int64_t generation = state.generation;
+        
+        Chunk chunk{offset, size, std::async(std::launch::async,
+            [reader, object_name, offset, size, handle, generation]() {
+                ChunkData data;
+                data.content.resize(size);
+                size_t total_read = 0;
+                while (total_read < size) {
+                    int n = reader->read(object_name, &data.content[total_read], size - total_read,
+                                         offset + static_cast<off_t>(total_read), handle, generation);
+                    if (n < 0) {
+                        if (total_read == 0) {
+                            data.status = -1;
+                        }
+                        break;
+                    }
+                    if (n == 0) {
+                        break;
+                    }
+                    total_read += static_cast<size_t>(n);
+                }
+                data.content.resize(total_read);
+                return data;
+            }).share()};
+        state.chunks.push_back(std::move(chunk));
+    }
+    
+    // True once a completed chunk came back short, i.e. the end of the
+    // object is already covered and nothing past it should be scheduled
+    bool reachedEof(HandleState& state) {
+        if (state.eof_offset >= 0) {
+            return true;
+        }
+        for (const auto& chunk : state.chunks) {
+            if (chunk.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+                continue;
+            }
+            const ChunkData& data = chunk.result.get();
+            if (data.status < 0 || data.content.size() < chunk.size) {
+                state.eof_offset = chunk.offset + static_cast<off_t>(data.content.size());
+                return true;
+            }
+        }
+        return false;
+    }
+    
+    void resetState(HandleState& state) {
+        dropChunks(state);
+        state.next_offset = -1;
+        state.eof_offset = -1;
+        state.window = 0;
+    }
+    
+    void dropChunks(HandleState& state) {
+        for (auto& chunk : state.chunks) {
+            discard(chunk);
+        }
+        state.chunks.clear();
+    }
+    
+    std::vector<std::shared_ptr<HandleState>> snapshotHandles() {
+        std::lock_guard<std::mutex> lock(handles_mutex_);
+        std::vector<std::shared_ptr<HandleState>> states;
+        states.reserve(handles_.size());
+        for (const auto& [handle, state] : handles_) {
+            states.push_back(state);
+        }
+        return states;
+    }
+    
+    // In-flight fetches cannot be cancelled; park them so a seek never waits
+    void discard(Chunk& chunk) {
+        if (chunk.result.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+            std::lock_guard<std::mutex> lock(discarded_mutex_);
+            discarded_.push_back(chunk.result);
+        }
+    }
+    
+    void reapDiscarded() {
+        std::lock_guard<std::mutex> lock(discarded_mutex_);
+        discarded_.erase(
+            std::remove_if(discarded_.begin(), discarded_.end(), [](const auto& f) {
+                return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+            }),
+            discarded_.end());
     }
 
     std::unique_ptr<IReader> underlying_reader_;
-    std::unordered_map<std::string, std::string> cache_;
+    size_t chunk_size_;
+    size_t max_chunks_;
     bool debug_mode_;
-    bool verbose_logging_;
+    std::mutex handles_mutex_;
+    std::unordered_map<std::uint64_t, std::shared_ptr<HandleState>> handles_;
+    std::mutex discarded_mutex_;
+    std::vector<std::shared_future<ChunkData>> discarded_;
 };
 
 // Dummy reader - returns zeros up to a fixed size for testing
@@ -182,7 +1208,9 @@ public:
     int read(const std::string& object_name, 
              char* buf, 
              size_t size, 
-             off_t offset) override {
+             off_t offset,
+             std::uint64_t handle = 0,
+             std::int64_t generation = 0) override {
         // Simulate a file of fixed size
         if (static_cast<size_t>(offset) >= max_size_) {
             return 0; // EOF
@@ -0,0 +1,137 @@
+#include "reader.hpp"
+#include "gcs/gcs_client.hpp"
+#include "gcs/fake_gcs_sdk_client.hpp"
+#include <benchmark/benchmark.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+using gcscfuse::CachedReader;
+using gcscfuse::DummyReader;
+using gcscfuse::FakeGCSSDKClient;
+using gcscfuse::GCSClient;
+using gcscfuse::GCSDirectReader;
+using gcscfuse::ReadAheadReader;
+
+namespace {
+
+constexpr size_t kObjectSize = 64 * 1024 * 1024;
+const std::string kBucket = "bench-bucket";
+const std::string kObject = "data/object.bin";
+
+// Sequential reads of size bytes, wrapping at the end of the object
+void readSequential(benchmark::State& state, gcscfuse::IReader& reader, size_t size, std::uint64_t handle = 0)
+{
+    std::vector<char> buf(size);
+    off_t offset = 0;
+    for (auto _ : state) {
+        int n = reader.read(kObject, buf.data(), size, offset, handle);
+        if (n <= 0) {
+            state.SkipWithError("read failed");
+            break;
+        }
+        offset = (offset + n) % static_cast<off_t>(kObjectSize);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+}
+
+std::unique_ptr<FakeGCSSDKClient> makeFake(FakeGCSSDKClient::Profile profile)
+{
+    auto fake = std::make_unique<FakeGCSSDKClient>(profile);
+    fake->addObject(kObject, kObjectSize);
+    return fake;
+}
+
+void BM_DummyReaderRead(benchmark::State& state)
+{
+    DummyReader reader(kObjectSize);
+    readSequential(state, reader, static_cast<size_t>(state.range(0)));
+}
+BENCHMARK(BM_DummyReaderRead)->RangeMultiplier(4)->Range(4 << 10, 1 << 20);
+
+// Reads served from cached blocks: args are block size, then read size
+void BM_CachedReaderHit(benchmark::State& state)
+{
+    const size_t block_size = static_cast<size_t>(state.range(0));
+    CachedReader reader(std::make_unique<DummyReader>(kObjectSize), false, false,
+                        block_size, 2 * kObjectSize);
+    std::vector<char> warm(block_size);
+    for (size_t offset = 0; offset < kObjectSize; offset += block_size) {
+        reader.read(kObject, warm.data(), block_size, static_cast<off_t>(offset));
+    }
+    readSequential(state, reader, static_cast<size_t>(state.range(1)));
+}
+BENCHMARK(BM_CachedReaderHit)
+    ->ArgsProduct({{64 << 10, 1 << 20, 4 << 20}, {4 << 10, 128 << 10, 1 << 20}});
+
+// Streaming through a cache smaller than the object, so every block misses
+void BM_CachedReaderMiss(benchmark::State& state)
+{
+    const size_t block_size = static_cast<size_t>(state.range(0));
+    CachedReader reader(std::make_unique<DummyReader>(kObjectSize), false, false,
+                        block_size, kObjectSize / 4);
+    readSequential(state, reader, 128 << 10);
+}
+BENCHMARK(BM_CachedReaderMiss)->Arg(64 << 10)->Arg(1 << 20)->Arg(4 << 20);
+
+// Reads through GCSClient from a bucket at the given latency (us) and
+// bandwidth (MiB/s), one request per read
+void BM_GCSDirectReaderRead(benchmark::State& state)
+{
+    FakeGCSSDKClient::Profile profile;
+    profile.latency = std::chrono::microseconds(state.range(0));
+    profile.bandwidth_bytes_per_sec = static_cast<std::uint64_t>(state.range(1)) << 20;
+    GCSClient client(makeFake(profile));
+    GCSDirectReader reader(kBucket, client);
+    readSequential(state, reader, 1 << 20);
+}
+BENCHMARK(BM_GCSDirectReaderRead)
+    ->Args({0, 0})->Args({1000, 0})->Args({1000, 1024})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// The same reads on an opened handle, continuing one stream instead of
+// sending a request per read
+void BM_GCSDirectReaderStreamed(benchmark::State& state)
+{
+    FakeGCSSDKClient::Profile profile;
+    profile.latency = std::chrono::microseconds(state.range(0));
+    profile.bandwidth_bytes_per_sec = static_cast<std::uint64_t>(state.range(1)) << 20;
+    GCSClient client(makeFake(profile));
+    GCSDirectReader reader(kBucket, client);
+    reader.open(1, kObject, static_cast<off_t>(kObjectSize));
+    readSequential(state, reader, 1 << 20, 1);
+    reader.release(1);
+}
+BENCHMARK(BM_GCSDirectReaderStreamed)
+    ->Args({0, 0})->Args({1000, 0})->Args({1000, 1024})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+// The same bucket behind read-ahead, which overlaps the round trips
+void BM_ReadAheadReaderRead(benchmark::State& state)
+{
+    FakeGCSSDKClient::Profile profile;
+    profile.latency = std::chrono::microseconds(state.range(0));
+    profile.bandwidth_bytes_per_sec = static_cast<std::uint64_t>(state.range(1)) << 20;
+    GCSClient client(makeFake(profile));
+    ReadAheadReader reader(std::make_unique<GCSDirectReader>(kBucket, client));
+    reader.open(1, kObject, static_cast<off_t>(kObjectSize));
+    readSequential(state, reader, 1 << 20, 1);
+    reader.release(1);
+}
+BENCHMARK(BM_ReadAheadReaderRead)
+    ->Args({0, 0})->Args({1000, 0})->Args({1000, 1024})
+    ->UseRealTime()->Unit(benchmark::kMillisecond);
+
+void BM_GCSClientGetObjectMetadata(benchmark::State& state)
+{
+    FakeGCSSDKClient::Profile profile;
+    profile.latency = std::chrono::microseconds(state.range(0));
+    GCSClient client(makeFake(profile));
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(client.getObjectMetadata(kBucket, kObject));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_GCSClientGetObjectMetadata)->Arg(0)->Arg(100)->UseRealTime();
+
+}
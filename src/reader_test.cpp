@@ -2,10 +2,61 @@
 
 #include <gtest/gtest.h>
 #include "../src/reader.hpp"
+#include "../src/gcs/fake_gcs_sdk_client.hpp"
 #include <cstring>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
 
 using namespace gcscfuse;
 
+namespace {
+// Reader over an in-memory object that records every request it serves
+class RecordingReader : public IReader {
+public:
+    explicit RecordingReader(std::string content) : content_(std::move(content)) {}
+    
+    int read(const std::string&, char* buf, size_t size, off_t offset,
+             std::uint64_t = 0, std::int64_t generation = 0) override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            requests.emplace_back(offset, size);
+            generations.push_back(generation);
+        }
+        if (static_cast<size_t>(offset) >= content_.size()) {
+            return 0;
+        }
+        size = std::min(size, content_.size() - offset);
+        std::memcpy(buf, content_.data() + offset, size);
+        return static_cast<int>(size);
+    }
+    
+    std::vector<std::pair<off_t, size_t>> snapshot() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return requests;
+    }
+    
+    std::vector<std::pair<off_t, size_t>> requests;
+    std::vector<std::int64_t> generations;  // generation each request was pinned to
+
+private:
+    std::mutex mutex_;
+    std::string content_;
+};
+
+std::string makePattern(size_t size) {
+    std::string data(size, '\0');
+    for (size_t i = 0; i < size; i++) {
+        data[i] = static_cast<char>('a' + (i % 26));
+    }
+    return data;
+}
+}
+
 TEST(ReaderTest, DummyReaderBasicRead) {
     DummyReader reader;
     
@@ -216,6 +267,694 @@ TEST(ReaderTest, CachedReaderMultipleFiles) {
     EXPECT_EQ(bytes4, 30);
 }
 
+TEST(ReaderTest, CachedReaderFetchesOnlyTouchedBlocks) {
+    auto recording = std::make_unique<RecordingReader>(makePattern(10000));
+    auto* recording_ptr = recording.get();
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024);
+    
+    // 100 bytes straddling blocks 2 and 3
+    char buf[100];
+    int bytes_read = cached_reader.read("big.bin", buf, 100, 3000);
+    
+    ASSERT_EQ(bytes_read, 100);
+    EXPECT_EQ(std::string(buf, 100), makePattern(10000).substr(3000, 100));
+    ASSERT_EQ(recording_ptr->requests.size(), 2u);
+    EXPECT_EQ(recording_ptr->requests[0], std::make_pair(static_cast<off_t>(2048), static_cast<size_t>(1024)));
+    EXPECT_EQ(recording_ptr->requests[1], std::make_pair(static_cast<off_t>(3072), static_cast<size_t>(1024)));
+    
+    // Re-reading the same range is served from cache
+    bytes_read = cached_reader.read("big.bin", buf, 100, 3000);
+    EXPECT_EQ(bytes_read, 100);
+    EXPECT_EQ(recording_ptr->requests.size(), 2u);
+}
+
+TEST(ReaderTest, CachedReaderStopsAtEndOfObject) {
+    auto recording = std::make_unique<RecordingReader>(makePattern(2500));
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024);
+    
+    char buf[1000];
+    int bytes_read = cached_reader.read("small.bin", buf, 1000, 2000);
+    EXPECT_EQ(bytes_read, 500);
+    EXPECT_EQ(std::string(buf, 500), makePattern(2500).substr(2000));
+    
+    bytes_read = cached_reader.read("small.bin", buf, 1000, 5000);
+    EXPECT_EQ(bytes_read, 0);
+}
+
+TEST(ReaderTest, CachedReaderRespectsMemoryBudget) {
+    auto recording = std::make_unique<RecordingReader>(makePattern(64 * 1024));
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 4096);
+    
+    char buf[1024];
+    for (off_t offset = 0; offset < 64 * 1024; offset += 1024) {
+        EXPECT_EQ(cached_reader.read("big.bin", buf, 1024, offset), 1024);
+    }
+    
+    EXPECT_LE(cached_reader.cache().sizeBytes(), 4096u);
+}
+
+TEST(ReaderTest, CachedReadersShareOneCacheBudget) {
+    auto shared = std::make_shared<ContentCache>(1024, 4096);
+    auto first_recording = std::make_unique<RecordingReader>(std::string(2048, 'a'));
+    auto second_recording = std::make_unique<RecordingReader>(std::string(2048, 'b'));
+    RecordingReader* second_ptr = second_recording.get();
+    CachedReader first(std::move(first_recording), shared, "first/");
+    CachedReader second(std::move(second_recording), shared, "second/");
+
+    // The same object name in two buckets is cached apart
+    char buf[1024];
+    EXPECT_EQ(first.read("data.bin", buf, 1024, 0), 1024);
+    EXPECT_EQ(std::string(buf, 1024), std::string(1024, 'a'));
+    EXPECT_EQ(second.read("data.bin", buf, 1024, 0), 1024);
+    EXPECT_EQ(std::string(buf, 1024), std::string(1024, 'b'));
+    EXPECT_TRUE(first.isCached("data.bin", 0));
+    EXPECT_TRUE(second.isCached("data.bin", 0));
+    EXPECT_EQ(shared->blockCount(), 2u);
+
+    EXPECT_EQ(second.read("data.bin", buf, 1024, 0), 1024);
+    EXPECT_EQ(second_ptr->requests.size(), 1u);
+
+    // Invalidating in one bucket leaves the other's blocks
+    first.invalidate("data.bin");
+    EXPECT_FALSE(first.isCached("data.bin", 0));
+    EXPECT_TRUE(second.isCached("data.bin", 0));
+
+    // Both readers draw on the one budget
+    for (off_t offset = 0; offset < 2048; offset += 1024) {
+        first.read("other.bin", buf, 1024, offset);
+        second.read("other.bin", buf, 1024, offset);
+    }
+    EXPECT_LE(shared->sizeBytes(), 4096u);
+}
+
+TEST(ReaderTest, CachedReaderCoalescesConcurrentMisses) {
+    // Underlying reads stall until the other readers have queued up
+    class GatedReader : public RecordingReader {
+    public:
+        using RecordingReader::RecordingReader;
+        int read(const std::string& object, char* buf, size_t size, off_t offset,
+                 std::uint64_t handle = 0, std::int64_t generation = 0) override {
+            while (!open.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            return RecordingReader::read(object, buf, size, offset, handle, generation);
+        }
+        std::atomic<bool> open{false};
+    };
+
+    auto gated = std::make_unique<GatedReader>(makePattern(4096));
+    auto* gated_ptr = gated.get();
+    CachedReader cached_reader(std::move(gated), false, false, 1024, 1024 * 1024);
+
+    constexpr int kReaders = 8;
+    std::vector<std::thread> readers;
+    std::vector<std::string> results(kReaders);
+    for (int i = 0; i < kReaders; i++) {
+        readers.emplace_back([&, i] {
+            char buf[100];
+            int n = cached_reader.read("shard.bin", buf, sizeof(buf), 100);
+            results[i].assign(buf, n > 0 ? n : 0);
+        });
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (cached_reader.fetchStats().shared < kReaders - 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    gated_ptr->open = true;
+    for (auto& t : readers) {
+        t.join();
+    }
+
+    EXPECT_EQ(gated_ptr->snapshot().size(), 1u);
+    for (const auto& r : results) {
+        EXPECT_EQ(r, makePattern(4096).substr(100, 100));
+    }
+}
+
+// Serves at most max_read bytes per call and fails the call after the first
+// failures_left times, as a dropped GCS stream would
+class FlakyReader : public RecordingReader {
+public:
+    FlakyReader(std::string content, size_t max_read, int failures)
+        : RecordingReader(std::move(content)), max_read(max_read), failures_left(failures) {}
+    int read(const std::string& object, char* buf, size_t size, off_t offset,
+             std::uint64_t handle = 0, std::int64_t generation = 0) override {
+        if (calls++ > 0 && failures_left > 0) {
+            failures_left--;
+            return error;
+        }
+        return RecordingReader::read(object, buf, std::min(size, max_read), offset, handle, generation);
+    }
+    size_t max_read;
+    int failures_left;
+    int calls = 0;
+    int error = -EIO;
+};
+
+TEST(ReaderTest, CachedReaderDoesNotCacheBlockCutShortByError) {
+    const std::string content = makePattern(4096);
+    auto flaky = std::make_unique<FlakyReader>(content, 300, 1);
+    CachedReader cached_reader(std::move(flaky), false, false, 1024, 1024 * 1024);
+
+    // The partial block is served, but not kept as the object's last block
+    char buf[1024];
+    EXPECT_EQ(cached_reader.read("file.bin", buf, 1024, 0), 300);
+    EXPECT_FALSE(cached_reader.isCached("file.bin", 0));
+
+    EXPECT_EQ(cached_reader.read("file.bin", buf, 1024, 0), 1024);
+    EXPECT_EQ(std::string(buf, 1024), content.substr(0, 1024));
+    EXPECT_TRUE(cached_reader.isCached("file.bin", 0));
+}
+
+TEST(ReaderTest, CachedReaderDoesNotCacheIncompleteWholeObject) {
+    // An object that ends before its stat size (replaced meanwhile) reads
+    // as an early EOF
+    const std::string content = makePattern(3000);
+    auto flaky = std::make_unique<FlakyReader>(content, 1000, 1);
+    flaky->error = 0;
+    CachedReader cached_reader(std::move(flaky), false, false, 1024, 1024 * 1024, 256, 4096);
+    cached_reader.open(1, "small.bin", 3000);
+
+    char buf[100];
+    EXPECT_EQ(cached_reader.read("small.bin", buf, 100, 0, 1), 100);
+    EXPECT_FALSE(cached_reader.isCached("small.bin", 0));
+
+    ASSERT_EQ(cached_reader.read("small.bin", buf, 100, 2900, 1), 100);
+    EXPECT_EQ(std::string(buf, 100), content.substr(2900));
+    EXPECT_TRUE(cached_reader.isCached("small.bin", 2));
+    cached_reader.release(1);
+}
+
+TEST(ReaderTest, CachedReaderFetchesSmallObjectWhole) {
+    const std::string content = makePattern(3000);
+    auto recording = std::make_unique<RecordingReader>(content);
+    auto* recording_ptr = recording.get();
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024, 256, 4096);
+    cached_reader.open(1, "small.bin", 3000);
+    
+    char buf[100];
+    ASSERT_EQ(cached_reader.read("small.bin", buf, 100, 2500, 1), 100);
+    EXPECT_EQ(std::string(buf, 100), content.substr(2500, 100));
+    ASSERT_EQ(recording_ptr->requests.size(), 1u);
+    EXPECT_EQ(recording_ptr->requests[0], std::make_pair(static_cast<off_t>(0), static_cast<size_t>(3000)));
+    
+    // Every block, including the short last one, is now cached
+    ASSERT_EQ(cached_reader.read("small.bin", buf, 100, 0, 1), 100);
+    ASSERT_EQ(cached_reader.read("small.bin", buf, 100, 2900, 1), 100);
+    EXPECT_EQ(std::string(buf, 100), content.substr(2900));
+    EXPECT_EQ(recording_ptr->requests.size(), 1u);
+    EXPECT_EQ(cached_reader.strategyStats().whole_objects, 1u);
+    cached_reader.release(1);
+}
+
+TEST(ReaderTest, CachedReaderFetchesRangesForRandomReads) {
+    const std::string content = makePattern(64 * 1024);
+    auto recording = std::make_unique<RecordingReader>(content);
+    auto* recording_ptr = recording.get();
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024, 256, 4096);
+    cached_reader.open(1, "big.bin", 64 * 1024);
+    
+    // The first seek still reads a block; the second switches to ranges
+    char buf[64];
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 64, 10000, 1), 64);
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 64, 40100, 1), 64);
+    EXPECT_EQ(std::string(buf, 64), content.substr(40100, 64));
+    ASSERT_EQ(recording_ptr->requests.size(), 2u);
+    EXPECT_EQ(recording_ptr->requests[0], std::make_pair(static_cast<off_t>(9216), static_cast<size_t>(1024)));
+    EXPECT_EQ(recording_ptr->requests[1], std::make_pair(static_cast<off_t>(39936), static_cast<size_t>(256)));
+    
+    // Reads within the last range are served from it
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 64, 39950, 1), 64);
+    EXPECT_EQ(std::string(buf, 64), content.substr(39950, 64));
+    EXPECT_EQ(recording_ptr->requests.size(), 2u);
+    
+    // A read straddling two range units fetches both
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 64, 20480 - 32, 1), 64);
+    ASSERT_EQ(recording_ptr->requests.size(), 3u);
+    EXPECT_EQ(recording_ptr->requests[2], std::make_pair(static_cast<off_t>(20480 - 256), static_cast<size_t>(512)));
+    
+    // Blocks already cached are still served from the cache
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 64, 9300, 1), 64);
+    EXPECT_EQ(std::string(buf, 64), content.substr(9300, 64));
+    EXPECT_EQ(recording_ptr->requests.size(), 3u);
+    
+    const auto stats = cached_reader.strategyStats();
+    EXPECT_EQ(stats.blocks, 1u);
+    EXPECT_EQ(stats.ranges, 2u);
+    EXPECT_EQ(stats.range_bytes, 768u);
+    cached_reader.release(1);
+}
+
+TEST(ReaderTest, CachedReaderReturnsToBlocksWhenReadsTurnSequential) {
+    const std::string content = makePattern(64 * 1024);
+    auto recording = std::make_unique<RecordingReader>(content);
+    auto* recording_ptr = recording.get();
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024, 256, 4096);
+    cached_reader.open(1, "big.bin", 64 * 1024);
+    
+    char buf[128];
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 128, 30000, 1), 128);
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 128, 50000, 1), 128);
+    EXPECT_EQ(cached_reader.strategyStats().ranges, 1u);
+    
+    // One sequential read stays in range mode; the next goes back to blocks
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 128, 50128, 1), 128);
+    const size_t before = recording_ptr->snapshot().size();
+    ASSERT_EQ(cached_reader.read("big.bin", buf, 128, 50256, 1), 128);
+    EXPECT_EQ(std::string(buf, 128), content.substr(50256, 128));
+    auto requests = recording_ptr->snapshot();
+    ASSERT_EQ(requests.size(), before + 1);
+    EXPECT_EQ(requests.back(), std::make_pair(static_cast<off_t>(50176), static_cast<size_t>(1024)));
+    cached_reader.release(1);
+}
+
+TEST(ReaderTest, CachedReaderPrefetchCachesWholeObject) {
+    const std::string content = makePattern(2500);
+    auto recording = std::make_unique<RecordingReader>(content);
+    auto* recording_ptr = recording.get();
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024);
+    
+    EXPECT_TRUE(cached_reader.prefetch("tiny.bin", 2500));
+    ASSERT_EQ(recording_ptr->requests.size(), 1u);
+    EXPECT_EQ(recording_ptr->requests[0], std::make_pair(static_cast<off_t>(0), static_cast<size_t>(2500)));
+    
+    // Already cached: neither a second prefetch nor reads go to the reader
+    EXPECT_TRUE(cached_reader.prefetch("tiny.bin", 2500));
+    char buf[1000];
+    ASSERT_EQ(cached_reader.read("tiny.bin", buf, 1000, 2000), 500);
+    EXPECT_EQ(std::string(buf, 500), content.substr(2000));
+    EXPECT_EQ(recording_ptr->requests.size(), 1u);
+    EXPECT_EQ(cached_reader.strategyStats().prefetches, 1u);
+}
+
+TEST(ReaderTest, CachedReaderKeepsGenerationsApart) {
+    auto recording = std::make_unique<RecordingReader>(makePattern(4096));
+    auto* recording_ptr = recording.get();
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024);
+    
+    char buf[100];
+    ASSERT_EQ(cached_reader.read("v.bin", buf, sizeof(buf), 0, 0, 1), 100);
+    ASSERT_EQ(cached_reader.read("v.bin", buf, sizeof(buf), 200, 0, 1), 100);
+    EXPECT_EQ(recording_ptr->snapshot().size(), 1u);
+    
+    // A read pinned to a newer generation never gets the older block
+    ASSERT_EQ(cached_reader.read("v.bin", buf, sizeof(buf), 0, 0, 2), 100);
+    EXPECT_EQ(recording_ptr->snapshot().size(), 2u);
+    EXPECT_EQ(recording_ptr->generations, (std::vector<std::int64_t>{1, 2}));
+    EXPECT_EQ(cached_reader.cache().stats().stale, 1u);
+    
+    // Unpinned reads take whatever is cached
+    ASSERT_EQ(cached_reader.read("v.bin", buf, sizeof(buf), 0), 100);
+    EXPECT_EQ(recording_ptr->snapshot().size(), 2u);
+}
+
+TEST(ReaderTest, CachedReaderWithoutOpenReadsBlocks) {
+    auto recording = std::make_unique<RecordingReader>(makePattern(3000));
+    auto* recording_ptr = recording.get();
+    CachedReader cached_reader(std::move(recording), false, false, 1024, 1024 * 1024, 256, 4096);
+    
+    char buf[100];
+    ASSERT_EQ(cached_reader.read("small.bin", buf, 100, 2500, 1), 100);
+    ASSERT_FALSE(recording_ptr->requests.empty());
+    EXPECT_EQ(recording_ptr->requests[0], std::make_pair(static_cast<off_t>(2048), static_cast<size_t>(1024)));
+    EXPECT_EQ(cached_reader.strategyStats().blocks, 1u);
+}
+
+// ==================== GCSDirectReader Tests ====================
+
+TEST(ReaderTest, GCSDirectReaderContinuesSequentialReadsOnOneStream) {
+    const std::string content = makePattern(10000);
+    auto fake = std::make_unique<FakeGCSSDKClient>();
+    auto* fake_ptr = fake.get();
+    fake->addObject("seq.bin", content);
+    GCSClient client(std::move(fake));
+    GCSDirectReader reader("bucket", client);
+    reader.open(1, "seq.bin", 10000);
+    
+    char buf[1000];
+    for (off_t offset = 0; offset < 10000; offset += 1000) {
+        ASSERT_EQ(reader.read("seq.bin", buf, 1000, offset, 1), 1000);
+        EXPECT_EQ(std::string(buf, 1000), content.substr(offset, 1000));
+    }
+    EXPECT_EQ(fake_ptr->stats().read_requests, 1u);
+    
+    // A seek opens a new stream from the new offset
+    ASSERT_EQ(reader.read("seq.bin", buf, 1000, 2000, 1), 1000);
+    EXPECT_EQ(std::string(buf, 1000), content.substr(2000, 1000));
+    ASSERT_EQ(reader.read("seq.bin", buf, 1000, 3000, 1), 1000);
+    EXPECT_EQ(fake_ptr->stats().read_requests, 2u);
+    
+    reader.release(1);
+    EXPECT_EQ(reader.trackedHandles(), 0u);
+}
+
+TEST(ReaderTest, GCSDirectReaderKeepsInterleavedStreams) {
+    const std::string content = makePattern(8000);
+    auto fake = std::make_unique<FakeGCSSDKClient>();
+    auto* fake_ptr = fake.get();
+    fake->addObject("two.bin", content);
+    GCSClient client(std::move(fake));
+    GCSDirectReader reader("bucket", client);
+    reader.open(1, "two.bin", 8000);
+    
+    // Two sequential cursors on one handle, as read-ahead chunks produce
+    char buf[500];
+    for (off_t step = 0; step < 4000; step += 500) {
+        ASSERT_EQ(reader.read("two.bin", buf, 500, step, 1), 500);
+        EXPECT_EQ(std::string(buf, 500), content.substr(step, 500));
+        ASSERT_EQ(reader.read("two.bin", buf, 500, 4000 + step, 1), 500);
+        EXPECT_EQ(std::string(buf, 500), content.substr(4000 + step, 500));
+    }
+    EXPECT_EQ(fake_ptr->stats().read_requests, 2u);
+    reader.release(1);
+}
+
+TEST(ReaderTest, GCSDirectReaderWithoutOpenReadsRanges) {
+    auto fake = std::make_unique<FakeGCSSDKClient>();
+    auto* fake_ptr = fake.get();
+    fake->addObject("plain.bin", makePattern(4000));
+    GCSClient client(std::move(fake));
+    GCSDirectReader reader("bucket", client);
+    
+    char buf[1000];
+    ASSERT_EQ(reader.read("plain.bin", buf, 1000, 0, 1), 1000);
+    ASSERT_EQ(reader.read("plain.bin", buf, 1000, 1000, 1), 1000);
+    EXPECT_EQ(fake_ptr->stats().read_requests, 2u);
+    EXPECT_EQ(reader.trackedHandles(), 0u);
+}
+
+TEST(ReaderTest, GCSDirectReaderDropsStreamsOnInvalidate) {
+    auto fake = std::make_unique<FakeGCSSDKClient>();
+    auto* fake_ptr = fake.get();
+    fake->addObject("changed.bin", makePattern(4000));
+    GCSClient client(std::move(fake));
+    GCSDirectReader reader("bucket", client);
+    reader.open(1, "changed.bin", 4000);
+    
+    char buf[1000];
+    ASSERT_EQ(reader.read("changed.bin", buf, 1000, 0, 1), 1000);
+    fake_ptr->addObject("changed.bin", std::string(4000, 'z'));
+    reader.invalidate("changed.bin");
+    
+    ASSERT_EQ(reader.read("changed.bin", buf, 1000, 1000, 1), 1000);
+    EXPECT_EQ(std::string(buf, 1000), std::string(1000, 'z'));
+    EXPECT_EQ(fake_ptr->stats().read_requests, 2u);
+    
+    // Reading to the end leaves no stream behind
+    ASSERT_EQ(reader.read("changed.bin", buf, 1000, 2000, 1), 1000);
+    ASSERT_EQ(reader.read("changed.bin", buf, 1000, 3000, 1), 1000);
+    EXPECT_EQ(reader.read("changed.bin", buf, 1000, 4000, 1), 0);
+    reader.release(1);
+}
+
+TEST(ReaderTest, GCSDirectReaderPinsGeneration) {
+    const std::string content = makePattern(4000);
+    auto fake = std::make_unique<FakeGCSSDKClient>();
+    auto* fake_ptr = fake.get();
+    fake->addObject("pinned.bin", content);
+    GCSClient client(std::move(fake));
+    const std::int64_t first = client.getObjectMetadata("bucket", "pinned.bin")->generation;
+    GCSDirectReader reader("bucket", client);
+    reader.open(1, "pinned.bin", 4000);
+    
+    char buf[1000];
+    ASSERT_EQ(reader.read("pinned.bin", buf, 1000, 0, 1, first), 1000);
+    fake_ptr->addObject("pinned.bin", std::string(4000, 'z'));
+    
+    // The open stream keeps serving the generation it was opened on
+    ASSERT_EQ(reader.read("pinned.bin", buf, 1000, 1000, 1, first), 1000);
+    EXPECT_EQ(std::string(buf, 1000), content.substr(1000, 1000));
+    
+    // A new request for the replaced generation finds nothing
+    EXPECT_EQ(reader.read("pinned.bin", buf, 1000, 2000, 0, first), 0);
+    ASSERT_EQ(reader.read("pinned.bin", buf, 1000, 2000, 0, first + 1), 1000);
+    EXPECT_EQ(std::string(buf, 1000), std::string(1000, 'z'));
+    reader.release(1);
+}
+
+TEST(ReaderTest, GCSDirectReaderReportsBrokenReadsAsErrors) {
+    auto fake = std::make_unique<FakeGCSSDKClient>();
+    auto* fake_ptr = fake.get();
+    fake->addObject("broken.bin", makePattern(4000));
+    fake->failReads("broken.bin", 300);
+    GCSClient client(std::move(fake));
+    GCSDirectReader reader("bucket", client);
+    reader.open(1, "broken.bin", 4000);
+    
+    // The bytes before the break are not passed off as a short read,
+    // neither on a ranged GET nor on a stream
+    char buf[1000];
+    EXPECT_EQ(reader.read("broken.bin", buf, 1000, 0), -EIO);
+    EXPECT_EQ(reader.read("broken.bin", buf, 1000, 0, 1), -EIO);
+    
+    // Failing before the first byte is no empty file either
+    fake_ptr->failReads("broken.bin", 0);
+    EXPECT_EQ(reader.read("broken.bin", buf, 1000, 0), -EIO);
+    
+    fake_ptr->restoreReads("broken.bin");
+    EXPECT_EQ(reader.read("broken.bin", buf, 1000, 0, 1), 1000);
+    EXPECT_EQ(reader.read("broken.bin", buf, 1000, 4000), 0);
+    reader.release(1);
+}
+
+TEST(ReaderTest, CachedReaderDoesNotCacheBlockBrokenOffByGCS) {
+    const std::string content = makePattern(4096);
+    auto fake = std::make_unique<FakeGCSSDKClient>();
+    auto* fake_ptr = fake.get();
+    fake->addObject("broken.bin", content);
+    fake->failReads("broken.bin", 300);
+    GCSClient client(std::move(fake));
+    CachedReader cached_reader(std::make_unique<GCSDirectReader>("bucket", client), false, false,
+                               1024, 1024 * 1024);
+    
+    char buf[1024];
+    EXPECT_LT(cached_reader.read("broken.bin", buf, 1024, 0), 0);
+    EXPECT_FALSE(cached_reader.isCached("broken.bin", 0));
+    
+    fake_ptr->restoreReads("broken.bin");
+    ASSERT_EQ(cached_reader.read("broken.bin", buf, 1024, 0), 1024);
+    EXPECT_EQ(std::string(buf, 1024), content.substr(0, 1024));
+    EXPECT_TRUE(cached_reader.isCached("broken.bin", 0));
+}
+
+// ==================== ReadAheadReader Tests ====================
+
+TEST(ReaderTest, ReadAheadServesSequentialReads) {
+    const std::string content = makePattern(100000);
+    ReadAheadReader reader(std::make_unique<RecordingReader>(content), 4096, 4);
+    
+    std::string result;
+    char buf[1000];
+    off_t offset = 0;
+    while (true) {
+        int n = reader.read("big.bin", buf, sizeof(buf), offset, 1);
+        ASSERT_GE(n, 0);
+        if (n == 0) break;
+        result.append(buf, n);
+        offset += n;
+    }
+    
+    EXPECT_EQ(result, content);
+}
+
+TEST(ReaderTest, ReadAheadPrefetchesAheadOfSequentialReader) {
+    auto recording = std::make_unique<RecordingReader>(makePattern(100000));
+    auto* recording_ptr = recording.get();
+    ReadAheadReader reader(std::move(recording), 4096, 4);
+    
+    char buf[4096];
+    ASSERT_EQ(reader.read("big.bin", buf, 4096, 0, 1), 4096);
+    ASSERT_EQ(reader.read("big.bin", buf, 4096, 4096, 1), 4096);
+    ASSERT_EQ(reader.read("big.bin", buf, 4096, 8192, 1), 4096);
+    
+    // The window has ramped up, so fetches beyond the last read get issued
+    off_t furthest = 0;
+    for (int attempt = 0; attempt < 100 && furthest <= 8192; attempt++) {
+        for (const auto& [offset, size] : recording_ptr->snapshot()) {
+            furthest = std::max(furthest, offset);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_GT(furthest, 8192);
+}
+
+TEST(ReaderTest, ReadAheadSeekFallsBackToDirectRead) {
+    const std::string content = makePattern(100000);
+    auto recording = std::make_unique<RecordingReader>(content);
+    auto* recording_ptr = recording.get();
+    ReadAheadReader reader(std::move(recording), 4096, 4);
+    
+    char buf[100];
+    ASSERT_EQ(reader.read("big.bin", buf, 100, 0, 1), 100);
+    
+    // Random access returns exactly the requested range in one request
+    size_t before = recording_ptr->snapshot().size();
+    ASSERT_EQ(reader.read("big.bin", buf, 100, 50000, 1), 100);
+    EXPECT_EQ(std::string(buf, 100), content.substr(50000, 100));
+    
+    auto requests = recording_ptr->snapshot();
+    ASSERT_GE(requests.size(), before + 1);
+    EXPECT_EQ(requests.back(), std::make_pair(static_cast<off_t>(50000), static_cast<size_t>(100)));
+}
+
+TEST(ReaderTest, ReadAheadWithoutHandlePassesThrough) {
+    auto recording = std::make_unique<RecordingReader>(makePattern(10000));
+    auto* recording_ptr = recording.get();
+    ReadAheadReader reader(std::move(recording), 4096, 4);
+    
+    char buf[100];
+    ASSERT_EQ(reader.read("big.bin", buf, 100, 0), 100);
+    ASSERT_EQ(reader.read("big.bin", buf, 100, 100), 100);
+    
+    EXPECT_EQ(recording_ptr->snapshot().size(), 2u);
+}
+
+TEST(ReaderTest, ReadAheadHandlesAreIndependent) {
+    const std::string content = makePattern(50000);
+    ReadAheadReader reader(std::make_unique<RecordingReader>(content), 4096, 4);
+    
+    char buf1[500];
+    char buf2[500];
+    for (off_t offset = 0; offset < 20000; offset += 500) {
+        ASSERT_EQ(reader.read("big.bin", buf1, 500, offset, 1), 500);
+        ASSERT_EQ(reader.read("big.bin", buf2, 500, 40000 - offset, 2), 500);
+        EXPECT_EQ(std::string(buf1, 500), content.substr(offset, 500));
+        EXPECT_EQ(std::string(buf2, 500), content.substr(40000 - offset, 500));
+    }
+    
+    reader.release(1);
+    reader.release(2);
+}
+
+TEST(ReaderTest, ReadAheadStopsAtEndOfObject) {
+    const std::string content = makePattern(10000);
+    ReadAheadReader reader(std::make_unique<RecordingReader>(content), 4096, 8);
+    
+    char buf[8192];
+    EXPECT_EQ(reader.read("small.bin", buf, 8192, 0, 1), 8192);
+    EXPECT_EQ(reader.read("small.bin", buf, 8192, 8192, 1), 10000 - 8192);
+    EXPECT_EQ(reader.read("small.bin", buf, 8192, 10000, 1), 0);
+}
+
+// ==================== DiskCachedReader Tests ====================
+
+namespace {
+std::string makeTempDir() {
+    char dir_template[] = "/tmp/gcscfuse-reader-test-XXXXXX";
+    return mkdtemp(dir_template) ? dir_template : "";
+}
+}
+
+TEST(ReaderTest, DiskCachedReaderServesRepeatReadsFromDisk) {
+    const std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+    const std::string content = makePattern(10000);
+    auto recording = std::make_unique<RecordingReader>(content);
+    auto* raw = recording.get();
+    DiskCachedReader reader(std::move(recording), dir, 4096, 1024 * 1024);
+    
+    char buf[6000];
+    ASSERT_EQ(reader.read("file.bin", buf, 6000, 1000), 6000);
+    EXPECT_EQ(std::string(buf, 6000), content.substr(1000, 6000));
+    const size_t fetches = raw->snapshot().size();
+    EXPECT_EQ(fetches, 2u);  // blocks 0 and 1
+    
+    ASSERT_EQ(reader.read("file.bin", buf, 6000, 1000), 6000);
+    EXPECT_EQ(std::string(buf, 6000), content.substr(1000, 6000));
+    EXPECT_EQ(raw->snapshot().size(), fetches);
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ReaderTest, DiskCachedReaderSurvivesRestart) {
+    const std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+    const std::string content = makePattern(5000);
+    char buf[5000];
+    {
+        DiskCachedReader reader(std::make_unique<RecordingReader>(content), dir, 4096, 1024 * 1024);
+        ASSERT_EQ(reader.read("file.bin", buf, 5000, 0), 5000);
+    }
+    
+    auto recording = std::make_unique<RecordingReader>(content);
+    auto* raw = recording.get();
+    DiskCachedReader reader(std::move(recording), dir, 4096, 1024 * 1024);
+    ASSERT_EQ(reader.read("file.bin", buf, 5000, 0), 5000);
+    EXPECT_EQ(std::string(buf, 5000), content);
+    EXPECT_TRUE(raw->snapshot().empty());
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ReaderTest, DiskCachedReaderInvalidate) {
+    const std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+    auto recording = std::make_unique<RecordingReader>("content");
+    auto* raw = recording.get();
+    DiskCachedReader reader(std::move(recording), dir, 4096, 1024 * 1024);
+    
+    char buf[16];
+    EXPECT_EQ(reader.read("file.txt", buf, 16, 0), 7);
+    const size_t fetches = raw->snapshot().size();
+    reader.invalidate("file.txt");
+    EXPECT_EQ(reader.cache().blockCount(), 0u);
+    EXPECT_EQ(reader.read("file.txt", buf, 16, 0), 7);
+    EXPECT_GT(raw->snapshot().size(), fetches);
+    EXPECT_EQ(reader.cache().blockCount(), 1u);
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ReaderTest, DiskCachedReaderLocatesCachedBlocks) {
+    const std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+    const std::string content = makePattern(6000);
+    DiskCachedReader reader(std::make_unique<RecordingReader>(content), dir, 4096, 1024 * 1024);
+    
+    FileExtent extent;
+    EXPECT_FALSE(reader.locate("file.bin", 1000, 100, extent));
+    
+    char buf[6000];
+    ASSERT_EQ(reader.read("file.bin", buf, 6000, 0), 6000);
+    
+    // Extents stop at the block boundary
+    ASSERT_TRUE(reader.locate("file.bin", 8000, 100, extent));
+    EXPECT_EQ(extent.size, 4096u - 100);
+    ASSERT_EQ(pread(extent.fd, buf, extent.size, extent.pos), static_cast<ssize_t>(extent.size));
+    EXPECT_EQ(std::string(buf, extent.size), content.substr(100, extent.size));
+    
+    // The short last block ends at EOF
+    ASSERT_TRUE(reader.locate("file.bin", 8000, 4096, extent));
+    EXPECT_EQ(extent.size, 6000u - 4096);
+    
+    std::filesystem::remove_all(dir);
+}
+
+TEST(ReaderTest, CachedReaderLocatesOnlyBlocksNotInMemory) {
+    const std::string dir = makeTempDir();
+    ASSERT_FALSE(dir.empty());
+    const std::string content = makePattern(4096);
+    char buf[4096];
+    {
+        DiskCachedReader warm(std::make_unique<RecordingReader>(content), dir, 4096, 1024 * 1024);
+        ASSERT_EQ(warm.read("file.bin", buf, 4096, 0), 4096);
+    }
+    
+    CachedReader reader(
+        std::make_unique<DiskCachedReader>(std::make_unique<RecordingReader>(content), dir, 4096, 1024 * 1024),
+        false, false, 4096, 1024 * 1024);
+    
+    FileExtent extent;
+    EXPECT_TRUE(reader.locate("file.bin", 4096, 0, extent));
+    extent = FileExtent();
+    
+    ASSERT_EQ(reader.read("file.bin", buf, 4096, 0), 4096);
+    EXPECT_FALSE(reader.locate("file.bin", 4096, 0, extent));
+    
+    std::filesystem::remove_all(dir);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <future>
+#include <exception>
+#include <cstdint>
+#include <cstddef>
+
+namespace gcscfuse {
+
+/**
+ * SingleFlight - Coalesces concurrent calls for the same key
+ *
+ * The first caller for a key runs the fetch; callers arriving while it is
+ * in flight wait for it and get a copy of its result (or its exception)
+ * instead of issuing the same request again. Once the call completes the
+ * key is forgotten, so later callers fetch afresh: this deduplicates, it
+ * does not cache.
+ *
+ * Value is copied to every waiter, so it should be cheap to copy
+ * (a shared_ptr, a small struct).
+ *
+ * Thread-safe.
+ */
+template <typename Key, typename Value>
+class SingleFlight {
+public:
+    struct Stats {
+        std::uint64_t calls = 0;   // fetches actually run
+        std::uint64_t shared = 0;  // callers served by another caller's fetch
+    };
+
+    // Run fetch() for key, or wait for the fetch already running for key
+    template <typename Fetch>
+    Value run(const Key& key, Fetch&& fetch) {
+        std::promise<Value> promise;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            auto it = in_flight_.find(key);
+            if (it != in_flight_.end()) {
+                std::shared_future<Value> pending = it->second;
+                stats_.shared++;
+                lock.unlock();
+                return pending.get();
+            }
+            in_flight_.emplace(key, promise.get_future().share());
+            stats_.calls++;
+        }
+
+        try {
+            Value value = fetch();
+            finish(key);
+            promise.set_value(value);
+            return value;
+        } catch (...) {
+            finish(key);
+            promise.set_exception(std::current_exception());
+            throw;
+        }
+    }
+
+    size_t inFlight() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return in_flight_.size();
+    }
+
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+
+private:
+    mutable std::mutex mutex_;
+    std::map<Key, std::shared_future<Value>> in_flight_;
+    Stats stats_;
+
+    void finish(const Key& key) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        in_flight_.erase(key);
+    }
+};
+
+} // namespace gcscfuse
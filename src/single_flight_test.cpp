@@ -0,0 +1,137 @@
+#include <gtest/gtest.h>
+#include "single_flight.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gcscfuse;
+
+// Fetch that blocks until released, so callers pile up behind it
+class Gate {
+public:
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this] { return open_; });
+    }
+
+    void open() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        open_ = true;
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool open_ = false;
+};
+
+// Wait until n callers are waiting on the in-flight fetch
+template <typename SF>
+void waitForShared(const SF& flights, std::uint64_t n) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (flights.stats().shared < n && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+TEST(SingleFlightTest, RunsFetchAndReturnsResult) {
+    SingleFlight<std::string, int> flights;
+    EXPECT_EQ(flights.run("a", [] { return 42; }), 42);
+    EXPECT_EQ(flights.stats().calls, 1u);
+    EXPECT_EQ(flights.inFlight(), 0u);
+}
+
+TEST(SingleFlightTest, ConcurrentCallersShareOneFetch) {
+    SingleFlight<std::string, int> flights;
+    Gate gate;
+    std::atomic<int> fetches{0};
+
+    std::vector<std::thread> threads;
+    std::vector<int> results(8, 0);
+    threads.emplace_back([&] {
+        results[0] = flights.run("key", [&] { fetches++; gate.wait(); return 7; });
+    });
+    while (flights.inFlight() == 0) {
+        std::this_thread::yield();
+    }
+    for (size_t i = 1; i < results.size(); ++i) {
+        threads.emplace_back([&, i] {
+            results[i] = flights.run("key", [&] { fetches++; return -1; });
+        });
+    }
+
+    waitForShared(flights, results.size() - 1);
+    gate.open();
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(fetches.load(), 1);
+    for (int r : results) {
+        EXPECT_EQ(r, 7);
+    }
+    EXPECT_EQ(flights.stats().shared, results.size() - 1);
+}
+
+TEST(SingleFlightTest, DifferentKeysDoNotWait) {
+    SingleFlight<std::string, int> flights;
+    Gate gate;
+
+    std::thread slow([&] { flights.run("slow", [&] { gate.wait(); return 1; }); });
+    while (flights.inFlight() == 0) {
+        std::this_thread::yield();
+    }
+
+    EXPECT_EQ(flights.run("fast", [] { return 2; }), 2);
+    gate.open();
+    slow.join();
+}
+
+TEST(SingleFlightTest, ExceptionReachesAllWaiters) {
+    SingleFlight<std::string, int> flights;
+    Gate gate;
+
+    std::atomic<int> failures{0};
+    std::thread leader([&] {
+        try {
+            flights.run("key", [&]() -> int { gate.wait(); throw std::runtime_error("boom"); });
+        } catch (const std::runtime_error&) {
+            failures++;
+        }
+    });
+    while (flights.inFlight() == 0) {
+        std::this_thread::yield();
+    }
+    std::thread follower([&] {
+        try {
+            flights.run("key", [] { return 0; });
+        } catch (const std::runtime_error&) {
+            failures++;
+        }
+    });
+
+    waitForShared(flights, 1);
+    gate.open();
+    leader.join();
+    follower.join();
+    EXPECT_EQ(failures.load(), 2);
+}
+
+TEST(SingleFlightTest, CompletedKeyIsFetchedAgain) {
+    SingleFlight<std::string, int> flights;
+    int fetches = 0;
+    flights.run("key", [&] { return ++fetches; });
+    EXPECT_EQ(flights.run("key", [&] { return ++fetches; }), 2);
+    EXPECT_EQ(flights.stats().calls, 2u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
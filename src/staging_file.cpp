@@ -0,0 +1,106 @@
+#include "staging_file.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace gcscfuse {
+
+StagingFile::View::~View() {
+    if (size_ > 0) {
+        munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::unique_ptr<StagingFile> StagingFile::create(const std::string& dir) {
+    std::string base = dir;
+    if (base.empty()) {
+        const char* tmpdir = std::getenv("TMPDIR");
+        base = (tmpdir && *tmpdir) ? tmpdir : "/tmp";
+    }
+    std::string path_template = base + "/gcscfuse-staging-XXXXXX";
+    std::vector<char> path(path_template.begin(), path_template.end());
+    path.push_back('\0');
+
+    int fd = mkstemp(path.data());
+    if (fd < 0) {
+        std::cerr << "Error creating staging file in " << base << ": " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+
+    // Unlink right away so the space is reclaimed however we exit
+    unlink(path.data());
+    return std::unique_ptr<StagingFile>(new StagingFile(fd));
+}
+
+StagingFile::~StagingFile() {
+    close(fd_);
+}
+
+ssize_t StagingFile::write(const char* buf, size_t size, off_t offset) {
+    size_t written = 0;
+    while (written < size) {
+        ssize_t n = pwrite(fd_, buf + written, size - written, offset + static_cast<off_t>(written));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        written += static_cast<size_t>(n);
+    }
+
+    size_ = std::max(size_, static_cast<size_t>(offset) + size);
+    return static_cast<ssize_t>(written);
+}
+
+ssize_t StagingFile::read(char* buf, size_t size, off_t offset) const {
+    if (static_cast<size_t>(offset) >= size_) {
+        return 0;
+    }
+    size = std::min(size, size_ - static_cast<size_t>(offset));
+
+    size_t total = 0;
+    while (total < size) {
+        ssize_t n = pread(fd_, buf + total, size - total, offset + static_cast<off_t>(total));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -errno;
+        }
+        if (n == 0) {
+            break;
+        }
+        total += static_cast<size_t>(n);
+    }
+    return static_cast<ssize_t>(total);
+}
+
+int StagingFile::truncate(size_t new_size) {
+    if (ftruncate(fd_, static_cast<off_t>(new_size)) != 0) {
+        return -errno;
+    }
+    size_ = new_size;
+    return 0;
+}
+
+std::unique_ptr<StagingFile::View> StagingFile::view() const {
+    if (size_ == 0) {
+        return std::make_unique<View>(nullptr, 0);
+    }
+
+    void* data = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+    if (data == MAP_FAILED) {
+        std::cerr << "Error mapping staging file: " << strerror(errno) << std::endl;
+        return nullptr;
+    }
+    return std::make_unique<View>(static_cast<const char*>(data), size_);
+}
+
+} // namespace gcscfuse
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+#include <sys/types.h>
+
+namespace gcscfuse {
+
+/**
+ * StagingFile - Disk-backed scratch file holding a file's pending content
+ *
+ * Used when a write pattern cannot be streamed straight to GCS (random or
+ * overlapping writes), so large files do not have to be held in memory.
+ * The file is unlinked as soon as it is created; it disappears when the
+ * StagingFile is destroyed or the process exits.
+ *
+ * Not thread-safe; callers serialize access per object.
+ */
+class StagingFile {
+public:
+    /**
+     * Read-only mapping of the whole staged content, e.g. for upload.
+     * Stays valid while the View lives; the file must not be resized meanwhile.
+     */
+    class View {
+    public:
+        View(const char* data, size_t size) : data_(data), size_(size) {}
+        ~View();
+        View(const View&) = delete;
+        View& operator=(const View&) = delete;
+
+        const char* data() const { return data_; }
+        size_t size() const { return size_; }
+
+    private:
+        const char* data_;
+        size_t size_;
+    };
+
+    /**
+     * Create an empty staging file in dir (the system temp dir if empty)
+     * @return nullptr if the file could not be created
+     */
+    static std::unique_ptr<StagingFile> create(const std::string& dir);
+
+    ~StagingFile();
+    StagingFile(const StagingFile&) = delete;
+    StagingFile& operator=(const StagingFile&) = delete;
+
+    // Write at offset, extending the file (gaps read as zeros). Returns bytes written or -errno.
+    ssize_t write(const char* buf, size_t size, off_t offset);
+
+    // Read at offset. Returns bytes read (0 at EOF) or -errno.
+    ssize_t read(char* buf, size_t size, off_t offset) const;
+
+    // Resize to new_size. Returns 0 or -errno.
+    int truncate(size_t new_size);
+
+    // Current content size in bytes
+    size_t size() const { return size_; }
+
+    // Descriptor of the backing file, for splicing data in and out of it
+    // directly. Writes made through it must be reported with extendTo().
+    int fd() const { return fd_; }
+
+    // Record that content now reaches at least `end` bytes
+    void extendTo(size_t end) { size_ = std::max(size_, end); }
+
+    // Map the content for reading; nullptr on failure
+    std::unique_ptr<View> view() const;
+
+private:
+    explicit StagingFile(int fd) : fd_(fd) {}
+
+    int fd_;
+    size_t size_ = 0;
+};
+
+} // namespace gcscfuse
@@ -0,0 +1,86 @@
+#include <gtest/gtest.h>
+#include "staging_file.hpp"
+#include <unistd.h>
+
+using namespace gcscfuse;
+
+// Test fixture for StagingFile tests
+class StagingFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        file = StagingFile::create("");
+        ASSERT_NE(file, nullptr);
+    }
+
+    std::unique_ptr<StagingFile> file;
+};
+
+TEST_F(StagingFileTest, StartsEmpty) {
+    char buf[8];
+    EXPECT_EQ(file->size(), 0u);
+    EXPECT_EQ(file->read(buf, sizeof(buf), 0), 0);
+}
+
+TEST_F(StagingFileTest, WriteThenRead) {
+    ASSERT_EQ(file->write("hello world", 11, 0), 11);
+
+    char buf[16] = {};
+    EXPECT_EQ(file->read(buf, 5, 6), 5);
+    EXPECT_EQ(std::string(buf, 5), "world");
+    EXPECT_EQ(file->size(), 11u);
+}
+
+TEST_F(StagingFileTest, ReadStopsAtEnd) {
+    file->write("abc", 3, 0);
+
+    char buf[16];
+    EXPECT_EQ(file->read(buf, sizeof(buf), 1), 2);
+    EXPECT_EQ(file->read(buf, sizeof(buf), 3), 0);
+}
+
+TEST_F(StagingFileTest, WritePastEndZeroFillsGap) {
+    file->write("x", 1, 4);
+
+    char buf[5];
+    ASSERT_EQ(file->read(buf, sizeof(buf), 0), 5);
+    EXPECT_EQ(std::string(buf, 5), std::string("\0\0\0\0x", 5));
+}
+
+TEST_F(StagingFileTest, TruncateShrinksAndGrows) {
+    file->write("abcdef", 6, 0);
+
+    ASSERT_EQ(file->truncate(2), 0);
+    EXPECT_EQ(file->size(), 2u);
+
+    ASSERT_EQ(file->truncate(4), 0);
+    char buf[4];
+    ASSERT_EQ(file->read(buf, sizeof(buf), 0), 4);
+    EXPECT_EQ(std::string(buf, 4), std::string("ab\0\0", 4));
+}
+
+TEST_F(StagingFileTest, ViewMapsWholeContent) {
+    file->write("0123456789", 10, 0);
+
+    auto view = file->view();
+    ASSERT_NE(view, nullptr);
+    EXPECT_EQ(std::string(view->data(), view->size()), "0123456789");
+}
+
+TEST_F(StagingFileTest, WritesThroughFdAreCountedAfterExtend) {
+    ASSERT_EQ(pwrite(file->fd(), "direct", 6, 2), 6);
+    EXPECT_EQ(file->size(), 0u);
+
+    file->extendTo(8);
+    char buf[8];
+    ASSERT_EQ(file->read(buf, sizeof(buf), 0), 8);
+    EXPECT_EQ(std::string(buf, 8), std::string("\0\0direct", 8));
+}
+
+TEST(StagingFileCreateTest, FailsForMissingDirectory) {
+    EXPECT_EQ(StagingFile::create("/nonexistent/staging/dir"), nullptr);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,200 +1,842 @@
 #include "stat_cache.hpp"
-#include <sstream>
 #include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
-StatCache::StatCache() : root_(std::make_unique<TrieNode>()) {
+namespace {
+size_t hashName(std::string_view name) {
+    return std::hash<std::string_view>{}(name);
+}
+
+// Approximate footprint of one interned name: the map node (entry, link and
+// cached hash) plus the string's heap buffer once it outgrows the inline one
+size_t internedNameBytes(const std::string& name) {
+    size_t bytes = sizeof(std::pair<const std::string, size_t>) + 2 * sizeof(void*);
+    if (name.capacity() >= sizeof(std::string)) {
+        bytes += name.capacity() + 1;
+    }
+    return bytes;
+}
+
+// Snapshot layout, all integers in host byte order:
+//   header:  magic[8] version:u32 key_length:u32 record_count:u64 key
+//   record:  depth:u16 name_length:u16 flags:u8 size:i64 mtime:i64
+//            generation:i64 metageneration:i64 crc32c:u32 name
+// Records are in pre-order; depth 1 is a child of the root, and a record's
+// parent is the closest earlier record one level up.
+constexpr char kSnapshotMagic[8] = {'G', 'C', 'S', 'S', 'T', 'A', 'T', '\0'};
+constexpr uint32_t kSnapshotVersion = 2;
+constexpr uint8_t kRecordExists = 1 << 0;
+constexpr uint8_t kRecordDirectory = 1 << 1;
+constexpr uint8_t kRecordListed = 1 << 2;
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template <typename T>
+bool readValue(const char*& pos, const char* end, T& value) {
+    if (static_cast<size_t>(end - pos) < sizeof(value)) {
+        return false;
+    }
+    std::memcpy(&value, pos, sizeof(value));
+    pos += sizeof(value);
+    return true;
+}
+}
+
+// ============================================================================
+// ChildTable
+// ============================================================================
+
+StatCache::TrieNode* StatCache::ChildTable::find(std::string_view name) const {
+    if (size_ == 0) {
+        return nullptr;
+    }
+    const uint32_t mask = capacity_ - 1;
+    for (uint32_t i = hashName(name) & mask; slots_[i]; i = (i + 1) & mask) {
+        if (*slots_[i]->name == name) {
+            return slots_[i];
+        }
+    }
+    return nullptr;
+}
+
+void StatCache::ChildTable::insert(TrieNode* child) {
+    // Keep the load factor at or below 3/4 so probe runs stay short
+    if ((size_ + 1) * 4 > capacity_ * 3) {
+        rehash(capacity_ == 0 ? 4 : capacity_ * 2);
+    }
+    const uint32_t mask = capacity_ - 1;
+    uint32_t i = hashName(*child->name) & mask;
+    while (slots_[i]) {
+        i = (i + 1) & mask;
+    }
+    slots_[i] = child;
+    size_++;
+}
+
+void StatCache::ChildTable::erase(std::string_view name) {
+    if (size_ == 0) {
+        return;
+    }
+    const uint32_t mask = capacity_ - 1;
+    uint32_t i = hashName(name) & mask;
+    while (slots_[i] && *slots_[i]->name != name) {
+        i = (i + 1) & mask;
+    }
+    if (!slots_[i]) {
+        return;
+    }
+    slots_[i] = nullptr;
+    size_--;
+
+    if (size_ == 0) {
+        delete[] slots_;
+        slots_ = nullptr;
+        capacity_ = 0;
+        return;
+    }
+
+    // Backward-shift deletion: pull later entries of the probe run into the
+    // hole unless their home slot lies after it, so lookups need no tombstones
+    for (uint32_t j = (i + 1) & mask; slots_[j]; j = (j + 1) & mask) {
+        uint32_t home = hashName(*slots_[j]->name) & mask;
+        bool stays = (i <= j) ? (i < home && home <= j) : (i < home || home <= j);
+        if (!stays) {
+            slots_[i] = slots_[j];
+            slots_[j] = nullptr;
+            i = j;
+        }
+    }
+}
+
+void StatCache::ChildTable::rehash(uint32_t capacity) {
+    TrieNode** old_slots = slots_;
+    uint32_t old_capacity = capacity_;
+
+    slots_ = new TrieNode*[capacity]();
+    capacity_ = capacity;
+    size_ = 0;
+    for (uint32_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i]) {
+            insert(old_slots[i]);
+        }
+    }
+    delete[] old_slots;
+}
+
+// ============================================================================
+// NodePool
+// ============================================================================
+
+StatCache::TrieNode* StatCache::NodePool::create() {
+    Slot* slot = free_;
+    if (slot) {
+        free_ = slot->next;
+    } else {
+        if (next_in_chunk_ == kChunkNodes) {
+            chunks_.push_back(std::make_unique<Slot[]>(kChunkNodes));
+            next_in_chunk_ = 0;
+        }
+        slot = &chunks_.back()[next_in_chunk_++];
+    }
+    live_++;
+    return new (slot->storage) TrieNode();
+}
+
+void StatCache::NodePool::destroy(TrieNode* node) {
+    node->~TrieNode();
+    Slot* slot = reinterpret_cast<Slot*>(node);
+    slot->next = free_;
+    free_ = slot;
+    live_--;
+}
+
+// ============================================================================
+// StatCache
+// ============================================================================
+
+StatCache::StatCache() {
+    resetRoot();
+}
+
+StatCache::~StatCache() {
+    stopSweeper();
+    destroySubtree(root_);
+}
+
+void StatCache::resetRoot() {
+    root_ = pool_.create();
     root_->exists = true;
     root_->stat_info.is_directory = true;
     root_->stat_info.mode = S_IFDIR | 0755;
     root_->stat_info.metadata_loaded = true;
 }
 
-std::vector<std::string> StatCache::splitPath(const std::string& path) const {
-    std::vector<std::string> components;
-    
-    if (path.empty() || path == "/") {
-        return components;
+bool StatCache::nextComponent(std::string_view& rest, std::string_view& component) {
+    size_t start = rest.find_first_not_of('/');
+    if (start == std::string_view::npos) {
+        rest = std::string_view();
+        return false;
     }
-    
-    std::string cleaned = path;
-    // Remove leading slash
-    if (cleaned[0] == '/') {
-        cleaned = cleaned.substr(1);
+    size_t end = rest.find('/', start);
+    if (end == std::string_view::npos) {
+        end = rest.size();
     }
-    // Remove trailing slash
-    if (!cleaned.empty() && cleaned.back() == '/') {
-        cleaned = cleaned.substr(0, cleaned.length() - 1);
+    component = rest.substr(start, end - start);
+    rest.remove_prefix(end);
+    return true;
+}
+
+const StatCache::TrieNode* StatCache::findNode(std::string_view path) const {
+    const TrieNode* current = root_;
+    std::string_view component;
+    while (current && nextComponent(path, component)) {
+        current = current->children.find(component);
     }
-    
-    std::stringstream ss(cleaned);
-    std::string component;
-    while (std::getline(ss, component, '/')) {
-        if (!component.empty()) {
-            components.push_back(component);
+    return current;
+}
+
+StatCache::TrieNode* StatCache::findOrCreateNode(std::string_view path, bool mark_parents) {
+    const time_t now = time(nullptr);
+    TrieNode* current = root_;
+    std::string_view component;
+    while (nextComponent(path, component)) {
+        if (mark_parents && current != root_) {
+            markDirectory(current, now);
         }
+        TrieNode* child = current->children.find(component);
+        current = child ? child : addChild(current, component);
     }
-    
-    return components;
+    return current;
 }
 
-StatCache::TrieNode* StatCache::findNode(const std::string& path, bool create_if_missing) {
-    auto components = splitPath(path);
-    
-    TrieNode* current = root_.get();
-    
-    for (const auto& component : components) {
-        auto it = current->children.find(component);
-        
-        if (it == current->children.end()) {
-            if (!create_if_missing) {
-                return nullptr;
+StatCache::TrieNode* StatCache::addChild(TrieNode* parent, std::string_view name) {
+    // The temporary key only allocates for long names, once per new node
+    auto [it, inserted] = names_.try_emplace(std::string(name), 0);
+    if (inserted) {
+        name_bytes_ += internedNameBytes(it->first);
+    }
+    it->second++;
+
+    TrieNode* child = pool_.create();
+    child->name = &it->first;
+    child->parent = parent;
+
+    child_bytes_ -= parent->children.slotBytes();
+    parent->children.insert(child);
+    child_bytes_ += parent->children.slotBytes();
+    clockInsert(child);
+    return child;
+}
+
+void StatCache::removeChild(TrieNode* node) {
+    TrieNode* parent = node->parent;
+    child_bytes_ -= parent->children.slotBytes();
+    parent->children.erase(*node->name);
+    child_bytes_ += parent->children.slotBytes();
+
+    clockUnlink(node);
+    auto it = names_.find(*node->name);
+    pool_.destroy(node);
+    if (--it->second == 0) {
+        name_bytes_ -= internedNameBytes(it->first);
+        names_.erase(it);
+    }
+}
+
+void StatCache::destroySubtree(TrieNode* node) {
+    std::vector<TrieNode*> pending{node};
+    while (!pending.empty()) {
+        TrieNode* current = pending.back();
+        pending.pop_back();
+        current->children.forEach([&](TrieNode* child) { pending.push_back(child); });
+        pool_.destroy(current);
+    }
+}
+
+void StatCache::clockInsert(TrieNode* node) {
+    if (!clock_hand_) {
+        node->clock_prev = node->clock_next = node;
+        clock_hand_ = sweep_hand_ = node;
+        return;
+    }
+    // Just behind the hand, so a new node gets a full revolution before it is considered
+    node->clock_next = clock_hand_;
+    node->clock_prev = clock_hand_->clock_prev;
+    node->clock_prev->clock_next = node;
+    clock_hand_->clock_prev = node;
+}
+
+void StatCache::clockUnlink(TrieNode* node) {
+    if (node->clock_next == node) {
+        clock_hand_ = sweep_hand_ = nullptr;
+        return;
+    }
+    if (clock_hand_ == node) clock_hand_ = node->clock_next;
+    if (sweep_hand_ == node) sweep_hand_ = node->clock_next;
+    node->clock_prev->clock_next = node->clock_next;
+    node->clock_next->clock_prev = node->clock_prev;
+}
+
+void StatCache::pruneFrom(TrieNode* node) {
+    while (node != root_ && node->children.empty() && !node->exists) {
+        TrieNode* parent = node->parent;
+        removeChild(node);
+        node = parent;
+    }
+}
+
+void StatCache::evictLeaf(TrieNode* node) {
+    if (node->exists) {
+        // The parent's cached listing no longer names every child
+        node->parent->listed_time = 0;
+        node->parent->listing_has_subdirs = false;
+    }
+    node->exists = false;
+    node->negative = false;
+    node->stat_info = StatInfo();
+    pruneFrom(node);
+}
+
+void StatCache::enforceLimit() {
+    if (max_entries_ == 0) return;
+
+    // Two revolutions are enough: the first clears reference bits
+    size_t budget = 2 * pool_.live();
+    while (pool_.live() - 1 > max_entries_ && clock_hand_ && budget-- > 0) {
+        TrieNode* node = clock_hand_;
+        clock_hand_ = node->clock_next;
+        if (!node->children.empty() || node->referenced.exchange(false, std::memory_order_relaxed)) {
+            continue;
+        }
+        evictLeaf(node);
+        eviction_stats_.evicted++;
+    }
+}
+
+bool StatCache::isStale(const TrieNode& node) const {
+    if (node.exists) {
+        return isPastMaxStaleness(node.stat_info.cache_time);
+    }
+    if (node.negative) {
+        return !isNegativeFresh(node.negative_time);
+    }
+    return true;
+}
+
+void StatCache::setMaxEntries(size_t max_entries) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    max_entries_ = max_entries;
+}
+
+size_t StatCache::sweepExpired() {
+    size_t swept = 0;
+    size_t remaining = size();
+    while (remaining > 0) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        size_t batch = std::min(remaining, kSweepBatch);
+        remaining -= batch;
+        for (; batch > 0 && sweep_hand_; --batch) {
+            TrieNode* node = sweep_hand_;
+            sweep_hand_ = node->clock_next;
+            if (node->children.empty() && isStale(*node)) {
+                evictLeaf(node);
+                eviction_stats_.expired++;
+                swept++;
             }
-            current->children[component] = std::make_unique<TrieNode>();
         }
-        
-        current = current->children[component].get();
+        if (!sweep_hand_) break;
     }
-    
-    return current;
+    return swept;
 }
 
-void StatCache::insertFile(const std::string& path, off_t size, time_t mtime) {
-    auto components = splitPath(path);
-    if (components.empty()) return;
-    
-    // Ensure all parent directories exist
-    std::string parent_path;
-    for (size_t i = 0; i < components.size() - 1; ++i) {
-        parent_path += "/" + components[i];
-        insertDirectory(parent_path);
+void StatCache::startSweeper(int interval_seconds) {
+    if (interval_seconds <= 0 || sweeper_.joinable()) return;
+
+    sweeper_ = std::thread([this, interval_seconds] {
+        std::unique_lock<std::mutex> lock(sweeper_mutex_);
+        while (!sweeper_cv_.wait_for(lock, std::chrono::seconds(interval_seconds),
+                                     [this] { return stop_sweeper_; })) {
+            lock.unlock();
+            sweepExpired();
+            lock.lock();
+        }
+    });
+}
+
+void StatCache::stopSweeper() {
+    {
+        std::lock_guard<std::mutex> lock(sweeper_mutex_);
+        stop_sweeper_ = true;
     }
-    
-    // Insert the file
-    TrieNode* node = findNode(path, true);
-    if (node) {
-        node->exists = true;
-        node->stat_info.is_directory = false;
-        node->stat_info.mode = S_IFREG | 0644;  // Read-write file
-        node->stat_info.size = size;
-        node->stat_info.mtime = mtime;
-        node->stat_info.cache_time = time(nullptr);
-        node->stat_info.metadata_loaded = true;
+    sweeper_cv_.notify_all();
+    if (sweeper_.joinable()) {
+        sweeper_.join();
+    }
+    std::lock_guard<std::mutex> lock(sweeper_mutex_);
+    stop_sweeper_ = false;
+}
+
+void StatCache::removeSubtree(TrieNode* node) {
+    // Reverse pre-order removes every child before its parent
+    std::vector<TrieNode*> order;
+    std::vector<TrieNode*> pending{node};
+    while (!pending.empty()) {
+        TrieNode* current = pending.back();
+        pending.pop_back();
+        order.push_back(current);
+        current->children.forEach([&](TrieNode* child) { pending.push_back(child); });
     }
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        removeChild(*it);
+    }
+}
+
+void StatCache::markDirectory(TrieNode* node, time_t now) {
+    if (node->stat_info.metadata_loaded && !node->stat_info.stale) {
+        // A directory seen again is confirmed for another TTL; a file keeps its entry
+        if (node->stat_info.is_directory) {
+            node->stat_info.cache_time = now;
+        }
+        return;
+    }
+
+    node->exists = true;
+    node->negative = false;
+    node->stat_info.is_directory = true;
+    node->stat_info.mode = S_IFDIR | 0755;
+    node->stat_info.size = 0;
+    node->stat_info.mtime = now;
+    node->stat_info.cache_time = now;
+    node->stat_info.generation = 0;
+    node->stat_info.metageneration = 0;
+    node->stat_info.crc32c = 0;
+    node->stat_info.metadata_loaded = true;
+    node->stat_info.stale = false;
+}
+
+void StatCache::insertFile(const std::string& path, off_t size, time_t mtime,
+                           int64_t generation, int64_t metageneration, uint32_t crc32c) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+
+    // One walk creates the node and records every parent as a directory
+    TrieNode* node = findOrCreateNode(path, true);
+    if (node == root_) return;
+
+    node->exists = true;
+    node->negative = false;
+    node->stat_info.is_directory = false;
+    node->stat_info.mode = S_IFREG | 0644;  // Read-write file
+    node->stat_info.size = size;
+    node->stat_info.mtime = mtime;
+    node->stat_info.cache_time = time(nullptr);
+    node->stat_info.generation = generation;
+    node->stat_info.metageneration = metageneration;
+    node->stat_info.crc32c = crc32c;
+    node->stat_info.metadata_loaded = true;
+    node->stat_info.stale = false;
+    enforceLimit();
 }
 
 void StatCache::insertDirectory(const std::string& path) {
-    if (path.empty() || path == "/") return;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    TrieNode* node = findOrCreateNode(path, false);
+    if (node != root_) {
+        markDirectory(node, time(nullptr));
+    }
+    enforceLimit();
+}
+
+void StatCache::insertNegative(const std::string& path) {
+    if (negative_timeout_ <= 0) return;
+
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    TrieNode* node = findOrCreateNode(path, false);
+    if (node == root_) return;
+
+    node->exists = false;
+    node->stat_info = StatInfo();
+    node->negative = true;
+    node->negative_time = time(nullptr);
+    enforceLimit();
+}
+
+void StatCache::markDirectoryListed(const std::string& path, bool includes_subdirectories,
+                                    size_t listed_children) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    TrieNode* node = findOrCreateNode(path, false);
+    markDirectory(node, time(nullptr));
+    
+    std::vector<TrieNode*> gone;
+    node->children.forEach([&](TrieNode* child) {
+        if (child->exists && (child->stat_info.stale || isExpired(child->stat_info)) &&
+            (includes_subdirectories || !child->stat_info.is_directory)) {
+            gone.push_back(child);
+        }
+    });
+    for (TrieNode* child : gone) {
+        removeSubtree(child);
+    }
     
-    TrieNode* node = findNode(path, true);
-    if (node && !node->stat_info.metadata_loaded) {
-        node->exists = true;
-        node->stat_info.is_directory = true;
-        node->stat_info.mode = S_IFDIR | 0755;
-        node->stat_info.size = 0;
-        node->stat_info.mtime = time(nullptr);
-        node->stat_info.cache_time = time(nullptr);
-        node->stat_info.metadata_loaded = true;
+    size_t cached_children = 0;
+    if (listed_children > 0) {
+        node->children.forEach([&](const TrieNode* child) { cached_children += child->exists; });
+    }
+    if (node->stat_info.is_directory && cached_children >= listed_children) {
+        node->listed_time = time(nullptr);
+        node->listing_has_subdirs = includes_subdirectories;
+        node->listing_stale = false;
+    }
+    enforceLimit();
+}
+
+bool StatCache::isListingFresh(const std::string& path) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const TrieNode* node = findNode(path);
+    if (!node || !node->exists || !node->stat_info.is_directory || node->listed_time == 0) {
+        return false;
+    }
+    node->referenced.store(true, std::memory_order_relaxed);
+    return !isPastMaxStaleness(node->listed_time);
+}
+
+bool StatCache::isListingStale(const std::string& path) const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const TrieNode* node = findNode(path);
+    if (!node || node->listed_time == 0) {
+        return false;
     }
+    return node->listing_stale ||
+           (cache_timeout_ > 0 && (time(nullptr) - node->listed_time) > cache_timeout_);
+}
+
+bool StatCache::isKnownMissing(const std::string& path) const {
+    if (negative_timeout_ <= 0) return false;
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const TrieNode* current = root_;
+    std::string_view rest = path;
+    std::string_view component;
+    while (nextComponent(rest, component)) {
+        const TrieNode* child = current->children.find(component);
+
+        if (!child || !child->exists) {
+            // Not in a complete listing of the parent, or looked up and not found
+            if (current->stat_info.is_directory && current->listing_has_subdirs &&
+                isNegativeFresh(current->listed_time)) {
+                return true;
+            }
+            if (child && child->negative && isNegativeFresh(child->negative_time)) {
+                child->referenced.store(true, std::memory_order_relaxed);
+                return true;
+            }
+            return false;
+        }
+        current = child;
+    }
+
+    return false;
 }
 
 std::optional<StatCache::StatInfo> StatCache::getStat(const std::string& path) const {
-    if (path.empty() || path == "/") {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+
+    const TrieNode* node = findNode(path);
+    if (node == root_) {
         return root_->stat_info;
     }
-    
-    TrieNode* node = const_cast<StatCache*>(this)->findNode(path, false);
     if (node && node->exists && node->stat_info.metadata_loaded) {
         // Check if expired (lazy eviction)
-        if (isExpired(node->stat_info)) {
+        if (isPastMaxStaleness(node->stat_info.cache_time)) {
             return std::nullopt;
         }
-        return node->stat_info;
+        node->referenced.store(true, std::memory_order_relaxed);
+        StatInfo info = node->stat_info;
+        info.stale = info.stale || isExpired(info);
+        return info;
     }
-    
+
     return std::nullopt;
 }
 
 bool StatCache::exists(const std::string& path) const {
-    if (path.empty() || path == "/") {
-        return true;
-    }
-    
-    TrieNode* node = const_cast<StatCache*>(this)->findNode(path, false);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const TrieNode* node = findNode(path);
     return node && node->exists;
 }
 
 bool StatCache::isDirectory(const std::string& path) const {
-    if (path.empty() || path == "/") {
-        return true;
-    }
-    
-    TrieNode* node = const_cast<StatCache*>(this)->findNode(path, false);
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const TrieNode* node = findNode(path);
     return node && node->exists && node->stat_info.is_directory;
 }
 
 void StatCache::clear() {
-    root_ = std::make_unique<TrieNode>();
-    root_->exists = true;
-    root_->stat_info.is_directory = true;
-    root_->stat_info.mode = S_IFDIR | 0755;
-    root_->stat_info.metadata_loaded = true;
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    destroySubtree(root_);
+    names_.clear();
+    name_bytes_ = 0;
+    child_bytes_ = 0;
+    clock_hand_ = sweep_hand_ = nullptr;
+    resetRoot();
 }
 
 std::vector<std::string> StatCache::listDirectory(const std::string& path) const {
     std::vector<std::string> entries;
-    
-    TrieNode* node = const_cast<StatCache*>(this)->findNode(path, false);
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const TrieNode* node = findNode(path);
     if (!node || !node->stat_info.is_directory) {
         return entries;
     }
-    
-    for (const auto& [name, child] : node->children) {
+
+    entries.reserve(node->children.size());
+    node->children.forEach([&](const TrieNode* child) {
         if (child->exists) {
-            entries.push_back(name);
+            entries.push_back(*child->name);
         }
+    });
+    std::sort(entries.begin(), entries.end());
+
+    return entries;
+}
+
+std::vector<std::pair<std::string, StatCache::StatInfo>> StatCache::listDirectoryWithStats(const std::string& path) const {
+    std::vector<std::pair<std::string, StatInfo>> entries;
+
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const TrieNode* node = findNode(path);
+    if (!node || !node->stat_info.is_directory) {
+        return entries;
     }
-    
+
+    entries.reserve(node->children.size());
+    node->children.forEach([&](const TrieNode* child) {
+        if (child->exists) {
+            entries.emplace_back(*child->name, child->stat_info);
+        }
+    });
+    std::sort(entries.begin(), entries.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
     return entries;
 }
 
-void StatCache::remove(const std::string& path)
-{
-    std::vector<std::string> components = splitPath(path);
-    if (components.empty()) {
-        return;
+bool StatCache::saveSnapshot(const std::string& file_path, const std::string& key) const {
+    std::string data;
+    uint64_t records = 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(mutex_);
+        data.reserve(pool_.live() * 52);
+        
+        // Pre-order walk; negative entries are too short-lived to keep
+        std::vector<std::pair<const TrieNode*, uint16_t>> pending;
+        root_->children.forEach([&](const TrieNode* child) { pending.emplace_back(child, 1); });
+        while (!pending.empty()) {
+            auto [node, depth] = pending.back();
+            pending.pop_back();
+            if (!node->exists && node->children.empty()) {
+                continue;
+            }
+            
+            uint8_t flags = 0;
+            if (node->exists) flags |= kRecordExists;
+            if (node->stat_info.is_directory) flags |= kRecordDirectory;
+            if (node->listed_time != 0) flags |= kRecordListed;
+            appendValue<uint16_t>(data, depth);
+            appendValue<uint16_t>(data, static_cast<uint16_t>(node->name->size()));
+            appendValue<uint8_t>(data, flags);
+            appendValue<int64_t>(data, node->stat_info.size);
+            appendValue<int64_t>(data, node->stat_info.mtime);
+            appendValue<int64_t>(data, node->stat_info.generation);
+            appendValue<int64_t>(data, node->stat_info.metageneration);
+            appendValue<uint32_t>(data, node->stat_info.crc32c);
+            data.append(*node->name);
+            records++;
+            
+            if (depth < UINT16_MAX) {
+                node->children.forEach([&](const TrieNode* child) {
+                    pending.emplace_back(child, static_cast<uint16_t>(depth + 1));
+                });
+            }
+        }
     }
     
-    TrieNode* current = root_.get();
-    std::vector<TrieNode*> path_nodes;
-    path_nodes.push_back(current);
+    std::string header(kSnapshotMagic, sizeof(kSnapshotMagic));
+    appendValue<uint32_t>(header, kSnapshotVersion);
+    appendValue<uint32_t>(header, static_cast<uint32_t>(key.size()));
+    appendValue<uint64_t>(header, records);
+    header.append(key);
     
-    // Navigate to the target node
-    for (const auto& component : components) {
-        auto it = current->children.find(component);
-        if (it == current->children.end()) {
-            return; // Path doesn't exist, nothing to remove
+    // Written beside the target and renamed over it, so a crash mid-write
+    // leaves the previous snapshot intact
+    const std::string temp_path = file_path + ".tmp-" + std::to_string(::getpid());
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        out.write(header.data(), static_cast<std::streamsize>(header.size()));
+        out.write(data.data(), static_cast<std::streamsize>(data.size()));
+        out.close();
+        if (!out) {
+            std::cerr << "Failed to write stat cache snapshot " << temp_path << std::endl;
+            std::remove(temp_path.c_str());
+            return false;
         }
-        current = it->second.get();
-        path_nodes.push_back(current);
+    }
+    if (std::rename(temp_path.c_str(), file_path.c_str()) != 0) {
+        std::cerr << "Failed to replace stat cache snapshot " << file_path << ": "
+                  << std::strerror(errno) << std::endl;
+        std::remove(temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+size_t StatCache::loadSnapshot(const std::string& file_path, const std::string& key) {
+    int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return 0;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size == 0) {
+        ::close(fd);
+        return 0;
+    }
+    const size_t length = static_cast<size_t>(st.st_size);
+    void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return 0;
     }
     
-    // Mark the node as non-existent
-    current->exists = false;
-    current->stat_info = StatInfo();
+    const char* pos = static_cast<const char*>(mapped);
+    const char* end = pos + length;
+    uint32_t version = 0;
+    uint32_t key_length = 0;
+    uint64_t records = 0;
+    bool valid = length >= sizeof(kSnapshotMagic) &&
+                 std::memcmp(pos, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0;
+    if (valid) {
+        pos += sizeof(kSnapshotMagic);
+        valid = readValue(pos, end, version) && version == kSnapshotVersion &&
+                readValue(pos, end, key_length) && readValue(pos, end, records) &&
+                static_cast<size_t>(end - pos) >= key_length &&
+                std::string_view(pos, key_length) == key;
+        pos += valid ? key_length : 0;
+    }
     
-    // Optionally, clean up empty nodes (prune the trie)
-    // Work backwards from the target to root
-    for (int i = components.size() - 1; i >= 0; --i) {
-        TrieNode* node = path_nodes[i + 1];
-        
-        // If node has no children and doesn't exist, remove it from parent
-        if (node->children.empty() && !node->exists) {
-            TrieNode* parent = path_nodes[i];
-            parent->children.erase(components[i]);
-        } else {
-            // Stop pruning if node is still needed
-            break;
+    size_t loaded = 0;
+    if (valid) {
+        std::unique_lock<std::shared_mutex> lock(mutex_);
+        const time_t now = time(nullptr);
+        std::vector<TrieNode*> ancestors{root_};
+        for (uint64_t i = 0; i < records; ++i) {
+            uint16_t depth = 0;
+            uint16_t name_length = 0;
+            uint8_t flags = 0;
+            int64_t size = 0;
+            int64_t mtime = 0;
+            int64_t generation = 0;
+            int64_t metageneration = 0;
+            uint32_t crc32c = 0;
+            if (!readValue(pos, end, depth) || !readValue(pos, end, name_length) ||
+                !readValue(pos, end, flags) || !readValue(pos, end, size) ||
+                !readValue(pos, end, mtime) || !readValue(pos, end, generation) ||
+                !readValue(pos, end, metageneration) || !readValue(pos, end, crc32c) ||
+                static_cast<size_t>(end - pos) < name_length ||
+                depth == 0 || depth > ancestors.size() || name_length == 0) {
+                valid = false;
+                break;
+            }
+            // Names are interned straight from the mapping
+            std::string_view name(pos, name_length);
+            pos += name_length;
+            
+            ancestors.resize(depth);
+            TrieNode* parent = ancestors.back();
+            TrieNode* node = parent->children.find(name);
+            if (!node) {
+                node = addChild(parent, name);
+            }
+            ancestors.push_back(node);
+            
+            if (!(flags & kRecordExists) || node->exists || node->negative) {
+                continue;
+            }
+            node->exists = true;
+            node->stat_info.is_directory = (flags & kRecordDirectory) != 0;
+            node->stat_info.mode = node->stat_info.is_directory ? (S_IFDIR | 0755) : (S_IFREG | 0644);
+            node->stat_info.size = static_cast<off_t>(size);
+            node->stat_info.mtime = static_cast<time_t>(mtime);
+            node->stat_info.generation = generation;
+            node->stat_info.metageneration = metageneration;
+            node->stat_info.crc32c = crc32c;
+            node->stat_info.cache_time = now;
+            node->stat_info.metadata_loaded = true;
+            node->stat_info.stale = true;
+            if ((flags & kRecordListed) && node->stat_info.is_directory) {
+                node->listed_time = now;
+                node->listing_has_subdirs = false;
+                node->listing_stale = true;
+            }
+            loaded++;
         }
+        enforceLimit();
+    }
+    ::munmap(mapped, length);
+    
+    if (!valid) {
+        std::cerr << "Ignoring stat cache snapshot " << file_path
+                  << ": unreadable or written for another bucket (" << loaded << " entries loaded)" << std::endl;
     }
+    return loaded;
 }
 
+size_t StatCache::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return pool_.live() - 1;
+}
+
+StatCache::EvictionStats StatCache::evictionStats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    return eviction_stats_;
+}
+
+StatCache::MemoryStats StatCache::memoryStats() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    MemoryStats stats;
+    stats.nodes = pool_.live();
+    stats.names = names_.size();
+    stats.node_bytes = pool_.bytes();
+    stats.child_bytes = child_bytes_;
+    stats.name_bytes = name_bytes_ + names_.bucket_count() * sizeof(void*);
+    return stats;
+}
+
+void StatCache::remove(const std::string& path)
+{
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    TrieNode* node = const_cast<TrieNode*>(findNode(path));
+    if (!node || node == root_) {
+        return; // Path doesn't exist, nothing to remove
+    }
+
+    // Mark the node as non-existent
+    node->exists = false;
+    node->negative = false;
+    node->stat_info = StatInfo();
+
+    pruneFrom(node);
+}
@@ -1,70 +1,322 @@
 #pragma once
 
 #include <string>
-#include <map>
+#include <string_view>
+#include <unordered_map>
 #include <memory>
 #include <vector>
+#include <cstdint>
+#include <cstddef>
 #include <sys/stat.h>
 #include <optional>
+#include <shared_mutex>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
 
 /**
  * StatCache - Trie-based cache for storing file/directory metadata
  * 
  * Efficiently stores stat information for paths in a trie structure.
  * Each node represents a path component (directory or file).
+ *
+ * A directory can carry a "listing complete" mark, so readdir can be served
+ * from its cached children until the stat TTL expires.
+ *
+ * Paths known not to exist are kept as negative entries with their own,
+ * usually much shorter, TTL. A directory whose complete listing (including
+ * subdirectories) was cached also answers "missing" for any child not in it,
+ * for the same TTL.
+ *
+ * Lookups walk the path as string_views without allocating. Nodes come
+ * from a chunked pool, children sit in a flat open-addressing table, and
+ * component names are interned, so memory per entry stays small when
+ * millions of paths are cached; memoryStats() reports it.
+ *
+ * With a maximum entry count, inserts past it evict cold leaves in CLOCK
+ * order (an approximation of LRU whose reference bit lookups can set under
+ * the shared lock). An optional sweeper thread prunes expired leaves in
+ * small batches so a long-running mount does not keep them forever.
+ *
+ * The trie can be saved to a snapshot file and loaded into a later run.
+ * Loaded entries are marked stale: they are served as usual, and the
+ * caller revalidates them lazily (cheaply, for files whose generation the
+ * snapshot kept). Loaded listings serve readdir but never
+ * answer "missing", since objects may have appeared since the snapshot.
+ *
+ * Thread-safe: lookups take a shared lock on the trie, so concurrent
+ * getattr calls do not serialize; mutations take an exclusive lock.
  */
 class StatCache {
 public:
     struct StatInfo {
         mode_t mode;           // File type and permissions
+        uint32_t crc32c;       // CRC32C of the object's content, 0 if unknown
         off_t size;            // File size in bytes
         time_t mtime;          // Last modification time
         time_t cache_time;     // Time when this entry was cached
+        int64_t generation;    // GCS generation of the object, 0 if unknown (e.g. written here)
+        int64_t metageneration;  // GCS metageneration within that generation, 0 if unknown
         bool is_directory;     // True if this is a directory
         bool metadata_loaded;  // True if metadata has been fetched from GCS
+        bool stale;            // Loaded from a snapshot and not yet confirmed against GCS
         
         StatInfo() 
-            : mode(0), size(0), mtime(0), cache_time(0), is_directory(false), metadata_loaded(false) {}
+            : mode(0), crc32c(0), size(0), mtime(0), cache_time(0), generation(0), metageneration(0),
+              is_directory(false), metadata_loaded(false), stale(false) {}
+    };
+
+    // Memory held by the cache; bytes / nodes is the cost per cached path
+    struct MemoryStats {
+        size_t nodes = 0;        // trie nodes in use, including the root
+        size_t names = 0;        // distinct interned path components
+        size_t node_bytes = 0;   // node pool chunks, used or free
+        size_t child_bytes = 0;  // children hash table slots
+        size_t name_bytes = 0;   // interned name storage
+        size_t bytes() const { return node_bytes + child_bytes + name_bytes; }
+    };
+    
+    struct EvictionStats {
+        uint64_t evicted = 0;  // cold entries dropped to stay under the entry limit
+        uint64_t expired = 0;  // expired entries pruned by sweeps
     };
 
 private:
+    struct TrieNode;
+
+    // Open-addressing hash table of a node's children, keyed by their
+    // interned names. A slot is one pointer, so small directories stay small.
+    class ChildTable {
+    public:
+        ChildTable() = default;
+        ~ChildTable() { delete[] slots_; }
+        ChildTable(const ChildTable&) = delete;
+        ChildTable& operator=(const ChildTable&) = delete;
+
+        TrieNode* find(std::string_view name) const;
+        void insert(TrieNode* child);
+        void erase(std::string_view name);
+
+        bool empty() const { return size_ == 0; }
+        size_t size() const { return size_; }
+        size_t slotBytes() const { return capacity_ * sizeof(TrieNode*); }
+
+        template <typename Fn>
+        void forEach(Fn&& fn) const {
+            for (uint32_t i = 0; i < capacity_; ++i) {
+                if (slots_[i]) fn(slots_[i]);
+            }
+        }
+
+    private:
+        TrieNode** slots_ = nullptr;
+        uint32_t size_ = 0;
+        uint32_t capacity_ = 0;  // 0 or a power of two
+
+        void rehash(uint32_t capacity);
+    };
+
     struct TrieNode {
-        std::map<std::string, std::unique_ptr<TrieNode>> children;
+        const std::string* name = nullptr;  // interned, null for the root
+        TrieNode* parent = nullptr;
+        TrieNode* clock_prev = nullptr;  // ring of all non-root nodes, in insertion order
+        TrieNode* clock_next = nullptr;
+        ChildTable children;
         StatInfo stat_info;
-        bool exists = false;  // True if this path exists (file or directory)
+        time_t negative_time = 0;  // When the negative entry was recorded
+        time_t listed_time = 0;    // When this directory's complete listing was cached, 0 = never
+        bool exists = false;       // True if this path exists (file or directory)
+        bool negative = false;     // True if this path is known not to exist
+        bool listing_has_subdirs = false;  // Whether that listing also covered subdirectories
+        bool listing_stale = false;        // That listing came from a snapshot
+        mutable std::atomic<bool> referenced{false};  // looked up since the clock hand last passed
         
         TrieNode() = default;
     };
 
-    std::unique_ptr<TrieNode> root_;
+    // Fixed-size chunks of node storage with a free list, so inserting a
+    // path does not cost one heap allocation per component
+    class NodePool {
+    public:
+        NodePool() = default;
+        ~NodePool() = default;  // nodes must already be destroyed
+        NodePool(const NodePool&) = delete;
+        NodePool& operator=(const NodePool&) = delete;
+
+        TrieNode* create();
+        void destroy(TrieNode* node);
+
+        size_t live() const { return live_; }
+        size_t bytes() const { return chunks_.size() * kChunkNodes * sizeof(Slot); }
+
+    private:
+        union Slot {
+            Slot* next;
+            alignas(TrieNode) unsigned char storage[sizeof(TrieNode)];
+        };
+        static constexpr size_t kChunkNodes = 1024;
+
+        std::vector<std::unique_ptr<Slot[]>> chunks_;
+        Slot* free_ = nullptr;
+        size_t next_in_chunk_ = kChunkNodes;
+        size_t live_ = 0;
+    };
+
+    NodePool pool_;
+    TrieNode* root_ = nullptr;
+    
+    // Each distinct component name is stored once, shared by every node
+    // with that name; the count is the number of such nodes
+    std::unordered_map<std::string, size_t> names_;
+    size_t name_bytes_ = 0;
+    size_t child_bytes_ = 0;
+    
+    // Eviction and sweep positions in the node ring
+    TrieNode* clock_hand_ = nullptr;
+    TrieNode* sweep_hand_ = nullptr;
+    size_t max_entries_ = 0;  // 0 = unlimited
+    EvictionStats eviction_stats_;
+    
+    // Nodes visited per exclusive lock hold while sweeping
+    static constexpr size_t kSweepBatch = 4096;
+    
+    std::thread sweeper_;
+    std::mutex sweeper_mutex_;
+    std::condition_variable sweeper_cv_;
+    bool stop_sweeper_ = false;
+    
     int cache_timeout_ = 60;  // Default 60 seconds timeout
+    int negative_timeout_ = 5;  // Default 5 seconds for negative answers, 0 = disabled
+    int stale_timeout_ = 0;     // Seconds past the TTL an entry is still served, 0 = never
+    mutable std::shared_mutex mutex_;
     
     // Check if cache entry is expired
     bool isExpired(const StatInfo& info) const {
         if (cache_timeout_ <= 0) return false;  // No timeout
         return (time(nullptr) - info.cache_time) > cache_timeout_;
     }
+    
+    // Check if something cached at `when` is past the TTL plus the
+    // stale-while-revalidate window, and so no longer served at all
+    bool isPastMaxStaleness(time_t when) const {
+        if (cache_timeout_ <= 0) return false;
+        return (time(nullptr) - when) > cache_timeout_ + stale_timeout_;
+    }
+    
+    // Check if a negative answer recorded at `when` still holds
+    bool isNegativeFresh(time_t when) const {
+        return negative_timeout_ > 0 && when != 0 && (time(nullptr) - when) <= negative_timeout_;
+    }
 
-    // Helper to split path into components
-    std::vector<std::string> splitPath(const std::string& path) const;
+    // Advance over the next non-empty component of rest; false when none is left
+    static bool nextComponent(std::string_view& rest, std::string_view& component);
     
-    // Helper to find or create a node for a path
-    TrieNode* findNode(const std::string& path, bool create_if_missing = false);
+    // Node for a path, or null (caller holds mutex_)
+    const TrieNode* findNode(std::string_view path) const;
+    
+    // Node for a path, creating missing nodes on the way; with
+    // mark_parents, every ancestor is also recorded as a directory
+    // (caller holds mutex_ exclusively)
+    TrieNode* findOrCreateNode(std::string_view path, bool mark_parents);
+    
+    // Allocate a child node named name under parent / unlink and free a
+    // childless node (caller holds mutex_ exclusively)
+    TrieNode* addChild(TrieNode* parent, std::string_view name);
+    void removeChild(TrieNode* node);
+    
+    // Free a node and everything below it, without unlinking it from its parent
+    void destroySubtree(TrieNode* node);
+    
+    // Unlink and free a node and everything below it
+    void removeSubtree(TrieNode* node);
+    
+    // Give a node directory stat info unless it already has metadata
+    static void markDirectory(TrieNode* node, time_t now);
+    
+    void resetRoot();
+    
+    // Add a node to / drop it from the ring, keeping both hands on live nodes
+    void clockInsert(TrieNode* node);
+    void clockUnlink(TrieNode* node);
+    
+    // Unlink nodes that no longer hold anything, from node up towards the root
+    void pruneFrom(TrieNode* node);
+    
+    // Drop a childless entry the parent's cached listing included
+    void evictLeaf(TrieNode* node);
+    
+    // Evict cold leaves until the entry limit holds (caller holds mutex_ exclusively)
+    void enforceLimit();
+    
+    // True if a leaf holds nothing still worth answering from
+    bool isStale(const TrieNode& node) const;
 
 public:
     StatCache();
-    ~StatCache() = default;
+    ~StatCache();
+    
+    StatCache(const StatCache&) = delete;
+    StatCache& operator=(const StatCache&) = delete;
     
     // Set cache timeout in seconds (0 = no timeout)
     void setCacheTimeout(int timeout_seconds) { cache_timeout_ = timeout_seconds; }
+    
+    // Set how long negative answers hold, in seconds (0 = no negative caching)
+    void setNegativeTimeout(int timeout_seconds) { negative_timeout_ = timeout_seconds; }
+    
+    // Keep serving entries and listings for up to this many seconds past the
+    // TTL, marked stale so the caller refreshes them (0 = expire at the TTL)
+    void setStaleWhileRevalidate(int seconds) { stale_timeout_ = seconds; }
+    
+    // Cap the number of cached paths (0 = unlimited); applies from the next insert
+    void setMaxEntries(size_t max_entries);
+    
+    // Prune expired entries every interval_seconds on a background thread
+    // until stopSweeper() or destruction (0 = do nothing)
+    void startSweeper(int interval_seconds);
+    void stopSweeper();
+    
+    // Prune every expired leaf now, releasing the lock between batches;
+    // returns the number of entries removed
+    size_t sweepExpired();
 
-    // Insert a file with its metadata
-    void insertFile(const std::string& path, off_t size, time_t mtime);
+    // Insert a file with its metadata and, if known, the version of the
+    // object it describes
+    void insertFile(const std::string& path, off_t size, time_t mtime,
+                    int64_t generation = 0, int64_t metageneration = 0, uint32_t crc32c = 0);
     
     // Mark a path as a directory
     void insertDirectory(const std::string& path);
     
-    // Get stat info for a path
+    // Record that a path does not exist (e.g. a failed lookup)
+    void insertNegative(const std::string& path);
+    
+    // Record that the cached children of a directory are its complete listing.
+    // Pass includes_subdirectories = false when the listing only had objects;
+    // it then cannot rule out a child being a subdirectory. With
+    // listed_children, nothing is recorded unless at least that many
+    // children are still cached, since eviction may have dropped some
+    // while the listing was being inserted. Children still stale or
+    // expired were not refreshed by the listing, so they are removed.
+    void markDirectoryListed(const std::string& path, bool includes_subdirectories = true,
+                             size_t listed_children = 0);
+    
+    // True if the directory's cached children are a complete listing that
+    // can be served: within the TTL, or within the stale-while-revalidate
+    // window after it
+    bool isListingFresh(const std::string& path) const;
+    
+    // True if that listing should be redone: it is past the TTL, or came
+    // from a snapshot and has not been redone since
+    bool isListingStale(const std::string& path) const;
+    
+    // True if the path is known not to exist: a fresh negative entry, or a
+    // component missing from a freshly listed directory
+    bool isKnownMissing(const std::string& path) const;
+    
+    // Get stat info for a path. Within the stale-while-revalidate window
+    // after the TTL the entry is returned with stale set.
     std::optional<StatInfo> getStat(const std::string& path) const;
     
     // Check if a path exists in the cache
@@ -79,6 +331,25 @@ public:
     // Clear all cached data
     void clear();
     
-    // Get all immediate children of a directory
+    // Get all immediate children of a directory, sorted by name
     std::vector<std::string> listDirectory(const std::string& path) const;
+    
+    // Get all immediate children of a directory with their stat info, sorted
+    // by name (metadata_loaded is false for children known only by name)
+    std::vector<std::pair<std::string, StatInfo>> listDirectoryWithStats(const std::string& path) const;
+    
+    // Write every cached path to file_path (via a temporary file and rename),
+    // tagged with key so a snapshot is never loaded for another bucket
+    bool saveSnapshot(const std::string& file_path, const std::string& key) const;
+    
+    // Merge a snapshot written by saveSnapshot with the same key; entries
+    // already cached win. Returns the number of paths loaded, 0 if the file
+    // is missing, for another key, or corrupt.
+    size_t loadSnapshot(const std::string& file_path, const std::string& key);
+    
+    // Cached paths (trie nodes other than the root)
+    size_t size() const;
+    
+    MemoryStats memoryStats() const;
+    EvictionStats evictionStats() const;
 };
@@ -0,0 +1,121 @@
+#include "stat_cache.hpp"
+#include <benchmark/benchmark.h>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace {
+
+// Paths in a three-level tree with 100 files per leaf directory, the shape
+// of a bucket of partitioned datasets
+const std::vector<std::string>& benchPaths(size_t count)
+{
+    static std::mutex mutex;
+    static std::map<size_t, std::vector<std::string>> paths_by_count;
+    std::lock_guard<std::mutex> lock(mutex);
+    auto& paths = paths_by_count[count];
+    if (paths.empty()) {
+        paths.reserve(count);
+        for (size_t i = 0; i < count; ++i) {
+            paths.push_back("/dataset" + std::to_string(i / 100000) + "/part" + std::to_string(i / 100 % 1000) +
+                            "/file" + std::to_string(i) + ".parquet");
+        }
+    }
+    return paths;
+}
+
+void fill(StatCache& cache, const std::vector<std::string>& paths)
+{
+    for (const auto& path : paths) {
+        cache.insertFile(path, 4096, 0);
+    }
+}
+
+// Step through indexes in an order unrelated to insertion
+size_t nextIndex(std::uint64_t& state, size_t count)
+{
+    state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return static_cast<size_t>(state >> 33) % count;
+}
+
+void BM_StatCacheInsert(benchmark::State& state)
+{
+    const auto& paths = benchPaths(static_cast<size_t>(state.range(0)));
+    std::optional<StatCache> cache;
+    for (auto _ : state) {
+        state.PauseTiming();
+        cache.reset();
+        cache.emplace();
+        state.ResumeTiming();
+        fill(*cache, paths);
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * paths.size()));
+    state.counters["bytes_per_path"] = static_cast<double>(cache->memoryStats().bytes()) /
+                                       static_cast<double>(paths.size());
+}
+BENCHMARK(BM_StatCacheInsert)->Arg(100000)->Arg(1000000)->Arg(2000000)->Unit(benchmark::kMillisecond);
+
+StatCache* lookup_cache = nullptr;
+
+void BM_StatCacheLookup(benchmark::State& state)
+{
+    const auto& paths = benchPaths(static_cast<size_t>(state.range(0)));
+    // Threads wait at the start of the loop until thread 0 has filled the cache
+    if (state.thread_index() == 0) {
+        lookup_cache = new StatCache();
+        fill(*lookup_cache, paths);
+    }
+    std::uint64_t rng = static_cast<std::uint64_t>(state.thread_index()) + 1;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(lookup_cache->getStat(paths[nextIndex(rng, paths.size())]));
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        delete lookup_cache;
+        lookup_cache = nullptr;
+    }
+}
+BENCHMARK(BM_StatCacheLookup)->Arg(100000)->Arg(1000000)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_StatCacheLookupMissing(benchmark::State& state)
+{
+    StatCache cache;
+    fill(cache, benchPaths(100000));
+    const std::string missing = "/dataset0/part7/absent.parquet";
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.getStat(missing));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StatCacheLookupMissing);
+
+void BM_StatCacheListDirectory(benchmark::State& state)
+{
+    StatCache cache;
+    fill(cache, benchPaths(100000));
+    cache.markDirectoryListed("/dataset0/part7");
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(cache.listDirectoryWithStats("/dataset0/part7"));
+    }
+    state.SetItemsProcessed(state.iterations() * 100);
+}
+BENCHMARK(BM_StatCacheListDirectory);
+
+void BM_StatCacheEviction(benchmark::State& state)
+{
+    // Inserts into a full cache, each one evicting an older path
+    const auto& paths = benchPaths(1000000);
+    StatCache cache;
+    cache.setMaxEntries(static_cast<size_t>(state.range(0)));
+    size_t next = 0;
+    for (auto _ : state) {
+        cache.insertFile(paths[next], 4096, 0);
+        next = (next + 1) % paths.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_StatCacheEviction)->Arg(100000);
+
+}
@@ -1,6 +1,11 @@
 #include <gtest/gtest.h>
 #include <thread>
 #include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unistd.h>
 #include "stat_cache.hpp"
 
 // Test fixture for StatCache tests
@@ -33,6 +38,20 @@ TEST_F(StatCacheTest, InsertAndRetrieveFile) {
     EXPECT_TRUE(result->metadata_loaded);
 }
 
+TEST_F(StatCacheTest, InsertFileKeepsObjectVersion) {
+    cache->insertFile("/v.txt", 10, 1, 1700000000123456, 2, 0xdeadbeef);
+    
+    auto result = cache->getStat("/v.txt");
+    ASSERT_TRUE(result.has_value());
+    EXPECT_EQ(result->generation, 1700000000123456);
+    EXPECT_EQ(result->metageneration, 2);
+    EXPECT_EQ(result->crc32c, 0xdeadbeefu);
+    
+    // Written locally: the new generation is not known yet
+    cache->insertFile("/v.txt", 11, 2);
+    EXPECT_EQ(cache->getStat("/v.txt")->generation, 0);
+}
+
 TEST_F(StatCacheTest, InsertAndRetrieveDirectory) {
     cache->insertDirectory("/mydir");
     
@@ -203,6 +222,175 @@ TEST_F(StatCacheTest, DirectoryCacheTimeIsSet) {
     EXPECT_LE(result->cache_time, after);
 }
 
+// ============================================================================
+// Directory Listing Tests
+// ============================================================================
+
+TEST_F(StatCacheTest, ListingNotFreshUntilMarked) {
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    
+    EXPECT_FALSE(cache->isListingFresh("/dir"));
+    cache->markDirectoryListed("/dir");
+    EXPECT_TRUE(cache->isListingFresh("/dir"));
+    EXPECT_FALSE(cache->isListingFresh("/missing"));
+}
+
+TEST_F(StatCacheTest, MarkListedCreatesEmptyDirectory) {
+    cache->markDirectoryListed("/empty");
+    
+    EXPECT_TRUE(cache->isDirectory("/empty"));
+    EXPECT_TRUE(cache->isListingFresh("/empty"));
+    EXPECT_TRUE(cache->listDirectory("/empty").empty());
+}
+
+TEST_F(StatCacheTest, ListedRootIsFresh) {
+    cache->insertFile("/a.txt", 10, time(nullptr));
+    cache->markDirectoryListed("/");
+    
+    EXPECT_TRUE(cache->isListingFresh("/"));
+    auto entries = cache->listDirectory("/");
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0], "a.txt");
+}
+
+TEST_F(StatCacheTest, ListingKeepsLocalChanges) {
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    cache->markDirectoryListed("/dir");
+    
+    cache->insertFile("/dir/b.txt", 10, time(nullptr));
+    cache->remove("/dir/a.txt");
+    
+    EXPECT_TRUE(cache->isListingFresh("/dir"));
+    auto entries = cache->listDirectory("/dir");
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0], "b.txt");
+}
+
+TEST_F(StatCacheTest, ListDirectoryWithStats) {
+    cache->insertFile("/dir/a.txt", 42, 1000);
+    cache->insertDirectory("/dir/sub");
+    cache->insertNegative("/dir/missing");
+    
+    auto entries = cache->listDirectoryWithStats("/dir");
+    ASSERT_EQ(entries.size(), 2u);
+    EXPECT_EQ(entries[0].first, "a.txt");
+    EXPECT_EQ(entries[0].second.size, 42);
+    EXPECT_EQ(entries[0].second.mtime, 1000);
+    EXPECT_FALSE(entries[0].second.is_directory);
+    EXPECT_EQ(entries[1].first, "sub");
+    EXPECT_TRUE(entries[1].second.is_directory);
+    EXPECT_TRUE(entries[1].second.metadata_loaded);
+}
+
+TEST_F(StatCacheTest, ListingExpiresWithStatTTL) {
+    cache->setCacheTimeout(1);
+    cache->markDirectoryListed("/dir");
+    
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    EXPECT_FALSE(cache->isListingFresh("/dir"));
+}
+
+TEST_F(StatCacheTest, ClearDropsListing) {
+    cache->markDirectoryListed("/dir");
+    cache->clear();
+    EXPECT_FALSE(cache->isListingFresh("/dir"));
+}
+
+// ============================================================================
+// Negative Entry Tests
+// ============================================================================
+
+TEST_F(StatCacheTest, NegativeEntryMarksPathMissing) {
+    cache->insertNegative("/__pycache__");
+    
+    EXPECT_TRUE(cache->isKnownMissing("/__pycache__"));
+    EXPECT_TRUE(cache->isKnownMissing("/__pycache__/mod.pyc"));
+    EXPECT_FALSE(cache->getStat("/__pycache__").has_value());
+    EXPECT_FALSE(cache->isKnownMissing("/other"));
+}
+
+TEST_F(StatCacheTest, InsertClearsNegativeEntry) {
+    cache->insertNegative("/new.txt");
+    cache->insertFile("/new.txt", 10, time(nullptr));
+    EXPECT_FALSE(cache->isKnownMissing("/new.txt"));
+    
+    cache->insertNegative("/dir");
+    cache->insertFile("/dir/file.txt", 10, time(nullptr));
+    EXPECT_FALSE(cache->isKnownMissing("/dir"));
+    EXPECT_TRUE(cache->isDirectory("/dir"));
+}
+
+TEST_F(StatCacheTest, NegativeEntriesNotListed) {
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    cache->insertNegative("/dir/.git");
+    
+    auto entries = cache->listDirectory("/dir");
+    ASSERT_EQ(entries.size(), 1u);
+    EXPECT_EQ(entries[0], "a.txt");
+}
+
+TEST_F(StatCacheTest, ListedDirectoryAnswersMissingChildren) {
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    cache->insertDirectory("/dir/sub");
+    
+    EXPECT_FALSE(cache->isKnownMissing("/dir/b.txt"));
+    cache->markDirectoryListed("/dir");
+    
+    EXPECT_TRUE(cache->isKnownMissing("/dir/b.txt"));
+    EXPECT_TRUE(cache->isKnownMissing("/dir/b/c.txt"));
+    EXPECT_FALSE(cache->isKnownMissing("/dir/a.txt"));
+    // Children of an unlisted subdirectory are unknown
+    EXPECT_FALSE(cache->isKnownMissing("/dir/sub/x"));
+}
+
+TEST_F(StatCacheTest, ListedRootAnswersMissingChildren) {
+    cache->insertFile("/a.txt", 10, time(nullptr));
+    cache->markDirectoryListed("/");
+    
+    EXPECT_TRUE(cache->isKnownMissing("/missing"));
+    EXPECT_FALSE(cache->isKnownMissing("/a.txt"));
+}
+
+TEST_F(StatCacheTest, RemovedPathInListedDirectoryIsMissing) {
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    cache->markDirectoryListed("/dir");
+    
+    cache->remove("/dir/a.txt");
+    EXPECT_TRUE(cache->isKnownMissing("/dir/a.txt"));
+}
+
+TEST_F(StatCacheTest, ObjectOnlyListingDoesNotRuleOutSubdirectories) {
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    cache->markDirectoryListed("/dir", false);
+    
+    EXPECT_TRUE(cache->isListingFresh("/dir"));
+    EXPECT_FALSE(cache->isKnownMissing("/dir/maybe-a-subdir"));
+}
+
+TEST_F(StatCacheTest, NegativeTimeoutZeroDisables) {
+    cache->setNegativeTimeout(0);
+    cache->insertNegative("/missing");
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    cache->markDirectoryListed("/dir");
+    
+    EXPECT_FALSE(cache->isKnownMissing("/missing"));
+    EXPECT_FALSE(cache->isKnownMissing("/dir/b.txt"));
+}
+
+TEST_F(StatCacheTest, NegativeEntriesExpireOnTheirOwnTTL) {
+    cache->setCacheTimeout(60);
+    cache->setNegativeTimeout(1);
+    cache->insertFile("/dir/a.txt", 10, time(nullptr));
+    cache->markDirectoryListed("/dir");
+    cache->insertNegative("/missing");
+    
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    
+    EXPECT_FALSE(cache->isKnownMissing("/missing"));
+    EXPECT_FALSE(cache->isKnownMissing("/dir/b.txt"));
+    EXPECT_TRUE(cache->getStat("/dir/a.txt").has_value());
+}
+
 // ============================================================================
 // Edge Cases and Error Handling
 // ============================================================================
@@ -289,6 +477,347 @@ TEST_F(StatCacheTest, HandlesDeeplyNestedPaths) {
     EXPECT_FALSE(result->is_directory);
 }
 
+TEST_F(StatCacheTest, ConcurrentInsertAndLookup) {
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([this, t]() {
+            for (int i = 0; i < 250; i++) {
+                std::string path = "/dir" + std::to_string(t) + "/file" + std::to_string(i) + ".txt";
+                cache->insertFile(path, i, time(nullptr));
+                cache->getStat(path);
+                cache->listDirectory("/dir" + std::to_string(t));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    
+    for (int t = 0; t < 4; t++) {
+        for (int i = 0; i < 250; i++) {
+            std::string path = "/dir" + std::to_string(t) + "/file" + std::to_string(i) + ".txt";
+            EXPECT_TRUE(cache->exists(path));
+        }
+    }
+}
+
+// ============================================================================
+// Memory Layout Tests
+// ============================================================================
+
+TEST_F(StatCacheTest, ManyChildrenSurviveGrowthAndRemoval) {
+    for (int i = 0; i < 500; i++) {
+        cache->insertFile("/dir/f" + std::to_string(i), i, 0);
+    }
+    // Remove every other child; the rest must stay reachable
+    for (int i = 0; i < 500; i += 2) {
+        cache->remove("/dir/f" + std::to_string(i));
+    }
+    for (int i = 0; i < 500; i++) {
+        EXPECT_EQ(cache->exists("/dir/f" + std::to_string(i)), i % 2 == 1) << i;
+    }
+    EXPECT_EQ(cache->listDirectory("/dir").size(), 250u);
+}
+
+TEST_F(StatCacheTest, RepeatedNamesAreInternedOnce) {
+    for (int i = 0; i < 100; i++) {
+        cache->insertFile("/d" + std::to_string(i) + "/__init__.py", 0, 0);
+    }
+    auto stats = cache->memoryStats();
+    EXPECT_EQ(stats.nodes, 201u);  // root, 100 directories, 100 files
+    EXPECT_EQ(stats.names, 101u);  // d0..d99 plus one shared __init__.py
+    EXPECT_GT(stats.bytes(), 0u);
+}
+
+TEST_F(StatCacheTest, RemoveAndClearReleaseMemory) {
+    auto empty = cache->memoryStats();
+    cache->insertFile("/a/b/c.txt", 1, 0);
+    EXPECT_EQ(cache->memoryStats().nodes, 4u);
+    
+    cache->remove("/a/b/c.txt");
+    cache->remove("/a/b");
+    cache->remove("/a");
+    auto removed = cache->memoryStats();
+    EXPECT_EQ(removed.nodes, 1u);
+    EXPECT_EQ(removed.names, 0u);
+    EXPECT_EQ(removed.child_bytes, empty.child_bytes);
+    
+    cache->insertFile("/x/y", 1, 0);
+    cache->clear();
+    EXPECT_EQ(cache->memoryStats().nodes, 1u);
+    EXPECT_EQ(cache->memoryStats().names, 0u);
+}
+
+// ============================================================================
+// Bounded Size and Sweeping Tests
+// ============================================================================
+
+TEST_F(StatCacheTest, EntryLimitEvictsColdLeaves) {
+    cache->setMaxEntries(10);
+    for (int i = 0; i < 100; i++) {
+        cache->insertFile("/f" + std::to_string(i), i, 0);
+    }
+    EXPECT_LE(cache->size(), 10u);
+    EXPECT_EQ(cache->evictionStats().evicted, 90u);
+    // The newest entries are the last ones the clock reaches
+    EXPECT_TRUE(cache->exists("/f99"));
+    EXPECT_FALSE(cache->exists("/f0"));
+}
+
+TEST_F(StatCacheTest, LookedUpEntriesSurviveEviction) {
+    cache->setMaxEntries(4);
+    for (int i = 0; i < 4; i++) {
+        cache->insertFile("/f" + std::to_string(i), i, 0);
+    }
+    ASSERT_TRUE(cache->getStat("/f0").has_value());
+    
+    cache->insertFile("/f4", 4, 0);
+    EXPECT_TRUE(cache->exists("/f0"));
+    EXPECT_FALSE(cache->exists("/f1"));
+    EXPECT_EQ(cache->size(), 4u);
+}
+
+TEST_F(StatCacheTest, EvictionKeepsParentsOfCachedLeaves) {
+    cache->setMaxEntries(3);
+    cache->insertFile("/a/b/c.txt", 1, 0);
+    cache->insertFile("/a/b/d.txt", 1, 0);
+    
+    // Only leaves go; the directories stay while a child is cached
+    EXPECT_EQ(cache->size(), 3u);
+    EXPECT_TRUE(cache->isDirectory("/a/b"));
+    EXPECT_TRUE(cache->exists("/a/b/d.txt"));
+}
+
+TEST_F(StatCacheTest, EvictionInvalidatesParentListing) {
+    cache->insertFile("/dir/a.txt", 1, 0);
+    cache->insertFile("/dir/b.txt", 1, 0);
+    cache->markDirectoryListed("/dir");
+    ASSERT_TRUE(cache->isKnownMissing("/dir/c.txt"));
+    
+    cache->setMaxEntries(2);
+    cache->insertFile("/other", 1, 0);
+    
+    // A child was dropped, so the listing can no longer vouch for absence
+    EXPECT_FALSE(cache->isListingFresh("/dir"));
+    EXPECT_FALSE(cache->isKnownMissing("/dir/a.txt"));
+}
+
+TEST_F(StatCacheTest, ListingIsNotMarkedWhenChildrenWereEvicted) {
+    cache->insertFile("/dir/a.txt", 1, 0);
+    cache->markDirectoryListed("/dir", true, 2);
+    EXPECT_FALSE(cache->isListingFresh("/dir"));
+    
+    cache->insertFile("/dir/b.txt", 1, 0);
+    cache->markDirectoryListed("/dir", true, 2);
+    EXPECT_TRUE(cache->isListingFresh("/dir"));
+}
+
+TEST_F(StatCacheTest, SweepPrunesExpiredEntries) {
+    cache->setCacheTimeout(1);
+    cache->setNegativeTimeout(1);
+    cache->insertFile("/old/a.txt", 1, 0);
+    cache->insertNegative("/missing");
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    cache->insertFile("/new.txt", 1, 0);
+    
+    // a.txt and the negative entry, then /old once it is an expired leaf
+    EXPECT_EQ(cache->sweepExpired(), 2u);
+    EXPECT_EQ(cache->sweepExpired(), 1u);
+    EXPECT_EQ(cache->size(), 1u);
+    EXPECT_TRUE(cache->exists("/new.txt"));
+    EXPECT_EQ(cache->evictionStats().expired, 3u);
+}
+
+TEST_F(StatCacheTest, SweeperThreadPrunesInBackground) {
+    cache->setCacheTimeout(1);
+    cache->insertFile("/a.txt", 1, 0);
+    cache->startSweeper(1);
+    
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (cache->size() > 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    cache->stopSweeper();
+    EXPECT_EQ(cache->size(), 0u);
+}
+
+// ============================================================================
+// Stale-While-Revalidate Tests
+// ============================================================================
+
+TEST_F(StatCacheTest, ExpiredEntryIsServedStaleWithinWindow) {
+    cache->setCacheTimeout(1);
+    cache->setStaleWhileRevalidate(60);
+    cache->insertFile("/a.txt", 5, 0);
+    EXPECT_FALSE(cache->getStat("/a.txt")->stale);
+    
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    auto stale = cache->getStat("/a.txt");
+    ASSERT_TRUE(stale.has_value());
+    EXPECT_TRUE(stale->stale);
+    EXPECT_EQ(stale->size, 5);
+    
+    // A refresh makes it fresh again; the sweeper leaves it alone meanwhile
+    EXPECT_EQ(cache->sweepExpired(), 0u);
+    cache->insertFile("/a.txt", 6, 0);
+    EXPECT_FALSE(cache->getStat("/a.txt")->stale);
+}
+
+TEST_F(StatCacheTest, MaxStalenessIsAHardBound) {
+    cache->setCacheTimeout(1);
+    cache->setStaleWhileRevalidate(1);
+    cache->insertFile("/a.txt", 5, 0);
+    cache->insertDirectory("/dir");
+    cache->markDirectoryListed("/dir");
+    
+    std::this_thread::sleep_for(std::chrono::seconds(3));
+    EXPECT_FALSE(cache->getStat("/a.txt").has_value());
+    EXPECT_FALSE(cache->isListingFresh("/dir"));
+}
+
+TEST_F(StatCacheTest, ExpiredListingIsServedStaleWithinWindow) {
+    cache->setCacheTimeout(1);
+    cache->setStaleWhileRevalidate(60);
+    cache->insertFile("/dir/old.txt", 1, 0);
+    cache->insertFile("/dir/kept.txt", 1, 0);
+    cache->markDirectoryListed("/dir");
+    EXPECT_FALSE(cache->isListingStale("/dir"));
+    
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    EXPECT_TRUE(cache->isListingFresh("/dir"));
+    EXPECT_TRUE(cache->isListingStale("/dir"));
+    
+    // Relisting refreshes what is still there and drops what is not
+    cache->insertFile("/dir/kept.txt", 1, 0);
+    cache->markDirectoryListed("/dir");
+    EXPECT_FALSE(cache->isListingStale("/dir"));
+    EXPECT_EQ(cache->listDirectory("/dir"), (std::vector<std::string>{"kept.txt"}));
+}
+
+TEST_F(StatCacheTest, DirectorySeenAgainIsRefreshed) {
+    cache->setCacheTimeout(1);
+    cache->insertDirectory("/dir");
+    std::this_thread::sleep_for(std::chrono::seconds(2));
+    EXPECT_FALSE(cache->getStat("/dir").has_value());
+    
+    cache->insertDirectory("/dir");
+    ASSERT_TRUE(cache->getStat("/dir").has_value());
+    EXPECT_TRUE(cache->getStat("/dir")->is_directory);
+}
+
+// ============================================================================
+// Snapshot Tests
+// ============================================================================
+
+class StatCacheSnapshotTest : public StatCacheTest {
+protected:
+    void SetUp() override {
+        StatCacheTest::SetUp();
+        path = "/tmp/gcscfuse-stat-snapshot-" + std::to_string(::getpid());
+    }
+
+    void TearDown() override {
+        std::remove(path.c_str());
+        StatCacheTest::TearDown();
+    }
+
+    std::string path;
+};
+
+TEST_F(StatCacheSnapshotTest, RoundTripLoadsStaleEntries) {
+    cache->insertFile("/dir/a.txt", 42, 1000);
+    cache->insertFile("/dir/sub/b.txt", 7, 2000);
+    cache->markDirectoryListed("/dir");
+    cache->insertNegative("/missing");
+    ASSERT_TRUE(cache->saveSnapshot(path, "bucket"));
+    
+    StatCache loaded;
+    EXPECT_EQ(loaded.loadSnapshot(path, "bucket"), 4u);
+    
+    auto a = loaded.getStat("/dir/a.txt");
+    ASSERT_TRUE(a.has_value());
+    EXPECT_EQ(a->size, 42);
+    EXPECT_EQ(a->mtime, 1000);
+    EXPECT_TRUE(a->stale);
+    EXPECT_TRUE(loaded.isDirectory("/dir/sub"));
+    EXPECT_FALSE(loaded.exists("/missing"));
+    
+    // The listing serves readdir, but cannot vouch for absence
+    EXPECT_TRUE(loaded.isListingFresh("/dir"));
+    EXPECT_TRUE(loaded.isListingStale("/dir"));
+    EXPECT_FALSE(loaded.isKnownMissing("/dir/new.txt"));
+    EXPECT_EQ(loaded.listDirectory("/dir"), (std::vector<std::string>{"a.txt", "sub"}));
+}
+
+TEST_F(StatCacheSnapshotTest, RoundTripKeepsObjectVersion) {
+    cache->insertFile("/dir/a.txt", 42, 1000, 123456789, 4, 0x01020304);
+    ASSERT_TRUE(cache->saveSnapshot(path, "bucket"));
+    
+    StatCache loaded;
+    ASSERT_EQ(loaded.loadSnapshot(path, "bucket"), 2u);
+    auto a = loaded.getStat("/dir/a.txt");
+    ASSERT_TRUE(a.has_value());
+    EXPECT_EQ(a->generation, 123456789);
+    EXPECT_EQ(a->metageneration, 4);
+    EXPECT_EQ(a->crc32c, 0x01020304u);
+}
+
+TEST_F(StatCacheSnapshotTest, RefreshClearsStaleness) {
+    cache->insertFile("/dir/a.txt", 1, 0);
+    cache->markDirectoryListed("/dir");
+    ASSERT_TRUE(cache->saveSnapshot(path, "bucket"));
+    
+    StatCache loaded;
+    ASSERT_EQ(loaded.loadSnapshot(path, "bucket"), 2u);
+    loaded.insertFile("/dir/a.txt", 2, 0);
+    loaded.insertDirectory("/dir");
+    loaded.markDirectoryListed("/dir");
+    
+    EXPECT_FALSE(loaded.getStat("/dir/a.txt")->stale);
+    EXPECT_FALSE(loaded.getStat("/dir")->stale);
+    EXPECT_FALSE(loaded.isListingStale("/dir"));
+}
+
+TEST_F(StatCacheSnapshotTest, RelistingDropsEntriesGoneSinceSnapshot) {
+    cache->insertFile("/dir/kept.txt", 1, 0);
+    cache->insertFile("/dir/gone/deep.txt", 1, 0);
+    cache->markDirectoryListed("/dir");
+    ASSERT_TRUE(cache->saveSnapshot(path, "bucket"));
+    
+    StatCache loaded;
+    ASSERT_EQ(loaded.loadSnapshot(path, "bucket"), 4u);
+    loaded.insertFile("/dir/kept.txt", 1, 0);
+    loaded.markDirectoryListed("/dir");
+    
+    EXPECT_EQ(loaded.listDirectory("/dir"), (std::vector<std::string>{"kept.txt"}));
+    EXPECT_FALSE(loaded.exists("/dir/gone/deep.txt"));
+    EXPECT_EQ(loaded.size(), 2u);
+}
+
+TEST_F(StatCacheSnapshotTest, CachedEntriesWinOverSnapshot) {
+    cache->insertFile("/a.txt", 1, 0);
+    ASSERT_TRUE(cache->saveSnapshot(path, "bucket"));
+    
+    StatCache loaded;
+    loaded.insertFile("/a.txt", 99, 0);
+    loaded.loadSnapshot(path, "bucket");
+    EXPECT_EQ(loaded.getStat("/a.txt")->size, 99);
+    EXPECT_FALSE(loaded.getStat("/a.txt")->stale);
+}
+
+TEST_F(StatCacheSnapshotTest, OtherKeyOrCorruptFileIsIgnored) {
+    cache->insertFile("/a.txt", 1, 0);
+    ASSERT_TRUE(cache->saveSnapshot(path, "bucket"));
+    
+    StatCache other;
+    EXPECT_EQ(other.loadSnapshot(path, "other-bucket"), 0u);
+    EXPECT_FALSE(other.exists("/a.txt"));
+    
+    std::ofstream(path, std::ios::binary | std::ios::trunc) << "not a snapshot";
+    EXPECT_EQ(other.loadSnapshot(path, "bucket"), 0u);
+    EXPECT_EQ(other.loadSnapshot(path + ".absent", "bucket"), 0u);
+}
+
 // ============================================================================
 // Main
 // ============================================================================
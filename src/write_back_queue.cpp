@@ -0,0 +1,150 @@
+#include "write_back_queue.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <exception>
+#include <iostream>
+
+namespace gcscfuse {
+
+WriteBackQueue::WriteBackQueue(UploadFunction upload, size_t max_bytes, size_t workers)
+    : upload_(std::move(upload)),
+      max_bytes_(std::max<size_t>(max_bytes, 1))
+{
+    workers = std::max<size_t>(workers, 1);
+    workers_.reserve(workers);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back(&WriteBackQueue::workerLoop, this);
+    }
+}
+
+WriteBackQueue::~WriteBackQueue() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    work_cv_.notify_all();
+    for (auto& worker : workers_) {
+        worker.join();
+    }
+}
+
+void WriteBackQueue::enqueue(const std::string& key, size_t bytes) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto it = pending_.find(key);
+    if (it != pending_.end() && it->second.queued) {
+        // Still waiting: the upload will read the latest content anyway
+        pending_bytes_ = pending_bytes_ - it->second.queued_bytes + bytes;
+        it->second.queued_bytes = bytes;
+        stats_.coalesced++;
+        return;
+    }
+
+    if (pending_bytes_ > 0 && pending_bytes_ + bytes > max_bytes_) {
+        stats_.throttled++;
+        done_cv_.wait(lock, [&] { return pending_bytes_ == 0 || pending_bytes_ + bytes <= max_bytes_; });
+        it = pending_.find(key);
+        if (it != pending_.end() && it->second.queued) {
+            pending_bytes_ = pending_bytes_ - it->second.queued_bytes + bytes;
+            it->second.queued_bytes = bytes;
+            stats_.coalesced++;
+            return;
+        }
+    }
+
+    Pending& pending = pending_[key];
+    pending.queued = true;
+    pending.queued_bytes = bytes;
+    pending_bytes_ += bytes;
+    stats_.enqueued++;
+    // A key being uploaded is queued again by its worker when it finishes
+    if (!pending.uploading) {
+        queue_.push_back(key);
+        lock.unlock();
+        work_cv_.notify_one();
+    }
+}
+
+int WriteBackQueue::wait(const std::string& key) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [&] { return pending_.find(key) == pending_.end(); });
+    auto it = errors_.find(key);
+    if (it == errors_.end()) {
+        return 0;
+    }
+    int error = it->second;
+    errors_.erase(it);
+    return error;
+}
+
+int WriteBackQueue::takeError(const std::string& key) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = errors_.find(key);
+    if (it == errors_.end()) {
+        return 0;
+    }
+    int error = it->second;
+    errors_.erase(it);
+    return error;
+}
+
+void WriteBackQueue::drain() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_cv_.wait(lock, [this] { return pending_.empty(); });
+}
+
+WriteBackQueue::Stats WriteBackQueue::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.pending_bytes = pending_bytes_;
+    stats.pending_files = pending_.size();
+    return stats;
+}
+
+void WriteBackQueue::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        // Stopping still uploads what is queued; dropping it would lose data
+        work_cv_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+        if (queue_.empty()) {
+            return;
+        }
+
+        std::string key = std::move(queue_.front());
+        queue_.pop_front();
+        Pending& pending = pending_[key];
+        pending.queued = false;
+        pending.uploading = true;
+        pending.uploading_bytes = pending.queued_bytes;
+        pending.queued_bytes = 0;
+        lock.unlock();
+
+        int result;
+        try {
+            result = upload_(key);
+        } catch (const std::exception& e) {
+            std::cerr << "Error writing back " << key << ": " << e.what() << std::endl;
+            result = -EIO;
+        }
+
+        lock.lock();
+        auto it = pending_.find(key);
+        pending_bytes_ -= it->second.uploading_bytes;
+        it->second.uploading = false;
+        it->second.uploading_bytes = 0;
+        if (result != 0) {
+            errors_[key] = result;
+            stats_.failed++;
+        } else {
+            stats_.uploaded++;
+        }
+        if (it->second.queued) {
+            queue_.push_back(key);
+            work_cv_.notify_one();
+        } else {
+            pending_.erase(it);
+        }
+        done_cv_.notify_all();
+    }
+}
+
+} // namespace gcscfuse
@@ -0,0 +1,100 @@
+#pragma once
+
+#include <string>
+#include <deque>
+#include <map>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+namespace gcscfuse {
+
+/**
+ * WriteBackQueue - Uploads closed files in the background
+ *
+ * Files handed to enqueue() are uploaded by a pool of worker threads, so
+ * close() returns without waiting for GCS. The upload function reads the
+ * file's content when it runs, so a file enqueued several times (one close
+ * per dup) while waiting is uploaded once. A file enqueued while its upload
+ * is running is uploaded again after it, never by two workers at once, so
+ * the last content always lands last.
+ *
+ * Back-pressure: enqueue() blocks while the queued and uploading bytes
+ * exceed max_bytes, unless nothing else is pending (a file larger than the
+ * budget still goes through, one at a time).
+ *
+ * A failed upload is remembered for its key until wait() or takeError()
+ * reports it, which is how an error surfaces on the next fsync or close.
+ *
+ * Thread-safe.
+ */
+class WriteBackQueue {
+public:
+    // Uploads one key; returns 0 or -errno
+    using UploadFunction = std::function<int(const std::string& key)>;
+
+    struct Stats {
+        std::uint64_t enqueued = 0;
+        std::uint64_t coalesced = 0;  // enqueued while already waiting
+        std::uint64_t uploaded = 0;
+        std::uint64_t failed = 0;
+        std::uint64_t throttled = 0;  // enqueues that waited for the byte budget
+        std::uint64_t pending_bytes = 0;
+        std::uint64_t pending_files = 0;
+    };
+
+    // Starts workers threads that call upload for each queued key
+    WriteBackQueue(UploadFunction upload, size_t max_bytes, size_t workers);
+
+    // Uploads everything still queued, then stops the workers
+    ~WriteBackQueue();
+
+    WriteBackQueue(const WriteBackQueue&) = delete;
+    WriteBackQueue& operator=(const WriteBackQueue&) = delete;
+
+    // Queue key for upload, accounting bytes against the budget
+    void enqueue(const std::string& key, size_t bytes);
+
+    // Block until key is neither queued nor uploading; returns and clears
+    // the error of its last upload (0 if it succeeded or never ran)
+    int wait(const std::string& key);
+
+    // Return and clear the recorded error of key without waiting
+    int takeError(const std::string& key);
+
+    // Block until nothing is queued or uploading
+    void drain();
+
+    Stats stats() const;
+
+private:
+    struct Pending {
+        bool queued = false;
+        bool uploading = false;
+        size_t queued_bytes = 0;
+        size_t uploading_bytes = 0;
+    };
+
+    UploadFunction upload_;
+    size_t max_bytes_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable work_cv_;
+    std::condition_variable done_cv_;     // an upload finished: waiters and back-pressure
+    std::deque<std::string> queue_;       // keys waiting for a worker, oldest first
+    std::map<std::string, Pending> pending_;
+    std::map<std::string, int> errors_;   // key -> -errno of its last failed upload
+    size_t pending_bytes_ = 0;
+    bool stopping_ = false;
+    Stats stats_;
+
+    std::vector<std::thread> workers_;
+
+    void workerLoop();
+};
+
+} // namespace gcscfuse
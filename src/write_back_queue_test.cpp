@@ -0,0 +1,184 @@
+#include <gtest/gtest.h>
+#include "write_back_queue.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace gcscfuse;
+
+// Records uploads; can hold workers until released and fail chosen keys
+class UploadRecorder {
+public:
+    int operator()(const std::string& key) {
+        std::unique_lock<std::mutex> lock(mutex);
+        uploaded.push_back(key);
+        in_flight[key]++;
+        max_in_flight_per_key = std::max(max_in_flight_per_key, in_flight[key]);
+        cv.notify_all();
+        cv.wait(lock, [this] { return !blocked; });
+        in_flight[key]--;
+        return key == failing ? -EIO : 0;
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(mutex);
+        blocked = false;
+        cv.notify_all();
+    }
+
+    void waitForUploads(size_t count) {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait_for(lock, std::chrono::seconds(5), [&] { return uploaded.size() >= count; });
+    }
+
+    size_t count(const std::string& key) {
+        std::lock_guard<std::mutex> lock(mutex);
+        return static_cast<size_t>(std::count(uploaded.begin(), uploaded.end(), key));
+    }
+
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::string> uploaded;
+    std::map<std::string, int> in_flight;
+    int max_in_flight_per_key = 0;
+    bool blocked = false;
+    std::string failing;
+};
+
+TEST(WriteBackQueueTest, UploadsEnqueuedKeys) {
+    UploadRecorder recorder;
+    WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 1 << 20, 2);
+
+    queue.enqueue("a", 10);
+    queue.enqueue("b", 20);
+    queue.drain();
+
+    EXPECT_EQ(recorder.count("a"), 1u);
+    EXPECT_EQ(recorder.count("b"), 1u);
+    auto stats = queue.stats();
+    EXPECT_EQ(stats.uploaded, 2u);
+    EXPECT_EQ(stats.pending_bytes, 0u);
+    EXPECT_EQ(stats.pending_files, 0u);
+}
+
+TEST(WriteBackQueueTest, CoalescesKeyEnqueuedWhileWaiting) {
+    UploadRecorder recorder;
+    recorder.blocked = true;
+    WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 1 << 20, 1);
+
+    queue.enqueue("busy", 1);
+    recorder.waitForUploads(1);
+    queue.enqueue("file", 100);
+    queue.enqueue("file", 100);
+    queue.enqueue("file", 150);
+    EXPECT_EQ(queue.stats().pending_bytes, 151u);
+
+    recorder.release();
+    queue.drain();
+    EXPECT_EQ(recorder.count("file"), 1u);
+    EXPECT_EQ(queue.stats().coalesced, 2u);
+}
+
+TEST(WriteBackQueueTest, KeyEnqueuedWhileUploadingIsUploadedAgainAfterward) {
+    UploadRecorder recorder;
+    recorder.blocked = true;
+    WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 1 << 20, 4);
+
+    queue.enqueue("file", 10);
+    recorder.waitForUploads(1);
+    queue.enqueue("file", 20);
+
+    // Other workers are idle, but the second upload must wait for the first
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_EQ(recorder.count("file"), 1u);
+
+    recorder.release();
+    queue.drain();
+    EXPECT_EQ(recorder.count("file"), 2u);
+    EXPECT_EQ(recorder.max_in_flight_per_key, 1);
+}
+
+TEST(WriteBackQueueTest, WaitReturnsAndClearsUploadError) {
+    UploadRecorder recorder;
+    recorder.failing = "bad";
+    WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 1 << 20, 2);
+
+    queue.enqueue("bad", 1);
+    queue.enqueue("good", 1);
+    EXPECT_EQ(queue.wait("bad"), -EIO);
+    EXPECT_EQ(queue.wait("bad"), 0);
+    EXPECT_EQ(queue.wait("good"), 0);
+    EXPECT_EQ(queue.stats().failed, 1u);
+}
+
+TEST(WriteBackQueueTest, TakeErrorDoesNotWait) {
+    UploadRecorder recorder;
+    recorder.failing = "bad";
+    WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 1 << 20, 1);
+
+    EXPECT_EQ(queue.takeError("bad"), 0);
+    queue.enqueue("bad", 1);
+    queue.drain();
+    EXPECT_EQ(queue.takeError("bad"), -EIO);
+    EXPECT_EQ(queue.takeError("bad"), 0);
+}
+
+TEST(WriteBackQueueTest, WaitsForBytesBudget) {
+    UploadRecorder recorder;
+    recorder.blocked = true;
+    WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 100, 1);
+
+    queue.enqueue("first", 80);
+    recorder.waitForUploads(1);
+
+    std::atomic<bool> enqueued{false};
+    std::thread writer([&] {
+        queue.enqueue("second", 80);
+        enqueued = true;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    EXPECT_FALSE(enqueued.load());
+
+    recorder.release();
+    writer.join();
+    EXPECT_TRUE(enqueued.load());
+    queue.drain();
+    EXPECT_EQ(recorder.count("second"), 1u);
+    EXPECT_EQ(queue.stats().throttled, 1u);
+}
+
+TEST(WriteBackQueueTest, OversizedKeyGoesThroughWhenIdle) {
+    UploadRecorder recorder;
+    WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 100, 1);
+
+    queue.enqueue("huge", 1000);
+    queue.drain();
+    EXPECT_EQ(recorder.count("huge"), 1u);
+    EXPECT_EQ(queue.stats().throttled, 0u);
+}
+
+TEST(WriteBackQueueTest, DestructorUploadsPendingWork) {
+    UploadRecorder recorder;
+    recorder.blocked = true;
+    {
+        WriteBackQueue queue([&](const std::string& k) { return recorder(k); }, 1 << 20, 1);
+        queue.enqueue("running", 1);
+        recorder.waitForUploads(1);
+        queue.enqueue("pending", 1);
+        recorder.release();
+    }
+    EXPECT_EQ(recorder.count("running"), 1u);
+    EXPECT_EQ(recorder.count("pending"), 1u);
+}
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,471 @@
+#!/usr/bin/env python3
+"""
+Multi-client load harness for gcscfuse against a local GCS emulator.
+
+Mounts gcscfuse once per (config, workload, clients) combination, runs the
+workload from P processes x T threads and reports throughput and latency
+percentiles per operation. Configs are sets of GCSFUSE_* environment
+variables (see configs.json), so any GCSFSConfig knob can be compared.
+
+Workloads:
+  shard_fanout      each client streams its own large shards in 1 MiB reads
+  tree_walk         every client walks the whole tree, listing and stat'ing
+  checkpoint_write  each client writes large checkpoint files and closes them
+  small_files       random whole-file reads of 4-64 KiB files
+
+Usage:
+  python3 load_harness.py --binary ../../build/gcscfuse
+  python3 load_harness.py --configs default,no-stat-cache --workloads tree_walk \\
+      --clients 1x1,4x8 --duration 20
+  python3 load_harness.py --target-dir /mnt/gcs   # already mounted, no emulator
+
+The emulator is any server speaking the GCS JSON API (fake-gcs-server,
+storage-testbench) at --emulator, default $CLOUD_STORAGE_EMULATOR_ENDPOINT
+or http://localhost:4443. --start-emulator runs fake-gcs-server in docker.
+gcscfuse reaches it through the SDK's CLOUD_STORAGE_EMULATOR_ENDPOINT.
+"""
+
+import argparse
+import json
+import multiprocessing
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+import urllib.error
+import urllib.parse
+import urllib.request
+from concurrent.futures import ThreadPoolExecutor
+from datetime import datetime
+from pathlib import Path
+
+SCRIPT_DIR = Path(__file__).resolve().parent
+PREFIX = "loadtest"
+READ_CHUNK = 1024 * 1024
+WRITE_CHUNK = 4 * 1024 * 1024
+MIB = 1024 * 1024
+
+WORKLOADS = ["shard_fanout", "tree_walk", "checkpoint_write", "small_files"]
+
+
+# ----------------------------------------------------------------------------
+# Dataset
+# ----------------------------------------------------------------------------
+
+def dataset(scale):
+    """Objects read by the workloads, as (name, size) pairs."""
+    shards = max(1, int(32 * scale))
+    shard_size = 32 * MIB
+    objects = [(f"{PREFIX}/shards/shard-{i:05d}.bin", shard_size) for i in range(shards)]
+    top = max(1, int(10 * scale))
+    for a in range(top):
+        for b in range(10):
+            for c in range(20):
+                objects.append((f"{PREFIX}/tree/d{a:02d}/d{b:02d}/f{c:03d}.txt", 1024))
+    # gcscfuse has no mkdir, so checkpoints are written into a seeded directory
+    objects.append((f"{PREFIX}/checkpoints/.keep", 0))
+    rng = random.Random(42)
+    for i in range(max(1, int(2000 * scale))):
+        objects.append((f"{PREFIX}/small/d{i // 100:03d}/f{i:05d}.bin", rng.randint(4, 64) * 1024))
+    return objects
+
+
+def content(name, size):
+    """Deterministic content for an object."""
+    pattern = (name.encode() + b"\n") * (64 // (len(name) + 1) + 1)
+    return (pattern * (size // len(pattern) + 1))[:size]
+
+
+class Emulator:
+    """Minimal GCS JSON API client for seeding the emulator."""
+
+    def __init__(self, endpoint, bucket):
+        self.endpoint = endpoint.rstrip("/")
+        self.bucket = bucket
+
+    def request(self, method, path, data=None, headers=None):
+        req = urllib.request.Request(self.endpoint + path, data=data, method=method, headers=headers or {})
+        with urllib.request.urlopen(req, timeout=60) as resp:
+            return resp.read()
+
+    def wait_ready(self, timeout=30):
+        deadline = time.time() + timeout
+        while True:
+            try:
+                self.request("GET", "/storage/v1/b?project=loadtest")
+                return
+            except (urllib.error.URLError, ConnectionError):
+                if time.time() > deadline:
+                    raise RuntimeError(f"GCS emulator not reachable at {self.endpoint}")
+                time.sleep(0.5)
+
+    def create_bucket(self):
+        body = json.dumps({"name": self.bucket}).encode()
+        try:
+            self.request("POST", "/storage/v1/b?project=loadtest", body, {"Content-Type": "application/json"})
+        except urllib.error.HTTPError as e:
+            if e.code != 409:  # already exists
+                raise
+
+    def upload(self, name, data):
+        query = urllib.parse.urlencode({"uploadType": "media", "name": name})
+        self.request("POST", f"/upload/storage/v1/b/{self.bucket}/o?{query}", data,
+                     {"Content-Type": "application/octet-stream"})
+
+
+def seed_emulator(emulator, objects, parallelism=16):
+    emulator.create_bucket()
+    with ThreadPoolExecutor(parallelism) as pool:
+        list(pool.map(lambda obj: emulator.upload(obj[0], content(*obj)), objects))
+
+
+def seed_directory(root, objects):
+    for name, size in objects:
+        path = Path(root) / name
+        if path.exists() and path.stat().st_size == size:
+            continue
+        path.parent.mkdir(parents=True, exist_ok=True)
+        path.write_bytes(content(name, size))
+
+
+def start_emulator(port):
+    subprocess.run(["docker", "rm", "-f", "gcscfuse-load-emulator"], capture_output=True)
+    subprocess.run(["docker", "run", "-d", "--rm", "--name", "gcscfuse-load-emulator",
+                    "-p", f"{port}:{port}", "fsouza/fake-gcs-server",
+                    "-scheme", "http", "-port", str(port), "-public-host", f"localhost:{port}"],
+                   check=True, capture_output=True)
+
+
+def stop_emulator():
+    subprocess.run(["docker", "rm", "-f", "gcscfuse-load-emulator"], capture_output=True)
+
+
+# ----------------------------------------------------------------------------
+# Workloads: each runs in one client thread until the deadline and returns
+# {op: [latency_seconds, ...]} plus the bytes moved
+# ----------------------------------------------------------------------------
+
+class Recorder:
+    def __init__(self):
+        self.latencies = {}
+        self.bytes = 0
+
+    def time(self, op, fn, *args):
+        start = time.perf_counter()
+        result = fn(*args)
+        self.latencies.setdefault(op, []).append(time.perf_counter() - start)
+        return result
+
+
+def shard_fanout(root, client, clients, deadline, rec, run_id):
+    shards = sorted((Path(root) / PREFIX / "shards").iterdir())
+    mine = shards[client::clients] or [shards[client % len(shards)]]
+    while time.time() < deadline:
+        for shard in mine:
+            fd = rec.time("open", os.open, shard, os.O_RDONLY)
+            try:
+                while time.time() < deadline:
+                    data = rec.time("read", os.read, fd, READ_CHUNK)
+                    if not data:
+                        break
+                    rec.bytes += len(data)
+            finally:
+                os.close(fd)
+            if time.time() >= deadline:
+                return
+
+
+def tree_walk(root, client, clients, deadline, rec, run_id):
+    tree = Path(root) / PREFIX / "tree"
+    tops = sorted(os.listdir(tree))
+    # Clients start at different subtrees, as concurrent find(1) runs would
+    order = tops[client % len(tops):] + tops[:client % len(tops)]
+    while time.time() < deadline:
+        for top in order:
+            stack = [str(tree / top)]
+            while stack and time.time() < deadline:
+                path = stack.pop()
+                for entry in rec.time("listdir", os.listdir, path):
+                    full = os.path.join(path, entry)
+                    st = rec.time("stat", os.stat, full)
+                    if (st.st_mode & 0o170000) == 0o040000:
+                        stack.append(full)
+
+
+def checkpoint_write(root, client, clients, deadline, rec, run_id, size=64 * MIB):
+    directory = Path(root) / PREFIX / "checkpoints"
+    chunk = os.urandom(WRITE_CHUNK)
+    index = 0
+    while time.time() < deadline:
+        path = directory / f"{run_id}.client{client:03d}.ckpt-{index:04d}.bin"
+        fd = rec.time("create", os.open, path, os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o644)
+        try:
+            written = 0
+            while written < size:
+                written += rec.time("write", os.write, fd, chunk[:min(WRITE_CHUNK, size - written)])
+            rec.bytes += written
+        finally:
+            # close uploads the file, so it is timed as its own op
+            rec.time("close", os.close, fd)
+        index += 1
+
+
+def small_files(root, client, clients, deadline, rec, run_id):
+    small = Path(root) / PREFIX / "small"
+    files = [str(d / f) for d in sorted(small.iterdir()) for f in sorted(os.listdir(d))]
+    rng = random.Random(client)
+
+    def read_whole(path):
+        with open(path, "rb", buffering=0) as f:
+            return f.read()
+
+    while time.time() < deadline:
+        rec.bytes += len(rec.time("file", read_whole, rng.choice(files)))
+
+
+WORKLOAD_FUNCS = {
+    "shard_fanout": shard_fanout,
+    "tree_walk": tree_walk,
+    "checkpoint_write": checkpoint_write,
+    "small_files": small_files,
+}
+
+
+def client_process(args):
+    workload, root, process_index, processes, threads, deadline, run_id = args
+    recorders = [Recorder() for _ in range(threads)]
+    errors = []
+
+    def run(thread_index):
+        client = process_index * threads + thread_index
+        try:
+            WORKLOAD_FUNCS[workload](root, client, processes * threads, deadline, recorders[thread_index], run_id)
+        except OSError as e:
+            errors.append(str(e))
+
+    workers = [threading.Thread(target=run, args=(i,)) for i in range(threads)]
+    for worker in workers:
+        worker.start()
+    for worker in workers:
+        worker.join()
+    latencies = {}
+    for rec in recorders:
+        for op, values in rec.latencies.items():
+            latencies.setdefault(op, []).extend(values)
+    return latencies, sum(rec.bytes for rec in recorders), errors
+
+
+def run_workload(workload, root, processes, threads, duration, run_id):
+    start = time.time()
+    deadline = start + duration
+    jobs = [(workload, root, p, processes, threads, deadline, run_id) for p in range(processes)]
+    with multiprocessing.get_context("fork").Pool(processes) as pool:
+        results = pool.map(client_process, jobs)
+    elapsed = time.time() - start
+    latencies, total_bytes, errors = {}, 0, []
+    for lat, nbytes, errs in results:
+        for op, values in lat.items():
+            latencies.setdefault(op, []).extend(values)
+        total_bytes += nbytes
+        errors.extend(errs)
+    return latencies, total_bytes, errors, elapsed
+
+
+# ----------------------------------------------------------------------------
+# Mounting and reporting
+# ----------------------------------------------------------------------------
+
+def percentile(sorted_values, q):
+    if not sorted_values:
+        return 0.0
+    index = min(len(sorted_values) - 1, max(0, int(q * len(sorted_values) + 0.5) - 1))
+    return sorted_values[index]
+
+
+def summarize(latencies, elapsed):
+    ops = {}
+    for op, values in sorted(latencies.items()):
+        values.sort()
+        ops[op] = {
+            "count": len(values),
+            "ops_per_sec": len(values) / elapsed if elapsed > 0 else 0.0,
+            "p50_ms": percentile(values, 0.50) * 1e3,
+            "p90_ms": percentile(values, 0.90) * 1e3,
+            "p99_ms": percentile(values, 0.99) * 1e3,
+            "p999_ms": percentile(values, 0.999) * 1e3,
+            "max_ms": values[-1] * 1e3,
+        }
+    return ops
+
+
+class Mount:
+    def __init__(self, binary, bucket, env, log_path):
+        self.mount_point = tempfile.mkdtemp(prefix="gcscfuse_load_")
+        self.log = open(log_path, "w")
+        self.proc = subprocess.Popen([binary, bucket, self.mount_point, "-f"], env=env,
+                                     stdout=self.log, stderr=subprocess.STDOUT)
+        deadline = time.time() + 15
+        while not os.path.ismount(self.mount_point):
+            if self.proc.poll() is not None or time.time() > deadline:
+                self.close()
+                raise RuntimeError(f"gcscfuse failed to mount, see {log_path}")
+            time.sleep(0.1)
+
+    def stats(self):
+        try:
+            return Path(self.mount_point, ".gcscfuse", "stats").read_text()
+        except OSError:
+            return ""
+
+    def close(self):
+        for tool in ("fusermount3", "fusermount"):
+            if shutil.which(tool):
+                subprocess.run([tool, "-u", self.mount_point], capture_output=True)
+                break
+        try:
+            self.proc.wait(timeout=30)
+        except subprocess.TimeoutExpired:
+            self.proc.kill()
+            self.proc.wait()
+        self.log.close()
+        os.rmdir(self.mount_point)
+
+
+def parse_clients(spec):
+    result = []
+    for item in spec.split(","):
+        processes, _, threads = item.partition("x")
+        result.append((int(processes), int(threads or 1)))
+    return result
+
+
+def write_summary(path, runs):
+    lines = [
+        "| config | workload | clients | MiB/s | op | ops/s | p50 ms | p90 ms | p99 ms | p99.9 ms | max ms |",
+        "|--------|----------|---------|-------|----|-------|--------|--------|--------|----------|--------|",
+    ]
+    for run in runs:
+        mib_s = run["bytes"] / MIB / run["duration_s"] if run["duration_s"] > 0 else 0.0
+        for op, s in run["ops"].items():
+            lines.append(f"| {run['config']} | {run['workload']} | {run['processes']}x{run['threads']} "
+                         f"| {mib_s:.1f} | {op} | {s['ops_per_sec']:.0f} | {s['p50_ms']:.3f} | {s['p90_ms']:.3f} "
+                         f"| {s['p99_ms']:.3f} | {s['p999_ms']:.3f} | {s['max_ms']:.3f} |")
+    Path(path).write_text("\n".join(lines) + "\n")
+    print("\n".join(lines))
+
+
+def find_binary():
+    for candidate in ("./gcscfuse", "../build/gcscfuse", "../../build/gcscfuse", "./build/gcscfuse"):
+        if os.path.exists(candidate):
+            return candidate
+    return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--binary", default=find_binary(), help="gcscfuse binary")
+    parser.add_argument("--bucket", default="gcscfuse-load", help="emulator bucket")
+    parser.add_argument("--emulator", default=os.environ.get("CLOUD_STORAGE_EMULATOR_ENDPOINT", "http://localhost:4443"))
+    parser.add_argument("--start-emulator", action="store_true", help="run fake-gcs-server in docker")
+    parser.add_argument("--target-dir", help="run against this already-mounted directory instead")
+    parser.add_argument("--config-file", default=str(SCRIPT_DIR / "configs.json"))
+    parser.add_argument("--configs", help="comma-separated config names (default: all)")
+    parser.add_argument("--workloads", default=",".join(WORKLOADS))
+    parser.add_argument("--clients", default="1x1,1x8,4x8", help="PROCESSESxTHREADS list")
+    parser.add_argument("--duration", type=float, default=30, help="seconds per run")
+    parser.add_argument("--scale", type=float, default=1.0, help="dataset size multiplier")
+    parser.add_argument("--skip-seed", action="store_true")
+    parser.add_argument("--results-dir", default=f"./load_results_{datetime.now():%Y%m%d_%H%M%S}")
+    args = parser.parse_args()
+
+    workloads = args.workloads.split(",")
+    unknown = [w for w in workloads if w not in WORKLOAD_FUNCS]
+    if unknown:
+        parser.error(f"unknown workloads: {', '.join(unknown)}")
+    clients = parse_clients(args.clients)
+    with open(args.config_file) as f:
+        configs = json.load(f)
+    if args.target_dir:
+        configs = {"external": {}}
+    elif args.configs:
+        configs = {name: configs[name] for name in args.configs.split(",")}
+    if not args.target_dir and not args.binary:
+        parser.error("gcscfuse binary not found, pass --binary")
+
+    results_dir = Path(args.results_dir)
+    results_dir.mkdir(parents=True, exist_ok=True)
+    objects = dataset(args.scale)
+
+    if args.start_emulator:
+        start_emulator(urllib.parse.urlparse(args.emulator).port or 4443)
+    try:
+        if not args.skip_seed:
+            total = sum(size for _, size in objects)
+            print(f"Seeding {len(objects)} objects ({total / MIB:.0f} MiB)...")
+            if args.target_dir:
+                seed_directory(args.target_dir, objects)
+            else:
+                emulator = Emulator(args.emulator, args.bucket)
+                emulator.wait_ready()
+                seed_emulator(emulator, objects)
+
+        runs = []
+        for config_name, config_env in configs.items():
+            for workload in workloads:
+                for processes, threads in clients:
+                    label = f"{config_name}.{workload}.{processes}x{threads}"
+                    print(f"\n=== {label} ({args.duration:.0f}s) ===")
+                    mount = None
+                    if args.target_dir:
+                        root = args.target_dir
+                    else:
+                        env = dict(os.environ, CLOUD_STORAGE_EMULATOR_ENDPOINT=args.emulator)
+                        env.update({key: str(value) for key, value in config_env.items()})
+                        mount = Mount(args.binary, args.bucket, env, results_dir / f"{label}.mount.log")
+                        root = mount.mount_point
+                    try:
+                        latencies, nbytes, errors, elapsed = run_workload(
+                            workload, root, processes, threads, args.duration, label)
+                        if mount:
+                            (results_dir / f"{label}.stats.txt").write_text(mount.stats())
+                        if workload == "checkpoint_write":
+                            for path in (Path(root) / PREFIX / "checkpoints").glob(f"{label}.*"):
+                                path.unlink()
+                    finally:
+                        if mount:
+                            mount.close()
+                    run = {
+                        "config": config_name,
+                        "env": config_env,
+                        "workload": workload,
+                        "processes": processes,
+                        "threads": threads,
+                        "duration_s": elapsed,
+                        "bytes": nbytes,
+                        "errors": errors[:20],
+                        "error_count": len(errors),
+                        "ops": summarize(latencies, elapsed),
+                    }
+                    runs.append(run)
+                    for op, s in run["ops"].items():
+                        print(f"  {op:8s} {s['ops_per_sec']:10.0f} ops/s  p50 {s['p50_ms']:.3f} ms  "
+                              f"p99 {s['p99_ms']:.3f} ms  p99.9 {s['p999_ms']:.3f} ms")
+                    if errors:
+                        print(f"  {len(errors)} client errors, first: {errors[0]}")
+
+        (results_dir / "results.json").write_text(json.dumps({"runs": runs}, indent=2))
+        print()
+        write_summary(results_dir / "summary.md", runs)
+        print(f"\nResults: {results_dir}/results.json, {results_dir}/summary.md")
+        return 1 if any(run["error_count"] for run in runs) else 0
+    finally:
+        if args.start_emulator:
+            stop_emulator()
+
+
+if __name__ == "__main__":
+    sys.exit(main())